@@ -392,6 +392,22 @@ AC_DEFUN([OPAL_SETUP_CC],[
     AC_DEFINE_UNQUOTED([OPAL_C_HAVE_BUILTIN_CLZ], [$have_cc_builtin_clz],
         [Whether C compiler supports __builtin_clz])
 
+    # see if the C compiler supports __builtin_ctzll
+    AC_CACHE_CHECK([if $CC supports __builtin_ctzll],
+        [opal_cv_cc_supports___builtin_ctzll],
+        [AC_LINK_IFELSE([AC_LANG_PROGRAM([],
+            [unsigned long long value = 0x10000; /* we know the lowest bit set is 16 */
+             if (16 != __builtin_ctzll(value)) return 0;])],
+            [opal_cv_cc_supports___builtin_ctzll="yes"],
+            [opal_cv_cc_supports___builtin_ctzll="no"])])
+    if test "$opal_cv_cc_supports___builtin_ctzll" = "yes" ; then
+        have_cc_builtin_ctzll=1
+    else
+        have_cc_builtin_ctzll=0
+    fi
+    AC_DEFINE_UNQUOTED([OPAL_C_HAVE_BUILTIN_CTZLL], [$have_cc_builtin_ctzll],
+        [Whether C compiler supports __builtin_ctzll])
+
     # Preload the optflags for the case where the user didn't specify
     # any.  If we're using GNU compilers, use -O3 (since it GNU
     # doesn't require all compilation units to be compiled with the
@@ -20,6 +20,7 @@
 
 #include "ompi/mca/pml/pml.h"
 #include "ompi/runtime/params.h"
+#include "ompi/runtime/ompi_async_progress.h"
 
 #include "ompi/interlib/interlib.h"
 #include "ompi/communicator/communicator.h"
@@ -347,6 +348,14 @@ static int ompi_mpi_instance_init_common (int argc, char **argv)
         return ret;
     }
 
+    /* the asynchronous progress thread enters the progress engine
+     * concurrently with the application, the components have to be
+     * selected and initialized thread-safe */
+    if (ompi_mpi_async_progress) {
+        opal_set_using_threads(true);
+        ompi_mpi_thread_multiple = true;
+    }
+
     OBJ_CONSTRUCT(&ompi_instance_common_domain, opal_finalize_domain_t);
     opal_finalize_domain_init (&ompi_instance_common_domain, "ompi_mpi_instance_init_common");
     opal_finalize_set_domain (&ompi_instance_common_domain);
@@ -766,6 +775,10 @@ static int ompi_mpi_instance_init_common (int argc, char **argv)
         opal_progress_set_event_poll_rate(ompi_mpi_event_tick_rate);
     }
 
+    if (OMPI_SUCCESS != (ret = ompi_async_progress_init())) {
+        return ompi_instance_print_error ("ompi_async_progress_init", ret);
+    }
+
     /* At this point, we are fully configured and in MPI mode.  Any
        communication calls here will work exactly like they would in
        the user's code.  Setup the connections between procs and warm
@@ -851,6 +864,9 @@ static int ompi_mpi_instance_finalize_common (void)
     int ret;
     opal_pmix_lock_t mylock;
 
+    /* nothing may enter the progress engine behind our back from now on */
+    ompi_async_progress_finalize();
+
     /* As finalize is the last legal MPI call, we are allowed to force the release
      * of the user buffer used for bsend, before going anywhere further.
      */
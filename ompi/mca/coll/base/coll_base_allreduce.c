@@ -1243,3 +1243,214 @@ int ompi_coll_base_allreduce_intra_redscat_allgather(
 }
 
 /* copied function (with appropriate renaming) ends here */
+
+/*
+ *   ompi_coll_base_allreduce_intra_recursive_multiplying
+ *
+ *   Function:       Recursive multiplying (k-nomial) algorithm for allreduce
+ *   Accepts:        Same as MPI_Allreduce(), plus the radix k (>= 2)
+ *   Returns:        MPI_SUCCESS or error code
+ *
+ *   Description:    Generalization of recursive doubling to an arbitrary
+ *                   radix. Ranks are viewed as base-k numbers; in every step
+ *                   a rank exchanges its whole vector with the k - 1 ranks
+ *                   that differ from it only in the current digit, so the
+ *                   exchange completes in \log_k(p') steps instead of
+ *                   \log_2(p'), where p' is the largest power of k not greater
+ *                   than p. The p - p' remaining ranks first fold their data
+ *                   into rank (r mod p') and receive the result at the end,
+ *                   which costs a single extra round on either side no matter
+ *                   how far p is from a power of k.
+ *                   Every member of a group reduces the k contributions in the
+ *                   same (digit) order, so all ranks end up with bitwise
+ *                   identical results.
+ *
+ *   Limitations:    commutative operations only (falls back to recursive
+ *                   doubling otherwise, since the fold-in reorders ranks)
+ *
+ *         Example on 11 nodes, radix 3 (p' = 9):
+ *         Fold-in             9 -> 0, 10 -> 1
+ *         Step 1 (distance 1) {0,1,2} {3,4,5} {6,7,8}
+ *         Step 2 (distance 3) {0,3,6} {1,4,7} {2,5,8}
+ *         Fold-out            0 -> 9, 1 -> 10
+ *
+ *   Memory requirements (per process):
+ *   (k - 1) * count * extent
+ */
+int
+ompi_coll_base_allreduce_intra_recursive_multiplying(const void *sbuf, void *rbuf,
+                                                     int count,
+                                                     struct ompi_datatype_t *dtype,
+                                                     struct ompi_op_t *op,
+                                                     struct ompi_communicator_t *comm,
+                                                     mca_coll_base_module_t *module,
+                                                     int radix)
+{
+    int ret, line, rank, size, nprocs_pow, distance, digit, base, peer, slot, i;
+    int nreqs = 0;
+    char *tmpbuf_free = NULL, *tmpbuf, *accbuf;
+    ptrdiff_t span, gap = 0;
+    ompi_request_t **reqs = NULL;
+
+    size = ompi_comm_size(comm);
+    rank = ompi_comm_rank(comm);
+
+    OPAL_OUTPUT((ompi_coll_base_framework.framework_output,
+                 "coll:base:allreduce_intra_recursive_multiplying rank %d radix %d",
+                 rank, radix));
+
+    /* Special case for size == 1 */
+    if (1 == size) {
+        if (MPI_IN_PLACE != sbuf) {
+            ret = ompi_datatype_copy_content_same_ddt(dtype, count, (char*)rbuf, (char*)sbuf);
+            if (ret < 0) { line = __LINE__; goto error_hndl; }
+        }
+        return MPI_SUCCESS;
+    }
+
+    if (!ompi_op_is_commute(op)) {
+        OPAL_OUTPUT((ompi_coll_base_framework.framework_output,
+                     "coll:base:allreduce_intra_recursive_multiplying rank %d "
+                     "non-commutative op, switching to recursive doubling", rank));
+        return ompi_coll_base_allreduce_intra_recursivedoubling(sbuf, rbuf, count, dtype,
+                                                                op, comm, module);
+    }
+
+    if (radix < 2) radix = 2;
+    if (radix > size) radix = size;
+
+    /* Determine the largest power of radix less than or equal to size */
+    for (nprocs_pow = 1; nprocs_pow <= size / radix; nprocs_pow *= radix);
+
+    if (MPI_IN_PLACE != sbuf) {
+        ret = ompi_datatype_copy_content_same_ddt(dtype, count, (char*)rbuf, (char*)sbuf);
+        if (ret < 0) { line = __LINE__; goto error_hndl; }
+    }
+
+    /* Handle the ranks above the largest power of radix:
+       - they send their data to (rank mod nprocs_pow), wait for the final
+       result from the same rank and take no part in the exchange steps.
+    */
+    if (rank >= nprocs_pow) {
+        peer = rank % nprocs_pow;
+        ret = MCA_PML_CALL(send(rbuf, count, dtype, peer,
+                                MCA_COLL_BASE_TAG_ALLREDUCE,
+                                MCA_PML_BASE_SEND_STANDARD, comm));
+        if (MPI_SUCCESS != ret) { line = __LINE__; goto error_hndl; }
+        ret = MCA_PML_CALL(recv(rbuf, count, dtype, peer,
+                                MCA_COLL_BASE_TAG_ALLREDUCE, comm,
+                                MPI_STATUS_IGNORE));
+        if (MPI_SUCCESS != ret) { line = __LINE__; goto error_hndl; }
+        return MPI_SUCCESS;
+    }
+
+    /* One receive slot per peer of a step; at most radix - 1 ranks are folded
+       onto a single rank as well, so the same slots serve the fold-in. */
+    span = opal_datatype_span(&dtype->super, count, &gap);
+    tmpbuf_free = (char*) malloc(span * (radix - 1));
+    if (NULL == tmpbuf_free) { ret = OMPI_ERR_OUT_OF_RESOURCE; line = __LINE__; goto error_hndl; }
+    tmpbuf = tmpbuf_free - gap;
+
+    reqs = ompi_coll_base_comm_get_reqs(module->base_data, 2 * (radix - 1));
+    if (NULL == reqs) { ret = OMPI_ERR_OUT_OF_RESOURCE; line = __LINE__; goto error_hndl; }
+
+    /* Fold in the data of the ranks mapped onto this one */
+    for (peer = rank + nprocs_pow; peer < size; peer += nprocs_pow) {
+        ret = MCA_PML_CALL(irecv(tmpbuf + (ptrdiff_t)nreqs * span, count, dtype, peer,
+                                 MCA_COLL_BASE_TAG_ALLREDUCE, comm, &reqs[nreqs]));
+        nreqs++;
+        if (MPI_SUCCESS != ret) { line = __LINE__; goto error_hndl; }
+    }
+    if (0 < nreqs) {
+        ret = ompi_request_wait_all(nreqs, reqs, MPI_STATUSES_IGNORE);
+        if (MPI_SUCCESS != ret) { line = __LINE__; goto error_hndl; }
+        for (i = 0; i < nreqs; i++) {
+            /* rbuf = tmpbuf[i] (op) rbuf */
+            ompi_op_reduce(op, tmpbuf + (ptrdiff_t)i * span, rbuf, count, dtype);
+        }
+        nreqs = 0;
+    }
+
+    /* Communication/Computation loop
+       - Exchange the vector with the radix - 1 ranks sharing all digits but
+       the current one.
+       - Reduce the radix contributions in digit order:
+       result = v_0 (op) v_1 (op) ... (op) v_{radix-1}
+    */
+    for (distance = 1; distance < nprocs_pow; distance *= radix) {
+        digit = (rank / distance) % radix;
+        base = rank - digit * distance;
+
+        for (i = 0; i < radix; i++) {
+            if (i == digit) continue;
+            slot = (i < digit) ? i : i - 1;
+            ret = MCA_PML_CALL(irecv(tmpbuf + (ptrdiff_t)slot * span, count, dtype,
+                                     base + i * distance, MCA_COLL_BASE_TAG_ALLREDUCE,
+                                     comm, &reqs[nreqs]));
+            nreqs++;
+            if (MPI_SUCCESS != ret) { line = __LINE__; goto error_hndl; }
+        }
+        for (i = 0; i < radix; i++) {
+            if (i == digit) continue;
+            ret = MCA_PML_CALL(isend(rbuf, count, dtype, base + i * distance,
+                                     MCA_COLL_BASE_TAG_ALLREDUCE,
+                                     MCA_PML_BASE_SEND_STANDARD, comm, &reqs[nreqs]));
+            nreqs++;
+            if (MPI_SUCCESS != ret) { line = __LINE__; goto error_hndl; }
+        }
+        ret = ompi_request_wait_all(nreqs, reqs, MPI_STATUSES_IGNORE);
+        if (MPI_SUCCESS != ret) { line = __LINE__; goto error_hndl; }
+        nreqs = 0;
+
+        /* Accumulate from the highest digit down, so that every rank of the
+           group applies the operation in the same order */
+        accbuf = (radix - 1 == digit) ? (char*)rbuf : tmpbuf + (ptrdiff_t)(radix - 2) * span;
+        for (i = radix - 2; i >= 0; i--) {
+            if (i == digit) {
+                ompi_op_reduce(op, rbuf, accbuf, count, dtype);
+            } else {
+                slot = (i < digit) ? i : i - 1;
+                ompi_op_reduce(op, tmpbuf + (ptrdiff_t)slot * span, accbuf, count, dtype);
+            }
+        }
+        if (accbuf != (char*)rbuf) {
+            ret = ompi_datatype_copy_content_same_ddt(dtype, count, (char*)rbuf, accbuf);
+            if (ret < 0) { line = __LINE__; goto error_hndl; }
+        }
+    }
+
+    /* Send the result back to the folded ranks */
+    for (peer = rank + nprocs_pow; peer < size; peer += nprocs_pow) {
+        ret = MCA_PML_CALL(isend(rbuf, count, dtype, peer,
+                                 MCA_COLL_BASE_TAG_ALLREDUCE,
+                                 MCA_PML_BASE_SEND_STANDARD, comm, &reqs[nreqs]));
+        nreqs++;
+        if (MPI_SUCCESS != ret) { line = __LINE__; goto error_hndl; }
+    }
+    if (0 < nreqs) {
+        ret = ompi_request_wait_all(nreqs, reqs, MPI_STATUSES_IGNORE);
+        if (MPI_SUCCESS != ret) { line = __LINE__; goto error_hndl; }
+    }
+
+    free(tmpbuf_free);
+    return MPI_SUCCESS;
+
+ error_hndl:
+    /* find a real error code */
+    if (MPI_ERR_IN_STATUS == ret) {
+        for (i = 0; i < nreqs; i++) {
+            if (MPI_REQUEST_NULL == reqs[i]) continue;
+            if (MPI_ERR_PENDING == reqs[i]->req_status.MPI_ERROR) continue;
+            if (MPI_SUCCESS != reqs[i]->req_status.MPI_ERROR) {
+                ret = reqs[i]->req_status.MPI_ERROR;
+                break;
+            }
+        }
+    }
+    OPAL_OUTPUT((ompi_coll_base_framework.framework_output, "%s:%4d\tRank %d Error occurred %d\n",
+                 __FILE__, line, rank, ret));
+    (void)line;  // silence compiler warning
+    if (NULL != reqs) ompi_coll_base_free_reqs(reqs, nreqs);
+    if (NULL != tmpbuf_free) free(tmpbuf_free);
+    return ret;
+}
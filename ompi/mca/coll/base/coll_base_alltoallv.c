@@ -341,3 +341,370 @@ ompi_coll_base_alltoallv_intra_basic_linear(const void *sbuf, const int *scounts
 
     return err;
 }
+
+/*
+ * Post the next non-empty receive of the scattered algorithm, walking the
+ * peers by increasing distance to the right. Leaves the request untouched
+ * once every peer has been visited.
+ */
+static inline int
+alltoallv_scattered_post_recv(void *rbuf, const int *rcounts, const int *rdisps,
+                              struct ompi_datatype_t *rdtype, size_t rsize, ptrdiff_t rext,
+                              int rank, int size, int *step,
+                              struct ompi_communicator_t *comm, ompi_request_t **req)
+{
+    int peer;
+
+    for (; *step < size; (*step)++) {
+        peer = (rank + *step) % size;
+        if (0 == (size_t)rcounts[peer] * rsize) {
+            continue;
+        }
+        (*step)++;
+        return MCA_PML_CALL(irecv((char *) rbuf + (ptrdiff_t)rdisps[peer] * rext,
+                                  rcounts[peer], rdtype, peer,
+                                  MCA_COLL_BASE_TAG_ALLTOALLV, comm, req));
+    }
+    return MPI_SUCCESS;
+}
+
+/* Same as above for the sends, walking the peers to the left. */
+static inline int
+alltoallv_scattered_post_send(const void *sbuf, const int *scounts, const int *sdisps,
+                              struct ompi_datatype_t *sdtype, size_t ssize, ptrdiff_t sext,
+                              int rank, int size, int *step,
+                              struct ompi_communicator_t *comm, ompi_request_t **req)
+{
+    int peer;
+
+    for (; *step < size; (*step)++) {
+        peer = (rank + size - *step) % size;
+        if (0 == (size_t)scounts[peer] * ssize) {
+            continue;
+        }
+        (*step)++;
+        return MCA_PML_CALL(isend((char *) sbuf + (ptrdiff_t)sdisps[peer] * sext,
+                                  scounts[peer], sdtype, peer,
+                                  MCA_COLL_BASE_TAG_ALLTOALLV,
+                                  MCA_PML_BASE_SEND_STANDARD, comm, req));
+    }
+    return MPI_SUCCESS;
+}
+
+/*
+ * ompi_coll_base_alltoallv_intra_scattered
+ *
+ * Function:  Alltoallv with a bounded window of outstanding requests
+ * Accepts:   Same arguments as MPI_Alltoallv, plus the maximum number of
+ *            outstanding receives (and sends); 0 means no limit
+ * Returns:   MPI_SUCCESS or error code
+ *
+ * Description: Peers are visited by increasing distance, as in the pairwise
+ *              algorithm, but without a synchronization per step: up to
+ *              max_requests receives and max_requests sends are kept in flight
+ *              and a new one is posted as soon as one completes. Peers with
+ *              nothing to exchange are skipped entirely (MPI requires matching
+ *              type signatures, so both sides agree on empty exchanges), which
+ *              makes the cost proportional to the number of actual
+ *              communication partners for sparse exchanges.
+ */
+int
+ompi_coll_base_alltoallv_intra_scattered(const void *sbuf, const int *scounts, const int *sdisps,
+                                         struct ompi_datatype_t *sdtype,
+                                         void *rbuf, const int *rcounts, const int *rdisps,
+                                         struct ompi_datatype_t *rdtype,
+                                         struct ompi_communicator_t *comm,
+                                         mca_coll_base_module_t *module,
+                                         int max_requests)
+{
+    int i, size, rank, err = MPI_SUCCESS, line = -1, nreqs = 0, window, rstep, sstep, completed;
+    size_t ssize, rsize;
+    ptrdiff_t sext, rext;
+    ompi_request_t **reqs = NULL;
+
+    if (MPI_IN_PLACE == sbuf) {
+        return mca_coll_base_alltoallv_intra_basic_inplace (rbuf, rcounts, rdisps,
+                                                             rdtype, comm, module);
+    }
+
+    size = ompi_comm_size(comm);
+    rank = ompi_comm_rank(comm);
+
+    OPAL_OUTPUT((ompi_coll_base_framework.framework_output,
+                 "coll:base:alltoallv_intra_scattered rank %d max_requests %d",
+                 rank, max_requests));
+
+    ompi_datatype_type_extent(sdtype, &sext);
+    ompi_datatype_type_extent(rdtype, &rext);
+    ompi_datatype_type_size(sdtype, &ssize);
+    ompi_datatype_type_size(rdtype, &rsize);
+
+    /* Simple optimization - handle send to self first */
+    if (0 != scounts[rank]) {
+        err = ompi_datatype_sndrcv((char *) sbuf + (ptrdiff_t)sdisps[rank] * sext,
+                                   scounts[rank], sdtype,
+                                   (char *) rbuf + (ptrdiff_t)rdisps[rank] * rext,
+                                   rcounts[rank], rdtype);
+        if (MPI_SUCCESS != err) {
+            return err;
+        }
+    }
+
+    /* If only one process, we're done. */
+    if (1 == size) {
+        return MPI_SUCCESS;
+    }
+
+    /* The first half of the requests holds the receives, the second the sends */
+    window = ((max_requests <= 0) || (max_requests > (size - 1))) ? (size - 1) : max_requests;
+    reqs = ompi_coll_base_comm_get_reqs(module->base_data, 2 * window);
+    if (NULL == reqs) { err = OMPI_ERR_OUT_OF_RESOURCE; line = __LINE__; goto err_hndl; }
+    nreqs = 2 * window;
+
+    /* Post the first batch of receives and sends */
+    for (rstep = 1, sstep = 1, i = 0; i < window; i++) {
+        err = alltoallv_scattered_post_recv(rbuf, rcounts, rdisps, rdtype, rsize, rext,
+                                            rank, size, &rstep, comm, &reqs[i]);
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+        err = alltoallv_scattered_post_send(sbuf, scounts, sdisps, sdtype, ssize, sext,
+                                            rank, size, &sstep, comm, &reqs[window + i]);
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+    }
+
+    /* Refill the window as requests complete, until no request is left */
+    while (1) {
+        err = ompi_request_wait_any(nreqs, reqs, &completed, MPI_STATUS_IGNORE);
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+        if (MPI_UNDEFINED == completed) {
+            break;
+        }
+        reqs[completed] = MPI_REQUEST_NULL;
+        if (completed < window) {
+            err = alltoallv_scattered_post_recv(rbuf, rcounts, rdisps, rdtype, rsize, rext,
+                                                rank, size, &rstep, comm, &reqs[completed]);
+        } else {
+            err = alltoallv_scattered_post_send(sbuf, scounts, sdisps, sdtype, ssize, sext,
+                                                rank, size, &sstep, comm, &reqs[completed]);
+        }
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+    }
+
+    return MPI_SUCCESS;
+
+ err_hndl:
+    /* find a real error code */
+    if (MPI_ERR_IN_STATUS == err) {
+        for( i = 0; i < nreqs; i++ ) {
+            if (MPI_REQUEST_NULL == reqs[i]) continue;
+            if (MPI_ERR_PENDING == reqs[i]->req_status.MPI_ERROR) continue;
+            if (reqs[i]->req_status.MPI_ERROR != MPI_SUCCESS) {
+                err = reqs[i]->req_status.MPI_ERROR;
+                break;
+            }
+        }
+    }
+    OPAL_OUTPUT((ompi_coll_base_framework.framework_output,
+                 "%s:%4d\tError occurred %d, rank %2d", __FILE__, line, err,
+                 rank));
+    (void)line;  // silence compiler warning
+    ompi_coll_base_free_reqs(reqs, nreqs);
+    return err;
+}
+
+/* Grow a temporary buffer of the bruck algorithm to at least len bytes */
+static inline int
+alltoallv_bruck_reserve(char **buf, size_t *capacity, size_t len)
+{
+    char *tmp;
+
+    if (len <= *capacity) {
+        return OMPI_SUCCESS;
+    }
+    tmp = (char *) realloc(*buf, len);
+    if (NULL == tmp) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+    *buf = tmp;
+    *capacity = len;
+    return OMPI_SUCCESS;
+}
+
+/*
+ * ompi_coll_base_alltoallv_intra_bruck
+ *
+ * Function:  Two-phase Bruck algorithm for alltoallv
+ * Accepts:   Same arguments as MPI_Alltoallv
+ * Returns:   MPI_SUCCESS or error code
+ *
+ * Description: Bruck's algorithm completes in \ceil{\log_2(p)} steps by
+ *              forwarding data through intermediate ranks: after a local
+ *              rotation, slot j of a rank holds the (packed) block destined
+ *              to (rank + j), and in step k every rank sends all the slots
+ *              whose index has bit k set to (rank + 2^k). As the forwarding
+ *              ranks cannot know the size of the blocks they receive, each
+ *              step is done in two phases: the sizes of the blocks are
+ *              exchanged first, followed by the blocks themselves.
+ *              After the last step slot j holds the block from (rank - j).
+ *
+ * Limitations: Data is forwarded up to \log_2(p) times, so this algorithm
+ *              only pays off for small, latency-bound exchanges.
+ *
+ * Memory requirements (per process): O(total amount of data forwarded)
+ */
+int
+ompi_coll_base_alltoallv_intra_bruck(const void *sbuf, const int *scounts, const int *sdisps,
+                                     struct ompi_datatype_t *sdtype,
+                                     void *rbuf, const int *rcounts, const int *rdisps,
+                                     struct ompi_datatype_t *rdtype,
+                                     struct ompi_communicator_t *comm,
+                                     mca_coll_base_module_t *module)
+{
+    int i, j, n, rank, size, distance, sendto, recvfrom, nblocks, err = MPI_SUCCESS, line = -1;
+    size_t ssize, rsize, len, sendlen, recvlen, total, off, roff;
+    size_t cur_capacity = 0, next_capacity = 0, send_capacity = 0, recv_capacity = 0;
+    size_t *blen = NULL, *boff = NULL, *smeta = NULL, *rmeta = NULL;
+    char *cur = NULL, *next = NULL, *sendbuf = NULL, *recvbuf = NULL, *tmp;
+    ptrdiff_t sext, rext;
+
+    if (MPI_IN_PLACE == sbuf) {
+        return mca_coll_base_alltoallv_intra_basic_inplace (rbuf, rcounts, rdisps,
+                                                             rdtype, comm, module);
+    }
+
+    size = ompi_comm_size(comm);
+    rank = ompi_comm_rank(comm);
+
+    OPAL_OUTPUT((ompi_coll_base_framework.framework_output,
+                 "coll:base:alltoallv_intra_bruck rank %d", rank));
+
+    ompi_datatype_type_extent(sdtype, &sext);
+    ompi_datatype_type_extent(rdtype, &rext);
+    ompi_datatype_type_size(sdtype, &ssize);
+    ompi_datatype_type_size(rdtype, &rsize);
+
+    /* Simple optimization - handle send to self first */
+    if (0 != scounts[rank]) {
+        err = ompi_datatype_sndrcv((char *) sbuf + (ptrdiff_t)sdisps[rank] * sext,
+                                   scounts[rank], sdtype,
+                                   (char *) rbuf + (ptrdiff_t)rdisps[rank] * rext,
+                                   rcounts[rank], rdtype);
+        if (MPI_SUCCESS != err) {
+            return err;
+        }
+    }
+
+    /* If only one process, we're done. */
+    if (1 == size) {
+        return MPI_SUCCESS;
+    }
+
+    blen = (size_t *) malloc(4 * size * sizeof(size_t));
+    if (NULL == blen) { err = OMPI_ERR_OUT_OF_RESOURCE; line = __LINE__; goto err_hndl; }
+    boff = blen + size;
+    smeta = boff + size;
+    rmeta = smeta + size;
+
+    /* Local rotation: slot j holds the packed block destined to (rank + j) */
+    for (total = 0, j = 1; j < size; j++) {
+        i = (rank + j) % size;
+        blen[j] = (size_t)scounts[i] * ssize;
+        boff[j] = total;
+        total += blen[j];
+    }
+    err = alltoallv_bruck_reserve(&cur, &cur_capacity, total);
+    if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+    for (j = 1; j < size; j++) {
+        if (0 == blen[j]) continue;
+        i = (rank + j) % size;
+        err = ompi_datatype_sndrcv((char *) sbuf + (ptrdiff_t)sdisps[i] * sext, scounts[i], sdtype,
+                                   cur + boff[j], (int)blen[j], MPI_PACKED);
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+    }
+
+    for (distance = 1; distance < size; distance <<= 1) {
+        sendto = (rank + distance) % size;
+        recvfrom = (rank + size - distance) % size;
+
+        /* Collect the slots to forward in this step */
+        for (sendlen = 0, nblocks = 0, j = 1; j < size; j++) {
+            if (!(j & distance)) continue;
+            smeta[nblocks++] = blen[j];
+            sendlen += blen[j];
+        }
+        err = alltoallv_bruck_reserve(&sendbuf, &send_capacity, sendlen);
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+        for (off = 0, j = 1; j < size; j++) {
+            if (!(j & distance) || (0 == blen[j])) continue;
+            memcpy(sendbuf + off, cur + boff[j], blen[j]);
+            off += blen[j];
+        }
+
+        /* Phase 1: exchange the sizes of the forwarded blocks */
+        err = ompi_coll_base_sendrecv(smeta, nblocks * (int)sizeof(size_t), MPI_BYTE, sendto,
+                                      MCA_COLL_BASE_TAG_ALLTOALLV,
+                                      rmeta, nblocks * (int)sizeof(size_t), MPI_BYTE, recvfrom,
+                                      MCA_COLL_BASE_TAG_ALLTOALLV,
+                                      comm, MPI_STATUS_IGNORE, rank);
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+
+        for (recvlen = 0, n = 0; n < nblocks; n++) {
+            recvlen += rmeta[n];
+        }
+        err = alltoallv_bruck_reserve(&recvbuf, &recv_capacity, recvlen);
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+
+        /* Phase 2: exchange the blocks themselves */
+        err = ompi_coll_base_sendrecv(sendbuf, (int)sendlen, MPI_BYTE, sendto,
+                                      MCA_COLL_BASE_TAG_ALLTOALLV,
+                                      recvbuf, (int)recvlen, MPI_BYTE, recvfrom,
+                                      MCA_COLL_BASE_TAG_ALLTOALLV,
+                                      comm, MPI_STATUS_IGNORE, rank);
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+
+        /* Replace the forwarded slots by the received ones, compacting the
+         * whole set of slots into the other buffer. */
+        for (total = 0, n = 0, j = 1; j < size; j++) {
+            total += (j & distance) ? rmeta[n++] : blen[j];
+        }
+        err = alltoallv_bruck_reserve(&next, &next_capacity, total);
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+        for (off = 0, roff = 0, n = 0, j = 1; j < size; j++) {
+            if (j & distance) {
+                len = rmeta[n++];
+                if (0 != len) memcpy(next + off, recvbuf + roff, len);
+                roff += len;
+            } else {
+                len = blen[j];
+                if (0 != len) memcpy(next + off, cur + boff[j], len);
+            }
+            blen[j] = len;
+            boff[j] = off;
+            off += len;
+        }
+        tmp = cur; cur = next; next = tmp;
+        total = cur_capacity; cur_capacity = next_capacity; next_capacity = total;
+    }
+
+    /* Slot j now holds the block sent by (rank - j) */
+    for (j = 1; j < size; j++) {
+        if (0 == blen[j]) continue;
+        i = (rank + size - j) % size;
+        err = ompi_datatype_sndrcv(cur + boff[j], (int)blen[j], MPI_PACKED,
+                                   (char *) rbuf + (ptrdiff_t)rdisps[i] * rext, rcounts[i], rdtype);
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+    }
+
+ err_hndl:
+    if (MPI_SUCCESS != err) {
+        OPAL_OUTPUT((ompi_coll_base_framework.framework_output,
+                     "%s:%4d\tError occurred %d, rank %2d", __FILE__, line, err,
+                     rank));
+        (void)line;  // silence compiler warning
+    }
+    free(blen);
+    free(cur);
+    free(next);
+    free(sendbuf);
+    free(recvbuf);
+    return err;
+}
@@ -274,10 +274,12 @@ typedef struct mca_coll_han_single_collective_fallback_s {
         mca_coll_base_module_allgather_fn_t allgather;
         mca_coll_base_module_allgatherv_fn_t allgatherv;
         mca_coll_base_module_allreduce_fn_t allreduce;
+        mca_coll_base_module_alltoall_fn_t alltoall;
         mca_coll_base_module_barrier_fn_t barrier;
         mca_coll_base_module_bcast_fn_t bcast;
         mca_coll_base_module_gather_fn_t gather;
         mca_coll_base_module_reduce_fn_t reduce;
+        mca_coll_base_module_reduce_scatter_block_fn_t reduce_scatter_block;
         mca_coll_base_module_scatter_fn_t scatter;
     } module_fn;
     mca_coll_base_module_t* module;
@@ -292,9 +294,11 @@ typedef struct mca_coll_han_collectives_fallback_s {
     mca_coll_han_single_collective_fallback_t allgather;
     mca_coll_han_single_collective_fallback_t allgatherv;
     mca_coll_han_single_collective_fallback_t allreduce;
+    mca_coll_han_single_collective_fallback_t alltoall;
     mca_coll_han_single_collective_fallback_t barrier;
     mca_coll_han_single_collective_fallback_t bcast;
     mca_coll_han_single_collective_fallback_t reduce;
+    mca_coll_han_single_collective_fallback_t reduce_scatter_block;
     mca_coll_han_single_collective_fallback_t gather;
     mca_coll_han_single_collective_fallback_t scatter;
 } mca_coll_han_collectives_fallback_t;
@@ -357,6 +361,9 @@ OBJ_CLASS_DECLARATION(mca_coll_han_module_t);
 #define previous_allreduce          fallback.allreduce.module_fn.allreduce
 #define previous_allreduce_module   fallback.allreduce.module
 
+#define previous_alltoall           fallback.alltoall.module_fn.alltoall
+#define previous_alltoall_module    fallback.alltoall.module
+
 #define previous_barrier            fallback.barrier.module_fn.barrier
 #define previous_barrier_module     fallback.barrier.module
 
@@ -366,6 +373,9 @@ OBJ_CLASS_DECLARATION(mca_coll_han_module_t);
 #define previous_reduce             fallback.reduce.module_fn.reduce
 #define previous_reduce_module      fallback.reduce.module
 
+#define previous_reduce_scatter_block         fallback.reduce_scatter_block.module_fn.reduce_scatter_block
+#define previous_reduce_scatter_block_module  fallback.reduce_scatter_block.module
+
 #define previous_gather             fallback.gather.module_fn.gather
 #define previous_gather_module      fallback.gather.module
 
@@ -396,6 +406,8 @@ OBJ_CLASS_DECLARATION(mca_coll_han_module_t);
         HAN_LOAD_FALLBACK_COLLECTIVE(HANM, COMM, allreduce);                 \
         HAN_LOAD_FALLBACK_COLLECTIVE(HANM, COMM, allgather);                 \
         HAN_LOAD_FALLBACK_COLLECTIVE(HANM, COMM, allgatherv);                \
+        HAN_LOAD_FALLBACK_COLLECTIVE(HANM, COMM, alltoall);                  \
+        HAN_LOAD_FALLBACK_COLLECTIVE(HANM, COMM, reduce_scatter_block);      \
         han_module->enabled = false;  /* entire module set to pass-through from now on */ \
     } while(0)
 
@@ -460,6 +472,9 @@ int
 mca_coll_han_allreduce_intra_dynamic(ALLREDUCE_BASE_ARGS,
                                      mca_coll_base_module_t *module);
 int
+mca_coll_han_alltoall_intra_dynamic(ALLTOALL_BASE_ARGS,
+                                    mca_coll_base_module_t *module);
+int
 mca_coll_han_barrier_intra_dynamic(BARRIER_BASE_ARGS,
                                  mca_coll_base_module_t *module);
 int
@@ -472,6 +487,9 @@ int
 mca_coll_han_reduce_intra_dynamic(REDUCE_BASE_ARGS,
                                   mca_coll_base_module_t *module);
 int
+mca_coll_han_reduce_scatter_block_intra_dynamic(REDUCESCATTERBLOCK_BASE_ARGS,
+                                                mca_coll_base_module_t *module);
+int
 mca_coll_han_scatter_intra_dynamic(SCATTER_BASE_ARGS,
                                    mca_coll_base_module_t *module);
 
@@ -69,6 +69,14 @@ mca_coll_han_algorithm_value_t*  mca_coll_han_available_algorithms[COLLCOUNT] =
         {"simple", (fnptr_t)&mca_coll_han_allgather_intra_simple}, // 2-level
         { 0 }
     },
+    [ALLTOALL] = (mca_coll_han_algorithm_value_t[]){
+        {"intra", (fnptr_t)&mca_coll_han_alltoall_intra}, // 2-level
+        { 0 }
+    },
+    [REDUCESCATTERBLOCK] = (mca_coll_han_algorithm_value_t[]){
+        {"intra", (fnptr_t)&mca_coll_han_reduce_scatter_block_intra}, // 2-level
+        { 0 }
+    },
 };
 
 int
@@ -191,4 +191,23 @@ mca_coll_han_allgather_intra_simple(const void *sbuf, int scount,
                                     struct ompi_communicator_t *comm,
                                     mca_coll_base_module_t *module);
 
+/* Alltoall */
+int
+mca_coll_han_alltoall_intra(const void *sbuf, int scount,
+                            struct ompi_datatype_t *sdtype,
+                            void *rbuf, int rcount,
+                            struct ompi_datatype_t *rdtype,
+                            struct ompi_communicator_t *comm,
+                            mca_coll_base_module_t *module);
+
+/* Reduce_scatter_block */
+int
+mca_coll_han_reduce_scatter_block_intra(const void *sbuf,
+                                        void *rbuf,
+                                        int rcount,
+                                        struct ompi_datatype_t *dtype,
+                                        struct ompi_op_t *op,
+                                        struct ompi_communicator_t *comm,
+                                        mca_coll_base_module_t *module);
+
 #endif
@@ -0,0 +1,203 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/**
+ * @file
+ *
+ * This file contains the hierarchical implementation of alltoall.
+ *
+ * The node leaders gather the whole send buffers of their node, exchange a
+ * single aggregated message with each other node leader on the inter-node
+ * sub-communicator, and scatter the result back on their node. This trades
+ * intra-node copies for a number of inter-node messages that only depends
+ * on the number of nodes.
+ */
+
+#include <limits.h>
+
+#include "coll_han.h"
+#include "ompi/mca/coll/base/coll_base_functions.h"
+
+/*
+ * Copy the src_idx-th block of rcount rdtype elements of src
+ * into the dst_idx-th block of dst
+ */
+static inline void
+mca_coll_han_alltoall_copy_block(char *dst, const char *src, int rcount,
+                                 struct ompi_datatype_t *rdtype,
+                                 ptrdiff_t block_extent,
+                                 int dst_idx, int src_idx)
+{
+    ompi_datatype_copy_content_same_ddt(rdtype, rcount,
+                                        dst + (ptrdiff_t)dst_idx * block_extent,
+                                        (char *)src + (ptrdiff_t)src_idx * block_extent);
+}
+
+/*
+ * Hierarchical alltoall:
+ * 1. low gather of the full send buffers on the node leaders
+ * 2. the node leaders reorder the data per destination node
+ * 3. up alltoall between the node leaders, one message per node pair
+ * 4. the node leaders reorder the data per destination process
+ * 5. low scatter of the receive buffers from the node leaders
+ */
+int
+mca_coll_han_alltoall_intra(const void *sbuf, int scount,
+                            struct ompi_datatype_t *sdtype,
+                            void *rbuf, int rcount,
+                            struct ompi_datatype_t *rdtype,
+                            struct ompi_communicator_t *comm,
+                            mca_coll_base_module_t *module)
+{
+    mca_coll_han_module_t *han_module = (mca_coll_han_module_t *)module;
+    ompi_communicator_t *low_comm, *up_comm;
+    int w_size, low_rank, low_size, up_size, ret = OMPI_SUCCESS;
+    int *topo;
+    char *gather_buf = NULL, *gather_buf_start = NULL;
+    char *reorder_buf = NULL, *reorder_buf_start = NULL;
+    ptrdiff_t rlb, rext, block_extent;
+    size_t block_size;
+
+    /* Create the subcommunicators */
+    if( OMPI_SUCCESS != mca_coll_han_comm_create_new(comm, han_module) ) {
+        OPAL_OUTPUT_VERBOSE((30, mca_coll_han_component.han_output,
+                             "han cannot handle alltoall within this communicator. Fall back on another component\n"));
+        /* HAN cannot work with this communicator so fallback on all collectives */
+        HAN_LOAD_FALLBACK_COLLECTIVES(han_module, comm);
+        return comm->c_coll->coll_alltoall(sbuf, scount, sdtype, rbuf, rcount, rdtype,
+                                           comm, comm->c_coll->coll_alltoall_module);
+    }
+
+    /* Topo must be initialized to know rank distribution which then is used to
+     * determine if han can be used */
+    topo = mca_coll_han_topo_init(comm, han_module, 2);
+    if (han_module->are_ppn_imbalanced) {
+        OPAL_OUTPUT_VERBOSE((30, mca_coll_han_component.han_output,
+                             "han cannot handle alltoall with this communicator (imbalance). Fall back on another component\n"));
+        /* Put back the fallback collective support and call it once. All
+         * future calls will then be automatically redirected.
+         */
+        HAN_LOAD_FALLBACK_COLLECTIVE(han_module, comm, alltoall);
+        return comm->c_coll->coll_alltoall(sbuf, scount, sdtype, rbuf, rcount, rdtype,
+                                           comm, comm->c_coll->coll_alltoall_module);
+    }
+
+    low_comm = han_module->sub_comm[INTRA_NODE];
+    up_comm = han_module->sub_comm[INTER_NODE];
+    w_size = ompi_comm_size(comm);
+    low_rank = ompi_comm_rank(low_comm);
+    low_size = ompi_comm_size(low_comm);
+    up_size = ompi_comm_size(up_comm);
+
+    /* The node leaders exchange rcount * low_size * low_size elements per
+     * node pair and gather rcount * w_size elements per process, counts that
+     * no longer fit in an int for large messages on wide nodes. The counts
+     * and datatypes may differ between the processes, so the decision is
+     * taken on the size in bytes of a block, which all of them agree on and
+     * which bounds the count of any datatype that is not empty. */
+    block_size = rdtype->super.size * (size_t)rcount;
+    if (block_size * (size_t)low_size * (size_t)low_size > (size_t)INT_MAX
+        || block_size * (size_t)w_size > (size_t)INT_MAX) {
+        OPAL_OUTPUT_VERBOSE((30, mca_coll_han_component.han_output,
+                             "HAN/ALLTOALL: count too large for the aggregated messages, use the previous alltoall\n"));
+        return han_module->previous_alltoall(sbuf, scount, sdtype, rbuf, rcount, rdtype,
+                                             comm, han_module->previous_alltoall_module);
+    }
+
+    /* The data of an in place alltoall is read from the receive buffer before
+     * the receive buffer is overwritten by the final scatter */
+    if (MPI_IN_PLACE == sbuf) {
+        sbuf = rbuf;
+        scount = rcount;
+        sdtype = rdtype;
+    }
+
+    ompi_datatype_get_extent(rdtype, &rlb, &rext);
+    block_extent = rext * (ptrdiff_t)rcount;
+
+    if (0 == low_rank) {
+        ptrdiff_t rsize, rgap = 0;
+        /* Both intermediary buffers hold the data sent by (or to) all the
+         * processes of the node, including datatypes empty gaps */
+        rsize = opal_datatype_span(&rdtype->super, (int64_t)rcount * low_size * w_size, &rgap);
+        gather_buf = (char *) malloc(rsize);
+        reorder_buf = (char *) malloc(rsize);
+        if (NULL == gather_buf || NULL == reorder_buf) {
+            ret = OMPI_ERR_OUT_OF_RESOURCE;
+            goto cleanup;
+        }
+        gather_buf_start = gather_buf - rgap;
+        reorder_buf_start = reorder_buf - rgap;
+    }
+
+    /* 1. low gather on node leaders: gather_buf is [low src][global dst] */
+    ret = low_comm->c_coll->coll_gather((char *)sbuf, scount * w_size, sdtype,
+                                        gather_buf_start, rcount * w_size, rdtype, 0,
+                                        low_comm, low_comm->c_coll->coll_gather_module);
+    if (OMPI_SUCCESS != ret) {
+        OPAL_OUTPUT_VERBOSE((30, mca_coll_han_component.han_output,
+                             "HAN/ALLTOALL: low comm gather failed.\n"));
+        goto cleanup;
+    }
+
+    if (0 == low_rank) {
+        /* 2. reorder_buf is [up dst][low src][low dst] */
+        for (int up = 0; up < up_size; up++) {
+            for (int src = 0; src < low_size; src++) {
+                for (int dst = 0; dst < low_size; dst++) {
+                    int w_dst = topo[2 * (up * low_size + dst) + 1];
+                    mca_coll_han_alltoall_copy_block(reorder_buf_start, gather_buf_start,
+                                                     rcount, rdtype, block_extent,
+                                                     (up * low_size + src) * low_size + dst,
+                                                     src * w_size + w_dst);
+                }
+            }
+        }
+
+        /* 3. up alltoall: gather_buf is [up src][low src][low dst] */
+        ret = up_comm->c_coll->coll_alltoall(reorder_buf_start, rcount * low_size * low_size, rdtype,
+                                             gather_buf_start, rcount * low_size * low_size, rdtype,
+                                             up_comm, up_comm->c_coll->coll_alltoall_module);
+        if (OMPI_SUCCESS != ret) {
+            OPAL_OUTPUT_VERBOSE((30, mca_coll_han_component.han_output,
+                                 "HAN/ALLTOALL: up comm alltoall failed.\n"));
+            goto cleanup;
+        }
+
+        /* 4. reorder_buf is [low dst][global src] */
+        for (int up = 0; up < up_size; up++) {
+            for (int src = 0; src < low_size; src++) {
+                int w_src = topo[2 * (up * low_size + src) + 1];
+                for (int dst = 0; dst < low_size; dst++) {
+                    mca_coll_han_alltoall_copy_block(reorder_buf_start, gather_buf_start,
+                                                     rcount, rdtype, block_extent,
+                                                     dst * w_size + w_src,
+                                                     (up * low_size + src) * low_size + dst);
+                }
+            }
+        }
+    }
+
+    /* 5. low scatter from node leaders */
+    ret = low_comm->c_coll->coll_scatter(reorder_buf_start, rcount * w_size, rdtype,
+                                         rbuf, rcount * w_size, rdtype, 0,
+                                         low_comm, low_comm->c_coll->coll_scatter_module);
+    if (OMPI_SUCCESS != ret) {
+        OPAL_OUTPUT_VERBOSE((30, mca_coll_han_component.han_output,
+                             "HAN/ALLTOALL: low comm scatter failed.\n"));
+    }
+
+ cleanup:
+    if (NULL != gather_buf) {
+        free(gather_buf);
+    }
+    if (NULL != reorder_buf) {
+        free(reorder_buf);
+    }
+    return ret;
+}
@@ -43,7 +43,8 @@ ompi_coll_han_components ompi_coll_han_available_components[COMPONENTS_COUNT] =
     { TUNED, "tuned", NULL },
     { SM, "sm", NULL },
     { ADAPT, "adapt", NULL },
-    { HAN, "han", NULL }
+    { HAN, "han", NULL },
+    { SMSC, "smsc", NULL }
 };
 
 /*
@@ -442,6 +443,11 @@ static int han_register(void)
         cs->mca_sub_components[coll][GLOBAL_COMMUNICATOR] = HAN;
     }
     /* Specific default values */
+    /* The hierarchical alltoall and reduce_scatter_block gather the data of
+     * the whole node on its leader, they are only used when selected by a
+     * dynamic rule or by the MCA parameters */
+    cs->mca_sub_components[ALLTOALL][GLOBAL_COMMUNICATOR] = TUNED;
+    cs->mca_sub_components[REDUCESCATTERBLOCK][GLOBAL_COMMUNICATOR] = TUNED;
 
     /* Dynamic rule MCA var registration */
     for(coll = 0; coll < COLLCOUNT; coll++) {
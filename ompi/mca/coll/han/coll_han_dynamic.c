@@ -38,10 +38,12 @@ bool mca_coll_han_is_coll_dynamic_implemented(COLLTYPE_T coll_id)
     case ALLGATHER:
     case ALLGATHERV:
     case ALLREDUCE:
+    case ALLTOALL:
     case BARRIER:
     case BCAST:
     case GATHER:
     case REDUCE:
+    case REDUCESCATTERBLOCK:
     case SCATTER:
         return true;
     default:
@@ -706,6 +708,119 @@ mca_coll_han_allreduce_intra_dynamic(const void *sbuf,
 }
 
 
+/*
+ * Alltoall selector:
+ * On a sub-communicator, checks the stored rules to find the module to use
+ * On the global communicator, calls the han collective implementation, or
+ * calls the correct module if fallback mechanism is activated
+ * The alltoall size is the size of the data sent to each process
+ */
+int
+mca_coll_han_alltoall_intra_dynamic(const void *sbuf, int scount,
+                                    struct ompi_datatype_t *sdtype,
+                                    void *rbuf, int rcount,
+                                    struct ompi_datatype_t *rdtype,
+                                    struct ompi_communicator_t *comm,
+                                    mca_coll_base_module_t *module)
+{
+    mca_coll_han_module_t *han_module = (mca_coll_han_module_t*) module;
+    TOPO_LVL_T topo_lvl = han_module->topologic_level;
+    mca_coll_base_module_alltoall_fn_t alltoall;
+    mca_coll_base_module_t *sub_module;
+    size_t dtype_size;
+    int rank, verbosity = 0;
+
+    /* Compute configuration information for dynamic rules */
+    if( MPI_IN_PLACE != sbuf ) {
+        ompi_datatype_type_size(sdtype, &dtype_size);
+        dtype_size = dtype_size * scount;
+    } else {
+        ompi_datatype_type_size(rdtype, &dtype_size);
+        dtype_size = dtype_size * rcount;
+    }
+
+    sub_module = get_module(ALLTOALL,
+                            dtype_size,
+                            comm,
+                            han_module);
+
+    /* First errors are always printed by rank 0 */
+    rank = ompi_comm_rank(comm);
+    if( (0 == rank) && (han_module->dynamic_errors < mca_coll_han_component.max_dynamic_errors) ) {
+        verbosity = 30;
+    }
+
+    if(NULL == sub_module) {
+        /*
+         * No valid collective module from dynamic rules
+         * nor from mca parameter
+         */
+        han_module->dynamic_errors++;
+        opal_output_verbose(verbosity, mca_coll_han_component.han_output,
+                            "coll:han:mca_coll_han_alltoall_intra_dynamic "
+                            "HAN did not find any valid module for collective %d (%s) "
+                            "with topological level %d (%s) on communicator (%s/%s). "
+                            "Please check dynamic file/mca parameters\n",
+                            ALLTOALL, mca_coll_base_colltype_to_str(ALLTOALL),
+                            topo_lvl, mca_coll_han_topo_lvl_to_str(topo_lvl),
+                            ompi_comm_print_cid(comm), comm->c_name);
+        OPAL_OUTPUT_VERBOSE((30, mca_coll_han_component.han_output,
+                             "HAN/ALLTOALL: No module found for the sub-communicator. "
+                             "Falling back to another component\n"));
+        alltoall = han_module->previous_alltoall;
+        sub_module = han_module->previous_alltoall_module;
+    } else if (NULL == sub_module->coll_alltoall) {
+        /*
+         * No valid collective from dynamic rules
+         * nor from mca parameter
+         */
+        han_module->dynamic_errors++;
+        opal_output_verbose(verbosity, mca_coll_han_component.han_output,
+                            "coll:han:mca_coll_han_alltoall_intra_dynamic "
+                            "HAN found valid module for collective %d (%s) "
+                            "with topological level %d (%s) on communicator (%s/%s) "
+                            "but this module cannot handle this collective. "
+                            "Please check dynamic file/mca parameters\n",
+                            ALLTOALL, mca_coll_base_colltype_to_str(ALLTOALL),
+                            topo_lvl, mca_coll_han_topo_lvl_to_str(topo_lvl),
+                            ompi_comm_print_cid(comm), comm->c_name);
+        OPAL_OUTPUT_VERBOSE((30, mca_coll_han_component.han_output,
+                             "HAN/ALLTOALL: the module found for the sub-"
+                             "communicator cannot handle the ALLTOALL operation. "
+                             "Falling back to another component\n"));
+        alltoall = han_module->previous_alltoall;
+        sub_module = han_module->previous_alltoall_module;
+    } else if (GLOBAL_COMMUNICATOR == topo_lvl && sub_module == module) {
+        /*
+         * No fallback mechanism activated for this configuration
+         * sub_module is valid
+         * sub_module->coll_alltoall is valid and point to this function
+         * Call han topological collective algorithm
+         */
+        int algorithm_id = get_algorithm(ALLTOALL,
+                                         dtype_size,
+                                         comm,
+                                         han_module);
+        alltoall = (mca_coll_base_module_alltoall_fn_t)mca_coll_han_algorithm_id_to_fn(ALLTOALL, algorithm_id);
+        if (NULL == alltoall) { /* default behaviour */
+            alltoall = mca_coll_han_alltoall_intra;
+        }
+    } else {
+        /*
+         * If we get here:
+         * sub_module is valid
+         * sub_module->coll_alltoall is valid
+         * They points to the collective to use, according to the dynamic rules
+         * Selector's job is done, call the collective
+         */
+        alltoall = sub_module->coll_alltoall;
+    }
+    return alltoall(sbuf, scount, sdtype,
+                    rbuf, rcount, rdtype,
+                    comm, sub_module);
+}
+
+
 /*
  * Barrier selector:
  * On a sub-communicator, checks the stored rules to find the module to use
@@ -1145,6 +1260,118 @@ mca_coll_han_reduce_intra_dynamic(const void *sbuf,
 }
 
 
+/*
+ * Reduce_scatter_block selector:
+ * On a sub-communicator, checks the stored rules to find the module to use
+ * On the global communicator, calls the han collective implementation, or
+ * calls the correct module if fallback mechanism is activated
+ * The reduce_scatter_block size is the size of the block received by each process
+ */
+int
+mca_coll_han_reduce_scatter_block_intra_dynamic(const void *sbuf,
+                                                void *rbuf,
+                                                int rcount,
+                                                struct ompi_datatype_t *dtype,
+                                                struct ompi_op_t *op,
+                                                struct ompi_communicator_t *comm,
+                                                mca_coll_base_module_t *module)
+{
+    mca_coll_han_module_t *han_module = (mca_coll_han_module_t*) module;
+    TOPO_LVL_T topo_lvl = han_module->topologic_level;
+    mca_coll_base_module_reduce_scatter_block_fn_t reduce_scatter_block;
+    mca_coll_base_module_t *sub_module;
+    size_t dtype_size;
+    int rank, verbosity = 0;
+
+    /* Compute configuration information for dynamic rules */
+    ompi_datatype_type_size(dtype, &dtype_size);
+    dtype_size = dtype_size * rcount;
+
+    sub_module = get_module(REDUCESCATTERBLOCK,
+                            dtype_size,
+                            comm,
+                            han_module);
+
+    /* First errors are always printed by rank 0 */
+    rank = ompi_comm_rank(comm);
+    if( (0 == rank) && (han_module->dynamic_errors < mca_coll_han_component.max_dynamic_errors) ) {
+        verbosity = 30;
+    }
+
+    if(NULL == sub_module) {
+        /*
+         * No valid collective module from dynamic rules
+         * nor from mca parameter
+         */
+        han_module->dynamic_errors++;
+        opal_output_verbose(verbosity, mca_coll_han_component.han_output,
+                            "coll:han:mca_coll_han_reduce_scatter_block_intra_dynamic "
+                            "HAN did not find any valid module for collective %d (%s) "
+                            "with topological level %d (%s) on communicator (%s/%s). "
+                            "Please check dynamic file/mca parameters\n",
+                            REDUCESCATTERBLOCK, mca_coll_base_colltype_to_str(REDUCESCATTERBLOCK),
+                            topo_lvl, mca_coll_han_topo_lvl_to_str(topo_lvl),
+                            ompi_comm_print_cid(comm), comm->c_name);
+        OPAL_OUTPUT_VERBOSE((30, mca_coll_han_component.han_output,
+                             "HAN/REDUCE_SCATTER_BLOCK: No module found for the sub-communicator. "
+                             "Falling back to another component\n"));
+        reduce_scatter_block = han_module->previous_reduce_scatter_block;
+        sub_module = han_module->previous_reduce_scatter_block_module;
+    } else if (NULL == sub_module->coll_reduce_scatter_block) {
+        /*
+         * No valid collective from dynamic rules
+         * nor from mca parameter
+         */
+        han_module->dynamic_errors++;
+        opal_output_verbose(verbosity, mca_coll_han_component.han_output,
+                            "coll:han:mca_coll_han_reduce_scatter_block_intra_dynamic "
+                            "HAN found valid module for collective %d (%s) "
+                            "with topological level %d (%s) on communicator (%s/%s) "
+                            "but this module cannot handle this collective. "
+                            "Please check dynamic file/mca parameters\n",
+                            REDUCESCATTERBLOCK, mca_coll_base_colltype_to_str(REDUCESCATTERBLOCK),
+                            topo_lvl, mca_coll_han_topo_lvl_to_str(topo_lvl),
+                            ompi_comm_print_cid(comm), comm->c_name);
+        OPAL_OUTPUT_VERBOSE((30, mca_coll_han_component.han_output,
+                             "HAN/REDUCE_SCATTER_BLOCK: the module found for the sub-"
+                             "communicator cannot handle the REDUCE_SCATTER_BLOCK operation. "
+                             "Falling back to another component\n"));
+        reduce_scatter_block = han_module->previous_reduce_scatter_block;
+        sub_module = han_module->previous_reduce_scatter_block_module;
+    } else if (GLOBAL_COMMUNICATOR == topo_lvl && sub_module == module) {
+        /* Reproducibility: the hierarchical algorithm changes the reduction order */
+        if (mca_coll_han_component.han_reproducible) {
+            reduce_scatter_block = han_module->previous_reduce_scatter_block;
+            sub_module = han_module->previous_reduce_scatter_block_module;
+        } else {
+            /*
+             * No fallback mechanism activated for this configuration
+             * sub_module is valid
+             * sub_module->coll_reduce_scatter_block is valid and point to this function
+             * Call han topological collective algorithm
+             */
+            int algorithm_id = get_algorithm(REDUCESCATTERBLOCK, dtype_size, comm, han_module);
+            reduce_scatter_block = (mca_coll_base_module_reduce_scatter_block_fn_t)
+                mca_coll_han_algorithm_id_to_fn(REDUCESCATTERBLOCK, algorithm_id);
+            if (NULL == reduce_scatter_block) { /* default behaviour */
+                reduce_scatter_block = mca_coll_han_reduce_scatter_block_intra;
+            }
+        }
+    } else {
+        /*
+         * If we get here:
+         * sub_module is valid
+         * sub_module->coll_reduce_scatter_block is valid
+         * They points to the collective to use, according to the dynamic rules
+         * Selector's job is done, call the collective
+         */
+        reduce_scatter_block = sub_module->coll_reduce_scatter_block;
+    }
+    return reduce_scatter_block(sbuf, rbuf, rcount, dtype,
+                                op, comm, sub_module);
+}
+
+
 /*
  * Scatter selector:
  * On a sub-communicator, checks the stored rules to find the module to use
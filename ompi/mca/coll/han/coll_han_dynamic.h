@@ -105,6 +105,7 @@ typedef enum COMPONENTS {
     SM,
     ADAPT,
     HAN,
+    SMSC,
     COMPONENTS_COUNT
 } COMPONENT_T;
 
@@ -0,0 +1,177 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/**
+ * @file
+ *
+ * This file contains the hierarchical implementation of reduce_scatter_block.
+ *
+ * The send buffers are first reduced on the node leaders, which then run a
+ * reduce_scatter_block between them on the inter-node sub-communicator, each
+ * of them getting the part of the result owned by its node. This part is
+ * finally scattered on the node.
+ */
+
+#include <limits.h>
+
+#include "coll_han.h"
+#include "ompi/mca/coll/base/coll_base_functions.h"
+#include "ompi/op/op.h"
+
+/*
+ * Hierarchical reduce_scatter_block:
+ * 1. low reduce of the full send buffers on the node leaders
+ * 2. the node leaders reorder the reduced data per node if the ranks are
+ *    not mapped by core
+ * 3. up reduce_scatter_block between the node leaders
+ * 4. low scatter of the result from the node leaders
+ */
+int
+mca_coll_han_reduce_scatter_block_intra(const void *sbuf,
+                                        void *rbuf,
+                                        int rcount,
+                                        struct ompi_datatype_t *dtype,
+                                        struct ompi_op_t *op,
+                                        struct ompi_communicator_t *comm,
+                                        mca_coll_base_module_t *module)
+{
+    mca_coll_han_module_t *han_module = (mca_coll_han_module_t *)module;
+    ompi_communicator_t *low_comm, *up_comm;
+    int w_size, low_rank, low_size, ret = OMPI_SUCCESS;
+    int *topo;
+    char *reduce_buf = NULL, *reduce_buf_start = NULL;
+    char *result_buf = NULL, *result_buf_start = NULL;
+    char *up_sbuf = NULL;
+
+    /* No support for non-commutative operations */
+    if(!ompi_op_is_commute(op)) {
+        OPAL_OUTPUT_VERBOSE((30, mca_coll_han_component.han_output,
+                             "han cannot handle reduce_scatter_block with this operation. Fall back on another component\n"));
+        goto prev_reduce_scatter_block_intra;
+    }
+
+    /* Create the subcommunicators */
+    if( OMPI_SUCCESS != mca_coll_han_comm_create_new(comm, han_module) ) {
+        OPAL_OUTPUT_VERBOSE((30, mca_coll_han_component.han_output,
+                             "han cannot handle reduce_scatter_block with this communicator. Drop HAN support in this communicator and fall back on another component\n"));
+        /* HAN cannot work with this communicator so fallback on all collectives */
+        HAN_LOAD_FALLBACK_COLLECTIVES(han_module, comm);
+        return comm->c_coll->coll_reduce_scatter_block(sbuf, rbuf, rcount, dtype, op,
+                                                       comm, comm->c_coll->coll_reduce_scatter_block_module);
+    }
+
+    /* Topo must be initialized to know rank distribution which then is used to
+     * determine if han can be used */
+    topo = mca_coll_han_topo_init(comm, han_module, 2);
+    if (han_module->are_ppn_imbalanced) {
+        OPAL_OUTPUT_VERBOSE((30, mca_coll_han_component.han_output,
+                             "han cannot handle reduce_scatter_block with this communicator (imbalanced). Drop HAN support in this communicator and fall back on another component\n"));
+        /* Put back the fallback collective support and call it once. All
+         * future calls will then be automatically redirected.
+         */
+        HAN_LOAD_FALLBACK_COLLECTIVE(han_module, comm, reduce_scatter_block);
+        return comm->c_coll->coll_reduce_scatter_block(sbuf, rbuf, rcount, dtype, op,
+                                                       comm, comm->c_coll->coll_reduce_scatter_block_module);
+    }
+
+    low_comm = han_module->sub_comm[INTRA_NODE];
+    up_comm = han_module->sub_comm[INTER_NODE];
+    w_size = ompi_comm_size(comm);
+    low_rank = ompi_comm_rank(low_comm);
+    low_size = ompi_comm_size(low_comm);
+
+    /* The node leaders reduce rcount * w_size elements at once */
+    if ((size_t)rcount * (size_t)w_size > (size_t)INT_MAX) {
+        OPAL_OUTPUT_VERBOSE((30, mca_coll_han_component.han_output,
+                             "HAN/REDUCE_SCATTER_BLOCK: count too large for the aggregated messages, use the previous reduce_scatter_block\n"));
+        goto prev_reduce_scatter_block_intra;
+    }
+
+    /* The input of an in place reduce_scatter_block is fully reduced in the
+     * intermediary buffer of the node leader before the final scatter */
+    if (MPI_IN_PLACE == sbuf) {
+        sbuf = rbuf;
+    }
+
+    if (0 == low_rank) {
+        ptrdiff_t rsize, rgap = 0;
+        rsize = opal_datatype_span(&dtype->super, (int64_t)rcount * w_size, &rgap);
+        reduce_buf = (char *) malloc(rsize);
+        /* The reorder needs a second full sized buffer, the reduced data is
+         * then scattered between the node leaders into the first one */
+        if (han_module->is_mapbycore) {
+            rsize = opal_datatype_span(&dtype->super, (int64_t)rcount * low_size, &rgap);
+        }
+        result_buf = (char *) malloc(rsize);
+        if (NULL == reduce_buf || NULL == result_buf) {
+            ret = OMPI_ERR_OUT_OF_RESOURCE;
+            goto cleanup;
+        }
+        reduce_buf_start = reduce_buf - rgap;
+        result_buf_start = result_buf - rgap;
+    }
+
+    /* 1. low reduce on node leaders */
+    ret = low_comm->c_coll->coll_reduce((char *)sbuf, reduce_buf_start,
+                                        rcount * w_size, dtype, op, 0,
+                                        low_comm, low_comm->c_coll->coll_reduce_module);
+    if (OMPI_SUCCESS != ret) {
+        OPAL_OUTPUT_VERBOSE((30, mca_coll_han_component.han_output,
+                             "HAN/REDUCE_SCATTER_BLOCK: low comm reduce failed.\n"));
+        goto cleanup;
+    }
+
+    if (0 == low_rank) {
+        up_sbuf = reduce_buf_start;
+        /* 2. reorder the blocks in topological order, see reorder_gather */
+        if (!han_module->is_mapbycore) {
+            ptrdiff_t lb, extent, block_extent;
+            ompi_datatype_get_extent(dtype, &lb, &extent);
+            block_extent = extent * (ptrdiff_t)rcount;
+            for (int i = 0; i < w_size; i++) {
+                ompi_datatype_copy_content_same_ddt(dtype, rcount,
+                                                    result_buf_start + (ptrdiff_t)i * block_extent,
+                                                    reduce_buf_start + (ptrdiff_t)topo[2 * i + 1] * block_extent);
+            }
+            up_sbuf = result_buf_start;
+            result_buf_start = reduce_buf_start;
+        }
+
+        /* 3. up reduce_scatter_block between node leaders */
+        ret = up_comm->c_coll->coll_reduce_scatter_block(up_sbuf, result_buf_start,
+                                                         rcount * low_size, dtype, op, up_comm,
+                                                         up_comm->c_coll->coll_reduce_scatter_block_module);
+        if (OMPI_SUCCESS != ret) {
+            OPAL_OUTPUT_VERBOSE((30, mca_coll_han_component.han_output,
+                                 "HAN/REDUCE_SCATTER_BLOCK: up comm reduce_scatter_block failed.\n"));
+            goto cleanup;
+        }
+    }
+
+    /* 4. low scatter from node leaders */
+    ret = low_comm->c_coll->coll_scatter(result_buf_start, rcount, dtype,
+                                         rbuf, rcount, dtype, 0,
+                                         low_comm, low_comm->c_coll->coll_scatter_module);
+    if (OMPI_SUCCESS != ret) {
+        OPAL_OUTPUT_VERBOSE((30, mca_coll_han_component.han_output,
+                             "HAN/REDUCE_SCATTER_BLOCK: low comm scatter failed.\n"));
+    }
+
+ cleanup:
+    if (NULL != reduce_buf) {
+        free(reduce_buf);
+    }
+    if (NULL != result_buf) {
+        free(result_buf);
+    }
+    return ret;
+
+ prev_reduce_scatter_block_intra:
+    return han_module->previous_reduce_scatter_block(sbuf, rbuf, rcount, dtype, op,
+                                                     comm, han_module->previous_reduce_scatter_block_module);
+}
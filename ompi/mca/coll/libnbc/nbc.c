@@ -30,6 +30,7 @@
 #include "ompi/mca/coll/base/coll_base_util.h"
 #include "ompi/op/op.h"
 #include "ompi/mca/pml/pml.h"
+#include "ompi/runtime/ompi_async_progress.h"
 
 /* only used in this file */
 static inline int NBC_Start_round(NBC_Handle *handle);
@@ -681,6 +682,10 @@ int NBC_Start(NBC_Handle *handle) {
   opal_list_append(&mca_coll_libnbc_component.active_requests, (opal_list_item_t *)handle);
   OPAL_THREAD_UNLOCK(&mca_coll_libnbc_component.lock);
 
+  /* the progress function may be backing off while no schedule was active */
+  opal_progress_poll_now(ompi_coll_libnbc_progress);
+  ompi_async_progress_wakeup();
+
   return OMPI_SUCCESS;
 }
 
@@ -22,16 +22,45 @@
 
 #include "ompi_config.h"
 
+#include <string.h>
+
+#include "opal/runtime/opal.h"
+#include "opal/sys/atomic.h"
 #include "ompi/constants.h"
 #include "ompi/communicator/communicator.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/op/op.h"
 #include "coll_sm.h"
 
 
+/*
+ * Local functions
+ */
+static int allreduce_pipelined(const void *sbuf, void *rbuf, int count,
+                               struct ompi_datatype_t *dtype,
+                               struct ompi_op_t *op,
+                               struct ompi_communicator_t *comm,
+                               mca_coll_base_module_t *module);
+
+/*
+ * The control area of each process in a segment starts with one word
+ * per process, used by the reduction (see CHILD_NOTIFY_PARENT).  The
+ * allreduce uses the two words following them to tell the others that
+ * its fragment has been copied in, and that its slice of the fragment
+ * has been reduced.
+ */
+#define ALLREDUCE_COPIED(size)  (size)
+#define ALLREDUCE_REDUCED(size) ((size) + 1)
+
+
 /**
  * Shared memory allreduce.
  *
- * For the moment, all we're doing is a reduce to root==0 and then a
- * broadcast.  It is possible that we'll do something better someday.
+ * If the datatype can be reduced straight in the shared memory
+ * segments (i.e., its representation is the same packed as it is
+ * unpacked), use a pipelined reduce-scatter + allgather where all the
+ * processes share the reduction work.  Otherwise, fall back to a
+ * reduce to root==0 and then a broadcast.
  */
 int mca_coll_sm_allreduce_intra(const void *sbuf, void *rbuf, int count,
                                 struct ompi_datatype_t *dtype,
@@ -40,6 +69,25 @@ int mca_coll_sm_allreduce_intra(const void *sbuf, void *rbuf, int count,
                                 mca_coll_base_module_t *module)
 {
     int ret;
+    size_t ddt_size;
+    mca_coll_sm_module_t *sm_module = (mca_coll_sm_module_t*) module;
+
+    ompi_datatype_type_size(dtype, &ddt_size);
+    if (0 < count && ompi_datatype_is_contiguous_memory_layout(dtype, count) &&
+        (int) ddt_size <= mca_coll_sm_component.sm_control_size &&
+        (size_t) (ompi_comm_size(comm) + 2) * sizeof(size_t) <=
+        (size_t) mca_coll_sm_component.sm_control_size) {
+        /* Lazily enable the module the first time we invoke a
+           collective on it */
+        if (!sm_module->enabled) {
+            if (OMPI_SUCCESS !=
+                (ret = ompi_coll_sm_lazy_enable(module, comm))) {
+                return ret;
+            }
+        }
+
+        return allreduce_pipelined(sbuf, rbuf, count, dtype, op, comm, module);
+    }
 
     /* Note that only the root can pass MPI_IN_PLACE to MPI_REDUCE, so
        have slightly different logic for that case. */
@@ -60,3 +108,205 @@ int mca_coll_sm_allreduce_intra(const void *sbuf, void *rbuf, int count,
     return (ret == OMPI_SUCCESS) ?
         mca_coll_sm_bcast_intra(rbuf, count, dtype, 0, comm, module) : ret;
 }
+
+
+/*
+ * Control word of a process in a segment
+ */
+static inline size_t volatile *
+allreduce_control(mca_coll_sm_data_index_t *index, int rank, int word)
+{
+    return ((size_t volatile *)
+            (((char*) index->mcbmi_control) +
+             (rank * mca_coll_sm_component.sm_control_size))) + word;
+}
+
+/*
+ * Wait for all the processes to set a control word of a segment to
+ * value
+ */
+static void allreduce_wait_for_all(mca_coll_sm_data_index_t *index,
+                                   int size, int word, size_t value)
+{
+    for (int peer = 0; peer < size; ++peer) {
+        size_t volatile *ptr = allreduce_control(index, peer, word);
+        SPIN_CONDITION(value == *ptr, allreduce_wait_label);
+    }
+    opal_atomic_rmb();
+}
+
+/*
+ * Slice of a fragment of count elements that rank reduces.  The slices
+ * are kept on different cache lines when possible, so that the
+ * processes do not write to the same lines while reducing.
+ */
+static void allreduce_slice(size_t count, size_t ddt_size, int size, int rank,
+                            size_t *first, size_t *slice_count)
+{
+    size_t unit = 1, num_units, base, rem, start, len;
+
+    if (ddt_size < (size_t) opal_cache_line_size &&
+        0 == opal_cache_line_size % ddt_size) {
+        unit = opal_cache_line_size / ddt_size;
+    }
+    num_units = (count + unit - 1) / unit;
+    base = num_units / size;
+    rem = num_units % size;
+
+    start = (base * rank + (((size_t) rank < rem) ? (size_t) rank : rem)) * unit;
+    len = (base + (((size_t) rank < rem) ? 1 : 0)) * unit;
+    if (start > count) {
+        start = count;
+    }
+    if (len > count - start) {
+        len = count - start;
+    }
+    *first = start;
+    *slice_count = len;
+}
+
+
+/**
+ * Pipelined shared memory allreduce.
+ *
+ * The vector is processed in fragments, one per segment.  Each process
+ * owns a slice of every fragment:
+ *
+ * 1. every process copies its fragment in its part of the segment
+ *    (copy-in);
+ * 2. every process reduces its slice of the fragment out of the parts
+ *    of all the processes, in order (starting with process (size-1),
+ *    as the other coll modules do), and leaves the result in the part
+ *    of process (size-1) (reduce-scatter);
+ * 3. every process copies the whole reduced fragment out of the part
+ *    of process (size-1) into its rbuf (allgather).
+ *
+ * The three steps are pipelined over the segments of a set: while the
+ * slices of a segment are reduced, the next segment is being copied in
+ * and the previous one copied out.  The reductions go through
+ * ompi_op_reduce, and thus use the vectorized kernels of the op
+ * framework (e.g., op/avx) when they are available.
+ *
+ * Process 0 acts as the root with respect to the in-use flags.  The
+ * control words are set to the operation number (plus one, so that it
+ * is never 0) rather than being reset, so that they never need to be
+ * cleared.
+ */
+static int allreduce_pipelined(const void *sbuf, void *rbuf, int count,
+                               struct ompi_datatype_t *dtype,
+                               struct ompi_op_t *op,
+                               struct ompi_communicator_t *comm,
+                               mca_coll_base_module_t *module)
+{
+    mca_coll_sm_module_t *sm_module = (mca_coll_sm_module_t*) module;
+    mca_coll_sm_comm_t *data = sm_module->sm_comm_data;
+    mca_coll_sm_component_t *c = &mca_coll_sm_component;
+    int rank, size, flag_num, segment_num, num_segments;
+    mca_coll_sm_in_use_flag_t *flag;
+    mca_coll_sm_data_index_t *index;
+    size_t ddt_size, segment_ddt_count, done = 0, value;
+    ptrdiff_t gap, true_extent;
+    const char *src;
+    char *dst;
+
+    rank = ompi_comm_rank(comm);
+    size = ompi_comm_size(comm);
+
+    ompi_datatype_type_size(dtype, &ddt_size);
+    ompi_datatype_get_true_extent(dtype, &gap, &true_extent);
+    segment_ddt_count = c->sm_fragment_size / ddt_size;
+
+    /* The datatype is contiguous: the data starts at the true lower
+       bound of the buffers, and the packed representation is the
+       same */
+    src = ((MPI_IN_PLACE == sbuf) ? (const char *) rbuf : (const char *) sbuf) + gap;
+    dst = (char *) rbuf + gap;
+
+    do {
+        flag_num = (data->mcb_operation_count %
+                    c->sm_comm_num_in_use_flags);
+        FLAG_SETUP(flag_num, flag, data);
+        if (0 == rank) {
+            FLAG_WAIT_FOR_IDLE(flag, allreduce_root_flag_label);
+            FLAG_RETAIN(flag, size, data->mcb_operation_count);
+        } else {
+            FLAG_WAIT_FOR_OP(flag, data->mcb_operation_count, allreduce_nonroot_flag_label);
+        }
+        value = (size_t) data->mcb_operation_count + 1;
+        ++data->mcb_operation_count;
+
+        /* Number of segments of this set that we'll use */
+        segment_num = flag_num * c->sm_segs_per_inuse_flag;
+        num_segments = (int) (((size_t) count - done + segment_ddt_count - 1) /
+                              segment_ddt_count);
+        if (num_segments > c->sm_segs_per_inuse_flag) {
+            num_segments = c->sm_segs_per_inuse_flag;
+        }
+
+        for (int step = 0; step < num_segments + 2; ++step) {
+            size_t first, n, slice_first, slice_count;
+            char *result;
+            int s;
+
+            /* Copy-in of the fragment of segment step */
+            s = step;
+            if (s < num_segments) {
+                index = &(data->mcb_data_index[segment_num + s]);
+                first = done + s * segment_ddt_count;
+                n = ((size_t) count - first < segment_ddt_count) ?
+                    (size_t) count - first : segment_ddt_count;
+                memcpy(index->mcbmi_data + (rank * c->sm_fragment_size),
+                       src + first * ddt_size, n * ddt_size);
+                opal_atomic_wmb();
+                *allreduce_control(index, rank, ALLREDUCE_COPIED(size)) = value;
+            }
+
+            /* Reduction of my slice of the fragment of segment step-1 */
+            s = step - 1;
+            if (0 <= s && s < num_segments) {
+                index = &(data->mcb_data_index[segment_num + s]);
+                first = done + s * segment_ddt_count;
+                n = ((size_t) count - first < segment_ddt_count) ?
+                    (size_t) count - first : segment_ddt_count;
+                allreduce_wait_for_all(index, size, ALLREDUCE_COPIED(size), value);
+
+                allreduce_slice(n, ddt_size, size, rank, &slice_first, &slice_count);
+                if (0 < slice_count) {
+                    result = index->mcbmi_data + ((size - 1) * c->sm_fragment_size) +
+                        slice_first * ddt_size;
+                    for (int peer = size - 2; peer >= 0; --peer) {
+                        ompi_op_reduce(op,
+                                       index->mcbmi_data + (peer * c->sm_fragment_size) +
+                                       slice_first * ddt_size - gap,
+                                       result - gap, slice_count, dtype);
+                    }
+                }
+                opal_atomic_wmb();
+                *allreduce_control(index, rank, ALLREDUCE_REDUCED(size)) = value;
+            }
+
+            /* Copy-out of the reduced fragment of segment step-2 */
+            s = step - 2;
+            if (0 <= s) {
+                index = &(data->mcb_data_index[segment_num + s]);
+                first = done + s * segment_ddt_count;
+                n = ((size_t) count - first < segment_ddt_count) ?
+                    (size_t) count - first : segment_ddt_count;
+                allreduce_wait_for_all(index, size, ALLREDUCE_REDUCED(size), value);
+                memcpy(dst + first * ddt_size,
+                       index->mcbmi_data + ((size - 1) * c->sm_fragment_size),
+                       n * ddt_size);
+            }
+        }
+
+        done += num_segments * segment_ddt_count;
+        if (done > (size_t) count) {
+            done = count;
+        }
+
+        /* We're finished with this set of segments */
+        FLAG_RELEASE(flag);
+    } while (done < (size_t) count);
+
+    return OMPI_SUCCESS;
+}
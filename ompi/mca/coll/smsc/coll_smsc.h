@@ -0,0 +1,289 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+/**
+ * @file
+ *
+ * Shared memory single-copy collectives.
+ *
+ * Instead of moving the data through fragments of a shared segment
+ * (two copies per byte, see coll/sm), the processes only exchange the
+ * addresses of their user buffers through a small per-communicator
+ * control segment, and access the buffers of their peers directly
+ * using the shared memory single-copy framework (opal/mca/smsc: CMA,
+ * XPMEM, KNEM). Broadcast is a single copy from the root, reduce and
+ * allreduce reduce each part of the vector straight out of the peers'
+ * buffers.
+ *
+ * Only large messages benefit from this: smaller ones are handed to
+ * the underlying component.
+ */
+
+#ifndef MCA_COLL_SMSC_EXPORT_H
+#define MCA_COLL_SMSC_EXPORT_H
+
+#include "ompi_config.h"
+
+#include "mpi.h"
+#include "ompi/mca/mca.h"
+#include "opal/mca/common/sm/common_sm.h"
+#include "opal/mca/smsc/smsc.h"
+#include "opal/runtime/opal_progress.h"
+#include "ompi/mca/coll/coll.h"
+
+BEGIN_C_DECLS
+
+/* Call opal_progress once in a great while if we're blocked waiting
+   for our peers, see coll/sm */
+#define COLL_SMSC_SPIN_MAX 100000
+
+/* Buffers published by a process for a given operation */
+#define COLL_SMSC_SRC 0
+#define COLL_SMSC_DST 1
+#define COLL_SMSC_NUM_BUFFERS 2
+
+    /**
+     * Structure to hold the smsc coll component.  First it holds the
+     * base coll component, and then holds the current MCA param
+     * values.
+     */
+    typedef struct mca_coll_smsc_component_t {
+        /** Base coll component */
+        mca_coll_base_component_2_4_0_t super;
+
+        /** MCA parameter: Priority of this component */
+        int smsc_priority;
+
+        /** MCA parameter: Minimum message size (in bytes) for the
+            single-copy broadcast */
+        size_t smsc_bcast_min_size;
+
+        /** MCA parameter: Minimum message size (in bytes) for the
+            single-copy reduce */
+        size_t smsc_reduce_min_size;
+
+        /** MCA parameter: Minimum message size (in bytes) for the
+            single-copy allreduce */
+        size_t smsc_allreduce_min_size;
+
+        /** MCA parameter: Size of the pieces in which the reductions
+            are done (in bytes) */
+        size_t smsc_fragment_size;
+    } mca_coll_smsc_component_t;
+
+    /**
+     * Per-process control slot in the per-communicator shmem segment.
+     * Each slot is only written by its owner.  The counters hold the
+     * number of the last operation that reached the corresponding
+     * step on the owner.  The slots are padded to a cache line, and
+     * the registration data of the published buffers (if the smsc
+     * module requires it) follows the structure.
+     */
+    typedef struct mca_coll_smsc_ctrl_t {
+        /** The buffers of this operation are published */
+        volatile uint64_t op_ready;
+        /** This process is done reducing its part of the vector */
+        volatile uint64_t op_reduced;
+        /** This process is done accessing the buffers of its peers */
+        volatile uint64_t op_done;
+        /** This process could not publish its buffers for this
+            operation, which all the processes then run with the
+            previous module */
+        volatile uint64_t op_unavailable;
+        /** Published buffers */
+        void *addr[COLL_SMSC_NUM_BUFFERS];
+    } mca_coll_smsc_ctrl_t;
+
+    /**
+     * Data hanging off the communicator once the module is lazily
+     * enabled.
+     */
+    typedef struct mca_coll_smsc_comm_t {
+        /** Meta data that we get back from the common mmap allocation
+            function */
+        mca_common_sm_module_t *sm_bootstrap_meta;
+
+        /** Number of processes which could not get an smsc endpoint
+            for all their peers (in the shmem segment) */
+        opal_atomic_int32_t *mcb_failed;
+
+        /** Base of the control slots */
+        unsigned char *mcb_ctrl;
+
+        /** Size of a control slot */
+        size_t mcb_ctrl_size;
+
+        /** Size of the registration data of a published buffer (0 if
+            the smsc module does not need any) */
+        size_t mcb_reg_size;
+
+        /** Number of processes in the communicator */
+        int mcb_size;
+
+        /** smsc endpoints of the peers (NULL for this process) */
+        mca_smsc_endpoint_t **mcb_endpoints;
+
+        /** Operation number */
+        uint64_t mcb_operation_count;
+    } mca_coll_smsc_comm_t;
+
+    /** Coll smsc module */
+    typedef struct mca_coll_smsc_module_t {
+        /** Base module */
+        mca_coll_base_module_t super;
+
+        /* Whether this module has been lazily initialized or not yet */
+        bool enabled;
+
+        /* Whether the single-copy operations can be used on this
+           communicator (all the processes got their endpoints) */
+        bool single_copy;
+
+        /* Data that hangs off the communicator */
+        mca_coll_smsc_comm_t *smsc_comm_data;
+
+        /* Underlying functions and modules, used for small messages */
+        mca_coll_base_module_bcast_fn_t previous_bcast;
+        mca_coll_base_module_t *previous_bcast_module;
+        mca_coll_base_module_reduce_fn_t previous_reduce;
+        mca_coll_base_module_t *previous_reduce_module;
+        mca_coll_base_module_allreduce_fn_t previous_allreduce;
+        mca_coll_base_module_t *previous_allreduce_module;
+    } mca_coll_smsc_module_t;
+    OBJ_CLASS_DECLARATION(mca_coll_smsc_module_t);
+
+    /**
+     * Global component instance
+     */
+    OMPI_DECLSPEC extern mca_coll_smsc_component_t mca_coll_smsc_component;
+
+    /*
+     * coll module functions
+     */
+    int mca_coll_smsc_init_query(bool enable_progress_threads,
+                                 bool enable_mpi_threads);
+
+    mca_coll_base_module_t *
+    mca_coll_smsc_comm_query(struct ompi_communicator_t *comm, int *priority);
+
+    /* Lazily enable a module (since it involves expensive/slow mmap
+       allocation, etc.) */
+    int ompi_coll_smsc_lazy_enable(mca_coll_base_module_t *module,
+                                   struct ompi_communicator_t *comm);
+
+    int mca_coll_smsc_bcast_intra(void *buff, int count,
+                                  struct ompi_datatype_t *datatype,
+                                  int root,
+                                  struct ompi_communicator_t *comm,
+                                  mca_coll_base_module_t *module);
+    int mca_coll_smsc_reduce_intra(const void *sbuf, void* rbuf, int count,
+                                   struct ompi_datatype_t *dtype,
+                                   struct ompi_op_t *op,
+                                   int root,
+                                   struct ompi_communicator_t *comm,
+                                   mca_coll_base_module_t *module);
+    int mca_coll_smsc_allreduce_intra(const void *sbuf, void *rbuf, int count,
+                                      struct ompi_datatype_t *dtype,
+                                      struct ompi_op_t *op,
+                                      struct ompi_communicator_t *comm,
+                                      mca_coll_base_module_t *module);
+
+    /*
+     * Helpers shared by the collectives (coll_smsc_module.c)
+     */
+
+    /* Get the host memory that will be published for a user buffer.
+       Non contiguous or accelerator buffers are staged through a
+       temporary buffer, returned in *bounce (NULL otherwise).  If
+       pack is true, the data of the user buffer is copied into it. */
+    int mca_coll_smsc_buffer_prepare(void *buf, int count,
+                                     struct ompi_datatype_t *dtype,
+                                     bool pack, char **addr, char **bounce);
+
+    /* Copy the content of a temporary buffer back to the user buffer,
+       and release it */
+    int mca_coll_smsc_buffer_complete(void *buf, int count,
+                                      struct ompi_datatype_t *dtype,
+                                      char *bounce, bool unpack);
+
+    /* Publish the buffers of this process for the operation op.  If
+       they cannot be registered, the operation is marked unavailable
+       instead, see mca_coll_smsc_unavailable() */
+    void mca_coll_smsc_publish(mca_coll_smsc_comm_t *data, int rank, uint64_t op,
+                               void *src, void *dst, size_t size, void **reg);
+
+    /* Whether a process (or only peer if peer >= 0) could not publish
+       its buffers for the operation op.  Called once op_ready was
+       waited for, so that all the processes agree on the result */
+    bool mca_coll_smsc_unavailable(mca_coll_smsc_comm_t *data, int size, int peer,
+                                   uint64_t op);
+
+    /* Give up on the operation op before any access to the buffers of
+       the peers, once all the processes are past it */
+    void mca_coll_smsc_cancel(mca_coll_smsc_comm_t *data, int rank, int size,
+                              uint64_t op, void **reg);
+
+    /* Release the registrations made by mca_coll_smsc_publish */
+    void mca_coll_smsc_unpublish(void **reg);
+
+    /* Copy size bytes between a local buffer and the buffer published
+       by peer, starting at offset */
+    int mca_coll_smsc_copy(mca_coll_smsc_comm_t *data, int peer, int which,
+                           bool from_peer, void *local, size_t offset, size_t size);
+
+    /* Map size bytes of the buffer published by peer, starting at
+       offset, in the address space of this process (only if the smsc
+       module can map).  Returns the context to unmap the region. */
+    void *mca_coll_smsc_map(mca_coll_smsc_comm_t *data, int peer, int which,
+                            size_t offset, size_t size, void **local);
+
+    /* Wait until the counter at offset in the control slots of all
+       processes (or only of peer if peer >= 0) reaches op */
+    void mca_coll_smsc_wait(mca_coll_smsc_comm_t *data, int size, int peer,
+                            size_t counter, uint64_t op);
+
+    /* Reduce the elements [first, first + count) of the source
+       buffers of all the processes into the destination buffer
+       published by dst_peer (dst for this process) */
+    int mca_coll_smsc_reduce_part(mca_coll_smsc_comm_t *data, int rank, int size,
+                                  int dst_peer, char *src, char *dst,
+                                  size_t first, size_t count,
+                                  struct ompi_datatype_t *dtype,
+                                  struct ompi_op_t *op);
+
+    /* Part of the vector reduced by rank */
+    static inline void
+    mca_coll_smsc_get_part(size_t count, int size, int rank,
+                           size_t *first, size_t *part_count)
+    {
+        size_t base = count / size, rem = count % size;
+
+        *part_count = base + (((size_t) rank < rem) ? 1 : 0);
+        *first = base * rank + (((size_t) rank < rem) ? (size_t) rank : rem);
+    }
+
+    static inline mca_coll_smsc_ctrl_t *
+    mca_coll_smsc_ctrl(mca_coll_smsc_comm_t *data, int rank)
+    {
+        return (mca_coll_smsc_ctrl_t *) (data->mcb_ctrl + rank * data->mcb_ctrl_size);
+    }
+
+    /* Set a counter of this process once all its previous accesses to
+       memory are complete.  The loads matter as much as the stores:
+       op_done tells the owner of a buffer that it is not read anymore */
+    static inline void
+    mca_coll_smsc_signal(mca_coll_smsc_comm_t *data, int rank,
+                         size_t counter, uint64_t op)
+    {
+        opal_atomic_mb();
+        *(volatile uint64_t *) ((char *) mca_coll_smsc_ctrl(data, rank) + counter) = op;
+    }
+
+END_C_DECLS
+
+#endif /* MCA_COLL_SMSC_EXPORT_H */
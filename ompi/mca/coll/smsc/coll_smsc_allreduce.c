@@ -0,0 +1,123 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+/** @file */
+
+#include "ompi_config.h"
+
+#include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "coll_smsc.h"
+
+
+/**
+ * Shared memory single-copy allreduce.
+ *
+ * All the processes publish their send and receive buffers.  Each
+ * process reduces its own part of the vector out of all the send
+ * buffers into its receive buffer (reduce-scatter), then copies the
+ * parts of the others straight out of their receive buffers
+ * (allgather).
+ */
+int mca_coll_smsc_allreduce_intra(const void *sbuf, void *rbuf, int count,
+                                  struct ompi_datatype_t *dtype,
+                                  struct ompi_op_t *op,
+                                  struct ompi_communicator_t *comm,
+                                  mca_coll_base_module_t *module)
+{
+    mca_coll_smsc_module_t *smsc_module = (mca_coll_smsc_module_t*) module;
+    mca_coll_smsc_comm_t *data;
+    int ret, err, rank = ompi_comm_rank(comm), size = ompi_comm_size(comm);
+    char *src, *dst, *sbounce = NULL, *rbounce;
+    void *reg[COLL_SMSC_NUM_BUFFERS];
+    size_t dsize, first, part_count;
+    uint64_t op_count;
+
+    /* The datatype is the same on all the processes, so they all take
+       the same decision */
+    ompi_datatype_type_size(dtype, &dsize);
+    if (0 == dsize ||
+        dsize * (size_t) count < mca_coll_smsc_component.smsc_allreduce_min_size ||
+        !ompi_datatype_is_contiguous_memory_layout(dtype, count)) {
+        return smsc_module->previous_allreduce(sbuf, rbuf, count, dtype, op, comm,
+                                               smsc_module->previous_allreduce_module);
+    }
+
+    /* Lazily enable the module the first time we invoke a collective
+       on it */
+    if (!smsc_module->enabled) {
+        if (OMPI_SUCCESS != (ret = ompi_coll_smsc_lazy_enable(module, comm))) {
+            return ret;
+        }
+    }
+    if (!smsc_module->single_copy) {
+        return smsc_module->previous_allreduce(sbuf, rbuf, count, dtype, op, comm,
+                                               smsc_module->previous_allreduce_module);
+    }
+
+    data = smsc_module->smsc_comm_data;
+    op_count = ++data->mcb_operation_count;
+
+    /* In place, the part of a process is only read by itself before
+       being overwritten by the result */
+    ret = mca_coll_smsc_buffer_prepare(rbuf, count, dtype, MPI_IN_PLACE == sbuf,
+                                       &dst, &rbounce);
+    if (OMPI_SUCCESS != ret) {
+        return ret;
+    }
+    if (MPI_IN_PLACE == sbuf) {
+        src = dst;
+    } else {
+        ret = mca_coll_smsc_buffer_prepare((void *) sbuf, count, dtype, true, &src, &sbounce);
+        if (OMPI_SUCCESS != ret) {
+            mca_coll_smsc_buffer_complete(rbuf, count, dtype, rbounce, false);
+            return ret;
+        }
+    }
+
+    mca_coll_smsc_publish(data, rank, op_count, src, dst, dsize * (size_t) count, reg);
+    mca_coll_smsc_wait(data, size, -1, offsetof(mca_coll_smsc_ctrl_t, op_ready), op_count);
+    if (mca_coll_smsc_unavailable(data, size, -1, op_count)) {
+        mca_coll_smsc_cancel(data, rank, size, op_count, reg);
+        mca_coll_smsc_buffer_complete((void *) sbuf, count, dtype, sbounce, false);
+        mca_coll_smsc_buffer_complete(rbuf, count, dtype, rbounce, false);
+        return smsc_module->previous_allreduce(sbuf, rbuf, count, dtype, op, comm,
+                                               smsc_module->previous_allreduce_module);
+    }
+
+    /* Reduce-scatter */
+    mca_coll_smsc_get_part(count, size, rank, &first, &part_count);
+    err = mca_coll_smsc_reduce_part(data, rank, size, rank, src, dst,
+                                    first, part_count, dtype, op);
+    if (OMPI_SUCCESS != err) {
+        ret = err;
+    }
+    mca_coll_smsc_signal(data, rank, offsetof(mca_coll_smsc_ctrl_t, op_reduced), op_count);
+
+    /* Allgather, once nobody reads the send buffers anymore */
+    mca_coll_smsc_wait(data, size, -1, offsetof(mca_coll_smsc_ctrl_t, op_reduced), op_count);
+    for (int i = 1 ; i < size ; ++i) {
+        int peer = (rank + i) % size;
+
+        mca_coll_smsc_get_part(count, size, peer, &first, &part_count);
+        err = mca_coll_smsc_copy(data, peer, COLL_SMSC_DST, true, dst + first * dsize,
+                                 first * dsize, part_count * dsize);
+        if (OMPI_SUCCESS != err) {
+            ret = err;
+        }
+    }
+
+    mca_coll_smsc_signal(data, rank, offsetof(mca_coll_smsc_ctrl_t, op_done), op_count);
+    mca_coll_smsc_wait(data, size, -1, offsetof(mca_coll_smsc_ctrl_t, op_done), op_count);
+    mca_coll_smsc_unpublish(reg);
+
+    mca_coll_smsc_buffer_complete((void *) sbuf, count, dtype, sbounce, false);
+    mca_coll_smsc_buffer_complete(rbuf, count, dtype, rbounce, true);
+    return ret;
+}
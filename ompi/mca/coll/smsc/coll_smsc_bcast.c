@@ -0,0 +1,90 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+/** @file */
+
+#include "ompi_config.h"
+
+#include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "coll_smsc.h"
+
+
+/**
+ * Shared memory single-copy broadcast.
+ *
+ * The root publishes the address of its buffer, and all the other
+ * processes copy the data straight out of it.  The root returns once
+ * all of them are done.
+ */
+int mca_coll_smsc_bcast_intra(void *buff, int count,
+                              struct ompi_datatype_t *datatype, int root,
+                              struct ompi_communicator_t *comm,
+                              mca_coll_base_module_t *module)
+{
+    mca_coll_smsc_module_t *smsc_module = (mca_coll_smsc_module_t*) module;
+    mca_coll_smsc_comm_t *data;
+    int ret, rank = ompi_comm_rank(comm), size = ompi_comm_size(comm);
+    char *addr, *bounce;
+    void *reg[COLL_SMSC_NUM_BUFFERS];
+    size_t dsize;
+    uint64_t op;
+
+    ompi_datatype_type_size(datatype, &dsize);
+    dsize *= (size_t) count;
+    if (0 == dsize || dsize < mca_coll_smsc_component.smsc_bcast_min_size) {
+        return smsc_module->previous_bcast(buff, count, datatype, root, comm,
+                                           smsc_module->previous_bcast_module);
+    }
+
+    /* Lazily enable the module the first time we invoke a collective
+       on it */
+    if (!smsc_module->enabled) {
+        if (OMPI_SUCCESS != (ret = ompi_coll_smsc_lazy_enable(module, comm))) {
+            return ret;
+        }
+    }
+    if (!smsc_module->single_copy) {
+        return smsc_module->previous_bcast(buff, count, datatype, root, comm,
+                                           smsc_module->previous_bcast_module);
+    }
+
+    data = smsc_module->smsc_comm_data;
+    op = ++data->mcb_operation_count;
+
+    ret = mca_coll_smsc_buffer_prepare(buff, count, datatype, rank == root,
+                                       &addr, &bounce);
+    if (OMPI_SUCCESS != ret) {
+        return ret;
+    }
+
+    reg[COLL_SMSC_SRC] = reg[COLL_SMSC_DST] = NULL;
+    if (rank == root) {
+        mca_coll_smsc_publish(data, rank, op, addr, NULL, dsize, reg);
+    } else {
+        mca_coll_smsc_wait(data, size, root, offsetof(mca_coll_smsc_ctrl_t, op_ready), op);
+    }
+    if (mca_coll_smsc_unavailable(data, size, root, op)) {
+        mca_coll_smsc_cancel(data, rank, size, op, reg);
+        mca_coll_smsc_buffer_complete(buff, count, datatype, bounce, false);
+        return smsc_module->previous_bcast(buff, count, datatype, root, comm,
+                                           smsc_module->previous_bcast_module);
+    }
+    if (rank == root) {
+        mca_coll_smsc_signal(data, rank, offsetof(mca_coll_smsc_ctrl_t, op_done), op);
+        mca_coll_smsc_wait(data, size, -1, offsetof(mca_coll_smsc_ctrl_t, op_done), op);
+        mca_coll_smsc_unpublish(reg);
+    } else {
+        ret = mca_coll_smsc_copy(data, root, COLL_SMSC_SRC, true, addr, 0, dsize);
+        mca_coll_smsc_signal(data, rank, offsetof(mca_coll_smsc_ctrl_t, op_done), op);
+    }
+
+    mca_coll_smsc_buffer_complete(buff, count, datatype, bounce, rank != root);
+    return ret;
+}
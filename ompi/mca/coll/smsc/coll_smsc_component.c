@@ -0,0 +1,139 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+/**
+ * @file
+ *
+ * Most of the description of the data layout is in the
+ * coll_smsc_module.c file.
+ */
+
+#include "ompi_config.h"
+
+#include "ompi/constants.h"
+#include "ompi/mca/coll/coll.h"
+#include "coll_smsc.h"
+
+
+/*
+ * Public string showing the coll ompi_smsc component version number
+ */
+const char *mca_coll_smsc_component_version_string =
+    "Open MPI smsc collective MCA component version " OMPI_VERSION;
+
+
+/*
+ * Local functions
+ */
+static int smsc_register(void);
+
+/*
+ * Instantiate the public struct with all of our public information
+ * and pointers to our public functions in it
+ */
+
+mca_coll_smsc_component_t mca_coll_smsc_component = {
+
+    /* First, fill in the super */
+
+    {
+        /* First, the mca_component_t struct containing meta
+           information about the component itself */
+
+        .collm_version = {
+            MCA_COLL_BASE_VERSION_2_4_0,
+
+            /* Component name and version */
+            .mca_component_name = "smsc",
+            MCA_BASE_MAKE_VERSION(component, OMPI_MAJOR_VERSION, OMPI_MINOR_VERSION,
+                                  OMPI_RELEASE_VERSION),
+
+            /* Component functions */
+            .mca_register_component_params = smsc_register,
+        },
+        .collm_data = {
+            /* The component is not checkpoint ready */
+            MCA_BASE_METADATA_PARAM_NONE
+        },
+
+        /* Initialization / querying functions */
+
+        .collm_init_query = mca_coll_smsc_init_query,
+        .collm_comm_query = mca_coll_smsc_comm_query,
+    },
+
+    /* smsc-component specific information */
+
+    /* (default) priority */
+    0,
+
+    /* (default) minimum message sizes */
+    65536,
+    65536,
+    65536,
+
+    /* (default) fragment size */
+    65536,
+};
+
+
+/*
+ * Register MCA params
+ */
+static int smsc_register(void)
+{
+    mca_base_component_t *c = &mca_coll_smsc_component.super.collm_version;
+    mca_coll_smsc_component_t *cs = &mca_coll_smsc_component;
+
+    /* Like coll/sm, only used if explicitly requested: either with a
+       priority higher than coll/tuned, or as the intra-node module of
+       coll/han */
+    cs->smsc_priority = 0;
+    (void) mca_base_component_var_register(c, "priority", "Priority of the smsc coll component",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &cs->smsc_priority);
+
+    cs->smsc_bcast_min_size = 65536;
+    (void) mca_base_component_var_register(c, "bcast_min_size",
+                                           "Minimum message size (in bytes) to use the single-copy broadcast; smaller messages are handed to the underlying component",
+                                           MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, 0,
+                                           OPAL_INFO_LVL_5,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &cs->smsc_bcast_min_size);
+
+    cs->smsc_reduce_min_size = 65536;
+    (void) mca_base_component_var_register(c, "reduce_min_size",
+                                           "Minimum message size (in bytes) to use the single-copy reduce; smaller messages are handed to the underlying component",
+                                           MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, 0,
+                                           OPAL_INFO_LVL_5,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &cs->smsc_reduce_min_size);
+
+    cs->smsc_allreduce_min_size = 65536;
+    (void) mca_base_component_var_register(c, "allreduce_min_size",
+                                           "Minimum message size (in bytes) to use the single-copy allreduce; smaller messages are handed to the underlying component",
+                                           MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, 0,
+                                           OPAL_INFO_LVL_5,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &cs->smsc_allreduce_min_size);
+
+    cs->smsc_fragment_size = 65536;
+    (void) mca_base_component_var_register(c, "fragment_size",
+                                           "Size (in bytes) of the pieces in which the peers' data is reduced; should fit in the cache",
+                                           MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &cs->smsc_fragment_size);
+    if (0 == cs->smsc_fragment_size) {
+        cs->smsc_fragment_size = 65536;
+    }
+
+    return OMPI_SUCCESS;
+}
@@ -0,0 +1,605 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+/**
+ * @file
+ *
+ * The per-communicator shmem segment only holds control data: a
+ * cache line with the number of processes that failed to get an smsc
+ * endpoint for one of their peers, followed by one control slot per
+ * process (mca_coll_smsc_ctrl_t, followed by the registration data of
+ * the published buffers, padded to a cache line).
+ *
+ * An operation number is incremented on every single-copy operation.
+ * A process publishes the addresses of its buffers in its slot, then
+ * sets op_ready to this number.  Its peers wait for op_ready before
+ * accessing the buffers, and set their own op_reduced / op_done
+ * counters once they are done with them; the buffers are not released
+ * before all the processes reached op_done.  As all the counters only
+ * grow, they never have to be reset.  A process that cannot register
+ * its buffers sets op_unavailable to the operation number before
+ * op_ready: all the processes check it before any access and run the
+ * operation with the previous module instead.
+ */
+
+#include "ompi_config.h"
+
+#include <stdio.h>
+#include <string.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif  /* HAVE_UNISTD_H */
+
+#include "mpi.h"
+#include "opal_stdint.h"
+#include "opal/align.h"
+#include "opal/datatype/opal_convertor.h"
+#include "opal/mca/accelerator/accelerator.h"
+#include "opal/runtime/opal.h"
+#include "opal/util/os_path.h"
+#include "opal/util/printf.h"
+
+#include "ompi/communicator/communicator.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/group/group.h"
+#include "ompi/mca/coll/coll.h"
+#include "ompi/mca/coll/base/base.h"
+#include "ompi/runtime/ompi_rte.h"
+#include "ompi/proc/proc.h"
+#include "coll_smsc.h"
+
+#include "ompi/mca/coll/base/coll_tags.h"
+#include "ompi/mca/pml/pml.h"
+
+
+/*
+ * Local functions
+ */
+static int smsc_module_enable(mca_coll_base_module_t *module,
+                              struct ompi_communicator_t *comm);
+static int bootstrap_comm(ompi_communicator_t *comm,
+                          mca_coll_smsc_module_t *module);
+static int mca_coll_smsc_module_disable(mca_coll_base_module_t *module,
+                                        struct ompi_communicator_t *comm);
+
+#define OBJ_RELEASE_IF_NOT_NULL(obj)            \
+    do {                                        \
+        if (NULL != (obj)) {                    \
+            OBJ_RELEASE(obj);                   \
+        }                                       \
+    } while (0)
+
+/*
+ * Module constructor
+ */
+static void mca_coll_smsc_module_construct(mca_coll_smsc_module_t *module)
+{
+    module->enabled = false;
+    module->single_copy = false;
+    module->smsc_comm_data = NULL;
+    module->previous_bcast = NULL;
+    module->previous_bcast_module = NULL;
+    module->previous_reduce = NULL;
+    module->previous_reduce_module = NULL;
+    module->previous_allreduce = NULL;
+    module->previous_allreduce_module = NULL;
+    module->super.coll_module_disable = mca_coll_smsc_module_disable;
+}
+
+/*
+ * Module destructor
+ */
+static void mca_coll_smsc_module_destruct(mca_coll_smsc_module_t *module)
+{
+    mca_coll_smsc_comm_t *c = module->smsc_comm_data;
+
+    if (NULL != c) {
+        for (int i = 0 ; i < c->mcb_size ; ++i) {
+            if (NULL != c->mcb_endpoints[i]) {
+                MCA_SMSC_CALL(return_endpoint, c->mcb_endpoints[i]);
+            }
+        }
+        /* Munmap the per-communicator shmem data segment */
+        if (NULL != c->sm_bootstrap_meta) {
+            /* Ignore any errors -- what are we going to do about
+               them? */
+            mca_common_sm_fini(c->sm_bootstrap_meta);
+            OBJ_RELEASE(c->sm_bootstrap_meta);
+        }
+        free(c);
+    }
+
+    OBJ_RELEASE_IF_NOT_NULL(module->previous_bcast_module);
+    OBJ_RELEASE_IF_NOT_NULL(module->previous_reduce_module);
+    OBJ_RELEASE_IF_NOT_NULL(module->previous_allreduce_module);
+
+    module->enabled = false;
+}
+
+/*
+ * Module disable
+ */
+static int mca_coll_smsc_module_disable(mca_coll_base_module_t *module, struct ompi_communicator_t *comm)
+{
+    mca_coll_smsc_module_t *smsc_module = (mca_coll_smsc_module_t*) module;
+
+    /* Called once for each collective provided by the module */
+    smsc_module->previous_bcast = NULL;
+    OBJ_RELEASE_IF_NOT_NULL(smsc_module->previous_bcast_module);
+    smsc_module->previous_bcast_module = NULL;
+    smsc_module->previous_reduce = NULL;
+    OBJ_RELEASE_IF_NOT_NULL(smsc_module->previous_reduce_module);
+    smsc_module->previous_reduce_module = NULL;
+    smsc_module->previous_allreduce = NULL;
+    OBJ_RELEASE_IF_NOT_NULL(smsc_module->previous_allreduce_module);
+    smsc_module->previous_allreduce_module = NULL;
+    return OMPI_SUCCESS;
+}
+
+
+OBJ_CLASS_INSTANCE(mca_coll_smsc_module_t,
+                   mca_coll_base_module_t,
+                   mca_coll_smsc_module_construct,
+                   mca_coll_smsc_module_destruct);
+
+/*
+ * Initial query function that is invoked during MPI_INIT, allowing
+ * this component to disqualify itself if it doesn't support the
+ * required level of thread support.  This function is invoked exactly
+ * once.
+ */
+int mca_coll_smsc_init_query(bool enable_progress_threads,
+                             bool enable_mpi_threads)
+{
+    /* if no session directory was created, then we cannot be used */
+    if (NULL == ompi_process_info.job_session_dir) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+    /* nor if there is no single-copy mechanism on this node */
+    if (NULL == mca_smsc) {
+        opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                            "coll:smsc:init_query: no smsc module available; disqualifying myself");
+        return OMPI_ERR_NOT_AVAILABLE;
+    }
+    return OMPI_SUCCESS;
+}
+
+
+/*
+ * Invoked when there's a new communicator that has been created.
+ * Look at the communicator and decide which set of functions and
+ * priority we want to return.
+ */
+mca_coll_base_module_t *
+mca_coll_smsc_comm_query(struct ompi_communicator_t *comm, int *priority)
+{
+    mca_coll_smsc_module_t *smsc_module;
+
+    /* If we're intercomm, or if there's only one process in the
+       communicator, or if not all the processes in the communicator
+       are not on this node, then we don't want to run */
+    if (OMPI_COMM_IS_INTER(comm) || 1 == ompi_comm_size(comm) || ompi_group_have_remote_peers (comm->c_local_group)) {
+        opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                            "coll:smsc:comm_query (%s/%s): intercomm, comm is too small, or not all peers local; disqualifying myself",
+                            ompi_comm_print_cid (comm), comm->c_name);
+        return NULL;
+    }
+
+    /* Get the priority level attached to this module. If priority is less
+     * than 0, then the module is unavailable. */
+    *priority = mca_coll_smsc_component.smsc_priority;
+    if (mca_coll_smsc_component.smsc_priority < 0) {
+        opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                            "coll:smsc:comm_query (%s/%s): priority too low; disqualifying myself",
+                            ompi_comm_print_cid (comm), comm->c_name);
+        return NULL;
+    }
+
+    smsc_module = OBJ_NEW(mca_coll_smsc_module_t);
+    if (NULL == smsc_module) {
+        return NULL;
+    }
+
+    /* All is good -- return a module */
+    smsc_module->super.coll_module_enable = smsc_module_enable;
+    smsc_module->super.coll_allreduce = mca_coll_smsc_allreduce_intra;
+    smsc_module->super.coll_bcast     = mca_coll_smsc_bcast_intra;
+    smsc_module->super.coll_reduce    = mca_coll_smsc_reduce_intra;
+
+    opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                        "coll:smsc:comm_query (%s/%s): pick me! pick me!",
+                        ompi_comm_print_cid (comm), comm->c_name);
+    return &(smsc_module->super);
+}
+
+
+#define SMSC_SAVE_PREV_COLL_API(__api)                                  \
+    do {                                                                \
+        if (!comm->c_coll->coll_ ## __api || !comm->c_coll->coll_ ## __api ## _module) { \
+            opal_output_verbose(10, ompi_coll_base_framework.framework_output, \
+                                "coll:smsc:enable (%s/%s): no underlying " # __api "; disqualifying myself", \
+                                ompi_comm_print_cid(comm), comm->c_name); \
+            goto handle_error;                                          \
+        }                                                               \
+        smsc_module->previous_ ## __api            = comm->c_coll->coll_ ## __api; \
+        smsc_module->previous_ ## __api ## _module = comm->c_coll->coll_ ## __api ## _module; \
+        OBJ_RETAIN(smsc_module->previous_ ## __api ## _module);        \
+    } while(0)
+
+/*
+ * Init module on the communicator
+ */
+static int smsc_module_enable(mca_coll_base_module_t *module,
+                              struct ompi_communicator_t *comm)
+{
+    mca_coll_smsc_module_t *smsc_module = (mca_coll_smsc_module_t*) module;
+
+    /* The small messages are handed to the underlying component */
+    SMSC_SAVE_PREV_COLL_API(bcast);
+    SMSC_SAVE_PREV_COLL_API(reduce);
+    SMSC_SAVE_PREV_COLL_API(allreduce);
+
+    /* We do everything else lazily in ompi_coll_smsc_lazy_enable() */
+    return OMPI_SUCCESS;
+
+ handle_error:
+    mca_coll_smsc_module_disable(module, comm);
+    return OMPI_ERROR;
+}
+
+int ompi_coll_smsc_lazy_enable(mca_coll_base_module_t *module,
+                               struct ompi_communicator_t *comm)
+{
+    int ret, failed = 0;
+    int rank = ompi_comm_rank(comm);
+    int size = ompi_comm_size(comm);
+    mca_coll_smsc_module_t *smsc_module = (mca_coll_smsc_module_t*) module;
+    mca_coll_smsc_comm_t *data = NULL;
+    unsigned char *base;
+
+    /* Just make sure we haven't been here already */
+    if (smsc_module->enabled) {
+        return OMPI_SUCCESS;
+    }
+    smsc_module->enabled = true;
+
+    smsc_module->smsc_comm_data = data = (mca_coll_smsc_comm_t*)
+        calloc(1, sizeof(mca_coll_smsc_comm_t) + size * sizeof(mca_smsc_endpoint_t *));
+    if (NULL == data) {
+        opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                            "coll:smsc:enable (%s/%s): malloc failed",
+                            ompi_comm_print_cid (comm), comm->c_name);
+        return OMPI_ERR_TEMP_OUT_OF_RESOURCE;
+    }
+    data->mcb_size = size;
+    data->mcb_endpoints = (mca_smsc_endpoint_t **) (data + 1);
+    data->mcb_operation_count = 0;
+    if (mca_smsc_base_has_feature(MCA_SMSC_FEATURE_REQUIRE_REGISTATION)) {
+        data->mcb_reg_size = (size_t) mca_smsc_base_registration_data_size();
+    }
+    data->mcb_ctrl_size = OPAL_ALIGN(sizeof(mca_coll_smsc_ctrl_t) +
+                                     COLL_SMSC_NUM_BUFFERS * data->mcb_reg_size,
+                                     opal_cache_line_size, size_t);
+
+    /* Attach to this communicator's shmem data segment */
+    if (OMPI_SUCCESS != (ret = bootstrap_comm(comm, smsc_module))) {
+        free(data);
+        smsc_module->smsc_comm_data = NULL;
+        return ret;
+    }
+    base = data->sm_bootstrap_meta->module_data_addr;
+    data->mcb_failed = (opal_atomic_int32_t *) base;
+    data->mcb_ctrl = base + opal_cache_line_size;
+    memset(mca_coll_smsc_ctrl(data, rank), 0, data->mcb_ctrl_size);
+
+    /* Get the single-copy endpoints of all the peers.  The processes
+       have to agree on whether they can use them, as the decision to
+       use a single-copy operation must be the same everywhere. */
+    for (int i = 0 ; i < size ; ++i) {
+        if (i == rank) {
+            continue;
+        }
+        data->mcb_endpoints[i] = MCA_SMSC_CALL(get_endpoint,
+                                               &ompi_comm_peer_lookup(comm, i)->super);
+        if (NULL == data->mcb_endpoints[i]) {
+            failed = 1;
+        }
+    }
+    if (failed) {
+        opal_atomic_add(data->mcb_failed, 1);
+    }
+
+    /* Indicate that we have successfully attached and setup */
+    opal_atomic_add (&(data->sm_bootstrap_meta->module_seg->seg_inited), 1);
+
+    /* Wait for everyone in this communicator to attach and setup */
+    opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                        "coll:smsc:enable (%s/%s): waiting for peers to attach",
+                        ompi_comm_print_cid (comm), comm->c_name);
+    while (size != data->sm_bootstrap_meta->module_seg->seg_inited) {
+        opal_progress();
+    }
+    opal_atomic_rmb();
+
+    /* Once we're all here, remove the mmap file; it's not needed anymore */
+    if (0 == rank) {
+        unlink(data->sm_bootstrap_meta->shmem_ds.seg_name);
+        opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                            "coll:smsc:enable (%s/%s): removed mmap file %s",
+                            ompi_comm_print_cid (comm), comm->c_name,
+                            data->sm_bootstrap_meta->shmem_ds.seg_name);
+    }
+
+    smsc_module->single_copy = (0 == *data->mcb_failed);
+
+    /* All done */
+
+    opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                        "coll:smsc:enable (%s/%s): %s",
+                        ompi_comm_print_cid (comm), comm->c_name,
+                        smsc_module->single_copy ? "success!" :
+                        "some peers are not reachable, falling back on the underlying component");
+    return OMPI_SUCCESS;
+}
+
+static int bootstrap_comm(ompi_communicator_t *comm,
+                          mca_coll_smsc_module_t *module)
+{
+    char *shortpath, *fullpath;
+    mca_coll_smsc_comm_t *data = module->smsc_comm_data;
+    int comm_size = ompi_comm_size(comm);
+    ompi_process_name_t *lowest_name = NULL;
+    size_t size;
+    ompi_proc_t *proc;
+
+    /* Make the rendezvous filename for this communicators shmem data
+       segment.  The CID is not guaranteed to be unique among all
+       procs on this node, so also pair it with the PID of the proc
+       with the lowest PMIx name to form a unique filename. */
+    proc = ompi_group_peer_lookup(comm->c_local_group, 0);
+    lowest_name = OMPI_CAST_RTE_NAME(&proc->super.proc_name);
+    for (int i = 1; i < comm_size; ++i) {
+        proc = ompi_group_peer_lookup(comm->c_local_group, i);
+        if (ompi_rte_compare_name_fields(OMPI_RTE_CMP_ALL,
+                                          OMPI_CAST_RTE_NAME(&proc->super.proc_name),
+                                          lowest_name) < 0) {
+            lowest_name = OMPI_CAST_RTE_NAME(&proc->super.proc_name);
+        }
+    }
+    opal_asprintf(&shortpath, "coll-smsc-cid-%s-name-%s.mmap", ompi_comm_print_cid (comm),
+                  OMPI_NAME_PRINT(lowest_name));
+    if (NULL == shortpath) {
+        opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                            "coll:smsc:enable:bootstrap comm (%s/%s): asprintf failed",
+                            ompi_comm_print_cid (comm), comm->c_name);
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+    fullpath = opal_os_path(false, ompi_process_info.job_session_dir,
+                            shortpath, NULL);
+    free(shortpath);
+    if (NULL == fullpath) {
+        opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                            "coll:smsc:enable:bootstrap comm (%s/%s): opal_os_path failed",
+                            ompi_comm_print_cid (comm), comm->c_name);
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+
+    /* The segment header, padding to align the data on a cache line,
+       the cache line of the failure counter and the control slots */
+    size = sizeof(mca_common_sm_seg_header_t) + 2 * opal_cache_line_size +
+        comm_size * data->mcb_ctrl_size;
+    opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                        "coll:smsc:enable:bootstrap comm (%s/%s): attaching to %" PRIsize_t " byte mmap: %s",
+                        ompi_comm_print_cid (comm), comm->c_name, size, fullpath);
+    if (0 == ompi_comm_rank (comm)) {
+        data->sm_bootstrap_meta = mca_common_sm_module_create_and_attach (size, fullpath, sizeof(mca_common_sm_seg_header_t),
+                                                                          opal_cache_line_size);
+        if (NULL == data->sm_bootstrap_meta) {
+            opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                                "coll:smsc:enable:bootstrap comm (%s/%s): mca_common_sm_init_group failed",
+                                ompi_comm_print_cid (comm), comm->c_name);
+            free(fullpath);
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+
+        for (int i = 1 ; i < ompi_comm_size (comm) ; ++i) {
+            MCA_PML_CALL(send(&data->sm_bootstrap_meta->shmem_ds, sizeof (data->sm_bootstrap_meta->shmem_ds), MPI_BYTE,
+                         i, MCA_COLL_BASE_TAG_BCAST, MCA_PML_BASE_SEND_STANDARD, comm));
+        }
+    } else {
+        opal_shmem_ds_t shmem_ds;
+        MCA_PML_CALL(recv(&shmem_ds, sizeof (shmem_ds), MPI_BYTE, 0, MCA_COLL_BASE_TAG_BCAST, comm, MPI_STATUS_IGNORE));
+        data->sm_bootstrap_meta = mca_common_sm_module_attach (&shmem_ds, sizeof(mca_common_sm_seg_header_t),
+                                                               opal_cache_line_size);
+        if (NULL == data->sm_bootstrap_meta) {
+            opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                                "coll:smsc:enable:bootstrap comm (%s/%s): mca_common_sm_module_attach failed",
+                                ompi_comm_print_cid (comm), comm->c_name);
+            free(fullpath);
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+    }
+
+    /* All done */
+    free(fullpath);
+    return OMPI_SUCCESS;
+}
+
+int mca_coll_smsc_buffer_prepare(void *buf, int count,
+                                 struct ompi_datatype_t *dtype,
+                                 bool pack, char **addr, char **bounce)
+{
+    uint64_t flags;
+    int dev_id;
+    size_t size;
+
+    *bounce = NULL;
+    if (ompi_datatype_is_contiguous_memory_layout(dtype, count) &&
+        opal_accelerator.check_addr(buf, &dev_id, &flags) <= 0) {
+        ptrdiff_t true_lb, true_extent;
+        ompi_datatype_get_true_extent(dtype, &true_lb, &true_extent);
+        *addr = (char *) buf + true_lb;
+        return OMPI_SUCCESS;
+    }
+
+    ompi_datatype_type_size(dtype, &size);
+    size *= (size_t) count;
+    *addr = *bounce = (char *) malloc(size);
+    if (NULL == *bounce) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+
+    if (pack) {
+        opal_convertor_t convertor;
+        struct iovec iov = { .iov_base = *bounce, .iov_len = size };
+        uint32_t iov_count = 1;
+        size_t max_data = size;
+
+        OBJ_CONSTRUCT(&convertor, opal_convertor_t);
+        opal_convertor_copy_and_prepare_for_send(ompi_mpi_local_convertor, &dtype->super,
+                                                 count, buf, 0, &convertor);
+        opal_convertor_pack(&convertor, &iov, &iov_count, &max_data);
+        OBJ_DESTRUCT(&convertor);
+    }
+    return OMPI_SUCCESS;
+}
+
+int mca_coll_smsc_buffer_complete(void *buf, int count,
+                                  struct ompi_datatype_t *dtype,
+                                  char *bounce, bool unpack)
+{
+    if (NULL == bounce) {
+        return OMPI_SUCCESS;
+    }
+
+    if (unpack) {
+        opal_convertor_t convertor;
+        size_t size;
+        struct iovec iov = { .iov_base = bounce };
+        uint32_t iov_count = 1;
+
+        ompi_datatype_type_size(dtype, &size);
+        size *= (size_t) count;
+        iov.iov_len = size;
+        OBJ_CONSTRUCT(&convertor, opal_convertor_t);
+        opal_convertor_copy_and_prepare_for_recv(ompi_mpi_local_convertor, &dtype->super,
+                                                 count, buf, 0, &convertor);
+        opal_convertor_unpack(&convertor, &iov, &iov_count, &size);
+        OBJ_DESTRUCT(&convertor);
+    }
+    free(bounce);
+    return OMPI_SUCCESS;
+}
+
+static inline void *mca_coll_smsc_reg_data(mca_coll_smsc_comm_t *data, int rank, int which)
+{
+    return (char *) (mca_coll_smsc_ctrl(data, rank) + 1) + which * data->mcb_reg_size;
+}
+
+void mca_coll_smsc_publish(mca_coll_smsc_comm_t *data, int rank, uint64_t op,
+                           void *src, void *dst, size_t size, void **reg)
+{
+    mca_coll_smsc_ctrl_t *ctrl = mca_coll_smsc_ctrl(data, rank);
+    void *addr[COLL_SMSC_NUM_BUFFERS] = { src, dst };
+
+    for (int i = 0 ; i < COLL_SMSC_NUM_BUFFERS ; ++i) {
+        ctrl->addr[i] = addr[i];
+        reg[i] = NULL;
+        if (0 == data->mcb_reg_size || NULL == addr[i]) {
+            continue;
+        }
+        reg[i] = MCA_SMSC_CALL(register_region, addr[i], size);
+        if (NULL == reg[i]) {
+            /* Still signal op_ready so that the peers don't wait
+               forever, they all see the marker and fall back */
+            ctrl->op_unavailable = op;
+            continue;
+        }
+        memcpy(mca_coll_smsc_reg_data(data, rank, i), reg[i], data->mcb_reg_size);
+    }
+
+    mca_coll_smsc_signal(data, rank, offsetof(mca_coll_smsc_ctrl_t, op_ready), op);
+}
+
+bool mca_coll_smsc_unavailable(mca_coll_smsc_comm_t *data, int size, int peer, uint64_t op)
+{
+    int first = (peer < 0) ? 0 : peer;
+    int last = (peer < 0) ? size : peer + 1;
+
+    for (int i = first ; i < last ; ++i) {
+        if (op == mca_coll_smsc_ctrl(data, i)->op_unavailable) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void mca_coll_smsc_cancel(mca_coll_smsc_comm_t *data, int rank, int size,
+                          uint64_t op, void **reg)
+{
+    /* The control slots are reused by the next operation, nobody may
+       publish again before all the processes have seen the marker */
+    mca_coll_smsc_signal(data, rank, offsetof(mca_coll_smsc_ctrl_t, op_done), op);
+    mca_coll_smsc_wait(data, size, -1, offsetof(mca_coll_smsc_ctrl_t, op_done), op);
+    mca_coll_smsc_unpublish(reg);
+}
+
+void mca_coll_smsc_unpublish(void **reg)
+{
+    for (int i = 0 ; i < COLL_SMSC_NUM_BUFFERS ; ++i) {
+        if (NULL != reg[i]) {
+            MCA_SMSC_CALL(deregister_region, reg[i]);
+            reg[i] = NULL;
+        }
+    }
+}
+
+int mca_coll_smsc_copy(mca_coll_smsc_comm_t *data, int peer, int which,
+                       bool from_peer, void *local, size_t offset, size_t size)
+{
+    char *remote = (char *) mca_coll_smsc_ctrl(data, peer)->addr[which] + offset;
+    void *reg_data = (0 == data->mcb_reg_size) ? NULL : mca_coll_smsc_reg_data(data, peer, which);
+
+    if (0 == size) {
+        return OMPI_SUCCESS;
+    }
+    if (from_peer) {
+        return MCA_SMSC_CALL(copy_from, data->mcb_endpoints[peer], local, remote, size, reg_data);
+    }
+    return MCA_SMSC_CALL(copy_to, data->mcb_endpoints[peer], local, remote, size, reg_data);
+}
+
+void *mca_coll_smsc_map(mca_coll_smsc_comm_t *data, int peer, int which,
+                        size_t offset, size_t size, void **local)
+{
+    char *remote = (char *) mca_coll_smsc_ctrl(data, peer)->addr[which] + offset;
+
+    return MCA_SMSC_CALL(map_peer_region, data->mcb_endpoints[peer], /*flags=*/0,
+                         remote, size, local);
+}
+
+void mca_coll_smsc_wait(mca_coll_smsc_comm_t *data, int size, int peer,
+                        size_t counter, uint64_t op)
+{
+    int first = (peer < 0) ? 0 : peer;
+    int last = (peer < 0) ? size : peer + 1;
+
+    for (int i = first ; i < last ; ++i) {
+        volatile uint64_t *flag = (volatile uint64_t *)
+            ((char *) mca_coll_smsc_ctrl(data, i) + counter);
+        int spin = 0;
+
+        while (*flag < op) {
+            if (++spin == COLL_SMSC_SPIN_MAX) {
+                opal_progress();
+                spin = 0;
+            }
+        }
+    }
+    opal_atomic_rmb();
+}
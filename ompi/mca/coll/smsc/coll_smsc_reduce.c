@@ -0,0 +1,252 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+/** @file */
+
+#include "ompi_config.h"
+
+#include <string.h>
+
+#include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/op/op.h"
+#include "coll_smsc.h"
+
+
+/*
+ * The part is reduced in fragments of smsc_fragment_size bytes, in
+ * rank order so that non commutative operations are supported:
+ * the result starts as the data of the last process, then each
+ * process' data is applied to it from the left.  If the smsc module
+ * can map the memory of the peers, the operation is applied straight
+ * on their buffers; otherwise each fragment is first copied in a
+ * local temporary buffer.
+ */
+int mca_coll_smsc_reduce_part(mca_coll_smsc_comm_t *data, int rank, int size,
+                              int dst_peer, char *src, char *dst,
+                              size_t first, size_t count,
+                              struct ompi_datatype_t *dtype,
+                              struct ompi_op_t *op)
+{
+    bool can_map = mca_smsc_base_has_feature(MCA_SMSC_FEATURE_CAN_MAP);
+    char *acc = NULL, *tmp = NULL, *dst_base = NULL, **peer_src = NULL;
+    void **ctx = NULL, *dst_ctx = NULL;
+    ptrdiff_t gap, true_extent;
+    size_t dsize, frag_count, n;
+    int ret = OMPI_SUCCESS, err;
+
+    /* nothing to reduce for a zero-size datatype, and it would not
+       give a fragment count */
+    ompi_datatype_type_size(dtype, &dsize);
+    if (0 == count || 0 == dsize) {
+        return OMPI_SUCCESS;
+    }
+
+    /* The buffers point to the data, but ompi_op_reduce expects the
+       buffers of the user */
+    ompi_datatype_get_true_extent(dtype, &gap, &true_extent);
+    frag_count = mca_coll_smsc_component.smsc_fragment_size / dsize;
+    if (0 == frag_count) {
+        frag_count = 1;
+    }
+    if (frag_count > count) {
+        frag_count = count;
+    }
+
+    acc = (char *) malloc(frag_count * dsize);
+    if (NULL == acc) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+
+    if (can_map) {
+        peer_src = (char **) calloc(size, sizeof(char *));
+        ctx = (void **) calloc(size, sizeof(void *));
+        if (NULL == peer_src || NULL == ctx) {
+            ret = OMPI_ERR_OUT_OF_RESOURCE;
+            goto cleanup;
+        }
+        for (int j = 0 ; j < size ; ++j) {
+            if (j == rank) {
+                continue;
+            }
+            ctx[j] = mca_coll_smsc_map(data, j, COLL_SMSC_SRC, first * dsize,
+                                       count * dsize, (void **) &peer_src[j]);
+            if (NULL == ctx[j]) {
+                ret = OMPI_ERROR;
+                goto cleanup;
+            }
+        }
+        if (dst_peer != rank) {
+            dst_ctx = mca_coll_smsc_map(data, dst_peer, COLL_SMSC_DST, first * dsize,
+                                        count * dsize, (void **) &dst_base);
+            if (NULL == dst_ctx) {
+                ret = OMPI_ERROR;
+                goto cleanup;
+            }
+        }
+    } else {
+        tmp = (char *) malloc(frag_count * dsize);
+        if (NULL == tmp) {
+            ret = OMPI_ERR_OUT_OF_RESOURCE;
+            goto cleanup;
+        }
+    }
+    if (dst_peer == rank) {
+        dst_base = dst + first * dsize;
+    }
+
+    for (size_t done = 0 ; done < count ; done += n) {
+        size_t offset = (first + done) * dsize, bytes;
+
+        n = (count - done < frag_count) ? count - done : frag_count;
+        bytes = n * dsize;
+
+        for (int j = size - 1 ; j >= 0 ; --j) {
+            char *in;
+
+            if (j == rank) {
+                in = src + offset;
+            } else if (can_map) {
+                in = peer_src[j] + done * dsize;
+            } else {
+                in = (size - 1 == j) ? acc : tmp;
+                err = mca_coll_smsc_copy(data, j, COLL_SMSC_SRC, true, in, offset, bytes);
+                if (OMPI_SUCCESS != err) {
+                    ret = err;
+                }
+            }
+
+            if (size - 1 == j) {
+                if (in != acc) {
+                    memcpy(acc, in, bytes);
+                }
+            } else {
+                ompi_op_reduce(op, in - gap, acc - gap, n, dtype);
+            }
+        }
+
+        if (NULL != dst_base) {
+            memcpy(dst_base + done * dsize, acc, bytes);
+        } else {
+            err = mca_coll_smsc_copy(data, dst_peer, COLL_SMSC_DST, false, acc, offset, bytes);
+            if (OMPI_SUCCESS != err) {
+                ret = err;
+            }
+        }
+    }
+
+ cleanup:
+    if (NULL != ctx) {
+        for (int j = 0 ; j < size ; ++j) {
+            if (NULL != ctx[j]) {
+                MCA_SMSC_CALL(unmap_peer_region, ctx[j]);
+            }
+        }
+        free(ctx);
+    }
+    if (NULL != dst_ctx) {
+        MCA_SMSC_CALL(unmap_peer_region, dst_ctx);
+    }
+    free(peer_src);
+    free(tmp);
+    free(acc);
+    return ret;
+}
+
+/**
+ * Shared memory single-copy reduce.
+ *
+ * All the processes publish their send buffer, and the root its
+ * receive buffer.  Each process then reduces its own part of the
+ * vector out of all the send buffers, and stores the result straight
+ * in the receive buffer of the root.
+ */
+int mca_coll_smsc_reduce_intra(const void *sbuf, void* rbuf, int count,
+                               struct ompi_datatype_t *dtype,
+                               struct ompi_op_t *op,
+                               int root,
+                               struct ompi_communicator_t *comm,
+                               mca_coll_base_module_t *module)
+{
+    mca_coll_smsc_module_t *smsc_module = (mca_coll_smsc_module_t*) module;
+    mca_coll_smsc_comm_t *data;
+    int ret, err, rank = ompi_comm_rank(comm), size = ompi_comm_size(comm);
+    char *src, *dst = NULL, *sbounce, *rbounce = NULL;
+    void *reg[COLL_SMSC_NUM_BUFFERS];
+    size_t dsize, first, part_count;
+    uint64_t op_count;
+
+    /* The datatype is the same on all the processes, so they all take
+       the same decision */
+    ompi_datatype_type_size(dtype, &dsize);
+    if (0 == dsize ||
+        dsize * (size_t) count < mca_coll_smsc_component.smsc_reduce_min_size ||
+        !ompi_datatype_is_contiguous_memory_layout(dtype, count)) {
+        return smsc_module->previous_reduce(sbuf, rbuf, count, dtype, op, root, comm,
+                                            smsc_module->previous_reduce_module);
+    }
+
+    /* Lazily enable the module the first time we invoke a collective
+       on it */
+    if (!smsc_module->enabled) {
+        if (OMPI_SUCCESS != (ret = ompi_coll_smsc_lazy_enable(module, comm))) {
+            return ret;
+        }
+    }
+    if (!smsc_module->single_copy) {
+        return smsc_module->previous_reduce(sbuf, rbuf, count, dtype, op, root, comm,
+                                            smsc_module->previous_reduce_module);
+    }
+
+    data = smsc_module->smsc_comm_data;
+    op_count = ++data->mcb_operation_count;
+
+    if (MPI_IN_PLACE == sbuf) {
+        ret = mca_coll_smsc_buffer_prepare(rbuf, count, dtype, true, &src, &rbounce);
+        dst = src;
+        sbounce = NULL;
+    } else {
+        ret = mca_coll_smsc_buffer_prepare((void *) sbuf, count, dtype, true, &src, &sbounce);
+        if (OMPI_SUCCESS == ret && rank == root) {
+            ret = mca_coll_smsc_buffer_prepare(rbuf, count, dtype, false, &dst, &rbounce);
+            if (OMPI_SUCCESS != ret) {
+                mca_coll_smsc_buffer_complete((void *) sbuf, count, dtype, sbounce, false);
+            }
+        }
+    }
+    if (OMPI_SUCCESS != ret) {
+        return ret;
+    }
+
+    mca_coll_smsc_publish(data, rank, op_count, src, dst, dsize * (size_t) count, reg);
+    mca_coll_smsc_wait(data, size, -1, offsetof(mca_coll_smsc_ctrl_t, op_ready), op_count);
+    if (mca_coll_smsc_unavailable(data, size, -1, op_count)) {
+        mca_coll_smsc_cancel(data, rank, size, op_count, reg);
+        mca_coll_smsc_buffer_complete((void *) sbuf, count, dtype, sbounce, false);
+        mca_coll_smsc_buffer_complete(rbuf, count, dtype, rbounce, false);
+        return smsc_module->previous_reduce(sbuf, rbuf, count, dtype, op, root, comm,
+                                            smsc_module->previous_reduce_module);
+    }
+
+    mca_coll_smsc_get_part(count, size, rank, &first, &part_count);
+    err = mca_coll_smsc_reduce_part(data, rank, size, root, src, dst,
+                                    first, part_count, dtype, op);
+    if (OMPI_SUCCESS != err) {
+        ret = err;
+    }
+
+    /* Nobody can release its buffers before all the parts are done */
+    mca_coll_smsc_signal(data, rank, offsetof(mca_coll_smsc_ctrl_t, op_done), op_count);
+    mca_coll_smsc_wait(data, size, -1, offsetof(mca_coll_smsc_ctrl_t, op_done), op_count);
+    mca_coll_smsc_unpublish(reg);
+
+    mca_coll_smsc_buffer_complete((void *) sbuf, count, dtype, sbounce, false);
+    mca_coll_smsc_buffer_complete(rbuf, count, dtype, rbounce, rank == root);
+    return ret;
+}
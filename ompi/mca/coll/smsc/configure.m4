@@ -0,0 +1,16 @@
+# -*- autoconf -*-
+#
+# $COPYRIGHT$
+#
+# Additional copyrights may follow
+#
+# $HEADER$
+#
+
+AC_DEFUN([MCA_ompi_coll_smsc_CONFIG],[
+    AC_CONFIG_FILES([ompi/mca/coll/smsc/Makefile])
+
+    OPAL_MCA_CHECK_DEPENDENCY([ompi], [coll], [smsc], [opal], [common], [sm])
+
+    $1
+])dnl
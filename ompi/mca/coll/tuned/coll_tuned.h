@@ -26,6 +26,7 @@
 
 /* also need the dynamic rule structures */
 #include "coll_tuned_dynamic_rules.h"
+#include "coll_tuned_autotune.h"
 
 BEGIN_C_DECLS
 
@@ -125,7 +126,7 @@ int ompi_coll_tuned_alltoall_intra_check_forced_init (coll_tuned_force_algorithm
 /* AlltoAllV */
 int ompi_coll_tuned_alltoallv_intra_dec_fixed(ALLTOALLV_ARGS);
 int ompi_coll_tuned_alltoallv_intra_dec_dynamic(ALLTOALLV_ARGS);
-int ompi_coll_tuned_alltoallv_intra_do_this(ALLTOALLV_ARGS, int algorithm);
+int ompi_coll_tuned_alltoallv_intra_do_this(ALLTOALLV_ARGS, int algorithm, int max_requests);
 int ompi_coll_tuned_alltoallv_intra_check_forced_init(coll_tuned_force_algorithm_mca_param_indices_t *mca_param_indices);
 
 /* Barrier */
@@ -215,6 +216,9 @@ struct mca_coll_tuned_module_t {
 
     /* the communicator rules for each MPI collective for ONLY my comsize */
     ompi_coll_com_rule_t *com_rules[COLLCOUNT];
+
+    /* the online selection state of each MPI collective, if autotuned */
+    ompi_coll_tuned_autotune_t *autotune[COLLCOUNT];
 };
 typedef struct mca_coll_tuned_module_t mca_coll_tuned_module_t;
 OBJ_CLASS_DECLARATION(mca_coll_tuned_module_t);
@@ -27,12 +27,15 @@
 
 /* alltoallv algorithm variables */
 static int coll_tuned_alltoallv_forced_algorithm = 0;
+static int coll_tuned_alltoallv_max_requests = 0;
 
 /* valid values for coll_tuned_alltoallv_forced_algorithm */
 static const mca_base_var_enum_value_t alltoallv_algorithms[] = {
     {0, "ignore"},
     {1, "basic_linear"},
     {2, "pairwise"},
+    {3, "scattered"},
+    {4, "bruck"},
     {0, NULL}
 };
 
@@ -71,7 +74,7 @@ int ompi_coll_tuned_alltoallv_intra_check_forced_init(coll_tuned_force_algorithm
                                         "alltoallv_algorithm",
                                         "Which alltoallv algorithm is used. "
                                         "Can be locked down to choice of: 0 ignore, "
-                                        "1 basic linear, 2 pairwise. "
+                                        "1 basic linear, 2 pairwise, 3 scattered, 4 bruck. "
                                         "Only relevant if coll_tuned_use_dynamic_rules is true.",
                                         MCA_BASE_VAR_TYPE_INT, new_enum, 0, MCA_BASE_VAR_FLAG_SETTABLE,
                                         OPAL_INFO_LVL_5,
@@ -83,6 +86,26 @@ int ompi_coll_tuned_alltoallv_intra_check_forced_init(coll_tuned_force_algorithm
         return mca_param_indices->algorithm_param_index;
     }
 
+    coll_tuned_alltoallv_max_requests = ompi_coll_tuned_init_max_requests; /* get system wide default */
+    mca_param_indices->max_requests_param_index =
+      mca_base_component_var_register(&mca_coll_tuned_component.super.collm_version,
+                                      "alltoallv_algorithm_max_requests",
+                                      "Maximum number of outstanding send or recv requests. Only has meaning for the scattered algorithm. 0 means no limit.",
+                                      MCA_BASE_VAR_TYPE_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                      OPAL_INFO_LVL_5,
+                                      MCA_BASE_VAR_SCOPE_ALL,
+                                      &coll_tuned_alltoallv_max_requests);
+    if (mca_param_indices->max_requests_param_index < 0) {
+        return mca_param_indices->max_requests_param_index;
+    }
+
+    if (coll_tuned_alltoallv_max_requests < 0) {
+        if( 0 == ompi_comm_rank( MPI_COMM_WORLD ) ) {
+            opal_output( 0, "Maximum outstanding requests must be positive number or 0.  Initializing to 0 (no limit).\n" );
+        }
+        coll_tuned_alltoallv_max_requests = 0;
+    }
+
     return (MPI_SUCCESS);
 }
 
@@ -94,11 +117,11 @@ int ompi_coll_tuned_alltoallv_intra_do_this(const void *sbuf, const int *scounts
                                             struct ompi_datatype_t *rdtype,
                                             struct ompi_communicator_t *comm,
                                             mca_coll_base_module_t *module,
-                                            int algorithm)
+                                            int algorithm, int max_requests)
 {
     OPAL_OUTPUT((ompi_coll_tuned_stream,
-                 "coll:tuned:alltoallv_intra_do_this selected algorithm %d ",
-                 algorithm));
+                 "coll:tuned:alltoallv_intra_do_this selected algorithm %d max_requests %d",
+                 algorithm, max_requests));
 
     switch (algorithm) {
     case (0):
@@ -113,6 +136,14 @@ int ompi_coll_tuned_alltoallv_intra_do_this(const void *sbuf, const int *scounts
         return ompi_coll_base_alltoallv_intra_pairwise(sbuf, scounts, sdisps, sdtype,
                                                        rbuf, rcounts, rdisps, rdtype,
                                                        comm, module);
+    case (3):
+        return ompi_coll_base_alltoallv_intra_scattered(sbuf, scounts, sdisps, sdtype,
+                                                        rbuf, rcounts, rdisps, rdtype,
+                                                        comm, module, max_requests);
+    case (4):
+        return ompi_coll_base_alltoallv_intra_bruck(sbuf, scounts, sdisps, sdtype,
+                                                    rbuf, rcounts, rdisps, rdtype,
+                                                    comm, module);
     }  /* switch */
     OPAL_OUTPUT((ompi_coll_tuned_stream,
                  "coll:tuned:alltoall_intra_do_this attempt to select "
@@ -0,0 +1,410 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mpi.h"
+#include "opal/mca/threads/mutex.h"
+#include "opal/util/printf.h"
+#include "ompi/constants.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/op/op.h"
+#include "ompi/runtime/ompi_rte.h"
+#include "ompi/mca/coll/base/coll_base_functions.h"
+#include "coll_tuned.h"
+#include "coll_tuned_dynamic_rules.h"
+#include "coll_tuned_autotune.h"
+
+bool  ompi_coll_tuned_autotune = false;
+int   ompi_coll_tuned_autotune_trials = 5;
+char *ompi_coll_tuned_autotune_rules_filename = NULL;
+
+/* algorithms selected on this process, kept by rank 0 of the tuned
+ * communicators */
+typedef struct ompi_coll_tuned_autotune_decision_t {
+    int coll_id;
+    int comsize;
+    int bucket;
+    int algorithm;
+    int faninout;
+    int segsize;
+} ompi_coll_tuned_autotune_decision_t;
+
+static ompi_coll_tuned_autotune_decision_t *autotune_decisions = NULL;
+static int autotune_ndecisions = 0;
+static int autotune_maxdecisions = 0;
+static opal_mutex_t autotune_lock = OPAL_MUTEX_STATIC_INIT;
+/* the MCA variables are gone when the component is closed */
+static char *autotune_rules_filename = NULL;
+
+bool ompi_coll_tuned_autotune_is_supported(int coll_id)
+{
+    switch (coll_id) {
+    case ALLGATHER:
+    case ALLREDUCE:
+    case ALLTOALL:
+    case BARRIER:
+    case BCAST:
+    case GATHER:
+    case REDUCE:
+    case REDUCESCATTERBLOCK:
+    case SCATTER:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* exclude the algorithms that cannot run on this communicator */
+static bool ompi_coll_tuned_autotune_is_candidate(int coll_id, int algorithm, int comsize)
+{
+    /* the two_proc algorithms */
+    if ((ALLGATHER == coll_id && 6 == algorithm) ||
+        (ALLTOALL == coll_id && 5 == algorithm) ||
+        (BARRIER == coll_id && 5 == algorithm)) {
+        return 2 == comsize;
+    }
+    return true;
+}
+
+ompi_coll_tuned_autotune_t *ompi_coll_tuned_autotune_create(int coll_id, int comsize,
+                                                            int faninout, int segsize)
+{
+    ompi_coll_tuned_autotune_t *autotune;
+
+    autotune = (ompi_coll_tuned_autotune_t *) calloc(1, sizeof(ompi_coll_tuned_autotune_t));
+    if (NULL == autotune) {
+        return NULL;
+    }
+    autotune->coll_id = coll_id;
+    autotune->comsize = comsize;
+    autotune->faninout = faninout;
+    autotune->segsize = segsize;
+
+    /* algorithm 0 is the fixed decision */
+    autotune->candidates = (int *) malloc(ompi_coll_tuned_forced_max_algorithms[coll_id] * sizeof(int));
+    if (NULL == autotune->candidates) {
+        free(autotune);
+        return NULL;
+    }
+    for (int alg = 1; alg < ompi_coll_tuned_forced_max_algorithms[coll_id]; alg++) {
+        if (ompi_coll_tuned_autotune_is_candidate(coll_id, alg, comsize)) {
+            autotune->candidates[autotune->ncandidates++] = alg;
+        }
+    }
+    if (autotune->ncandidates < 2) {
+        ompi_coll_tuned_autotune_destroy(autotune);
+        return NULL;
+    }
+    return autotune;
+}
+
+void ompi_coll_tuned_autotune_destroy(ompi_coll_tuned_autotune_t *autotune)
+{
+    if (NULL == autotune) {
+        return;
+    }
+    for (int i = 0; i < COLL_TUNED_AUTOTUNE_NBUCKETS; i++) {
+        free(autotune->buckets[i].best);
+    }
+    free(autotune->candidates);
+    free(autotune);
+}
+
+static inline int ompi_coll_tuned_autotune_bucket_index(size_t msg_size)
+{
+    int index = 0;
+
+    while (0 != msg_size) {
+        msg_size >>= 1;
+        index++;
+    }
+    return index;
+}
+
+static inline size_t ompi_coll_tuned_autotune_bucket_size(int index)
+{
+    return (0 == index) ? 0 : ((size_t)1 << (index - 1));
+}
+
+int ompi_coll_tuned_autotune_begin(ompi_coll_tuned_autotune_t *autotune, size_t msg_size,
+                                   ompi_coll_tuned_autotune_bucket_t **bucket)
+{
+    ompi_coll_tuned_autotune_bucket_t *b;
+    int ncand = autotune->ncandidates;
+
+    *bucket = NULL;
+    b = &autotune->buckets[ompi_coll_tuned_autotune_bucket_index(msg_size)];
+    if (0 != b->algorithm) {
+        return b->algorithm;
+    }
+
+    if (NULL == b->best) {
+        b->best = (double *) malloc(ncand * sizeof(double));
+        if (NULL == b->best) {
+            /* consistently impossible to tune this bucket, fall back on
+             * the other decisions */
+            return 0;
+        }
+        for (int i = 0; i < ncand; i++) {
+            b->best[i] = DBL_MAX;
+        }
+    }
+
+    /* interleave the candidates to smooth the perturbations of the system */
+    b->current = b->calls % ncand;
+    *bucket = b;
+    b->start = opal_timer_base_get_cycles();
+    return autotune->candidates[b->current];
+}
+
+static void ompi_coll_tuned_autotune_record(ompi_coll_tuned_autotune_t *autotune, int bucket)
+{
+    ompi_coll_tuned_autotune_decision_t *decision;
+
+    OPAL_THREAD_LOCK(&autotune_lock);
+    /* the first communicator tuned for a given size and message size wins */
+    for (int i = 0; i < autotune_ndecisions; i++) {
+        decision = &autotune_decisions[i];
+        if (decision->coll_id == autotune->coll_id && decision->comsize == autotune->comsize &&
+            decision->bucket == bucket) {
+            goto unlock;
+        }
+    }
+    if (autotune_ndecisions == autotune_maxdecisions) {
+        int maxdecisions = (0 == autotune_maxdecisions) ? 16 : 2 * autotune_maxdecisions;
+        decision = (ompi_coll_tuned_autotune_decision_t *)
+            realloc(autotune_decisions, maxdecisions * sizeof(ompi_coll_tuned_autotune_decision_t));
+        if (NULL == decision) {
+            goto unlock;
+        }
+        autotune_decisions = decision;
+        autotune_maxdecisions = maxdecisions;
+    }
+    decision = &autotune_decisions[autotune_ndecisions++];
+    decision->coll_id = autotune->coll_id;
+    decision->comsize = autotune->comsize;
+    decision->bucket = bucket;
+    decision->algorithm = autotune->buckets[bucket].algorithm;
+    decision->faninout = autotune->faninout;
+    decision->segsize = autotune->segsize;
+ unlock:
+    OPAL_THREAD_UNLOCK(&autotune_lock);
+}
+
+int ompi_coll_tuned_autotune_end(ompi_coll_tuned_autotune_t *autotune,
+                                 ompi_coll_tuned_autotune_bucket_t *bucket, int ret,
+                                 struct ompi_communicator_t *comm,
+                                 struct mca_coll_tuned_module_t *tuned_module)
+{
+    mca_coll_base_module_t *module = (mca_coll_base_module_t *) tuned_module;
+    int ncand = autotune->ncandidates;
+    int rank, err, algorithm = 0;
+    double elapsed;
+
+    elapsed = (double)(opal_timer_base_get_cycles() - bucket->start) /
+              (double)opal_timer_base_get_freq();
+    if (OMPI_SUCCESS == ret && elapsed < bucket->best[bucket->current]) {
+        bucket->best[bucket->current] = elapsed;
+    }
+
+    /* failed calls are counted as well, all processes must reach the
+     * agreement during the same call */
+    if (++bucket->calls < ompi_coll_tuned_autotune_trials * ncand) {
+        return ret;
+    }
+
+    /* An algorithm is as fast as its slowest process: root 0 selects the
+     * candidate with the smallest maximum time and broadcasts its decision */
+    rank = ompi_comm_rank(comm);
+    err = ompi_coll_base_reduce_intra_basic_linear((0 == rank) ? MPI_IN_PLACE : bucket->best,
+                                                   bucket->best, ncand, &ompi_mpi_double.dt,
+                                                   &ompi_mpi_op_max.op, 0, comm, module);
+    if (OMPI_SUCCESS == err && 0 == rank) {
+        int best = 0;
+        for (int i = 1; i < ncand; i++) {
+            if (bucket->best[i] < bucket->best[best]) {
+                best = i;
+            }
+        }
+        algorithm = autotune->candidates[best];
+    }
+    if (OMPI_SUCCESS == err) {
+        err = ompi_coll_base_bcast_intra_basic_linear(&algorithm, 1, &ompi_mpi_int.dt, 0,
+                                                      comm, module);
+    }
+    if (OMPI_SUCCESS != err) {
+        /* restart the trials of this bucket */
+        bucket->calls = 0;
+        return (OMPI_SUCCESS == ret) ? err : ret;
+    }
+
+    bucket->algorithm = algorithm;
+    free(bucket->best);
+    bucket->best = NULL;
+
+    OPAL_OUTPUT((ompi_coll_tuned_stream,
+                 "coll:tuned:autotune collective %d comm size %d message size %" PRIsize_t
+                 " selected algorithm %d", autotune->coll_id, autotune->comsize,
+                 ompi_coll_tuned_autotune_bucket_size((int)(bucket - autotune->buckets)),
+                 algorithm));
+
+    /* every process of the communicator made the same selection */
+    if (0 == rank) {
+        ompi_coll_tuned_autotune_record(autotune, (int)(bucket - autotune->buckets));
+    }
+    return ret;
+}
+
+static int ompi_coll_tuned_autotune_compare(const void *a, const void *b)
+{
+    const ompi_coll_tuned_autotune_decision_t *da = (const ompi_coll_tuned_autotune_decision_t *) a;
+    const ompi_coll_tuned_autotune_decision_t *db = (const ompi_coll_tuned_autotune_decision_t *) b;
+
+    if (da->coll_id != db->coll_id) {
+        return da->coll_id - db->coll_id;
+    }
+    if (da->comsize != db->comsize) {
+        return da->comsize - db->comsize;
+    }
+    return da->bucket - db->bucket;
+}
+
+/*
+ * Write the selected algorithms, merged with the rules read from the dynamic
+ * rules file (if any). The rules of a communicator size are either copied
+ * from the rules file or built from the selections: we only tune the
+ * communicators for which the rules file has no exact entry.
+ */
+int ompi_coll_tuned_autotune_write_rules(const char *fname)
+{
+    ompi_coll_alg_rule_t *base_rules = mca_coll_tuned_component.all_base_rules;
+    int ncolls = 0, first = 0;
+    FILE *fptr;
+
+    if (0 == autotune_ndecisions) {
+        return OMPI_SUCCESS;
+    }
+    qsort(autotune_decisions, autotune_ndecisions,
+          sizeof(ompi_coll_tuned_autotune_decision_t), ompi_coll_tuned_autotune_compare);
+
+    fptr = fopen(fname, "w");
+    if (NULL == fptr) {
+        OPAL_OUTPUT((ompi_coll_tuned_stream, "coll:tuned:autotune cannot write rules file [%s]\n", fname));
+        return OMPI_ERROR;
+    }
+
+    for (int coll = 0; coll < COLLCOUNT; coll++) {
+        if ((NULL != base_rules && base_rules[coll].n_com_sizes > 0) ||
+            (first < autotune_ndecisions && autotune_decisions[first].coll_id == coll)) {
+            ncolls++;
+        }
+        while (first < autotune_ndecisions && autotune_decisions[first].coll_id == coll) {
+            first++;
+        }
+    }
+    fprintf(fptr, "# Rules generated by the coll tuned autotuning\n");
+    fprintf(fptr, "%d # number of collectives\n", ncolls);
+
+    first = 0;
+    for (int coll = 0; coll < COLLCOUNT; coll++) {
+        int nbase = (NULL == base_rules) ? 0 : base_rules[coll].n_com_sizes;
+        int last = first, ncoms = nbase, b = 0, i;
+
+        /* count the communicator sizes that are not in the rules file */
+        while (last < autotune_ndecisions && autotune_decisions[last].coll_id == coll) {
+            if (last == first || autotune_decisions[last].comsize != autotune_decisions[last - 1].comsize) {
+                for (i = 0; i < nbase; i++) {
+                    if (base_rules[coll].com_rules[i].mpi_comsize == autotune_decisions[last].comsize) {
+                        break;
+                    }
+                }
+                if (i == nbase) {
+                    ncoms++;
+                }
+            }
+            last++;
+        }
+        if (0 == ncoms) {
+            continue;
+        }
+
+        fprintf(fptr, "%d # collective ID\n", coll);
+        fprintf(fptr, "%d # number of com sizes\n", ncoms);
+        /* merge both lists, sorted by increasing communicator size */
+        while (b < nbase || first < last) {
+            if (b < nbase &&
+                (first == last || base_rules[coll].com_rules[b].mpi_comsize <= autotune_decisions[first].comsize)) {
+                ompi_coll_com_rule_t *com_p = &base_rules[coll].com_rules[b];
+                fprintf(fptr, "%d # comm size\n", com_p->mpi_comsize);
+                fprintf(fptr, "%d # number of msg sizes\n", com_p->n_msg_sizes);
+                for (i = 0; i < com_p->n_msg_sizes; i++) {
+                    ompi_coll_msg_rule_t *msg_p = &com_p->msg_rules[i];
+                    fprintf(fptr, "%" PRIsize_t " %d %d %ld # message size, algorithm, fanin/out, segment size\n",
+                            msg_p->msg_size, msg_p->result_alg, msg_p->result_topo_faninout,
+                            msg_p->result_segsize);
+                }
+                /* drop the selections made for a size present in the rules file */
+                while (first < last && autotune_decisions[first].comsize == com_p->mpi_comsize) {
+                    first++;
+                }
+                b++;
+                continue;
+            }
+            for (i = first; i < last && autotune_decisions[i].comsize == autotune_decisions[first].comsize; i++);
+            fprintf(fptr, "%d # comm size\n", autotune_decisions[first].comsize);
+            fprintf(fptr, "%d # number of msg sizes\n", i - first);
+            for (int j = first; j < i; j++) {
+                ompi_coll_tuned_autotune_decision_t *decision = &autotune_decisions[j];
+                /* the smallest tuned message size applies to all the smaller messages */
+                fprintf(fptr, "%" PRIsize_t " %d %d %d # message size, algorithm, fanin/out, segment size\n",
+                        (j == first) ? 0 : ompi_coll_tuned_autotune_bucket_size(decision->bucket),
+                        decision->algorithm, decision->faninout, decision->segsize);
+            }
+            first = i;
+        }
+    }
+    fclose(fptr);
+    return OMPI_SUCCESS;
+}
+
+void ompi_coll_tuned_autotune_init(void)
+{
+    if (NULL != ompi_coll_tuned_autotune_rules_filename) {
+        autotune_rules_filename = strdup(ompi_coll_tuned_autotune_rules_filename);
+    }
+}
+
+void ompi_coll_tuned_autotune_finalize(void)
+{
+    if (NULL != autotune_rules_filename) {
+        /* MPI_COMM_WORLD rank 0 writes the requested file, the other
+         * processes that led a tuned communicator append their rank */
+        if (0 == OMPI_PROC_MY_NAME->vpid) {
+            (void) ompi_coll_tuned_autotune_write_rules(autotune_rules_filename);
+        } else if (autotune_ndecisions > 0) {
+            char *fname;
+            if (0 < opal_asprintf(&fname, "%s.%u", autotune_rules_filename,
+                                  (unsigned) OMPI_PROC_MY_NAME->vpid)) {
+                (void) ompi_coll_tuned_autotune_write_rules(fname);
+                free(fname);
+            }
+        }
+        free(autotune_rules_filename);
+        autotune_rules_filename = NULL;
+    }
+    free(autotune_decisions);
+    autotune_decisions = NULL;
+    autotune_ndecisions = autotune_maxdecisions = 0;
+}
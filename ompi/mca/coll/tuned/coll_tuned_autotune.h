@@ -0,0 +1,95 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#ifndef MCA_COLL_TUNED_AUTOTUNE_H_HAS_BEEN_INCLUDED
+#define MCA_COLL_TUNED_AUTOTUNE_H_HAS_BEEN_INCLUDED
+
+#include "ompi_config.h"
+
+#include "opal/mca/timer/base/base.h"
+
+BEGIN_C_DECLS
+
+/*
+ * Online selection of the collective algorithms.
+ *
+ * When enabled (-coll_tuned_autotune together with
+ * -coll_tuned_use_dynamic_rules), the first invocations of a collective on a
+ * communicator rotate over all the available algorithms, for each message
+ * size bucket (powers of two). Once every algorithm has been timed
+ * coll_tuned_autotune_trials times, the processes agree on the fastest one,
+ * which is then used for all the following calls in this bucket. The
+ * decisions are collected by rank 0 of the tuned communicators and, if
+ * coll_tuned_autotune_rules_filename is set, dumped at the end of the
+ * execution in the dynamic rules file format, to be reused through
+ * coll_tuned_dynamic_rules_filename (MPI_COMM_WORLD rank 0 writes the
+ * file itself, the other processes add their rank to its name).
+ */
+
+/* one bucket per power of two, plus one for the empty messages */
+#define COLL_TUNED_AUTOTUNE_NBUCKETS (8 * (int)sizeof(size_t) + 1)
+
+typedef struct ompi_coll_tuned_autotune_bucket_t {
+    int calls;           /* number of calls timed so far */
+    int algorithm;       /* selected algorithm, 0 while still tuning */
+    int current;         /* candidate of the call being timed */
+    opal_timer_t start;  /* start of the call being timed */
+    double *best;        /* best time of each candidate */
+} ompi_coll_tuned_autotune_bucket_t;
+
+typedef struct ompi_coll_tuned_autotune_t {
+    int coll_id;
+    int comsize;
+    int faninout;
+    int segsize;
+    int ncandidates;
+    int *candidates;     /* algorithms usable on this communicator */
+    ompi_coll_tuned_autotune_bucket_t buckets[COLL_TUNED_AUTOTUNE_NBUCKETS];
+} ompi_coll_tuned_autotune_t;
+
+struct mca_coll_tuned_module_t;
+struct ompi_communicator_t;
+
+extern bool ompi_coll_tuned_autotune;
+extern int  ompi_coll_tuned_autotune_trials;
+extern char *ompi_coll_tuned_autotune_rules_filename;
+
+/* collectives whose algorithm can be selected online */
+bool ompi_coll_tuned_autotune_is_supported(int coll_id);
+
+/* returns NULL if there is nothing to select on this communicator */
+ompi_coll_tuned_autotune_t *ompi_coll_tuned_autotune_create(int coll_id, int comsize,
+                                                            int faninout, int segsize);
+void ompi_coll_tuned_autotune_destroy(ompi_coll_tuned_autotune_t *autotune);
+
+/*
+ * Select the algorithm for a message of msg_size bytes. Returns 0 if the
+ * caller should fall back on the other decision functions. If the call
+ * must be timed, *bucket is set and the caller has to report the end of the
+ * collective using ompi_coll_tuned_autotune_end, otherwise *bucket is NULL.
+ */
+int ompi_coll_tuned_autotune_begin(ompi_coll_tuned_autotune_t *autotune, size_t msg_size,
+                                   ompi_coll_tuned_autotune_bucket_t **bucket);
+
+/*
+ * Record the duration of a timed call, and select the algorithm of the
+ * bucket once all the trials are done. Returns ret, or the error code of
+ * the agreement on the selected algorithm.
+ */
+int ompi_coll_tuned_autotune_end(ompi_coll_tuned_autotune_t *autotune,
+                                 ompi_coll_tuned_autotune_bucket_t *bucket, int ret,
+                                 struct ompi_communicator_t *comm,
+                                 struct mca_coll_tuned_module_t *tuned_module);
+
+/* dump the selected algorithms into the autotune rules file */
+int ompi_coll_tuned_autotune_write_rules(const char *fname);
+void ompi_coll_tuned_autotune_init(void);
+void ompi_coll_tuned_autotune_finalize(void);
+
+END_C_DECLS
+#endif /* MCA_COLL_TUNED_AUTOTUNE_H_HAS_BEEN_INCLUDED */
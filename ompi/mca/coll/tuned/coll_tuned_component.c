@@ -191,6 +191,36 @@ static int tuned_register(void)
                                            MCA_BASE_VAR_SCOPE_READONLY,
                                            &ompi_coll_tuned_dynamic_rules_filename);
 
+    ompi_coll_tuned_autotune = false;
+    (void) mca_base_component_var_register(&mca_coll_tuned_component.super.collm_version,
+                                           "autotune",
+                                           "Select the algorithms online, by timing all of them during the first calls of each collective, communicator and message size (power of two). Only used with dynamic rules, and for the communicator sizes without a rule in the dynamic rules file",
+                                           MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
+                                           OPAL_INFO_LVL_6,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &ompi_coll_tuned_autotune);
+
+    ompi_coll_tuned_autotune_trials = 5;
+    (void) mca_base_component_var_register(&mca_coll_tuned_component.super.collm_version,
+                                           "autotune_trials",
+                                           "Number of calls timed for each algorithm before the online selection is made",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_6,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &ompi_coll_tuned_autotune_trials);
+    if (ompi_coll_tuned_autotune_trials < 1) {
+        ompi_coll_tuned_autotune_trials = 1;
+    }
+
+    ompi_coll_tuned_autotune_rules_filename = NULL;
+    (void) mca_base_component_var_register(&mca_coll_tuned_component.super.collm_version,
+                                           "autotune_rules_filename",
+                                           "Filename where MPI_COMM_WORLD rank 0 writes the algorithms selected online, merged with the dynamic rules file, at the end of the execution. The selections made on communicators led by another process are written by that process to the filename suffixed with its rank in MPI_COMM_WORLD",
+                                           MCA_BASE_VAR_TYPE_STRING, NULL, 0, 0,
+                                           OPAL_INFO_LVL_6,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &ompi_coll_tuned_autotune_rules_filename);
+
     /* register forced params */
     ompi_coll_tuned_allreduce_intra_check_forced_init(&ompi_coll_tuned_forced_params[ALLREDUCE]);
     ompi_coll_tuned_alltoall_intra_check_forced_init(&ompi_coll_tuned_forced_params[ALLTOALL]);
@@ -242,6 +272,9 @@ static int tuned_open(void)
                 mca_coll_tuned_component.all_base_rules = NULL;
             }
         }
+        if (ompi_coll_tuned_autotune) {
+            ompi_coll_tuned_autotune_init();
+        }
     }
 
     OPAL_OUTPUT((ompi_coll_tuned_stream, "coll:tuned:component_open: done!"));
@@ -260,6 +293,9 @@ static int tuned_close(void)
 
     OPAL_OUTPUT((ompi_coll_tuned_stream, "coll:tuned:component_close: done!"));
 
+    /* dump the online selections before the rules they are merged with */
+    ompi_coll_tuned_autotune_finalize();
+
     if( NULL != mca_coll_tuned_component.all_base_rules ) {
         ompi_coll_tuned_free_all_rules(mca_coll_tuned_component.all_base_rules, COLLCOUNT);
         mca_coll_tuned_component.all_base_rules = NULL;
@@ -276,8 +312,18 @@ mca_coll_tuned_module_construct(mca_coll_tuned_module_t *module)
     for( int i = 0; i < COLLCOUNT; i++ ) {
         tuned_module->user_forced[i].algorithm = 0;
         tuned_module->com_rules[i] = NULL;
+        tuned_module->autotune[i] = NULL;
+    }
+}
+
+static void
+mca_coll_tuned_module_destruct(mca_coll_tuned_module_t *module)
+{
+    for( int i = 0; i < COLLCOUNT; i++ ) {
+        ompi_coll_tuned_autotune_destroy(module->autotune[i]);
+        module->autotune[i] = NULL;
     }
 }
 
 OBJ_CLASS_INSTANCE(mca_coll_tuned_module_t, mca_coll_base_module_t,
-                   mca_coll_tuned_module_construct, NULL);
+                   mca_coll_tuned_module_construct, mca_coll_tuned_module_destruct);
@@ -27,6 +27,7 @@
 #include "ompi/constants.h"
 #include "ompi/datatype/ompi_datatype.h"
 #include "ompi/communicator/communicator.h"
+#include "ompi/op/op.h"
 #include "ompi/mca/coll/base/base.h"
 #include "ompi/mca/coll/coll.h"
 #include "ompi/mca/coll/base/coll_tags.h"
@@ -36,10 +37,13 @@
  * Notes on evaluation rules and ordering
  *
  * The order is:
- *      use file based rules if presented (-coll_tuned_dynamic_rules_filename = rules)
- * Else
  *      use forced rules (-coll_tuned_dynamic_ALG_intra_algorithm = algorithm-number)
  * Else
+ *      use online selected rules (-coll_tuned_autotune = 1), only for the
+ *      communicator sizes without an exact file based rule
+ * Else
+ *      use file based rules if presented (-coll_tuned_dynamic_rules_filename = rules)
+ * Else
  *      use fixed (compiled) rule set (or nested ifs)
  *
  */
@@ -70,6 +74,26 @@ ompi_coll_tuned_allreduce_intra_dec_dynamic (const void *sbuf, void *rbuf, int c
                                                        tuned_module->user_forced[ALLREDUCE].segsize);
     }
 
+    /* time the algorithms online while this collective is still tuned */
+    if (tuned_module->autotune[ALLREDUCE] && ompi_op_is_commute(op)) {
+        ompi_coll_tuned_autotune_t *autotune = tuned_module->autotune[ALLREDUCE];
+        ompi_coll_tuned_autotune_bucket_t *bucket;
+        int alg, ret;
+        size_t dsize;
+
+        ompi_datatype_type_size(dtype, &dsize);
+        dsize *= count;
+        alg = ompi_coll_tuned_autotune_begin(autotune, dsize, &bucket);
+        if (alg) {
+            ret = ompi_coll_tuned_allreduce_intra_do_this(sbuf, rbuf, count, dtype, op, comm, module,
+                                                          alg, autotune->faninout, autotune->segsize);
+            if (NULL != bucket) {
+                ret = ompi_coll_tuned_autotune_end(autotune, bucket, ret, comm, tuned_module);
+            }
+            return ret;
+        }
+    }
+
     /* check to see if we have some filebased rules */
     if (tuned_module->com_rules[ALLREDUCE]) {
         /* we do, so calc the message size or what ever we need and use this for the evaluation */
@@ -124,6 +148,30 @@ int ompi_coll_tuned_alltoall_intra_dec_dynamic(const void *sbuf, int scount,
                                                       tuned_module->user_forced[ALLTOALL].max_requests);
     }
 
+    /* time the algorithms online while this collective is still tuned */
+    if (tuned_module->autotune[ALLTOALL]) {
+        ompi_coll_tuned_autotune_t *autotune = tuned_module->autotune[ALLTOALL];
+        ompi_coll_tuned_autotune_bucket_t *bucket;
+        int alg, ret;
+        size_t dsize;
+
+        /* the send type is not significant for MPI_IN_PLACE */
+        ompi_datatype_type_size(rdtype, &dsize);
+        dsize *= (ptrdiff_t)ompi_comm_size(comm) * (ptrdiff_t)rcount;
+        alg = ompi_coll_tuned_autotune_begin(autotune, dsize, &bucket);
+        if (alg) {
+            ret = ompi_coll_tuned_alltoall_intra_do_this(sbuf, scount, sdtype,
+                                                         rbuf, rcount, rdtype,
+                                                         comm, module,
+                                                         alg, autotune->faninout, autotune->segsize,
+                                                         tuned_module->user_forced[ALLTOALL].max_requests);
+            if (NULL != bucket) {
+                ret = ompi_coll_tuned_autotune_end(autotune, bucket, ret, comm, tuned_module);
+            }
+            return ret;
+        }
+    }
+
     /* check to see if we have some filebased rules */
     if (tuned_module->com_rules[ALLTOALL]) {
         /* we do, so calc the message size or what ever we need and use this for the evaluation */
@@ -174,7 +222,8 @@ int ompi_coll_tuned_alltoallv_intra_dec_dynamic(const void *sbuf, const int *sco
         return ompi_coll_tuned_alltoallv_intra_do_this(sbuf, scounts, sdisps, sdtype,
                                                        rbuf, rcounts, rdisps, rdtype,
                                                        comm, module,
-                                                       tuned_module->user_forced[ALLTOALLV].algorithm);
+                                                       tuned_module->user_forced[ALLTOALLV].algorithm,
+                                                       tuned_module->user_forced[ALLTOALLV].max_requests);
     }
 
     /**
@@ -194,7 +243,7 @@ int ompi_coll_tuned_alltoallv_intra_dec_dynamic(const void *sbuf, const int *sco
             return ompi_coll_tuned_alltoallv_intra_do_this (sbuf, scounts, sdisps, sdtype,
                                                             rbuf, rcounts, rdisps, rdtype,
                                                             comm, module,
-                                                            alg);
+                                                            alg, max_requests);
         } /* found a method */
     } /*end if any com rules to check */
 
@@ -225,6 +274,23 @@ int ompi_coll_tuned_barrier_intra_dec_dynamic(struct ompi_communicator_t *comm,
                                                      tuned_module->user_forced[BARRIER].segsize);
     }
 
+    /* time the algorithms online while this collective is still tuned */
+    if (tuned_module->autotune[BARRIER]) {
+        ompi_coll_tuned_autotune_t *autotune = tuned_module->autotune[BARRIER];
+        ompi_coll_tuned_autotune_bucket_t *bucket;
+        int alg, ret;
+
+        alg = ompi_coll_tuned_autotune_begin(autotune, 0, &bucket);
+        if (alg) {
+            ret = ompi_coll_tuned_barrier_intra_do_this(comm, module,
+                                                        alg, autotune->faninout, autotune->segsize);
+            if (NULL != bucket) {
+                ret = ompi_coll_tuned_autotune_end(autotune, bucket, ret, comm, tuned_module);
+            }
+            return ret;
+        }
+    }
+
     /* check to see if we have some filebased rules */
     if (tuned_module->com_rules[BARRIER]) {
         /* we do, so calc the message size or what ever we need and use this for the evaluation */
@@ -268,6 +334,27 @@ int ompi_coll_tuned_bcast_intra_dec_dynamic(void *buf, int count,
                                                    tuned_module->user_forced[BCAST].segsize);
     }
 
+    /* time the algorithms online while this collective is still tuned */
+    if (tuned_module->autotune[BCAST]) {
+        ompi_coll_tuned_autotune_t *autotune = tuned_module->autotune[BCAST];
+        ompi_coll_tuned_autotune_bucket_t *bucket;
+        int alg, ret;
+        size_t dsize;
+
+        ompi_datatype_type_size(dtype, &dsize);
+        dsize *= count;
+        alg = ompi_coll_tuned_autotune_begin(autotune, dsize, &bucket);
+        if (alg) {
+            ret = ompi_coll_tuned_bcast_intra_do_this(buf, count, dtype, root,
+                                                      comm, module,
+                                                      alg, autotune->faninout, autotune->segsize);
+            if (NULL != bucket) {
+                ret = ompi_coll_tuned_autotune_end(autotune, bucket, ret, comm, tuned_module);
+            }
+            return ret;
+        }
+    }
+
     /* check to see if we have some filebased rules */
     if (tuned_module->com_rules[BCAST]) {
         /* we do, so calc the message size or what ever we need and use this for the evaluation */
@@ -321,6 +408,28 @@ int ompi_coll_tuned_reduce_intra_dec_dynamic( const void *sbuf, void *rbuf,
                                                     tuned_module->user_forced[REDUCE].max_requests);
     }
 
+    /* time the algorithms online while this collective is still tuned */
+    if (tuned_module->autotune[REDUCE] && ompi_op_is_commute(op)) {
+        ompi_coll_tuned_autotune_t *autotune = tuned_module->autotune[REDUCE];
+        ompi_coll_tuned_autotune_bucket_t *bucket;
+        int alg, ret;
+        size_t dsize;
+
+        ompi_datatype_type_size(dtype, &dsize);
+        dsize *= count;
+        alg = ompi_coll_tuned_autotune_begin(autotune, dsize, &bucket);
+        if (alg) {
+            ret = ompi_coll_tuned_reduce_intra_do_this(sbuf, rbuf, count, dtype,
+                                                       op, root, comm, module,
+                                                       alg, autotune->faninout, autotune->segsize,
+                                                       tuned_module->user_forced[REDUCE].max_requests);
+            if (NULL != bucket) {
+                ret = ompi_coll_tuned_autotune_end(autotune, bucket, ret, comm, tuned_module);
+            }
+            return ret;
+        }
+    }
+
     /* check to see if we have some filebased rules */
     if (tuned_module->com_rules[REDUCE]) {
 
@@ -431,6 +540,27 @@ int ompi_coll_tuned_reduce_scatter_block_intra_dec_dynamic(const void *sbuf, voi
                                                                   tuned_module->user_forced[REDUCESCATTERBLOCK].segsize);
     }
 
+    /* time the algorithms online while this collective is still tuned */
+    if (tuned_module->autotune[REDUCESCATTERBLOCK] && ompi_op_is_commute(op)) {
+        ompi_coll_tuned_autotune_t *autotune = tuned_module->autotune[REDUCESCATTERBLOCK];
+        ompi_coll_tuned_autotune_bucket_t *bucket;
+        int alg, ret;
+        size_t dsize;
+
+        ompi_datatype_type_size(dtype, &dsize);
+        dsize *= (ptrdiff_t)rcount * (ptrdiff_t)ompi_comm_size(comm);
+        alg = ompi_coll_tuned_autotune_begin(autotune, dsize, &bucket);
+        if (alg) {
+            ret = ompi_coll_tuned_reduce_scatter_block_intra_do_this(sbuf, rbuf, rcount, dtype,
+                                                                     op, comm, module,
+                                                                     alg, autotune->faninout, autotune->segsize);
+            if (NULL != bucket) {
+                ret = ompi_coll_tuned_autotune_end(autotune, bucket, ret, comm, tuned_module);
+            }
+            return ret;
+        }
+    }
+
     /* check to see if we have some filebased rules */
     if (tuned_module->com_rules[REDUCESCATTERBLOCK]) {
         /* we do, so calc the message size or what ever we need and use
@@ -488,6 +618,29 @@ int ompi_coll_tuned_allgather_intra_dec_dynamic(const void *sbuf, int scount,
                                                        tuned_module->user_forced[ALLGATHER].segsize);
     }
 
+    /* time the algorithms online while this collective is still tuned */
+    if (tuned_module->autotune[ALLGATHER]) {
+        ompi_coll_tuned_autotune_t *autotune = tuned_module->autotune[ALLGATHER];
+        ompi_coll_tuned_autotune_bucket_t *bucket;
+        int alg, ret;
+        size_t dsize;
+
+        /* the send type is not significant for MPI_IN_PLACE */
+        ompi_datatype_type_size(rdtype, &dsize);
+        dsize *= (ptrdiff_t)ompi_comm_size(comm) * (ptrdiff_t)rcount;
+        alg = ompi_coll_tuned_autotune_begin(autotune, dsize, &bucket);
+        if (alg) {
+            ret = ompi_coll_tuned_allgather_intra_do_this(sbuf, scount, sdtype,
+                                                          rbuf, rcount, rdtype,
+                                                          comm, module,
+                                                          alg, autotune->faninout, autotune->segsize);
+            if (NULL != bucket) {
+                ret = ompi_coll_tuned_autotune_end(autotune, bucket, ret, comm, tuned_module);
+            }
+            return ret;
+        }
+    }
+
     if (tuned_module->com_rules[ALLGATHER]) {
         /* We have file based rules:
            - calculate message size and other necessary information */
@@ -606,6 +759,35 @@ int ompi_coll_tuned_gather_intra_dec_dynamic(const void *sbuf, int scount,
                                                     tuned_module->user_forced[GATHER].segsize);
     }
 
+    /* time the algorithms online while this collective is still tuned */
+    if (tuned_module->autotune[GATHER]) {
+        ompi_coll_tuned_autotune_t *autotune = tuned_module->autotune[GATHER];
+        ompi_coll_tuned_autotune_bucket_t *bucket;
+        int alg, ret;
+        size_t dsize;
+
+        /* only the root knows the receive type, which may be the only one */
+        if (ompi_comm_rank(comm) == root) {
+            ompi_datatype_type_size(rdtype, &dsize);
+            dsize *= (ptrdiff_t)rcount;
+        } else {
+            ompi_datatype_type_size(sdtype, &dsize);
+            dsize *= (ptrdiff_t)scount;
+        }
+        dsize *= ompi_comm_size(comm);
+        alg = ompi_coll_tuned_autotune_begin(autotune, dsize, &bucket);
+        if (alg) {
+            ret = ompi_coll_tuned_gather_intra_do_this(sbuf, scount, sdtype,
+                                                       rbuf, rcount, rdtype,
+                                                       root, comm, module,
+                                                       alg, autotune->faninout, autotune->segsize);
+            if (NULL != bucket) {
+                ret = ompi_coll_tuned_autotune_end(autotune, bucket, ret, comm, tuned_module);
+            }
+            return ret;
+        }
+    }
+
     /**
      * check to see if we have some filebased rules.
      */
@@ -656,6 +838,35 @@ int ompi_coll_tuned_scatter_intra_dec_dynamic(const void *sbuf, int scount,
                                                      tuned_module->user_forced[SCATTER].segsize);
     }
 
+    /* time the algorithms online while this collective is still tuned */
+    if (tuned_module->autotune[SCATTER]) {
+        ompi_coll_tuned_autotune_t *autotune = tuned_module->autotune[SCATTER];
+        ompi_coll_tuned_autotune_bucket_t *bucket;
+        int alg, ret;
+        size_t dsize;
+
+        /* only the root knows the send type, which may be the only one */
+        if (ompi_comm_rank(comm) == root) {
+            ompi_datatype_type_size(sdtype, &dsize);
+            dsize *= (ptrdiff_t)scount;
+        } else {
+            ompi_datatype_type_size(rdtype, &dsize);
+            dsize *= (ptrdiff_t)rcount;
+        }
+        dsize *= ompi_comm_size(comm);
+        alg = ompi_coll_tuned_autotune_begin(autotune, dsize, &bucket);
+        if (alg) {
+            ret = ompi_coll_tuned_scatter_intra_do_this(sbuf, scount, sdtype,
+                                                        rbuf, rcount, rdtype,
+                                                        root, comm, module,
+                                                        alg, autotune->faninout, autotune->segsize);
+            if (NULL != bucket) {
+                ret = ompi_coll_tuned_autotune_end(autotune, bucket, ret, comm, tuned_module);
+            }
+            return ret;
+        }
+    }
+
     /**
      * check to see if we have some filebased rules.
      */
@@ -73,9 +73,10 @@ ompi_coll_tuned_allreduce_intra_dec_fixed(const void *sbuf, void *rbuf, int coun
      *  {4, "ring"},
      *  {5, "segmented_ring"},
      *  {6, "rabenseifner"
+     *  {7, "recursive_multiplying"},
      *
-     * Currently, ring, segmented ring, and rabenseifner do not support
-     * non-commutative operations.
+     * Currently, ring, segmented ring, rabenseifner and recursive multiplying
+     * do not support non-commutative operations.
      */
     if( !ompi_op_is_commute(op) ) {
         if (communicator_size < 4) {
@@ -211,6 +212,14 @@ ompi_coll_tuned_allreduce_intra_dec_fixed(const void *sbuf, void *rbuf, int coun
                 alg = 6;
             }
         }
+        /* On non-power-of-two communicators recursive doubling and
+         * rabenseifner pay extra fold-in rounds at mid sizes, while recursive
+         * multiplying folds into the nearest power of its radix in one. */
+        if (communicator_size >= 8 && communicator_size < 128 &&
+            (communicator_size & (communicator_size - 1)) &&
+            total_dsize >= 8192 && total_dsize < 65536) {
+            alg = 7;
+        }
     }
 
     return ompi_coll_tuned_allreduce_intra_do_this (sbuf, rbuf, count, dtype, op,
@@ -430,6 +439,8 @@ int ompi_coll_tuned_alltoallv_intra_dec_fixed(const void *sbuf, const int *scoun
     /** Algorithms:
      *  {1, "basic_linear"},
      *  {2, "pairwise"},
+     *  {3, "scattered"},
+     *  {4, "bruck"},
      *
      * We can only optimize based on com size
      */
@@ -450,7 +461,7 @@ int ompi_coll_tuned_alltoallv_intra_dec_fixed(const void *sbuf, const int *scoun
     return ompi_coll_tuned_alltoallv_intra_do_this (sbuf, scounts, sdisps, sdtype,
                                                     rbuf, rcounts, rdisps, rdtype,
                                                     comm, module,
-                                                    alg);
+                                                    alg, 0);
 }
 
 
@@ -148,6 +148,44 @@ ompi_coll_tuned_forced_getvalues( enum COLLTYPE type,
     return (MPI_SUCCESS);
 }
 
+/*
+ * Prepare the online selection of the algorithms of a collective, unless
+ * the user forced the algorithm or the rules file already has a rule for
+ * this communicator size.
+ */
+static int
+ompi_coll_tuned_autotune_setup( mca_coll_tuned_module_t *tuned_module,
+                                enum COLLTYPE type, int size )
+{
+    int faninout = 0, segsize = 0;
+
+    if( !ompi_coll_tuned_autotune || !ompi_coll_tuned_autotune_is_supported(type) ||
+        0 != tuned_module->user_forced[type].algorithm ) {
+        return 0;
+    }
+    if( NULL != tuned_module->com_rules[type] &&
+        size == tuned_module->com_rules[type]->mpi_comsize ) {
+        return 0;
+    }
+
+    /* use the same topology parameters as the forced algorithms */
+    switch( type ) {
+    case BARRIER:
+        break;
+    case BCAST: case REDUCE: case REDUCESCATTERBLOCK: case SCATTER:
+        faninout = tuned_module->user_forced[type].chain_fanout;
+        segsize = tuned_module->user_forced[type].segsize;
+        break;
+    default:
+        faninout = tuned_module->user_forced[type].tree_fanout;
+        segsize = tuned_module->user_forced[type].segsize;
+        break;
+    }
+
+    tuned_module->autotune[type] = ompi_coll_tuned_autotune_create(type, size, faninout, segsize);
+    return (NULL != tuned_module->autotune[type]);
+}
+
 #define COLL_TUNED_EXECUTE_IF_DYNAMIC(TMOD, TYPE, EXECUTE)              \
     {                                                                   \
         int need_dynamic_decision = 0;                                  \
@@ -164,6 +202,9 @@ ompi_coll_tuned_forced_getvalues( enum COLLTYPE type,
                 need_dynamic_decision = 1;                              \
             }                                                           \
         }                                                               \
+        if( ompi_coll_tuned_autotune_setup((TMOD), (TYPE), size) ) {    \
+            need_dynamic_decision = 1;                                  \
+        }                                                               \
         if( 1 == need_dynamic_decision ) {                              \
             OPAL_OUTPUT((ompi_coll_tuned_stream,"coll:tuned: enable dynamic selection for "#TYPE)); \
             EXECUTE;                                                    \
@@ -115,6 +115,15 @@ struct ompi_osc_rdma_component_t {
     /** maximum count for network AMO usage */
     unsigned long network_amo_max_count;
 
+    /** largest put that will be coalesced with other puts to the same target (0: disabled) */
+    unsigned int put_coalesce_size;
+
+    /** maximum size of a coalesced put */
+    unsigned int put_coalesce_limit;
+
+    /** number of coalesced puts after which a batch still open is written (0: no limit) */
+    unsigned int put_coalesce_max_age;
+
     /** memory alignment to be used for new windows */
     size_t memory_alignment;
 };
@@ -313,6 +322,25 @@ struct ompi_osc_rdma_module_t {
     /** number of time a get had to be retried */
     unsigned long get_retry_count;
 
+    /** number of puts that were coalesced */
+    unsigned long put_coalesce_count;
+
+    /** number of btl puts used to write the coalesced puts */
+    unsigned long put_coalesce_batches;
+
+    /** lock protecting the put batches */
+    opal_mutex_t put_batch_lock;
+
+    /** coalesced puts that have not been started yet (ompi_osc_rdma_put_batch_t) */
+    opal_list_t put_batches;
+
+    /** number of batches in put_batches, read without the lock */
+    opal_atomic_int32_t put_batches_open;
+
+    /** first error of a coalesced put started outside of the put that filled it, returned by
+     * the next completion of the rdma operations */
+    opal_atomic_int32_t put_batch_error;
+
     /** outstanding atomic operations */
     opal_atomic_int32_t pending_ops;
 };
@@ -609,13 +637,31 @@ static inline void ompi_osc_rdma_sync_rdma_dec (ompi_osc_rdma_sync_t *rdma_sync)
     ompi_osc_rdma_sync_rdma_dec_always (rdma_sync);
 }
 
+/**
+ * @brief start all the coalesced puts of a module
+ *
+ * @param[in] module          osc rdma module
+ */
+void ompi_osc_rdma_put_batch_flush_all (ompi_osc_rdma_module_t *module);
+
 /**
  * @brief complete all outstanding rdma operations to all peers
  *
  * @param[in] module          osc rdma module
+ *
+ * @returns the error of a coalesced put that failed since the last completion, if any
  */
-static inline void ompi_osc_rdma_sync_rdma_complete (ompi_osc_rdma_sync_t *sync)
+static inline int ompi_osc_rdma_sync_rdma_complete (ompi_osc_rdma_sync_t *sync)
 {
+    ompi_osc_rdma_module_t *module = sync->module;
+    int ret;
+
+    /* open batches do not hold a fragment, the fragment count below only covers the puts
+     * in flight */
+    if (module->put_batches_open) {
+        ompi_osc_rdma_put_batch_flush_all (module);
+    }
+
 #if !defined(BTL_VERSION) || (BTL_VERSION < 310)
     do {
         opal_progress ();
@@ -631,6 +677,12 @@ static inline void ompi_osc_rdma_sync_rdma_complete (ompi_osc_rdma_sync_t *sync)
         }
     }  while (ompi_osc_rdma_sync_get_count (sync) || (sync->module->rdma_frag && (sync->module->rdma_frag->pending > 1)));
 #endif
+
+    ret = module->put_batch_error;
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != ret)) {
+        ret = opal_atomic_swap_32 (&module->put_batch_error, OMPI_SUCCESS);
+    }
+    return ret;
 }
 
 /**
@@ -423,7 +423,7 @@ int ompi_osc_rdma_complete_atomic (ompi_win_t *win)
     ompi_osc_rdma_sync_t *sync = &module->all_sync;
     ompi_osc_rdma_peer_t **peers;
     ompi_group_t *group;
-    int group_size;
+    int group_size, rdma_ret;
     int ret __opal_attribute_unused__;
 
     OSC_RDMA_VERBOSE(MCA_BASE_VERBOSE_TRACE, "complete: %s", win->w_name);
@@ -457,7 +457,7 @@ int ompi_osc_rdma_complete_atomic (ompi_win_t *win)
 
     OPAL_THREAD_UNLOCK(&(module->lock));
 
-    ompi_osc_rdma_sync_rdma_complete (sync);
+    rdma_ret = ompi_osc_rdma_sync_rdma_complete (sync);
 
     /* for each process in the group increment their number of complete messages */
     for (int i = 0 ; i < group_size ; ++i) {
@@ -477,7 +477,7 @@ int ompi_osc_rdma_complete_atomic (ompi_win_t *win)
 
     OSC_RDMA_VERBOSE(MCA_BASE_VERBOSE_TRACE, "complete complete");
 
-    return OMPI_SUCCESS;
+    return rdma_ret;
 }
 
 int ompi_osc_rdma_wait_atomic (ompi_win_t *win)
@@ -566,7 +566,7 @@ int ompi_osc_rdma_test_atomic (ompi_win_t *win, int *flag)
 int ompi_osc_rdma_fence_atomic (int mpi_assert, ompi_win_t *win)
 {
     ompi_osc_rdma_module_t *module = GET_MODULE(win);
-    int ret = OMPI_SUCCESS;
+    int ret = OMPI_SUCCESS, rdma_ret;
 
     OSC_RDMA_VERBOSE(MCA_BASE_VERBOSE_TRACE, "fence: %d, %s", mpi_assert, win->w_name);
 
@@ -597,10 +597,13 @@ int ompi_osc_rdma_fence_atomic (int mpi_assert, ompi_win_t *win)
      * may be local stores that will not be visible as they should if we do not barrier. since that is the
      * case there is no optimization for NOPRECEDE */
 
-    ompi_osc_rdma_sync_rdma_complete (&module->all_sync);
+    rdma_ret = ompi_osc_rdma_sync_rdma_complete (&module->all_sync);
 
     /* ensure all writes to my memory are complete (both local stores, and RMA operations) */
     ret = module->comm->c_coll->coll_barrier(module->comm, module->comm->c_coll->coll_barrier_module);
+    if (OMPI_SUCCESS == ret) {
+        ret = rdma_ret;
+    }
 
     if (mpi_assert & MPI_MODE_NOSUCCEED) {
         /* as specified in MPI-3 p 438 3-5 the fence can end an epoch. it isn't explicitly
@@ -545,6 +545,194 @@ int ompi_osc_rdma_put_contig (ompi_osc_rdma_sync_t *sync, ompi_osc_rdma_peer_t *
     return ret;
 }
 
+/**
+ * @brief start the btl put of a batch of coalesced puts
+ *
+ * Must be called with the module put batch lock held. The lock is released while waiting for
+ * fragment space, the batch is then hidden from the other threads. The batch is empty on return.
+ */
+static int ompi_osc_rdma_put_batch_start (ompi_osc_rdma_put_batch_t *batch)
+{
+    ompi_osc_rdma_sync_t *sync = batch->sync;
+    ompi_osc_rdma_module_t *module = sync->module;
+    mca_btl_base_rdma_completion_fn_t cbfunc;
+    ompi_osc_rdma_frag_t *frag;
+    void *cbcontext;
+    char *ptr;
+    int ret;
+
+    OSC_RDMA_VERBOSE(MCA_BASE_VERBOSE_TRACE, "starting put of %lu coalesced puts (%lu bytes) to peer %d",
+                     batch->count, (unsigned long) batch->size, batch->peer->rank);
+
+    /* the completion of the sync waits for the batch from now on */
+    opal_list_remove_item (&module->put_batches, &batch->super);
+    (void) opal_atomic_add_fetch_32 (&module->put_batches_open, -1);
+    ompi_osc_rdma_sync_rdma_inc_always (sync);
+
+    /* only reserve the bytes that were staged. the fragment is full while earlier puts are in
+     * flight, progress until they complete without holding the lock */
+    do {
+        ret = ompi_osc_rdma_frag_alloc (module, batch->size, &frag, &ptr);
+        if (OPAL_LIKELY(OMPI_SUCCESS == ret) || OMPI_ERR_OUT_OF_RESOURCE != ret || NULL == module->rdma_frag) {
+            break;
+        }
+        batch->starting = true;
+        OPAL_THREAD_UNLOCK(&module->put_batch_lock);
+        ompi_osc_rdma_progress (module);
+        OPAL_THREAD_LOCK(&module->put_batch_lock);
+        batch->starting = false;
+    } while (1);
+
+    if (OPAL_LIKELY(OMPI_SUCCESS == ret)) {
+        memcpy (ptr, batch->buffer, batch->size);
+
+        /* the callback always has to return the fragment. see ompi_osc_rdma_put_contig for why a
+         * different callback is used with btl_flush */
+        if (ompi_osc_rdma_use_btl_flush (module)) {
+            cbcontext = (void *) module;
+            cbfunc = ompi_osc_rdma_put_complete_flush;
+        } else {
+            cbcontext = (void *) sync;
+            cbfunc = ompi_osc_rdma_put_complete;
+        }
+
+        ret = ompi_osc_rdma_put_real (sync, batch->peer, batch->target_address, batch->target_handle, ptr,
+                                      frag->handle, batch->size, cbfunc, cbcontext, frag);
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != ret)) {
+            ompi_osc_rdma_cleanup_rdma (sync, false, frag, NULL, NULL);
+        } else {
+            ++module->put_coalesce_batches;
+        }
+    }
+
+    ompi_osc_rdma_sync_rdma_dec_always (sync);
+    batch->sync = NULL;
+    batch->size = 0;
+    batch->count = 0;
+
+    return ret;
+}
+
+/**
+ * @brief start a batch outside of the put that filled it
+ *
+ * The puts were already reported as successful, the error is returned by the next completion
+ * of the rdma operations (flush, unlock, complete, fence).
+ */
+static void ompi_osc_rdma_put_batch_start_detached (ompi_osc_rdma_put_batch_t *batch)
+{
+    ompi_osc_rdma_module_t *module = batch->sync->module;
+    int ret;
+
+    ret = ompi_osc_rdma_put_batch_start (batch);
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != ret)) {
+        int32_t expected = OMPI_SUCCESS;
+
+        OSC_RDMA_VERBOSE(MCA_BASE_VERBOSE_WARN, "coalesced put to peer %d failed with error code %d",
+                         batch->peer->rank, ret);
+        (void) opal_atomic_compare_exchange_strong_32 (&module->put_batch_error, &expected, ret);
+    }
+}
+
+void ompi_osc_rdma_put_batch_flush_all (ompi_osc_rdma_module_t *module)
+{
+    ompi_osc_rdma_put_batch_t *batch;
+
+    /* starting a batch may release the lock, so the list is walked from its head again */
+    OPAL_THREAD_LOCK(&module->put_batch_lock);
+    while (!opal_list_is_empty (&module->put_batches)) {
+        batch = (ompi_osc_rdma_put_batch_t *) opal_list_get_first (&module->put_batches);
+        ompi_osc_rdma_put_batch_start_detached (batch);
+    }
+    OPAL_THREAD_UNLOCK(&module->put_batch_lock);
+}
+
+/**
+ * @brief add a small contiguous put to the put batch of a peer
+ *
+ * Puts that continue the remote range of the current batch are copied into its staging
+ * buffer. Any other put starts the current batch and opens a new one. The batches are
+ * written when they are full, when put_coalesce_max_age other puts were coalesced since
+ * they were opened, or when the rdma operations of the module are completed (flush,
+ * unlock, complete, fence, win_sync).
+ *
+ * @returns OMPI_ERR_NOT_AVAILABLE if the put could not be coalesced
+ */
+static int ompi_osc_rdma_put_coalesce (ompi_osc_rdma_sync_t *sync, ompi_osc_rdma_peer_t *peer, uint64_t target_address,
+                                       mca_btl_base_registration_handle_t *target_handle, const void *source_buffer,
+                                       size_t size)
+{
+    ompi_osc_rdma_module_t *module = sync->module;
+    size_t limit = opal_min(mca_osc_rdma_component.put_coalesce_limit, mca_osc_rdma_component.buffer_size >> 1);
+    unsigned int max_age = mca_osc_rdma_component.put_coalesce_max_age;
+    ompi_osc_rdma_put_batch_t *batch;
+    int ret = OMPI_SUCCESS;
+
+    if (size > limit) {
+        return OMPI_ERR_NOT_AVAILABLE;
+    }
+
+    OPAL_THREAD_LOCK(&module->put_batch_lock);
+    batch = peer->put_batch;
+    if (OPAL_UNLIKELY(NULL == batch)) {
+        batch = OBJ_NEW(ompi_osc_rdma_put_batch_t);
+        if (OPAL_UNLIKELY(NULL == batch)) {
+            OPAL_THREAD_UNLOCK(&module->put_batch_lock);
+            return OMPI_ERR_NOT_AVAILABLE;
+        }
+        batch->buffer = malloc (limit);
+        if (OPAL_UNLIKELY(NULL == batch->buffer)) {
+            OBJ_RELEASE(batch);
+            OPAL_THREAD_UNLOCK(&module->put_batch_lock);
+            return OMPI_ERR_NOT_AVAILABLE;
+        }
+        batch->peer = peer;
+        peer->put_batch = batch;
+    }
+
+    /* another thread is waiting for fragment space to start this batch */
+    if (OPAL_UNLIKELY(batch->starting)) {
+        OPAL_THREAD_UNLOCK(&module->put_batch_lock);
+        return OMPI_ERR_NOT_AVAILABLE;
+    }
+
+    if (NULL != batch->sync && (batch->sync != sync || batch->target_handle != target_handle ||
+                                batch->target_address + batch->size != target_address ||
+                                batch->size + size > limit)) {
+        ompi_osc_rdma_put_batch_start_detached (batch);
+    }
+
+    if (NULL == batch->sync) {
+        batch->sync = sync;
+        batch->target_address = target_address;
+        batch->target_handle = target_handle;
+        batch->opened = module->put_coalesce_count;
+        opal_list_append (&module->put_batches, &batch->super);
+        (void) opal_atomic_add_fetch_32 (&module->put_batches_open, 1);
+    }
+
+    memcpy (batch->buffer + batch->size, source_buffer, size);
+    batch->size += size;
+    ++batch->count;
+    ++module->put_coalesce_count;
+
+    if (batch->size == limit) {
+        ret = ompi_osc_rdma_put_batch_start (batch);
+    }
+
+    /* the batches are in the order they were opened. start the ones no put extended for a while */
+    while (max_age && !opal_list_is_empty (&module->put_batches)) {
+        batch = (ompi_osc_rdma_put_batch_t *) opal_list_get_first (&module->put_batches);
+        if (module->put_coalesce_count - batch->opened < max_age) {
+            break;
+        }
+        ompi_osc_rdma_put_batch_start_detached (batch);
+    }
+    OPAL_THREAD_UNLOCK(&module->put_batch_lock);
+
+    return ret;
+}
+
 static void ompi_osc_rdma_get_complete (struct mca_btl_base_module_t *btl, struct mca_btl_base_endpoint_t *endpoint,
                                         void *local_address, mca_btl_base_registration_handle_t *local_handle,
                                         void *context, void *data, int status)
@@ -780,6 +968,23 @@ static inline int ompi_osc_rdma_put_w_req (ompi_osc_rdma_sync_t *sync, const voi
                                          target_count, target_datatype, request);
     }
 
+    /* small contiguous puts without a request are coalesced with other puts to the same target */
+    if (NULL == request && origin_datatype->super.size * origin_count <= mca_osc_rdma_component.put_coalesce_size &&
+        ompi_datatype_is_contiguous_memory_layout (origin_datatype, origin_count) &&
+        ompi_datatype_is_contiguous_memory_layout (target_datatype, target_count)) {
+        ptrdiff_t origin_lb, target_lb, extent;
+
+        (void) ompi_datatype_get_true_extent (origin_datatype, &origin_lb, &extent);
+        (void) ompi_datatype_get_true_extent (target_datatype, &target_lb, &extent);
+
+        ret = ompi_osc_rdma_put_coalesce (sync, peer, target_address + target_lb, target_handle,
+                                          (const char *) origin_addr + origin_lb,
+                                          origin_datatype->super.size * origin_count);
+        if (OMPI_ERR_NOT_AVAILABLE != ret) {
+            return ret;
+        }
+    }
+
     return ompi_osc_rdma_master (sync, (void *) origin_addr, origin_count, origin_datatype, peer,
                                  target_address, target_handle, target_count, target_datatype, request,
                                  module->put_limit, ompi_osc_rdma_put_contig, false);
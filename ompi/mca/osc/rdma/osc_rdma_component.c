@@ -181,6 +181,21 @@ static int ompi_osc_rdma_pvar_read (const struct mca_base_pvar_t *pvar, void *va
     return OMPI_SUCCESS;
 }
 
+static int ompi_osc_rdma_pvar_read_coalesce_factor (const struct mca_base_pvar_t *pvar, void *value, void *obj)
+{
+    ompi_win_t *win = (ompi_win_t *) obj;
+    ompi_osc_rdma_module_t *module = GET_MODULE(win);
+    double factor = 0.0;
+
+    if (module->put_coalesce_batches) {
+        factor = (double) module->put_coalesce_count / (double) module->put_coalesce_batches;
+    }
+
+    memcpy (value, &factor, sizeof (factor));
+
+    return OMPI_SUCCESS;
+}
+
 static int ompi_osc_rdma_component_register (void)
 {
     char *description_str;
@@ -220,6 +235,36 @@ static int ompi_osc_rdma_component_register (void)
                                             MCA_BASE_VAR_SCOPE_LOCAL, &mca_osc_rdma_component.buffer_size);
     free(description_str);
 
+    mca_osc_rdma_component.put_coalesce_size = 0;
+    opal_asprintf(&description_str, "Largest contiguous put (in bytes) that is coalesced with other puts to "
+             "adjacent addresses of the same target. 0 disables coalescing (default: %u)",
+             mca_osc_rdma_component.put_coalesce_size);
+    (void) mca_base_component_var_register (&mca_osc_rdma_component.super.osc_version, "put_coalesce_size",
+                                            description_str, MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0, 0,
+                                            OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_LOCAL,
+                                            &mca_osc_rdma_component.put_coalesce_size);
+    free(description_str);
+
+    mca_osc_rdma_component.put_coalesce_limit = 4096;
+    opal_asprintf(&description_str, "Maximum size of a coalesced put. Limited to half of buffer_size "
+             "(default: %u)", mca_osc_rdma_component.put_coalesce_limit);
+    (void) mca_base_component_var_register (&mca_osc_rdma_component.super.osc_version, "put_coalesce_limit",
+                                            description_str, MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0, 0,
+                                            OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_LOCAL,
+                                            &mca_osc_rdma_component.put_coalesce_limit);
+    free(description_str);
+
+    mca_osc_rdma_component.put_coalesce_max_age = 256;
+    opal_asprintf(&description_str, "Number of coalesced puts to any target of a window after which a batch "
+             "that is still open is written, so that puts are not held back until the next synchronization "
+             "when no other put extends them. 0 disables (default: %u)",
+             mca_osc_rdma_component.put_coalesce_max_age);
+    (void) mca_base_component_var_register (&mca_osc_rdma_component.super.osc_version, "put_coalesce_max_age",
+                                            description_str, MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0, 0,
+                                            OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_LOCAL,
+                                            &mca_osc_rdma_component.put_coalesce_max_age);
+    free(description_str);
+
     mca_osc_rdma_component.max_attach = 64;
     opal_asprintf(&description_str, "Maximum number of buffers that can be attached to a dynamic window. "
              "Keep in mind that each attached buffer will use a potentially limited "
@@ -305,6 +350,27 @@ static int ompi_osc_rdma_component_register (void)
                                              ompi_osc_rdma_pvar_read, NULL, NULL,
                                              (void *) (intptr_t) offsetof (ompi_osc_rdma_module_t, get_retry_count));
 
+    (void) mca_base_component_pvar_register (&mca_osc_rdma_component.super.osc_version, "put_coalesce_count",
+                                             "Number of puts that were coalesced with other puts to the same target",
+                                             OPAL_INFO_LVL_4, MCA_BASE_PVAR_CLASS_COUNTER, MCA_BASE_VAR_TYPE_UNSIGNED_LONG,
+                                             NULL, MCA_BASE_VAR_BIND_MPI_WIN, MCA_BASE_PVAR_FLAG_CONTINUOUS,
+                                             ompi_osc_rdma_pvar_read, NULL, NULL,
+                                             (void *) (intptr_t) offsetof (ompi_osc_rdma_module_t, put_coalesce_count));
+
+    (void) mca_base_component_pvar_register (&mca_osc_rdma_component.super.osc_version, "put_coalesce_batches",
+                                             "Number of network puts used to write the coalesced puts",
+                                             OPAL_INFO_LVL_4, MCA_BASE_PVAR_CLASS_COUNTER, MCA_BASE_VAR_TYPE_UNSIGNED_LONG,
+                                             NULL, MCA_BASE_VAR_BIND_MPI_WIN, MCA_BASE_PVAR_FLAG_CONTINUOUS,
+                                             ompi_osc_rdma_pvar_read, NULL, NULL,
+                                             (void *) (intptr_t) offsetof (ompi_osc_rdma_module_t, put_coalesce_batches));
+
+    (void) mca_base_component_pvar_register (&mca_osc_rdma_component.super.osc_version, "put_coalesce_factor",
+                                             "Average number of puts written by each coalesced network put",
+                                             OPAL_INFO_LVL_4, MCA_BASE_PVAR_CLASS_LEVEL, MCA_BASE_VAR_TYPE_DOUBLE,
+                                             NULL, MCA_BASE_VAR_BIND_MPI_WIN, MCA_BASE_PVAR_FLAG_CONTINUOUS |
+                                             MCA_BASE_PVAR_FLAG_READONLY, ompi_osc_rdma_pvar_read_coalesce_factor,
+                                             NULL, NULL, NULL);
+
     return OMPI_SUCCESS;
 }
 
@@ -1377,6 +1443,10 @@ static int ompi_osc_rdma_component_select (struct ompi_win_t *win, void **base,
     OBJ_CONSTRUCT(&module->pending_posts, opal_list_t);
     OBJ_CONSTRUCT(&module->peer_lock, opal_mutex_t);
     OBJ_CONSTRUCT(&module->all_sync, ompi_osc_rdma_sync_t);
+    OBJ_CONSTRUCT(&module->put_batch_lock, opal_mutex_t);
+    OBJ_CONSTRUCT(&module->put_batches, opal_list_t);
+    module->put_batches_open = 0;
+    module->put_batch_error = OMPI_SUCCESS;
 
     module->same_disp_unit = check_config_value_bool ("same_disp_unit", info);
     module->same_size      = check_config_value_bool ("same_size", info);
@@ -14,3 +14,22 @@
 #include "osc_rdma_frag.h"
 
 OBJ_CLASS_INSTANCE(ompi_osc_rdma_frag_t, opal_free_list_item_t, NULL, NULL);
+
+static void ompi_osc_rdma_put_batch_construct (ompi_osc_rdma_put_batch_t *batch)
+{
+    batch->sync = NULL;
+    batch->peer = NULL;
+    batch->buffer = NULL;
+    batch->size = 0;
+    batch->count = 0;
+    batch->opened = 0;
+    batch->starting = false;
+}
+
+static void ompi_osc_rdma_put_batch_destruct (ompi_osc_rdma_put_batch_t *batch)
+{
+    free (batch->buffer);
+}
+
+OBJ_CLASS_INSTANCE(ompi_osc_rdma_put_batch_t, opal_list_item_t, ompi_osc_rdma_put_batch_construct,
+                   ompi_osc_rdma_put_batch_destruct);
@@ -95,6 +95,8 @@ int ompi_osc_rdma_free(ompi_win_t *win)
     OBJ_DESTRUCT(&module->lock);
     OBJ_DESTRUCT(&module->peer_lock);
     OBJ_DESTRUCT(&module->all_sync);
+    OBJ_DESTRUCT(&module->put_batch_lock);
+    OBJ_DESTRUCT(&module->put_batches);
 
     ompi_osc_rdma_deregister (module, module->state_handle);
     ompi_osc_rdma_deregister (module, module->base_handle);
@@ -31,7 +31,14 @@
 
 int ompi_osc_rdma_sync (struct ompi_win_t *win)
 {
-    ompi_osc_rdma_progress (GET_MODULE(win));
+    ompi_osc_rdma_module_t *module = GET_MODULE(win);
+
+    /* do not hold coalesced puts back from a target polling its memory */
+    if (module->put_batches_open) {
+        ompi_osc_rdma_put_batch_flush_all (module);
+    }
+
+    ompi_osc_rdma_progress (module);
     return OMPI_SUCCESS;
 }
 
@@ -40,6 +47,7 @@ int ompi_osc_rdma_flush (int target, struct ompi_win_t *win)
     ompi_osc_rdma_module_t *module = GET_MODULE(win);
     ompi_osc_rdma_sync_t *lock;
     ompi_osc_rdma_peer_t *peer;
+    int ret;
 
     assert (0 <= target);
 
@@ -57,11 +65,11 @@ int ompi_osc_rdma_flush (int target, struct ompi_win_t *win)
     OPAL_THREAD_UNLOCK(&module->lock);
 
     /* finish all outstanding fragments */
-    ompi_osc_rdma_sync_rdma_complete (lock);
+    ret = ompi_osc_rdma_sync_rdma_complete (lock);
 
     OSC_RDMA_VERBOSE(MCA_BASE_VERBOSE_TRACE, "flush on target %d complete", target);
 
-    return OMPI_SUCCESS;
+    return ret;
 }
 
 
@@ -69,7 +77,7 @@ int ompi_osc_rdma_flush_all (struct ompi_win_t *win)
 {
     ompi_osc_rdma_module_t *module = GET_MODULE(win);
     ompi_osc_rdma_sync_t *lock;
-    int ret = OMPI_SUCCESS;
+    int ret = OMPI_SUCCESS, rdma_ret = OMPI_SUCCESS;
     uint32_t key;
     void *node;
 
@@ -82,21 +90,24 @@ int ompi_osc_rdma_flush_all (struct ompi_win_t *win)
 
     /* globally complete all outstanding rdma requests */
     if (OMPI_OSC_RDMA_SYNC_TYPE_LOCK == module->all_sync.type) {
-        ompi_osc_rdma_sync_rdma_complete (&module->all_sync);
+        rdma_ret = ompi_osc_rdma_sync_rdma_complete (&module->all_sync);
     }
 
     /* flush all locks */
     ret = opal_hash_table_get_first_key_uint32 (&module->outstanding_locks, &key, (void **) &lock, &node);
     while (OPAL_SUCCESS == ret) {
         OSC_RDMA_VERBOSE(MCA_BASE_VERBOSE_DEBUG, "flushing lock %p", (void *) lock);
-        ompi_osc_rdma_sync_rdma_complete (lock);
+        ret = ompi_osc_rdma_sync_rdma_complete (lock);
+        if (OMPI_SUCCESS != ret && OMPI_SUCCESS == rdma_ret) {
+            rdma_ret = ret;
+        }
         ret = opal_hash_table_get_next_key_uint32 (&module->outstanding_locks, &key, (void **) &lock,
                                                    node, &node);
     }
 
     OSC_RDMA_VERBOSE(MCA_BASE_VERBOSE_TRACE, "flush_all complete");
 
-    return OPAL_SUCCESS;
+    return rdma_ret;
 }
 
 
@@ -270,7 +281,7 @@ int ompi_osc_rdma_unlock_atomic (int target, ompi_win_t *win)
     ompi_osc_rdma_module_t *module = GET_MODULE(win);
     ompi_osc_rdma_peer_t *peer;
     ompi_osc_rdma_sync_t *lock;
-    int ret = OMPI_SUCCESS;
+    int ret = OMPI_SUCCESS, rdma_ret;
 
     OPAL_THREAD_LOCK(&module->lock);
 
@@ -287,11 +298,14 @@ int ompi_osc_rdma_unlock_atomic (int target, ompi_win_t *win)
     ompi_osc_rdma_module_lock_remove (module, lock);
 
     /* finish all outstanding fragments */
-    ompi_osc_rdma_sync_rdma_complete (lock);
+    rdma_ret = ompi_osc_rdma_sync_rdma_complete (lock);
 
     if (!(lock->sync.lock.mpi_assert & MPI_MODE_NOCHECK)) {
         ret = ompi_osc_rdma_unlock_atomic_internal (module, peer, lock);
     }
+    if (OMPI_SUCCESS == ret) {
+        ret = rdma_ret;
+    }
 
     /* release our reference to this peer */
     OBJ_RELEASE(peer);
@@ -382,6 +396,7 @@ int ompi_osc_rdma_unlock_all_atomic (struct ompi_win_t *win)
 {
     ompi_osc_rdma_module_t *module = GET_MODULE(win);
     ompi_osc_rdma_sync_t *lock;
+    int ret;
 
     OSC_RDMA_VERBOSE(MCA_BASE_VERBOSE_TRACE, "unlock_all: %s", win->w_name);
 
@@ -395,7 +410,7 @@ int ompi_osc_rdma_unlock_all_atomic (struct ompi_win_t *win)
     }
 
     /* finish all outstanding fragments */
-    ompi_osc_rdma_sync_rdma_complete (lock);
+    ret = ompi_osc_rdma_sync_rdma_complete (lock);
 
     if (0 == (lock->sync.lock.mpi_assert & MPI_MODE_NOCHECK)) {
         if (OMPI_OSC_RDMA_LOCKING_ON_DEMAND == module->locking_mode) {
@@ -425,5 +440,5 @@ int ompi_osc_rdma_unlock_all_atomic (struct ompi_win_t *win)
 
     OSC_RDMA_VERBOSE(MCA_BASE_VERBOSE_TRACE, "unlock_all complete");
 
-    return OMPI_SUCCESS;
+    return ret;
 }
@@ -359,6 +359,10 @@ static void ompi_osc_rdma_peer_destruct (ompi_osc_rdma_peer_t *peer)
     if (peer->state_handle && (peer->flags & OMPI_OSC_RDMA_PEER_STATE_FREE)) {
         free (peer->state_handle);
     }
+
+    if (peer->put_batch) {
+        OBJ_RELEASE(peer->put_batch);
+    }
 }
 
 OBJ_CLASS_INSTANCE(ompi_osc_rdma_peer_t, opal_list_item_t,
@@ -50,6 +50,9 @@ struct ompi_osc_rdma_peer_t {
 
     /** index into BTL array */
     uint8_t state_btl_index;
+
+    /** coalesced puts to this peer (allocated on first use) */
+    struct ompi_osc_rdma_put_batch_t *put_batch;
 };
 typedef struct ompi_osc_rdma_peer_t ompi_osc_rdma_peer_t;
 
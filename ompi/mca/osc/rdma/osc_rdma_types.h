@@ -180,6 +180,33 @@ struct ompi_osc_rdma_frag_t {
 typedef struct ompi_osc_rdma_frag_t ompi_osc_rdma_frag_t;
 OBJ_CLASS_DECLARATION(ompi_osc_rdma_frag_t);
 
+/** Small puts to adjacent remote addresses staged in a buffer and written with one btl put */
+struct ompi_osc_rdma_put_batch_t {
+    opal_list_item_t super;
+
+    /** synchronization object of the coalesced puts (NULL if the batch is empty) */
+    struct ompi_osc_rdma_sync_t *sync;
+    struct ompi_osc_rdma_peer_t *peer;
+
+    /** staging buffer (put_coalesce_limit bytes). the data is copied to a fragment only when
+     * the batch is started, so an open batch does not hold a fragment */
+    char *buffer;
+
+    uint64_t target_address;
+    mca_btl_base_registration_handle_t *target_handle;
+
+    /** bytes staged so far */
+    size_t size;
+    /** number of puts staged so far */
+    unsigned long count;
+    /** value of the module put_coalesce_count when the batch was opened */
+    unsigned long opened;
+    /** the batch is being started by a thread that released the put batch lock */
+    bool starting;
+};
+typedef struct ompi_osc_rdma_put_batch_t ompi_osc_rdma_put_batch_t;
+OBJ_CLASS_DECLARATION(ompi_osc_rdma_put_batch_t);
+
 #define OSC_RDMA_VERBOSE(x, ...) OPAL_OUTPUT_VERBOSE((x, ompi_osc_base_framework.framework_output, __VA_ARGS__))
 
 #endif /* OMPI_OSC_RDMA_TYPES_H */
@@ -23,6 +23,13 @@ typedef opal_atomic_uint64_t osc_sm_post_atomic_type_t;
 #define OSC_SM_POST_BITS 6
 #define OSC_SM_POST_MASK 0x3f
 
+/* accumulate operations lock the target address range with striped
+ * reader-writer locks. operations done with processor atomics take their
+ * stripes shared, all others take them exclusive. */
+#define OSC_SM_ACC_LOCKS       16
+#define OSC_SM_ACC_LOCK_SHIFT  8
+#define OSC_SM_ACC_LOCK_WRITER 0x40000000
+
 /* data shared across all peers */
 struct ompi_osc_sm_global_state_t {
     int use_barrier_for_fence;
@@ -46,7 +53,7 @@ typedef struct ompi_osc_sm_lock_t ompi_osc_sm_lock_t;
 struct ompi_osc_sm_node_state_t {
     opal_atomic_int32_t complete_count;
     ompi_osc_sm_lock_t lock;
-    opal_atomic_lock_t accumulate_lock;
+    opal_atomic_int32_t accumulate_locks[OSC_SM_ACC_LOCKS];
 };
 typedef struct ompi_osc_sm_node_state_t ompi_osc_sm_node_state_t;
 
@@ -57,6 +64,12 @@ struct ompi_osc_sm_component_t {
     unsigned int priority;
 
     char *backing_directory;
+
+    /** Default for the acc_single_intrinsic info key */
+    bool acc_single_intrinsic;
+
+    /** Largest accumulate (in elements) done with processor atomics */
+    unsigned int acc_atomics_max_count;
 };
 typedef struct ompi_osc_sm_component_t ompi_osc_sm_component_t;
 OMPI_DECLSPEC extern ompi_osc_sm_component_t mca_osc_sm_component;
@@ -75,6 +88,7 @@ struct ompi_osc_sm_module_t {
     opal_shmem_ds_t seg_ds;
     void *segment_base;
     bool noncontig;
+    bool acc_single_intrinsic;
 
     size_t *sizes;
     void **bases;
@@ -100,6 +100,253 @@ ompi_osc_sm_rget(void *origin_addr,
 }
 
 
+/* take (or release) the accumulate locks covering [offset, offset + len) of
+ * a target. the stripes are always acquired in increasing order. */
+static void ompi_osc_sm_acc_lock_range(ompi_osc_sm_node_state_t *node_state, size_t offset,
+                                       size_t len, bool exclusive, bool lock)
+{
+    size_t first = offset >> OSC_SM_ACC_LOCK_SHIFT;
+    size_t last = (offset + (len ? len - 1 : 0)) >> OSC_SM_ACC_LOCK_SHIFT;
+
+    if (last - first + 1 >= OSC_SM_ACC_LOCKS) {
+        first = 0;
+        last = OSC_SM_ACC_LOCKS - 1;
+    } else {
+        first %= OSC_SM_ACC_LOCKS;
+        last %= OSC_SM_ACC_LOCKS;
+    }
+
+    for (size_t i = 0 ; i < OSC_SM_ACC_LOCKS ; ++i) {
+        opal_atomic_int32_t *stripe = node_state->accumulate_locks + i;
+
+        if ((first <= last) ? (i < first || i > last) : (i < first && i > last)) {
+            continue;
+        }
+
+        if (!lock) {
+            opal_atomic_mb();
+            (void) opal_atomic_fetch_add_32(stripe, exclusive ? -OSC_SM_ACC_LOCK_WRITER : -1);
+        } else if (exclusive) {
+            while (OSC_SM_ACC_LOCK_WRITER & opal_atomic_fetch_or_32(stripe, OSC_SM_ACC_LOCK_WRITER)) {
+                while (OSC_SM_ACC_LOCK_WRITER & *stripe) {
+                    /* spin */;
+                }
+            }
+            /* wait for the atomic operations in flight */
+            while (OSC_SM_ACC_LOCK_WRITER != *stripe) {
+                /* spin */;
+            }
+            opal_atomic_mb();
+        } else {
+            while (OSC_SM_ACC_LOCK_WRITER & opal_atomic_fetch_add_32(stripe, 1)) {
+                (void) opal_atomic_fetch_add_32(stripe, -1);
+                while (OSC_SM_ACC_LOCK_WRITER & *stripe) {
+                    /* spin */;
+                }
+            }
+            opal_atomic_mb();
+        }
+    }
+}
+
+/* apply op to a single element of a predefined datatype with processor atomics.
+ * origin is NULL for MPI_NO_OP and result is NULL if the old value is not needed. */
+#define OSC_SM_ATOMIC_OP(bits)                                          \
+static void ompi_osc_sm_atomic_op_ ## bits (struct ompi_op_t *op,       \
+                                            struct ompi_datatype_t *dt, \
+                                            void *target, const void *origin, \
+                                            void *result)               \
+{                                                                       \
+    opal_atomic_int ## bits ## _t *addr = (opal_atomic_int ## bits ## _t *) target; \
+    int ## bits ## _t value, old, new_value;                            \
+    bool is_int = OMPI_DATATYPE_FLAG_DATA_INT ==                        \
+        (dt->super.flags & OMPI_DATATYPE_FLAG_DATA_TYPE);               \
+                                                                        \
+    if (NULL == origin) {                                               \
+        old = *addr;                                                    \
+    } else {                                                            \
+        memcpy (&value, origin, sizeof (value));                        \
+        if (op == &ompi_mpi_op_replace.op) {                            \
+            old = opal_atomic_swap_ ## bits (addr, value);              \
+        } else if (is_int && OMPI_OP_SUM == op->op_type) {              \
+            old = opal_atomic_fetch_add_ ## bits (addr, value);         \
+        } else if (is_int && OMPI_OP_BAND == op->op_type) {             \
+            old = opal_atomic_fetch_and_ ## bits (addr, value);         \
+        } else if (is_int && OMPI_OP_BOR == op->op_type) {              \
+            old = opal_atomic_fetch_or_ ## bits (addr, value);          \
+        } else if (is_int && OMPI_OP_BXOR == op->op_type) {             \
+            old = opal_atomic_fetch_xor_ ## bits (addr, value);         \
+        } else {                                                        \
+            old = *addr;                                                \
+            do {                                                        \
+                new_value = old;                                        \
+                ompi_op_reduce (op, &value, &new_value, 1, dt);         \
+            } while (!opal_atomic_compare_exchange_strong_ ## bits (addr, &old, new_value)); \
+        }                                                               \
+    }                                                                   \
+                                                                        \
+    if (NULL != result) {                                               \
+        memcpy (result, &old, sizeof (old));                            \
+    }                                                                   \
+}
+
+OSC_SM_ATOMIC_OP(32)
+OSC_SM_ATOMIC_OP(64)
+
+#if OPAL_HAVE_ATOMIC_COMPARE_EXCHANGE_128
+static void ompi_osc_sm_atomic_op_128(struct ompi_op_t *op, struct ompi_datatype_t *dt,
+                                      void *target, const void *origin, void *result)
+{
+    opal_atomic_int128_t *addr = (opal_atomic_int128_t *) target;
+    opal_int128_t value, old = 0, new_value;
+
+    /* there is no 128-bit load or fetch-op. read the value with a compare-exchange */
+    (void) opal_atomic_compare_exchange_strong_128(addr, &old, old);
+
+    if (NULL != origin) {
+        memcpy (&value, origin, sizeof (value));
+        do {
+            new_value = value;
+            if (op != &ompi_mpi_op_replace.op) {
+                new_value = old;
+                ompi_op_reduce (op, &value, &new_value, 1, dt);
+            }
+        } while (!opal_atomic_compare_exchange_strong_128(addr, &old, new_value));
+    }
+
+    if (NULL != result) {
+        memcpy (result, &old, sizeof (old));
+    }
+}
+#endif
+
+/* check if an operation on count elements of dt at target can be done with
+ * processor atomics */
+static bool ompi_osc_sm_acc_use_atomics(ompi_osc_sm_module_t *module, struct ompi_op_t *op,
+                                        struct ompi_datatype_t *dt, size_t count, void *target)
+{
+    size_t size = dt->super.size;
+
+    if (!ompi_datatype_is_predefined(dt) || (size_t) (dt->super.ub - dt->super.lb) != size) {
+        return false;
+    }
+
+    if (!(op == &ompi_mpi_op_replace.op || op == &ompi_mpi_op_no_op.op || ompi_op_is_intrinsic(op))) {
+        return false;
+    }
+
+    /* with acc_single_intrinsic every accumulate to a location is done with
+     * atomics so the count does not matter */
+    if (!module->acc_single_intrinsic && count > mca_osc_sm_component.acc_atomics_max_count) {
+        return false;
+    }
+
+    switch (size) {
+    case 4:
+    case 8:
+#if OPAL_HAVE_ATOMIC_COMPARE_EXCHANGE_128
+    case 16:
+#endif
+        return 0 == ((uintptr_t) target & (size - 1));
+    default:
+        return false;
+    }
+}
+
+static void ompi_osc_sm_atomic_op(struct ompi_op_t *op, struct ompi_datatype_t *dt, size_t count,
+                                  void *target, const void *origin, void *result)
+{
+    size_t size = dt->super.size;
+
+    if (op == &ompi_mpi_op_no_op.op) {
+        origin = NULL;
+    }
+
+    for (size_t i = 0 ; i < count ; ++i) {
+        void *elem_result = result ? (char *) result + i * size : NULL;
+        const void *elem_origin = origin ? (const char *) origin + i * size : NULL;
+        void *elem_target = (char *) target + i * size;
+
+        switch (size) {
+        case 4:
+            ompi_osc_sm_atomic_op_32 (op, dt, elem_target, elem_origin, elem_result);
+            break;
+        case 8:
+            ompi_osc_sm_atomic_op_64 (op, dt, elem_target, elem_origin, elem_result);
+            break;
+#if OPAL_HAVE_ATOMIC_COMPARE_EXCHANGE_128
+        case 16:
+            ompi_osc_sm_atomic_op_128 (op, dt, elem_target, elem_origin, elem_result);
+            break;
+#endif
+        }
+    }
+}
+
+/* accumulate and get_accumulate (result_addr != NULL) */
+static int
+ompi_osc_sm_accumulate_common(ompi_osc_sm_module_t *module,
+                              const void *origin_addr,
+                              int origin_count,
+                              struct ompi_datatype_t *origin_dt,
+                              void *result_addr,
+                              int result_count,
+                              struct ompi_datatype_t *result_dt,
+                              int target,
+                              ptrdiff_t target_disp,
+                              int target_count,
+                              struct ompi_datatype_t *target_dt,
+                              struct ompi_op_t *op)
+{
+    ompi_osc_sm_node_state_t *node_state = module->node_states + target;
+    size_t offset = module->disp_units[target] * target_disp;
+    void *remote_address = ((char*) (module->bases[target])) + offset;
+    ptrdiff_t gap, span;
+    bool atomic;
+    int ret = OMPI_SUCCESS;
+
+    /* the origin buffer is ignored with MPI_NO_OP */
+    atomic = (op == &ompi_mpi_op_no_op.op || (target_count == origin_count && target_dt == origin_dt)) &&
+        (NULL == result_addr || (target_count == result_count && target_dt == result_dt)) &&
+        ompi_osc_sm_acc_use_atomics (module, op, target_dt, target_count, remote_address);
+
+    if (atomic && module->acc_single_intrinsic) {
+        ompi_osc_sm_atomic_op (op, target_dt, target_count, remote_address, origin_addr, result_addr);
+        return OMPI_SUCCESS;
+    }
+
+    span = opal_datatype_span (&target_dt->super, target_count, &gap);
+    offset += gap;
+
+    ompi_osc_sm_acc_lock_range (node_state, offset, span, !atomic, true);
+
+    if (atomic) {
+        ompi_osc_sm_atomic_op (op, target_dt, target_count, remote_address, origin_addr, result_addr);
+        goto done;
+    }
+
+    if (NULL != result_addr) {
+        ret = ompi_datatype_sndrcv(remote_address, target_count, target_dt,
+                                   result_addr, result_count, result_dt);
+        if (OMPI_SUCCESS != ret || op == &ompi_mpi_op_no_op.op) goto done;
+    }
+
+    if (op == &ompi_mpi_op_replace.op) {
+        ret = ompi_datatype_sndrcv((void *)origin_addr, origin_count, origin_dt,
+                                   remote_address, target_count, target_dt);
+    } else {
+        ret = ompi_osc_base_sndrcv_op(origin_addr, origin_count, origin_dt,
+                                      remote_address, target_count, target_dt,
+                                      op);
+    }
+
+ done:
+    ompi_osc_sm_acc_lock_range (node_state, offset, span, !atomic, false);
+
+    return ret;
+}
+
+
 int
 ompi_osc_sm_raccumulate(const void *origin_addr,
                         int origin_count,
@@ -115,7 +362,6 @@ ompi_osc_sm_raccumulate(const void *origin_addr,
     int ret;
     ompi_osc_sm_module_t *module =
         (ompi_osc_sm_module_t*) win->w_osc_module;
-    void *remote_address;
 
     OPAL_OUTPUT_VERBOSE((50, ompi_osc_base_framework.framework_output,
                          "raccumulate: 0x%lx, %d, %s, %d, %d, %d, %s, %s, 0x%lx",
@@ -125,18 +371,9 @@ ompi_osc_sm_raccumulate(const void *origin_addr,
                          op->o_name,
                          (unsigned long) win));
 
-    remote_address = ((char*) (module->bases[target])) + module->disp_units[target] * target_disp;
-
-    opal_atomic_lock(&module->node_states[target].accumulate_lock);
-    if (op == &ompi_mpi_op_replace.op) {
-        ret = ompi_datatype_sndrcv((void *)origin_addr, origin_count, origin_dt,
-                                    remote_address, target_count, target_dt);
-    } else {
-        ret = ompi_osc_base_sndrcv_op(origin_addr, origin_count, origin_dt,
-                                      remote_address, target_count, target_dt,
-                                      op);
-    }
-    opal_atomic_unlock(&module->node_states[target].accumulate_lock);
+    ret = ompi_osc_sm_accumulate_common(module, origin_addr, origin_count, origin_dt,
+                                        NULL, 0, NULL, target, target_disp,
+                                        target_count, target_dt, op);
 
     /* the only valid field of RMA request status is the MPI_ERROR field.
      * ompi_request_empty has status MPI_SUCCESS and indicates the request is
@@ -166,7 +403,6 @@ ompi_osc_sm_rget_accumulate(const void *origin_addr,
     int ret;
     ompi_osc_sm_module_t *module =
         (ompi_osc_sm_module_t*) win->w_osc_module;
-    void *remote_address;
 
     OPAL_OUTPUT_VERBOSE((50, ompi_osc_base_framework.framework_output,
                          "rget_accumulate: 0x%lx, %d, %s, %d, %d, %d, %s, %s, 0x%lx",
@@ -176,25 +412,9 @@ ompi_osc_sm_rget_accumulate(const void *origin_addr,
                          op->o_name,
                          (unsigned long) win));
 
-    remote_address = ((char*) (module->bases[target])) + module->disp_units[target] * target_disp;
-
-    opal_atomic_lock(&module->node_states[target].accumulate_lock);
-
-    ret = ompi_datatype_sndrcv(remote_address, target_count, target_dt,
-                               result_addr, result_count, result_dt);
-    if (OMPI_SUCCESS != ret || op == &ompi_mpi_op_no_op.op) goto done;
-
-    if (op == &ompi_mpi_op_replace.op) {
-        ret = ompi_datatype_sndrcv((void *)origin_addr, origin_count, origin_dt,
-                                   remote_address, target_count, target_dt);
-    } else {
-        ret = ompi_osc_base_sndrcv_op(origin_addr, origin_count, origin_dt,
-                                      remote_address, target_count, target_dt,
-                                      op);
-    }
-
- done:
-    opal_atomic_unlock(&module->node_states[target].accumulate_lock);
+    ret = ompi_osc_sm_accumulate_common(module, origin_addr, origin_count, origin_dt,
+                                        result_addr, result_count, result_dt, target,
+                                        target_disp, target_count, target_dt, op);
 
     /* the only valid field of RMA request status is the MPI_ERROR field.
      * ompi_request_empty has status MPI_SUCCESS and indicates the request is
@@ -281,7 +501,6 @@ ompi_osc_sm_accumulate(const void *origin_addr,
     int ret;
     ompi_osc_sm_module_t *module =
         (ompi_osc_sm_module_t*) win->w_osc_module;
-    void *remote_address;
 
     OPAL_OUTPUT_VERBOSE((50, ompi_osc_base_framework.framework_output,
                          "accumulate: 0x%lx, %d, %s, %d, %d, %d, %s, %s, 0x%lx",
@@ -291,18 +510,9 @@ ompi_osc_sm_accumulate(const void *origin_addr,
                          op->o_name,
                          (unsigned long) win));
 
-    remote_address = ((char*) (module->bases[target])) + module->disp_units[target] * target_disp;
-
-    opal_atomic_lock(&module->node_states[target].accumulate_lock);
-    if (op == &ompi_mpi_op_replace.op) {
-        ret = ompi_datatype_sndrcv((void *)origin_addr, origin_count, origin_dt,
-                                    remote_address, target_count, target_dt);
-    } else {
-        ret = ompi_osc_base_sndrcv_op(origin_addr, origin_count, origin_dt,
-                                      remote_address, target_count, target_dt,
-                                      op);
-    }
-    opal_atomic_unlock(&module->node_states[target].accumulate_lock);
+    ret = ompi_osc_sm_accumulate_common(module, origin_addr, origin_count, origin_dt,
+                                        NULL, 0, NULL, target, target_disp,
+                                        target_count, target_dt, op);
 
     return ret;
 }
@@ -325,7 +535,6 @@ ompi_osc_sm_get_accumulate(const void *origin_addr,
     int ret;
     ompi_osc_sm_module_t *module =
         (ompi_osc_sm_module_t*) win->w_osc_module;
-    void *remote_address;
 
     OPAL_OUTPUT_VERBOSE((50, ompi_osc_base_framework.framework_output,
                          "get_accumulate: 0x%lx, %d, %s, %d, %d, %d, %s, %s, 0x%lx",
@@ -335,25 +544,9 @@ ompi_osc_sm_get_accumulate(const void *origin_addr,
                          op->o_name,
                          (unsigned long) win));
 
-    remote_address = ((char*) (module->bases[target])) + module->disp_units[target] * target_disp;
-
-    opal_atomic_lock(&module->node_states[target].accumulate_lock);
-
-    ret = ompi_datatype_sndrcv(remote_address, target_count, target_dt,
-                               result_addr, result_count, result_dt);
-    if (OMPI_SUCCESS != ret || op == &ompi_mpi_op_no_op.op) goto done;
-
-    if (op == &ompi_mpi_op_replace.op) {
-        ret = ompi_datatype_sndrcv((void *)origin_addr, origin_count, origin_dt,
-                                   remote_address, target_count, target_dt);
-    } else {
-        ret = ompi_osc_base_sndrcv_op(origin_addr, origin_count, origin_dt,
-                                      remote_address, target_count, target_dt,
-                                      op);
-    }
-
- done:
-    opal_atomic_unlock(&module->node_states[target].accumulate_lock);
+    ret = ompi_osc_sm_accumulate_common(module, origin_addr, origin_count, origin_dt,
+                                        result_addr, result_count, result_dt, target,
+                                        target_disp, target_count, target_dt, op);
 
     return ret;
 }
@@ -370,8 +563,11 @@ ompi_osc_sm_compare_and_swap(const void *origin_addr,
 {
     ompi_osc_sm_module_t *module =
         (ompi_osc_sm_module_t*) win->w_osc_module;
+    ompi_osc_sm_node_state_t *node_state = module->node_states + target;
+    size_t offset = module->disp_units[target] * target_disp;
     void *remote_address;
     size_t size;
+    bool atomic;
 
     OPAL_OUTPUT_VERBOSE((50, ompi_osc_base_framework.framework_output,
                          "compare_and_swap: 0x%lx, %s, %d, %d, 0x%lx",
@@ -379,21 +575,59 @@ ompi_osc_sm_compare_and_swap(const void *origin_addr,
                          dt->name, target, (int) target_disp,
                          (unsigned long) win));
 
-    remote_address = ((char*) (module->bases[target])) + module->disp_units[target] * target_disp;
+    remote_address = ((char*) (module->bases[target])) + offset;
 
     ompi_datatype_type_size(dt, &size);
 
-    opal_atomic_lock(&module->node_states[target].accumulate_lock);
+    /* any op is fine here: only the datatype and the alignment are checked */
+    atomic = ompi_osc_sm_acc_use_atomics (module, &ompi_mpi_op_replace.op, dt, 1, remote_address);
 
-    /* fetch */
-    ompi_datatype_copy_content_same_ddt(dt, 1, (char*) result_addr, (char*) remote_address);
-    /* compare */
-    if (0 == memcmp(result_addr, compare_addr, size)) {
-        /* set */
-        ompi_datatype_copy_content_same_ddt(dt, 1, (char*) remote_address, (char*) origin_addr);
+    if (!(atomic && module->acc_single_intrinsic)) {
+        ompi_osc_sm_acc_lock_range (node_state, offset, size, !atomic, true);
     }
 
-    opal_atomic_unlock(&module->node_states[target].accumulate_lock);
+    if (atomic) {
+        switch (size) {
+        case 4: {
+            int32_t old, value;
+            memcpy (&old, compare_addr, sizeof (old));
+            memcpy (&value, origin_addr, sizeof (value));
+            (void) opal_atomic_compare_exchange_strong_32 ((opal_atomic_int32_t *) remote_address, &old, value);
+            memcpy (result_addr, &old, sizeof (old));
+            break;
+        }
+        case 8: {
+            int64_t old, value;
+            memcpy (&old, compare_addr, sizeof (old));
+            memcpy (&value, origin_addr, sizeof (value));
+            (void) opal_atomic_compare_exchange_strong_64 ((opal_atomic_int64_t *) remote_address, &old, value);
+            memcpy (result_addr, &old, sizeof (old));
+            break;
+        }
+#if OPAL_HAVE_ATOMIC_COMPARE_EXCHANGE_128
+        case 16: {
+            opal_int128_t old, value;
+            memcpy (&old, compare_addr, sizeof (old));
+            memcpy (&value, origin_addr, sizeof (value));
+            (void) opal_atomic_compare_exchange_strong_128 ((opal_atomic_int128_t *) remote_address, &old, value);
+            memcpy (result_addr, &old, sizeof (old));
+            break;
+        }
+#endif
+        }
+    } else {
+        /* fetch */
+        ompi_datatype_copy_content_same_ddt(dt, 1, (char*) result_addr, (char*) remote_address);
+        /* compare */
+        if (0 == memcmp(result_addr, compare_addr, size)) {
+            /* set */
+            ompi_datatype_copy_content_same_ddt(dt, 1, (char*) remote_address, (char*) origin_addr);
+        }
+    }
+
+    if (!(atomic && module->acc_single_intrinsic)) {
+        ompi_osc_sm_acc_lock_range (node_state, offset, size, !atomic, false);
+    }
 
     return OMPI_SUCCESS;
 }
@@ -410,7 +644,6 @@ ompi_osc_sm_fetch_and_op(const void *origin_addr,
 {
     ompi_osc_sm_module_t *module =
         (ompi_osc_sm_module_t*) win->w_osc_module;
-    void *remote_address;
 
     OPAL_OUTPUT_VERBOSE((50, ompi_osc_base_framework.framework_output,
                          "fetch_and_op: 0x%lx, %s, %d, %d, %s, 0x%lx",
@@ -419,23 +652,6 @@ ompi_osc_sm_fetch_and_op(const void *origin_addr,
                          op->o_name,
                          (unsigned long) win));
 
-    remote_address = ((char*) (module->bases[target])) + module->disp_units[target] * target_disp;
-
-    opal_atomic_lock(&module->node_states[target].accumulate_lock);
-
-    /* fetch */
-    ompi_datatype_copy_content_same_ddt(dt, 1, (char*) result_addr, (char*) remote_address);
-    if (op == &ompi_mpi_op_no_op.op) goto done;
-
-    /* op */
-    if (op == &ompi_mpi_op_replace.op) {
-        ompi_datatype_copy_content_same_ddt(dt, 1, (char*) remote_address, (char*) origin_addr);
-    } else {
-        ompi_op_reduce(op, (void *)origin_addr, remote_address, 1, dt);
-    }
-
- done:
-    opal_atomic_unlock(&module->node_states[target].accumulate_lock);
-
-    return OMPI_SUCCESS;;
+    return ompi_osc_sm_accumulate_common(module, origin_addr, 1, dt, result_addr, 1, dt,
+                                         target, target_disp, 1, dt, op);
 }
@@ -136,6 +136,26 @@ static int component_register (void)
                                           &mca_osc_sm_component.priority);
     free(description_str);
 
+    mca_osc_sm_component.acc_single_intrinsic = false;
+    opal_asprintf(&description_str, "Enable optimizations for MPI_Fetch_and_op, MPI_Accumulate, etc for codes "
+                  "that will not use anything more than a single predefined datatype. Info key of same name "
+                  "overrides this value (default: %s)",
+                  mca_osc_sm_component.acc_single_intrinsic ? "true" : "false");
+    (void) mca_base_component_var_register(&mca_osc_sm_component.super.osc_version, "acc_single_intrinsic",
+                                           description_str, MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0, OPAL_INFO_LVL_5,
+                                           MCA_BASE_VAR_SCOPE_GROUP, &mca_osc_sm_component.acc_single_intrinsic);
+    free(description_str);
+
+    mca_osc_sm_component.acc_atomics_max_count = 16;
+    opal_asprintf(&description_str, "Largest accumulate on a predefined datatype, in elements, that is "
+                  "applied with processor atomics instead of locking the target range. Must be the same "
+                  "on all processes (default: %u)", mca_osc_sm_component.acc_atomics_max_count);
+    (void) mca_base_component_var_register(&mca_osc_sm_component.super.osc_version, "acc_atomics_max_count",
+                                           description_str, MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_GROUP,
+                                           &mca_osc_sm_component.acc_atomics_max_count);
+    free(description_str);
+
     return OPAL_SUCCESS;
 }
 
@@ -215,8 +235,17 @@ component_select(struct ompi_win_t *win, void **base, size_t size, int disp_unit
 
     OBJ_CONSTRUCT(&module->lock, opal_mutex_t);
 
+    module->acc_single_intrinsic = mca_osc_sm_component.acc_single_intrinsic;
     if (NULL != info) {
+        bool acc_single_intrinsic;
+        int flag;
+
         ompi_osc_base_set_memory_alignment(info, &memory_alignment);
+
+        if (OMPI_SUCCESS == opal_info_get_bool(info, "acc_single_intrinsic",
+                                               &acc_single_intrinsic, &flag) && flag) {
+            module->acc_single_intrinsic = acc_single_intrinsic;
+        }
     }
 
     /* fill in the function pointer part */
@@ -386,7 +415,7 @@ component_select(struct ompi_win_t *win, void **base, size_t size, int disp_unit
 
     *base = module->bases[ompi_comm_rank(module->comm)];
 
-    opal_atomic_lock_init(&module->my_node_state->accumulate_lock, OPAL_ATOMIC_LOCK_UNLOCKED);
+    /* the accumulate locks are unlocked when zeroed */
 
     /* share everyone's displacement units. */
     module->disp_units = malloc(sizeof(int) * comm_size);
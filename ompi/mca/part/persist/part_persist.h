@@ -28,6 +28,7 @@
 #include <alloca.h>
 #endif
 
+#include <limits.h>
 #include<math.h>
 
 #include "ompi_config.h"
@@ -45,8 +46,13 @@
 #include "ompi/mca/part/persist/part_persist_sendreq.h"
 #include "ompi/message/message.h"
 #include "ompi/mca/pml/pml.h"
+#include "ompi/runtime/ompi_async_progress.h"
 BEGIN_C_DECLS
 
+/* largest internal message built by aggregating user partitions, kept within the int range
+ * that transfers of a single message are limited to on several transports */
+#define MCA_PART_PERSIST_MAX_TRANSPORT_BYTES ((size_t) INT_MAX)
+
 typedef struct mca_part_persist_list_t {
     opal_list_item_t        super;
     mca_part_persist_request_t *item;
@@ -60,6 +66,7 @@ struct ompi_part_persist_t {
     int                    free_list_num;
     int                    free_list_max;
     int                    free_list_inc;
+    int                    max_transport_parts; /**< maximum number of internal partitions of a send (0: no limit) */
     opal_list_t           *progress_list;
 
     int32_t next_send_tag;                /**< This is a counter for send tags for the actual data transfer. */
@@ -101,6 +108,7 @@ mca_part_persist_free_req(struct mca_part_persist_request_t* req)
     }
     free(req->persist_reqs);
     free(req->flags);
+    free((void *) req->ready_counts);
 
     if( MCA_PART_PERSIST_REQUEST_PRECV == req->req_type ) {
         MCA_PART_PERSIST_PRECV_REQUEST_RETURN(req);
@@ -110,6 +118,35 @@ mca_part_persist_free_req(struct mca_part_persist_request_t* req)
     return err;
 }
 
+/**
+ * Number of elements carried by internal partition i. All the internal partitions carry
+ * real_count elements except the last one which carries the remainder.
+ */
+__opal_attribute_always_inline__ static inline size_t
+mca_part_persist_real_count(struct mca_part_persist_request_t* req, size_t i)
+{
+    if(i + 1 < req->real_parts) {
+        return req->real_count;
+    }
+    return req->req_parts * req->req_count - req->real_count * (req->real_parts - 1);
+}
+
+/**
+ * Mark all the partitions of a send request as not ready. This is done before the
+ * request is started.
+ */
+__opal_attribute_always_inline__ static inline void
+mca_part_persist_reset_ready(struct mca_part_persist_request_t* req)
+{
+    size_t i, left;
+
+    for(i = 0; i < req->real_parts; i++) {
+        left = req->req_parts - i * req->parts_per_real;
+        req->ready_counts[i] = (int32_t) (left < req->parts_per_real ? left : req->parts_per_real);
+        req->flags[i] = -1;
+    }
+    opal_atomic_wmb();
+}
 
 __opal_attribute_always_inline__ static inline void mca_part_persist_init_lists(void)
 {
@@ -233,23 +270,20 @@ mca_part_persist_progress(void)
             ompi_request_test(&(req->setup_req[1]), &done, MPI_STATUS_IGNORE);
 
             if(done) {
-                size_t dt_size_;
-                int32_t dt_size;
+                ptrdiff_t extent;
 
                 if(MCA_PART_PERSIST_REQUEST_PSEND == req->req_type) {
                     /* parse message */
                     req->world_peer  = req->setup_info[1].world_rank; 
 
-                    err = opal_datatype_type_size(&(req->req_datatype->super), &dt_size_);
-                    if(OMPI_SUCCESS != err) return OMPI_ERROR;
-                    dt_size = (dt_size_ > (size_t) INT_MAX) ? MPI_UNDEFINED : (int) dt_size_;
-                    int32_t bytes = req->real_count * dt_size;
+                    /* internal partition i starts real_count * i elements into the user buffer */
+                    ompi_datatype_type_extent(req->req_datatype, &extent);
 
                     /* Set up persistent sends */
                     req->persist_reqs = (ompi_request_t**) malloc(sizeof(ompi_request_t*)*(req->real_parts));
                     for(i = 0; i < req->real_parts; i++) {
-                         void *buf = ((void*) (((char*)req->req_addr) + (bytes * i)));
-                         err = MCA_PML_CALL(isend_init(buf, req->real_count, req->req_datatype, req->world_peer, req->my_send_tag+i, MCA_PML_BASE_SEND_STANDARD, ompi_part_persist.part_comm, &(req->persist_reqs[i])));
+                         void *buf = ((void*) (((char*)req->req_addr) + (ptrdiff_t) (req->real_count * i) * extent));
+                         err = MCA_PML_CALL(isend_init(buf, mca_part_persist_real_count(req, i), req->req_datatype, req->world_peer, req->my_send_tag+i, MCA_PML_BASE_SEND_STANDARD, ompi_part_persist.part_comm, &(req->persist_reqs[i])));
                     }    
                 } else {
                     /* parse message */
@@ -259,17 +293,15 @@ mca_part_persist_progress(void)
                     req->real_parts   = req->setup_info[1].num_parts;
                     req->real_count   = req->setup_info[1].count;
 
-                    err = opal_datatype_type_size(&(req->req_datatype->super), &dt_size_);
-                    if(OMPI_SUCCESS != err) return OMPI_ERROR;
-                    dt_size = (dt_size_ > (size_t) INT_MAX) ? MPI_UNDEFINED : (int) dt_size_;
-                    int32_t bytes = req->real_count * dt_size;
+                    /* internal partition i starts real_count * i elements into the user buffer */
+                    ompi_datatype_type_extent(req->req_datatype, &extent);
 
                     /* Set up persistent sends */
                     req->persist_reqs = (ompi_request_t**) malloc(sizeof(ompi_request_t*)*(req->real_parts));
                     req->flags = (int*) calloc(req->real_parts,sizeof(int));
                     for(i = 0; i < req->real_parts; i++) {
-                         void *buf = ((void*) (((char*)req->req_addr) + (bytes * i)));
-                         err = MCA_PML_CALL(irecv_init(buf, req->real_count, req->req_datatype, req->world_peer, req->my_send_tag+i, ompi_part_persist.part_comm, &(req->persist_reqs[i])));
+                         void *buf = ((void*) (((char*)req->req_addr) + (ptrdiff_t) (req->real_count * i) * extent));
+                         err = MCA_PML_CALL(irecv_init(buf, mca_part_persist_real_count(req, i), req->req_datatype, req->world_peer, req->my_send_tag+i, ompi_part_persist.part_comm, &(req->persist_reqs[i])));
                     }
                     err = req->persist_reqs[0]->req_start(req->real_parts, (&(req->persist_reqs[0])));                     
 
@@ -279,6 +311,8 @@ mca_part_persist_progress(void)
                     if(OMPI_SUCCESS != err) return OMPI_ERROR;
                 }
 
+                /* MPI_Pready may start the sends as soon as the request is flagged initialized */
+                opal_atomic_wmb();
                 req->initialized = true; 
             }
         } else {
@@ -336,8 +370,7 @@ mca_part_persist_precv_init(void *buf,
                         struct ompi_request_t **request)
 {
     int err = OMPI_SUCCESS;
-    size_t dt_size_;
-    int dt_size;
+    size_t dt_size;
     mca_part_persist_list_t* new_progress_elem = NULL;
 
     mca_part_persist_precv_request_t *recvreq;
@@ -362,14 +395,14 @@ mca_part_persist_precv_init(void *buf,
     req->first_send  = true; 
     req->flag_post_setup_recv = false;
     req->flags = NULL;
+    req->ready_counts = NULL;
     /* Non-blocking receive on setup info */
     err	= MCA_PML_CALL(irecv(&req->setup_info[1], sizeof(struct ompi_mca_persist_setup_t), MPI_BYTE, src, tag, comm, &req->setup_req[1])); 
     if(OMPI_SUCCESS != err) return OMPI_ERROR;
 
     /* Compute total number of bytes */
-    err = opal_datatype_type_size(&(req->req_datatype->super), &dt_size_);
+    err = opal_datatype_type_size(&(req->req_datatype->super), &dt_size);
     if(OMPI_SUCCESS != err) return OMPI_ERROR;
-    dt_size = (dt_size_ > (size_t) INT_MAX) ? MPI_UNDEFINED : (int) dt_size_;
     req->req_bytes = parts * count * dt_size;
 
 
@@ -404,8 +437,7 @@ mca_part_persist_psend_init(const void* buf,
                         ompi_request_t** request)
 {
     int err = OMPI_SUCCESS;
-    size_t dt_size_;
-    int dt_size;
+    size_t dt_size;
     mca_part_persist_list_t* new_progress_elem = NULL;
     mca_part_persist_psend_request_t *sendreq;
 
@@ -428,26 +460,43 @@ mca_part_persist_psend_init(const void* buf,
     
 
     /* Determine total bytes to send. */
-    err = opal_datatype_type_size(&(req->req_datatype->super), &dt_size_);
+    err = opal_datatype_type_size(&(req->req_datatype->super), &dt_size);
     if(OMPI_SUCCESS != err) return OMPI_ERROR;
-    dt_size = (dt_size_ > (size_t) INT_MAX) ? MPI_UNDEFINED : (int) dt_size_;
     req->req_bytes = parts * count * dt_size;
 
 
 
+    /* Aggregate the user partitions into at most max_transport_parts internal partitions. Only the
+     * last internal partition may hold fewer user partitions. */
+    req->parts_per_real = 1;
+    if(0 < ompi_part_persist.max_transport_parts && parts > (size_t) ompi_part_persist.max_transport_parts) {
+        req->parts_per_real = (parts + ompi_part_persist.max_transport_parts - 1) / ompi_part_persist.max_transport_parts;
+    }
+    /* Do not aggregate past the size of a single transfer. A user partition that is larger on
+     * its own is still sent as one message. */
+    if(req->parts_per_real > 1 && count * dt_size > 0 &&
+       req->parts_per_real > MCA_PART_PERSIST_MAX_TRANSPORT_BYTES / (count * dt_size)) {
+        req->parts_per_real = MCA_PART_PERSIST_MAX_TRANSPORT_BYTES / (count * dt_size);
+        if(0 == req->parts_per_real) {
+            req->parts_per_real = 1;
+        }
+    }
+    req->real_parts = (parts + req->parts_per_real - 1) / req->parts_per_real;
+    req->real_count = count * req->parts_per_real;
+
     /* non-blocking send set-up data */
     req->setup_info[0].world_rank = ompi_comm_rank(&ompi_mpi_comm_world.comm);
-    req->setup_info[0].start_tag = ompi_part_persist.next_send_tag; ompi_part_persist.next_send_tag += parts; 
+    req->setup_info[0].start_tag = ompi_part_persist.next_send_tag; ompi_part_persist.next_send_tag += req->real_parts; 
     req->my_send_tag = req->setup_info[0].start_tag;
     req->setup_info[0].setup_tag = ompi_part_persist.next_recv_tag; ompi_part_persist.next_recv_tag++;
     req->my_recv_tag = req->setup_info[0].setup_tag;
-    req->setup_info[0].num_parts = parts;
-    req->real_parts = parts;
-    req->setup_info[0].count = count;
-    req->real_count = count;
+    req->setup_info[0].num_parts = req->real_parts;
+    req->setup_info[0].count = req->real_count;
 
 
     req->flags = (int*) calloc(req->real_parts, sizeof(int));
+    req->ready_counts = (opal_atomic_int32_t*) calloc(req->real_parts, sizeof(opal_atomic_int32_t));
+    if(NULL == req->flags || NULL == req->ready_counts) return OMPI_ERR_OUT_OF_RESOURCE;
 
     err = MCA_PML_CALL(isend(&(req->setup_info[0]), sizeof(struct ompi_mca_persist_setup_t), MPI_BYTE, dst, tag, MCA_PML_BASE_SEND_STANDARD, comm, &req->setup_req[0]));
     if(OMPI_SUCCESS != err) return OMPI_ERROR;
@@ -494,7 +543,7 @@ mca_part_persist_start(size_t count, ompi_request_t** requests)
         {
             if(MCA_PART_PERSIST_REQUEST_PSEND == req->req_type) {
                 req->done_count = 0;
-                memset((void*)req->flags,0,sizeof(int32_t)*req->real_parts);
+                mca_part_persist_reset_ready(req);
             } else {
                 req->done_count = 0;
                 err = req->persist_reqs[0]->req_start(req->real_parts, req->persist_reqs);
@@ -503,9 +552,7 @@ mca_part_persist_start(size_t count, ompi_request_t** requests)
         } else {
             if(MCA_PART_PERSIST_REQUEST_PSEND == req->req_type) {
                 req->done_count = 0;
-                for(i = 0; i < req->real_parts && OMPI_SUCCESS == err; i++) {
-                    req->flags[i] = -1;
-                }
+                mca_part_persist_reset_ready(req);
             } else {
                 req->done_count = 0;
             } 
@@ -519,6 +566,9 @@ mca_part_persist_start(size_t count, ompi_request_t** requests)
         OPAL_ATOMIC_SWAP_PTR(&req->req_ompi.req_complete, REQUEST_PENDING);   
     }
 
+    /* the partitions are matched and transferred by the progress function */
+    ompi_async_progress_wakeup();
+
     return err;
 }
 
@@ -528,19 +578,31 @@ mca_part_persist_pready(size_t min_part,
                     ompi_request_t* request)
 {
     int err = OMPI_SUCCESS;
-    size_t i;
+    size_t i, lo, hi;
 
     mca_part_persist_request_t *req = (mca_part_persist_request_t *)(request);
-    if(true == req->initialized)
-    {
-        err = req->persist_reqs[min_part]->req_start(max_part-min_part+1, (&(req->persist_reqs[min_part])));
-        for(i = min_part; i <= max_part && OMPI_SUCCESS == err; i++) {
+
+    /* Each internal partition counts its user partitions that are not ready yet. The thread
+     * that marks the last one ready sends the internal partition, so concurrent callers only
+     * contend on the counters they share. */
+    for(i = min_part / req->parts_per_real; i <= max_part / req->parts_per_real && OMPI_SUCCESS == err; i++) {
+        lo = i * req->parts_per_real;
+        hi = lo + req->parts_per_real - 1;
+        lo = (lo < min_part) ? min_part : lo;
+        hi = (hi > max_part) ? max_part : hi;
+
+        if(0 != opal_atomic_sub_fetch_32(&req->ready_counts[i], (int32_t) (hi - lo + 1))) {
+            continue;
+        }
+
+        opal_atomic_rmb();
+        if(true == req->initialized)
+        {
+            err = req->persist_reqs[i]->req_start(1, (&(req->persist_reqs[i])));
             req->flags[i] = 0; /* Mark partition as ready for testing */
         }
-    }
-    else
-    {
-        for(i = min_part; i <= max_part && OMPI_SUCCESS == err; i++) {
+        else
+        {
             req->flags[i] = -2; /* Mark partition as queued */
         }
     }
@@ -565,9 +627,10 @@ mca_part_persist_parrived(size_t min_part,
                 _flag = _flag && req->flags[i];            
             }
         } else {
-            float convert = ((float)req->real_parts) / ((float)req->req_parts);
-            size_t _min = floor(convert * min_part);
-            size_t _max = ceil(convert * max_part);
+            /* internal partitions holding the elements of the user partitions */
+            size_t _min = (min_part * req->req_count) / req->real_count;
+            size_t _max = ((max_part + 1) * req->req_count - 1) / req->real_count;
+            if(_max >= req->real_parts) _max = req->real_parts - 1;
             for(i = _min; i <= _max; i++) {
                 _flag = _flag && req->flags[i];
             }
@@ -84,6 +84,16 @@ mca_part_persist_component_register(void)
                                            MCA_BASE_VAR_SCOPE_READONLY,
                                            &ompi_part_persist.free_list_inc);
 
+    ompi_part_persist.max_transport_parts = 64;
+    (void) mca_base_component_var_register(&mca_part_persist_component.partm_version, "max_transport_parts",
+                                           "Maximum number of messages used to transfer the partitions of a "
+                                           "partitioned send. Adjacent partitions are aggregated in one message "
+                                           "which is sent when all of them are ready (0: one message per partition)",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_5,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &ompi_part_persist.max_transport_parts);
+
 
     return OPAL_SUCCESS;
 }
@@ -72,6 +72,8 @@ struct mca_part_persist_request_t {
     size_t real_parts;                   /**< internal number of partitions */
     size_t real_count;
     size_t part_size; 
+    size_t parts_per_real;               /**< user partitions aggregated in each internal partition (send side) */
+    opal_atomic_int32_t *ready_counts;   /**< user partitions not yet ready in each internal partition (send side) */
 
     ompi_request_t** persist_reqs;            /**< requests for persistent sends/recvs */
     ompi_request_t* setup_req [2];                /**< Request structure for setup messages */
@@ -24,8 +24,8 @@ AC_DEFUN([MCA_ompi_pml_ob1_POST_CONFIG], [
 AC_DEFUN([MCA_ompi_pml_ob1_CONFIG],[
     OPAL_VAR_SCOPE_PUSH([pml_ob1_matching_engine])
     AC_ARG_WITH([pml-ob1-matching], [AS_HELP_STRING([--with-pml-ob1-matching=type],
-                                                    [Configure pml/ob1 to use an alternate matching engine. Only valid on x86_64 systems.
-                                                     Valid values are: none, default, arrays, fuzzy-byte, fuzzy-short, fuzzy-word, vector (default: none)])])
+                                                    [Select the default matching engine of pml/ob1. The engine can be changed at runtime with the pml_ob1_matching_engine MCA parameter.
+                                                     Valid values are: none, default, hash, arrays, fuzzy-byte, fuzzy-short, fuzzy-word, vector (default: none)])])
 
     pml_ob1_matching_engine=MCA_PML_OB1_CUSTOM_MATCHING_NONE
 
@@ -52,13 +52,16 @@ AC_DEFUN([MCA_ompi_pml_ob1_CONFIG],[
             vector)
                 pml_ob1_matching_engine=MCA_PML_OB1_CUSTOM_MATCHING_VECTOR
                 ;;
+            hash)
+                pml_ob1_matching_engine=MCA_PML_OB1_CUSTOM_MATCHING_HASH
+                ;;
             *)
                 AC_MSG_ERROR([invalid matching type specified for --pml-ob1-matching: $with_pml_ob1_matching])
                 ;;
         esac
     fi
 
-    AC_DEFINE_UNQUOTED([MCA_PML_OB1_CUSTOM_MATCHING], [$pml_ob1_matching_engine], [Custom matching engine to use in pml/ob1])
+    AC_DEFINE_UNQUOTED([MCA_PML_OB1_CUSTOM_MATCHING], [$pml_ob1_matching_engine], [Default matching engine of pml/ob1])
 
     AC_CONFIG_FILES([ompi/mca/pml/ob1/Makefile])
     [$1]
@@ -0,0 +1,21 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#if defined(__x86_64__)
+
+#include "pml_ob1_custom_match.h"
+#include "pml_ob1_custom_match_arrays.h"
+
+#define MCA_PML_OB1_CUSTOM_MATCH_ENGINE mca_pml_ob1_match_arrays
+#define MCA_PML_OB1_CUSTOM_MATCH_ENGINE_NAME "arrays"
+#include "pml_ob1_custom_match_engine.h"
+
+#endif
@@ -0,0 +1,121 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Expose the custom match queues included before this file as a runtime
+ * matching engine. All custom match implementations use the same names, so
+ * each of them is wrapped in its own compilation unit which defines:
+ *
+ *   MCA_PML_OB1_CUSTOM_MATCH_ENGINE       name of the engine structure
+ *   MCA_PML_OB1_CUSTOM_MATCH_ENGINE_NAME  name used for the selection
+ */
+
+#ifndef PML_OB1_CUSTOM_MATCH_ENGINE_H
+#define PML_OB1_CUSTOM_MATCH_ENGINE_H
+
+#include "ompi/mca/pml/ob1/pml_ob1_match.h"
+
+static void *custom_match_engine_prq_init (void)
+{
+    return (void *) custom_match_prq_init ();
+}
+
+static void custom_match_engine_prq_destroy (void *prq)
+{
+    custom_match_prq_destroy ((custom_match_prq *) prq);
+}
+
+static void custom_match_engine_prq_append (void *prq, mca_pml_ob1_recv_request_t *req, int tag, int peer)
+{
+    custom_match_prq_append ((custom_match_prq *) prq, req, tag, peer);
+}
+
+static int custom_match_engine_prq_cancel (void *prq, mca_pml_ob1_recv_request_t *req, int tag, int peer)
+{
+    return custom_match_prq_cancel ((custom_match_prq *) prq, req);
+}
+
+static mca_pml_ob1_recv_request_t *custom_match_engine_prq_find_dequeue (void *prq, int tag, int peer)
+{
+    return (mca_pml_ob1_recv_request_t *) custom_match_prq_find_dequeue_verify ((custom_match_prq *) prq, tag, peer);
+}
+
+static size_t custom_match_engine_prq_size (void *prq)
+{
+    return (size_t) custom_match_prq_size ((custom_match_prq *) prq);
+}
+
+static void custom_match_engine_prq_dump (void *prq)
+{
+    custom_match_prq_dump ((custom_match_prq *) prq);
+}
+
+static void *custom_match_engine_umq_init (void)
+{
+    return (void *) custom_match_umq_init ();
+}
+
+static void custom_match_engine_umq_destroy (void *umq)
+{
+    custom_match_umq_destroy ((custom_match_umq *) umq);
+}
+
+static void custom_match_engine_umq_append (void *umq, mca_pml_ob1_recv_frag_t *frag, int tag, int peer)
+{
+    custom_match_umq_append ((custom_match_umq *) umq, tag, peer, frag);
+}
+
+static mca_pml_ob1_recv_frag_t *custom_match_engine_umq_find (void *umq, int tag, int peer,
+                                                               mca_pml_ob1_match_hold_t *hold)
+{
+    custom_match_umq_node *prev = NULL, *elem = NULL;
+    void *frag;
+
+    frag = custom_match_umq_find_verify_hold ((custom_match_umq *) umq, tag, peer, &prev, &elem, &hold->index);
+    hold->prev = prev;
+    hold->elem = elem;
+
+    return (mca_pml_ob1_recv_frag_t *) frag;
+}
+
+static void custom_match_engine_umq_remove (void *umq, mca_pml_ob1_match_hold_t *hold)
+{
+    custom_match_umq_remove_hold ((custom_match_umq *) umq, (custom_match_umq_node *) hold->prev,
+                                  (custom_match_umq_node *) hold->elem, hold->index);
+}
+
+static size_t custom_match_engine_umq_size (void *umq)
+{
+    return (size_t) custom_match_umq_size ((custom_match_umq *) umq);
+}
+
+static void custom_match_engine_umq_dump (void *umq)
+{
+    custom_match_umq_dump ((custom_match_umq *) umq);
+}
+
+const mca_pml_ob1_match_engine_t MCA_PML_OB1_CUSTOM_MATCH_ENGINE = {
+    .name = MCA_PML_OB1_CUSTOM_MATCH_ENGINE_NAME,
+    .prq_init = custom_match_engine_prq_init,
+    .prq_destroy = custom_match_engine_prq_destroy,
+    .prq_append = custom_match_engine_prq_append,
+    .prq_cancel = custom_match_engine_prq_cancel,
+    .prq_find_dequeue = custom_match_engine_prq_find_dequeue,
+    .prq_size = custom_match_engine_prq_size,
+    .prq_dump = custom_match_engine_prq_dump,
+    .umq_init = custom_match_engine_umq_init,
+    .umq_destroy = custom_match_engine_umq_destroy,
+    .umq_append = custom_match_engine_umq_append,
+    .umq_find = custom_match_engine_umq_find,
+    .umq_remove = custom_match_engine_umq_remove,
+    .umq_size = custom_match_engine_umq_size,
+    .umq_dump = custom_match_engine_umq_dump,
+};
+
+#endif /* PML_OB1_CUSTOM_MATCH_ENGINE_H */
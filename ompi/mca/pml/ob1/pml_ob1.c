@@ -62,6 +62,8 @@
 #include "pml_ob1_recvreq.h"
 #include "pml_ob1_rdmafrag.h"
 #include "pml_ob1_accelerator.h"
+#include "pml_ob1_smsc.h"
+#include "pml_ob1_match.h"
 
 mca_pml_ob1_t mca_pml_ob1 = {
     {
@@ -198,6 +200,7 @@ int mca_pml_ob1_enable(bool enable)
                           NULL, 0, NULL, NULL, NULL);
 
     mca_pml_ob1_accelerator_init();
+    mca_pml_ob1_smsc_init();
 
     mca_pml_ob1.enabled = true;
 
@@ -241,6 +244,39 @@ mca_pml_ob1_set_allow_overtake(opal_infosubscriber_t* obj,
     return "false";
 }
 
+/**
+ * Select the matching engine of a new communicator. The ompi_comm_pml_ob1_matching
+ * info key overrides the default set with the pml_ob1_matching_engine MCA parameter.
+ */
+static const mca_pml_ob1_match_engine_t *mca_pml_ob1_comm_matching_engine (ompi_communicator_t *comm)
+{
+    const mca_pml_ob1_match_engine_t *engine = mca_pml_ob1.matching_engine;
+    opal_cstring_t *info_str;
+    int flag = 0;
+
+#if OPAL_ENABLE_FT_MPI
+    /* revoking a communicator purges the builtin queues only */
+    if (ompi_ftmpi_enabled) {
+        return NULL;
+    }
+#endif
+
+    if (NULL != comm->super.s_info) {
+        opal_info_get (comm->super.s_info, "ompi_comm_pml_ob1_matching", &info_str, &flag);
+        if (flag) {
+            if (OMPI_SUCCESS != mca_pml_ob1_match_lookup (info_str->string, &engine)) {
+                opal_output_verbose (1, mca_pml_ob1_output, "pml:ob1: unknown matching engine %s requested "
+                                     "for communicator %s. available engines: %s", info_str->string,
+                                     ompi_comm_print_cid (comm), mca_pml_ob1_match_available ());
+                engine = mca_pml_ob1.matching_engine;
+            }
+            OBJ_RELEASE(info_str);
+        }
+    }
+
+    return engine;
+}
+
 int mca_pml_ob1_add_comm(ompi_communicator_t* comm)
 {
     /* allocate pml specific comm data */
@@ -248,6 +284,7 @@ int mca_pml_ob1_add_comm(ompi_communicator_t* comm)
     mca_pml_ob1_recv_frag_t *frag, *next_frag;
     mca_pml_ob1_comm_proc_t* pml_proc;
     mca_pml_ob1_match_hdr_t* hdr;
+    int rc;
 
     if (NULL == pml_comm) {
         return OMPI_ERR_OUT_OF_RESOURCE;
@@ -262,6 +299,19 @@ int mca_pml_ob1_add_comm(ompi_communicator_t* comm)
     ompi_comm_assert_subscribe (comm, OMPI_COMM_ASSERT_NO_ANY_SOURCE);
 
     mca_pml_ob1_comm_init_size(pml_comm, comm->c_remote_group->grp_proc_count);
+
+    rc = mca_pml_ob1_comm_set_matching(pml_comm, mca_pml_ob1_comm_matching_engine(comm));
+    if (OMPI_SUCCESS != rc) {
+        OBJ_RELEASE(pml_comm);
+        return rc;
+    }
+
+    /* the matching engines and the revoke logic expect a single matching lock */
+    pml_comm->peer_matching = mca_pml_ob1.peer_matching && opal_using_threads () &&
+        NULL == pml_comm->match;
+#if OPAL_ENABLE_FT_MPI
+    pml_comm->peer_matching = pml_comm->peer_matching && !ompi_ftmpi_enabled;
+#endif
     comm->c_pml_comm = pml_comm;
 
     /* Register the subscriber alert for the mpi_assert_allow_overtaking info. */
@@ -316,11 +366,11 @@ int mca_pml_ob1_add_comm(ompi_communicator_t* comm)
         pml_proc = mca_pml_ob1_peer_lookup(comm, hdr->hdr_src);
 
         if (OMPI_COMM_CHECK_ASSERT_ALLOW_OVERTAKE(comm)) {
-#if !MCA_PML_OB1_CUSTOM_MATCH
-            opal_list_append( &pml_proc->unexpected_frags, (opal_list_item_t*)frag );
-#else
-            custom_match_umq_append(pml_comm->umq, hdr->hdr_tag, hdr->hdr_src, frag);
-#endif
+            if (NULL != pml_comm->match) {
+                pml_comm->match->umq_append(pml_comm->umq, frag, hdr->hdr_tag, hdr->hdr_src);
+            } else {
+                opal_list_append( &pml_proc->unexpected_frags, (opal_list_item_t*)frag );
+            }
             PERUSE_TRACE_MSG_EVENT(PERUSE_COMM_MSG_INSERT_IN_UNEX_Q, comm,
                                    hdr->hdr_src, hdr->hdr_tag, PERUSE_RECV);
             continue;
@@ -331,11 +381,11 @@ int mca_pml_ob1_add_comm(ompi_communicator_t* comm)
         add_fragment_to_unexpected:
             /* We're now expecting the next sequence number. */
             pml_proc->expected_sequence++;
-#if !MCA_PML_OB1_CUSTOM_MATCH
-            opal_list_append( &pml_proc->unexpected_frags, (opal_list_item_t*)frag );
-#else
-            custom_match_umq_append(pml_comm->umq, hdr->hdr_tag, hdr->hdr_src, frag);
-#endif
+            if (NULL != pml_comm->match) {
+                pml_comm->match->umq_append(pml_comm->umq, frag, hdr->hdr_tag, hdr->hdr_src);
+            } else {
+                opal_list_append( &pml_proc->unexpected_frags, (opal_list_item_t*)frag );
+            }
             PERUSE_TRACE_MSG_EVENT(PERUSE_COMM_MSG_INSERT_IN_UNEX_Q, comm,
                                    hdr->hdr_src, hdr->hdr_tag, PERUSE_RECV);
             /* And now the ugly part. As some fragments can be inserted in the cant_match list,
@@ -609,7 +659,6 @@ static void mca_pml_ob1_dump_hdr(mca_pml_ob1_hdr_t* hdr)
                 header);
 }
 
-#if !MCA_PML_OB1_CUSTOM_MATCH
 static void mca_pml_ob1_dump_frag_list(opal_list_t* queue, bool is_req)
 {
     opal_list_item_t* item;
@@ -642,7 +691,6 @@ static void mca_pml_ob1_dump_frag_list(opal_list_t* queue, bool is_req)
         }
     }
 }
-#endif
 
 void mca_pml_ob1_dump_cant_match(mca_pml_ob1_recv_frag_t* queue)
 {
@@ -672,19 +720,18 @@ int mca_pml_ob1_dump(struct ompi_communicator_t* comm, int verbose)
                 comm->c_name, (void*) comm, ompi_comm_print_cid (comm), comm->c_my_rank,
                 pml_comm->recv_sequence, pml_comm->num_procs, pml_comm->last_probed);
 
-#if !MCA_PML_OB1_CUSTOM_MATCH
     if( opal_list_get_size(&pml_comm->wild_receives) ) {
         opal_output(0, "expected MPI_ANY_SOURCE fragments\n");
         mca_pml_ob1_dump_frag_list(&pml_comm->wild_receives, true);
     }
-#endif
 
-#if MCA_PML_OB1_CUSTOM_MATCH
-     opal_output(0, "expected receives\n");
-     custom_match_prq_dump(pml_comm->prq);
-     opal_output(0, "unexpected frag\n");
-     custom_match_umq_dump(pml_comm->umq);
-#endif
+    if( NULL != pml_comm->match ) {
+        opal_output(0, "matching engine %s\n", pml_comm->match->name);
+        opal_output(0, "expected receives\n");
+        pml_comm->match->prq_dump(pml_comm->prq);
+        opal_output(0, "unexpected frag\n");
+        pml_comm->match->umq_dump(pml_comm->umq);
+    }
 
     /* iterate through all procs on communicator */
     for( i = 0; i < (int)pml_comm->num_procs; i++ ) {
@@ -702,22 +749,18 @@ int mca_pml_ob1_dump(struct ompi_communicator_t* comm, int verbose)
                     proc->send_sequence);
 
         /* dump all receive queues */
-#if !MCA_PML_OB1_CUSTOM_MATCH
        if( opal_list_get_size(&proc->specific_receives) ) {
             opal_output(0, "expected specific receives\n");
             mca_pml_ob1_dump_frag_list(&proc->specific_receives, true);
         }
-#endif
         if( NULL != proc->frags_cant_match ) {
             opal_output(0, "out of sequence\n");
             mca_pml_ob1_dump_cant_match(proc->frags_cant_match);
         }
-#if !MCA_PML_OB1_CUSTOM_MATCH
         if( opal_list_get_size(&proc->unexpected_frags) ) {
             opal_output(0, "unexpected frag\n");
             mca_pml_ob1_dump_frag_list(&proc->unexpected_frags, false);
         }
-#endif
         /* dump all btls used for eager messages */
         for( n = 0; n < ep->btl_eager.arr_size; n++ ) {
             mca_bml_base_btl_t* bml_btl = &ep->btl_eager.bml_btls[n];
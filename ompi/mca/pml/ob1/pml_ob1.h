@@ -64,6 +64,12 @@ struct mca_pml_ob1_t {
     int max_rdma_per_request;
     int max_send_per_range;
     bool use_all_rdma;
+    size_t smsc_iov_min_size;
+    unsigned int smsc_iov_max;
+    char *matching_engine_name;
+    /* default matching engine of new communicators (NULL: builtin queues) */
+    const struct mca_pml_ob1_match_engine_t *matching_engine;
+    bool peer_matching;
 
     /* lock queue access */
     opal_mutex_t lock;
@@ -36,6 +36,7 @@
 typedef struct mca_pml_ob1_comm_proc_t mca_pml_ob1_comm_proc_t;
 
 #include "custommatch/pml_ob1_custom_match.h"
+#include "pml_ob1_match.h"
 
 BEGIN_C_DECLS
 
@@ -47,10 +48,9 @@ struct mca_pml_ob1_comm_proc_t {
     int16_t comm_index;           /**< index of this communicator on the receiver size (-1 - not set) */
     opal_atomic_int32_t send_sequence; /**< send side sequence number */
     struct mca_pml_ob1_recv_frag_t* frags_cant_match;  /**< out-of-order fragment queues */
-#if !MCA_PML_OB1_CUSTOM_MATCH
     opal_list_t specific_receives; /**< queues of unmatched specific receives */
     opal_list_t unexpected_frags;  /**< unexpected fragment queues */
-#endif
+    opal_mutex_t matching_lock;    /**< matching lock of this peer (see peer_matching) */
 };
 
 OBJ_CLASS_DECLARATION(mca_pml_ob1_comm_proc_t);
@@ -65,17 +65,16 @@ struct mca_pml_comm_t {
     opal_object_t super;
     volatile uint32_t recv_sequence;  /**< recv request sequence number - receiver side */
     opal_mutex_t matching_lock;   /**< matching lock */
-#if !MCA_PML_OB1_CUSTOM_MATCH
     opal_list_t wild_receives;    /**< queue of unmatched wild (source process not specified) receives */
-#endif
     opal_mutex_t proc_lock;
     mca_pml_ob1_comm_proc_t * volatile * procs;
     size_t num_procs;
     size_t last_probed;
-#if MCA_PML_OB1_CUSTOM_MATCH
-    custom_match_prq* prq;
-    custom_match_umq* umq;
-#endif
+    const mca_pml_ob1_match_engine_t *match; /**< matching engine (NULL: use the queues above) */
+    void *prq;                    /**< posted receive queue of the matching engine */
+    void *umq;                    /**< unexpected message queue of the matching engine */
+    bool peer_matching;           /**< match messages from different peers concurrently */
+    opal_atomic_int32_t wild_pending; /**< wildcard receives posted or being posted (peer_matching) */
 };
 typedef struct mca_pml_comm_t mca_pml_ob1_comm_t;
 
@@ -117,6 +116,113 @@ static inline mca_pml_ob1_comm_proc_t *mca_pml_ob1_peer_lookup (struct ompi_comm
 
 extern int mca_pml_ob1_comm_init_size(mca_pml_ob1_comm_t* comm, size_t size);
 
+/**
+ * Match the messages of a communicator with a matching engine instead of
+ * the builtin queues. Must be called before the communicator is used.
+ *
+ * @param  comm    Instance of mca_pml_ob1_comm_t
+ * @param  engine  Matching engine (NULL: builtin queues)
+ * @return         OMPI_SUCCESS or error status on failure.
+ */
+extern int mca_pml_ob1_comm_set_matching(mca_pml_ob1_comm_t* comm, const mca_pml_ob1_match_engine_t *engine);
+
+/**
+ * Matching locks
+ *
+ * Without peer_matching all matching on a communicator is serialized by the
+ * communicator matching lock. With peer_matching each peer has its own lock
+ * and fragments from different peers are matched concurrently as long as no
+ * MPI_ANY_SOURCE receive is pending. wild_pending counts the wildcard
+ * receives that are queued or being posted (the wildcard epoch). While it is
+ * non-zero every matching operation also takes the communicator lock, which
+ * orders it against the wildcard receives. Posting a wildcard receive opens
+ * the epoch, takes the communicator lock and then waits for all the matching
+ * operations running under a peer lock only to drain. The locks are always
+ * taken in the order communicator then peer.
+ */
+#define MCA_PML_OB1_MATCHING_LOCKED_COMM 0x1
+#define MCA_PML_OB1_MATCHING_LOCKED_PEER 0x2
+#define MCA_PML_OB1_MATCHING_LOCKED_ALL  0x4
+
+/**
+ * Lock the matching state of one peer
+ *
+ * @returns the locks held to be passed to mca_pml_ob1_matching_unlock(). If
+ * MCA_PML_OB1_MATCHING_LOCKED_COMM is not set the wildcard receive queue is
+ * empty and must not be accessed.
+ */
+static inline int mca_pml_ob1_matching_lock_peer (mca_pml_ob1_comm_t *comm, mca_pml_ob1_comm_proc_t *proc)
+{
+    if (!comm->peer_matching) {
+        OB1_MATCHING_LOCK(&comm->matching_lock);
+        return MCA_PML_OB1_MATCHING_LOCKED_COMM;
+    }
+
+    if (0 == comm->wild_pending) {
+        OB1_MATCHING_LOCK(&proc->matching_lock);
+        /* a wildcard receive may have been posted before the peer lock was taken */
+        opal_atomic_mb ();
+        if (OPAL_LIKELY(0 == comm->wild_pending)) {
+            return MCA_PML_OB1_MATCHING_LOCKED_PEER;
+        }
+        OB1_MATCHING_UNLOCK(&proc->matching_lock);
+    }
+
+    OB1_MATCHING_LOCK(&comm->matching_lock);
+    OB1_MATCHING_LOCK(&proc->matching_lock);
+    return MCA_PML_OB1_MATCHING_LOCKED_COMM | MCA_PML_OB1_MATCHING_LOCKED_PEER;
+}
+
+/**
+ * Lock the matching state of all the peers (wildcard receives)
+ */
+static inline int mca_pml_ob1_matching_lock_all (mca_pml_ob1_comm_t *comm)
+{
+    if (!comm->peer_matching) {
+        OB1_MATCHING_LOCK(&comm->matching_lock);
+        return MCA_PML_OB1_MATCHING_LOCKED_COMM;
+    }
+
+    (void) OPAL_THREAD_ADD_FETCH32(&comm->wild_pending, 1);
+    OB1_MATCHING_LOCK(&comm->matching_lock);
+
+    /* wait for the matching operations holding only a peer lock. new ones will
+     * see wild_pending and queue on the communicator lock. */
+    for (size_t i = 0 ; i < comm->num_procs ; ++i) {
+        mca_pml_ob1_comm_proc_t *proc = comm->procs[i];
+        if (NULL != proc) {
+            OB1_MATCHING_LOCK(&proc->matching_lock);
+            OB1_MATCHING_UNLOCK(&proc->matching_lock);
+        }
+    }
+
+    return MCA_PML_OB1_MATCHING_LOCKED_COMM | MCA_PML_OB1_MATCHING_LOCKED_ALL;
+}
+
+static inline void mca_pml_ob1_matching_unlock (mca_pml_ob1_comm_t *comm, mca_pml_ob1_comm_proc_t *proc, int held)
+{
+    if (held & MCA_PML_OB1_MATCHING_LOCKED_PEER) {
+        OB1_MATCHING_UNLOCK(&proc->matching_lock);
+    }
+    if (held & MCA_PML_OB1_MATCHING_LOCKED_COMM) {
+        OB1_MATCHING_UNLOCK(&comm->matching_lock);
+    }
+    if (held & MCA_PML_OB1_MATCHING_LOCKED_ALL) {
+        (void) OPAL_THREAD_ADD_FETCH32(&comm->wild_pending, -1);
+    }
+}
+
+/**
+ * Account for a wildcard receive entering (1) or leaving (-1) the wildcard
+ * receive queue. Must be called with the communicator lock held.
+ */
+static inline void mca_pml_ob1_matching_wild_update (mca_pml_ob1_comm_t *comm, int32_t delta)
+{
+    if (comm->peer_matching) {
+        (void) OPAL_THREAD_ADD_FETCH32(&comm->wild_pending, delta);
+    }
+}
+
 END_C_DECLS
 #endif
 
@@ -29,6 +29,7 @@
 
 #include "ompi_config.h"
 #include "opal/util/event.h"
+#include "opal/util/show_help.h"
 #include "mpi.h"
 #include "ompi/runtime/params.h"
 #include "ompi/mca/pml/pml.h"
@@ -40,6 +41,8 @@
 #include "pml_ob1_rdmafrag.h"
 #include "pml_ob1_recvfrag.h"
 #include "pml_ob1_accelerator.h"
+#include "pml_ob1_smsc.h"
+#include "pml_ob1_match.h"
 #include "ompi/mca/bml/base/base.h"
 #include "pml_ob1_component.h"
 #include "opal/mca/allocator/base/base.h"
@@ -154,12 +157,12 @@ static int mca_pml_ob1_get_unex_msgq_size (const struct mca_base_pvar_t *pvar, v
     for (i = 0 ; i < comm_size ; ++i) {
         pml_proc = pml_comm->procs[i];
         if (pml_proc) {
-#if MCA_PML_OB1_CUSTOM_MATCH
-            values[i] = custom_match_umq_size(pml_comm->umq); // TODO: given the structure of custom match this does not make sense,
-                                                     //       as we only have one set of queues.
-#else
-            values[i] = opal_list_get_size (&pml_proc->unexpected_frags);
-#endif
+            if (NULL != pml_comm->match) {
+                values[i] = pml_comm->match->umq_size(pml_comm->umq); // TODO: given the structure of the matching engines this does not make sense,
+                                                                      //       as we only have one set of queues.
+            } else {
+                values[i] = opal_list_get_size (&pml_proc->unexpected_frags);
+            }
         } else {
             values[i] = 0;
         }
@@ -181,12 +184,12 @@ static int mca_pml_ob1_get_posted_recvq_size (const struct mca_base_pvar_t *pvar
         pml_proc = pml_comm->procs[i];
 
         if (pml_proc) {
-#if MCA_PML_OB1_CUSTOM_MATCH
-            values[i] = custom_match_prq_size(pml_comm->prq); // TODO: given the structure of custom match this does not make sense,
-                                                     //       as we only have one set of queues.
-#else
-            values[i] = opal_list_get_size (&pml_proc->specific_receives);
-#endif
+            if (NULL != pml_comm->match) {
+                values[i] = pml_comm->match->prq_size(pml_comm->prq); // TODO: given the structure of the matching engines this does not make sense,
+                                                                      //       as we only have one set of queues.
+            } else {
+                values[i] = opal_list_get_size (&pml_proc->specific_receives);
+            }
         } else {
             values[i] = 0;
         }
@@ -223,6 +226,48 @@ static int mca_pml_ob1_component_register(void)
                                            "(default: false)", MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
                                            OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_GROUP, &mca_pml_ob1.use_all_rdma);
 
+    mca_pml_ob1.smsc_iov_min_size = 16384;
+    (void) mca_base_component_var_register(&mca_pml_ob1_component.pmlm_version, "smsc_iov_min_size",
+                                           "Minimum size of a non-contiguous message to a local peer "
+                                           "for the receiver to copy it directly from the sender's "
+                                           "buffer with a single-copy mechanism, instead of packing "
+                                           "and unpacking it. 0 disables (default: 16384)",
+                                           MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, 0, OPAL_INFO_LVL_5,
+                                           MCA_BASE_VAR_SCOPE_GROUP, &mca_pml_ob1.smsc_iov_min_size);
+
+    mca_pml_ob1.smsc_iov_max = 4096;
+    (void) mca_base_component_var_register(&mca_pml_ob1_component.pmlm_version, "smsc_iov_max",
+                                           "Maximum number of contiguous blocks in the sender's "
+                                           "buffer for a single-copy transfer of non-contiguous data. "
+                                           "0 or values above the receiver's limit use that limit "
+                                           "(default: 4096)",
+                                           MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0, 0, OPAL_INFO_LVL_5,
+                                           MCA_BASE_VAR_SCOPE_GROUP, &mca_pml_ob1.smsc_iov_max);
+    if (0 == mca_pml_ob1.smsc_iov_max || mca_pml_ob1.smsc_iov_max > MCA_PML_OB1_SMSC_IOV_LIMIT) {
+        mca_pml_ob1.smsc_iov_max = (unsigned int) MCA_PML_OB1_SMSC_IOV_LIMIT;
+    }
+
+    mca_pml_ob1.matching_engine_name = (char *) mca_pml_ob1_match_default_name ();
+    (void) mca_base_component_var_register(&mca_pml_ob1_component.pmlm_version, "matching_engine",
+                                           "Matching engine used by default for new communicators. The "
+                                           "ompi_comm_pml_ob1_matching info key selects the engine of "
+                                           "a single communicator at creation. Available engines: none "
+                                           "(per peer queues), hash (buckets indexed by source and tag), "
+                                           "linkedlist, arrays, fuzzy-byte, fuzzy-short, fuzzy-word, "
+                                           "vector. Some engines depend on the instruction set the "
+                                           "library was built for",
+                                           MCA_BASE_VAR_TYPE_STRING, NULL, 0, 0, OPAL_INFO_LVL_5,
+                                           MCA_BASE_VAR_SCOPE_READONLY, &mca_pml_ob1.matching_engine_name);
+
+    mca_pml_ob1.peer_matching = false;
+    (void) mca_base_component_var_register(&mca_pml_ob1_component.pmlm_version, "peer_matching",
+                                           "Match messages from different peers concurrently using a "
+                                           "matching lock per peer when MPI_THREAD_MULTIPLE is in use. "
+                                           "Only applies to communicators using the builtin matching "
+                                           "queues (default: false)",
+                                           MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0, OPAL_INFO_LVL_5,
+                                           MCA_BASE_VAR_SCOPE_READONLY, &mca_pml_ob1.peer_matching);
+
     mca_pml_ob1.allocator_name = "bucket";
     (void) mca_base_component_var_register(&mca_pml_ob1_component.pmlm_version, "allocator",
                                            "Name of allocator component for unexpected messages",
@@ -280,6 +325,14 @@ mca_pml_ob1_component_init( int* priority,
 
     *priority = mca_pml_ob1.priority;
 
+    if (OMPI_SUCCESS != mca_pml_ob1_match_lookup (mca_pml_ob1.matching_engine_name,
+                                                  &mca_pml_ob1.matching_engine)) {
+        opal_show_help ("help-mpi-pml-ob1.txt", "unknown_matching_engine", true,
+                        ompi_process_info.nodename, mca_pml_ob1.matching_engine_name,
+                        mca_pml_ob1_match_available ());
+        mca_pml_ob1.matching_engine = NULL;
+    }
+
     allocator_component = mca_allocator_component_lookup( mca_pml_ob1.allocator_name );
     if(NULL == allocator_component) {
         opal_output(0, "mca_pml_ob1_component_init: can't find allocator: %s\n", mca_pml_ob1.allocator_name);
@@ -364,6 +417,7 @@ int mca_pml_ob1_component_fini(void)
     OBJ_DESTRUCT(&mca_pml_ob1.send_ranges);
 
     mca_pml_ob1_accelerator_fini();
+    mca_pml_ob1_smsc_fini();
 
     if( NULL != mca_pml_ob1.allocator ) {
         (void)mca_pml_ob1.allocator->alc_finalize(mca_pml_ob1.allocator);
@@ -57,6 +57,7 @@
 #define MCA_PML_OB1_HDR_FLAGS_CONTIG  0x08  /* is user buffer contiguous */
 #define MCA_PML_OB1_HDR_FLAGS_NORDMA  0x10  /* rest will be send by copy-in-out */
 #define MCA_PML_OB1_HDR_FLAGS_SIGNAL  0x20  /* message can be optionally signalling */
+#define MCA_PML_OB1_HDR_FLAGS_IOV     0x40  /* rget of an io vector with single-copy */
 
 /**
  * Common hdr attributes - must be first element in each hdr type
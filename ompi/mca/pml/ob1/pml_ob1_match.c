@@ -0,0 +1,90 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include <string.h>
+
+#include "ompi/constants.h"
+
+#include "pml_ob1_match.h"
+#include "custommatch/pml_ob1_custom_match.h"
+
+static const mca_pml_ob1_match_engine_t *mca_pml_ob1_match_engines[] = {
+    &mca_pml_ob1_match_hash,
+    &mca_pml_ob1_match_linkedlist,
+#if defined(__x86_64__)
+    &mca_pml_ob1_match_arrays,
+#endif
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+    &mca_pml_ob1_match_fuzzy_byte,
+    &mca_pml_ob1_match_fuzzy_short,
+#endif
+#if defined(__AVX512F__)
+    &mca_pml_ob1_match_fuzzy_word,
+    &mca_pml_ob1_match_vector,
+#endif
+    NULL,
+};
+
+int mca_pml_ob1_match_lookup (const char *name, const mca_pml_ob1_match_engine_t **engine)
+{
+    if (NULL == name || '\0' == name[0] || 0 == strcmp (name, "none")) {
+        *engine = NULL;
+        return OMPI_SUCCESS;
+    }
+
+    for (int i = 0 ; NULL != mca_pml_ob1_match_engines[i] ; ++i) {
+        if (0 == strcmp (name, mca_pml_ob1_match_engines[i]->name)) {
+            *engine = mca_pml_ob1_match_engines[i];
+            return OMPI_SUCCESS;
+        }
+    }
+
+    return OMPI_ERR_NOT_FOUND;
+}
+
+const char *mca_pml_ob1_match_default_name (void)
+{
+    /* --with-pml-ob1-matching selects the default engine */
+    switch (MCA_PML_OB1_CUSTOM_MATCHING) {
+    case MCA_PML_OB1_CUSTOM_MATCHING_LINKEDLIST:
+        return "linkedlist";
+    case MCA_PML_OB1_CUSTOM_MATCHING_ARRAYS:
+        return "arrays";
+    case MCA_PML_OB1_CUSTOM_MATCHING_FUZZY_BYTE:
+        return "fuzzy-byte";
+    case MCA_PML_OB1_CUSTOM_MATCHING_FUZZY_SHORT:
+        return "fuzzy-short";
+    case MCA_PML_OB1_CUSTOM_MATCHING_FUZZY_WORD:
+        return "fuzzy-word";
+    case MCA_PML_OB1_CUSTOM_MATCHING_VECTOR:
+        return "vector";
+    case MCA_PML_OB1_CUSTOM_MATCHING_HASH:
+        return "hash";
+    default:
+        return "none";
+    }
+}
+
+const char *mca_pml_ob1_match_available (void)
+{
+    static char available[128];
+
+    if ('\0' == available[0]) {
+        strncat (available, "none", sizeof (available) - 1);
+        for (int i = 0 ; NULL != mca_pml_ob1_match_engines[i] ; ++i) {
+            strncat (available, ", ", sizeof (available) - strlen (available) - 1);
+            strncat (available, mca_pml_ob1_match_engines[i]->name,
+                     sizeof (available) - strlen (available) - 1);
+        }
+    }
+
+    return available;
+}
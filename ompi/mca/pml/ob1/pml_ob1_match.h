@@ -0,0 +1,109 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/**
+ * @file
+ *
+ * Runtime selectable matching engines. By default ob1 matches with the
+ * per-peer queues embedded in mca_pml_ob1_comm_t/mca_pml_ob1_comm_proc_t.
+ * A communicator can instead use one of the engines below, selected with
+ * the pml_ob1_matching_engine MCA parameter or the ompi_comm_pml_ob1_matching
+ * info key at communicator creation. An engine keeps one queue of posted
+ * receives (prq) and one queue of unexpected fragments (umq) for the whole
+ * communicator and must respect the MPI ordering rules, including for
+ * MPI_ANY_SOURCE and MPI_ANY_TAG. All functions are called with the
+ * communicator matching lock held.
+ */
+
+#ifndef MCA_PML_OB1_MATCH_H
+#define MCA_PML_OB1_MATCH_H
+
+#include "ompi_config.h"
+
+BEGIN_C_DECLS
+
+struct mca_pml_ob1_recv_request_t;
+struct mca_pml_ob1_recv_frag_t;
+
+/**
+ * Location of an unexpected fragment found by umq_find. It is passed back
+ * to umq_remove so the engine does not have to search the fragment again.
+ */
+struct mca_pml_ob1_match_hold_t {
+    void *prev;
+    void *elem;
+    int index;
+};
+typedef struct mca_pml_ob1_match_hold_t mca_pml_ob1_match_hold_t;
+
+struct mca_pml_ob1_match_engine_t {
+    /** name used by the MCA parameter and the info key */
+    const char *name;
+
+    void *(*prq_init) (void);
+    void (*prq_destroy) (void *prq);
+    /** queue a posted receive. peer/tag may be wildcards */
+    void (*prq_append) (void *prq, struct mca_pml_ob1_recv_request_t *req, int tag, int peer);
+    /** remove a posted receive. returns 1 if the request was found */
+    int (*prq_cancel) (void *prq, struct mca_pml_ob1_recv_request_t *req, int tag, int peer);
+    /** find and dequeue the oldest posted receive that matches an incoming message */
+    struct mca_pml_ob1_recv_request_t *(*prq_find_dequeue) (void *prq, int tag, int peer);
+    size_t (*prq_size) (void *prq);
+    void (*prq_dump) (void *prq);
+
+    void *(*umq_init) (void);
+    void (*umq_destroy) (void *umq);
+    void (*umq_append) (void *umq, struct mca_pml_ob1_recv_frag_t *frag, int tag, int peer);
+    /** find the oldest unexpected fragment matching a receive. peer/tag may be wildcards */
+    struct mca_pml_ob1_recv_frag_t *(*umq_find) (void *umq, int tag, int peer,
+                                                  mca_pml_ob1_match_hold_t *hold);
+    /** remove the fragment returned by the last umq_find */
+    void (*umq_remove) (void *umq, mca_pml_ob1_match_hold_t *hold);
+    size_t (*umq_size) (void *umq);
+    void (*umq_dump) (void *umq);
+};
+typedef struct mca_pml_ob1_match_engine_t mca_pml_ob1_match_engine_t;
+
+extern const mca_pml_ob1_match_engine_t mca_pml_ob1_match_hash;
+extern const mca_pml_ob1_match_engine_t mca_pml_ob1_match_linkedlist;
+#if defined(__x86_64__)
+extern const mca_pml_ob1_match_engine_t mca_pml_ob1_match_arrays;
+#endif
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+extern const mca_pml_ob1_match_engine_t mca_pml_ob1_match_fuzzy_byte;
+extern const mca_pml_ob1_match_engine_t mca_pml_ob1_match_fuzzy_short;
+#endif
+#if defined(__AVX512F__)
+extern const mca_pml_ob1_match_engine_t mca_pml_ob1_match_fuzzy_word;
+extern const mca_pml_ob1_match_engine_t mca_pml_ob1_match_vector;
+#endif
+
+/**
+ * Look up a matching engine by name
+ *
+ * @param[in]  name    engine name ("none" selects the builtin queues)
+ * @param[out] engine  engine or NULL for the builtin queues
+ *
+ * @returns OMPI_ERR_NOT_FOUND if no engine with this name is available
+ */
+int mca_pml_ob1_match_lookup (const char *name, const mca_pml_ob1_match_engine_t **engine);
+
+/**
+ * Name of the engine configured as default at build time
+ */
+const char *mca_pml_ob1_match_default_name (void);
+
+/**
+ * Comma separated list of the engines available in this build
+ */
+const char *mca_pml_ob1_match_available (void);
+
+END_C_DECLS
+
+#endif /* MCA_PML_OB1_MATCH_H */
@@ -0,0 +1,365 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/**
+ * @file
+ *
+ * Hashed matching engine. Posted receives and unexpected fragments with a
+ * specific source and tag are kept in buckets indexed by a hash of
+ * (source, tag), so deep queues spread over many peers and tags can be
+ * searched in (nearly) constant time. MPI ordering is kept as follows:
+ *
+ * - posted receives with MPI_ANY_SOURCE and/or MPI_ANY_TAG are kept in a
+ *   separate list. An incoming message takes the older of the first
+ *   matching receive in its bucket and the first matching wildcard receive,
+ *   using the receive sequence number assigned by ob1.
+ * - unexpected fragments are stamped with an arrival number. A wildcard
+ *   receive takes the oldest matching fragment over all buckets.
+ */
+
+#include "ompi_config.h"
+
+#include "opal/class/opal_list.h"
+#include "opal/util/output.h"
+
+#include "pml_ob1_match.h"
+#include "pml_ob1_recvreq.h"
+#include "pml_ob1_recvfrag.h"
+
+#define MCA_PML_OB1_MATCH_HASH_BUCKETS 128
+
+struct mca_pml_ob1_match_hash_prq_t {
+    /** receives with a specific source and tag */
+    opal_list_t buckets[MCA_PML_OB1_MATCH_HASH_BUCKETS];
+    /** receives with a wildcard source or tag, in posting order */
+    opal_list_t wild;
+    size_t size;
+};
+typedef struct mca_pml_ob1_match_hash_prq_t mca_pml_ob1_match_hash_prq_t;
+
+struct mca_pml_ob1_match_hash_node_t {
+    opal_list_item_t super;
+    mca_pml_ob1_recv_frag_t *frag;
+    uint64_t arrival;
+    int tag;
+    int peer;
+};
+typedef struct mca_pml_ob1_match_hash_node_t mca_pml_ob1_match_hash_node_t;
+
+static OBJ_CLASS_INSTANCE(mca_pml_ob1_match_hash_node_t, opal_list_item_t, NULL, NULL);
+
+struct mca_pml_ob1_match_hash_umq_t {
+    opal_list_t buckets[MCA_PML_OB1_MATCH_HASH_BUCKETS];
+    /** unused nodes */
+    opal_list_t spare;
+    uint64_t arrival;
+    size_t size;
+};
+typedef struct mca_pml_ob1_match_hash_umq_t mca_pml_ob1_match_hash_umq_t;
+
+static inline unsigned int mca_pml_ob1_match_hash_bucket (int tag, int peer)
+{
+    uint32_t key = ((uint32_t) peer * 0x9e3779b1u) ^ (uint32_t) tag;
+
+    key ^= key >> 16;
+    key *= 0x85ebca6bu;
+    key ^= key >> 13;
+
+    return key & (MCA_PML_OB1_MATCH_HASH_BUCKETS - 1);
+}
+
+static inline bool mca_pml_ob1_match_hash_tag_match (int req_tag, int tag)
+{
+    /* negative tags are reserved and are never matched by MPI_ANY_TAG */
+    return req_tag == tag || (OMPI_ANY_TAG == req_tag && tag >= 0);
+}
+
+static inline bool mca_pml_ob1_match_hash_is_wild (int tag, int peer)
+{
+    return OMPI_ANY_SOURCE == peer || OMPI_ANY_TAG == tag;
+}
+
+static void *mca_pml_ob1_match_hash_prq_init (void)
+{
+    mca_pml_ob1_match_hash_prq_t *prq = malloc (sizeof (*prq));
+
+    if (NULL == prq) {
+        return NULL;
+    }
+
+    for (int i = 0 ; i < MCA_PML_OB1_MATCH_HASH_BUCKETS ; ++i) {
+        OBJ_CONSTRUCT(prq->buckets + i, opal_list_t);
+    }
+    OBJ_CONSTRUCT(&prq->wild, opal_list_t);
+    prq->size = 0;
+
+    return prq;
+}
+
+static void mca_pml_ob1_match_hash_prq_destroy (void *queue)
+{
+    mca_pml_ob1_match_hash_prq_t *prq = (mca_pml_ob1_match_hash_prq_t *) queue;
+
+    /* the requests are not owned by the queue */
+    for (int i = 0 ; i < MCA_PML_OB1_MATCH_HASH_BUCKETS ; ++i) {
+        OBJ_DESTRUCT(prq->buckets + i);
+    }
+    OBJ_DESTRUCT(&prq->wild);
+    free (prq);
+}
+
+static void mca_pml_ob1_match_hash_prq_append (void *queue, mca_pml_ob1_recv_request_t *req, int tag,
+                                               int peer)
+{
+    mca_pml_ob1_match_hash_prq_t *prq = (mca_pml_ob1_match_hash_prq_t *) queue;
+    opal_list_t *list;
+
+    if (mca_pml_ob1_match_hash_is_wild (tag, peer)) {
+        list = &prq->wild;
+    } else {
+        list = prq->buckets + mca_pml_ob1_match_hash_bucket (tag, peer);
+    }
+
+    opal_list_append (list, (opal_list_item_t *) req);
+    ++prq->size;
+}
+
+static int mca_pml_ob1_match_hash_prq_cancel (void *queue, mca_pml_ob1_recv_request_t *req, int tag,
+                                              int peer)
+{
+    mca_pml_ob1_match_hash_prq_t *prq = (mca_pml_ob1_match_hash_prq_t *) queue;
+    opal_list_t *list;
+
+    if (mca_pml_ob1_match_hash_is_wild (tag, peer)) {
+        list = &prq->wild;
+    } else {
+        list = prq->buckets + mca_pml_ob1_match_hash_bucket (tag, peer);
+    }
+
+    opal_list_remove_item (list, (opal_list_item_t *) req);
+    --prq->size;
+
+    return 1;
+}
+
+static mca_pml_ob1_recv_request_t *mca_pml_ob1_match_hash_prq_find_dequeue (void *queue, int tag, int peer)
+{
+    mca_pml_ob1_match_hash_prq_t *prq = (mca_pml_ob1_match_hash_prq_t *) queue;
+    opal_list_t *bucket = prq->buckets + mca_pml_ob1_match_hash_bucket (tag, peer);
+    mca_pml_ob1_recv_request_t *req, *specific = NULL, *wild = NULL;
+
+    if (0 == prq->size) {
+        return NULL;
+    }
+
+    OPAL_LIST_FOREACH(req, bucket, mca_pml_ob1_recv_request_t) {
+        if (req->req_recv.req_base.req_tag == tag && req->req_recv.req_base.req_peer == peer) {
+            specific = req;
+            break;
+        }
+    }
+
+    OPAL_LIST_FOREACH(req, &prq->wild, mca_pml_ob1_recv_request_t) {
+        if (specific && req->req_recv.req_base.req_sequence > specific->req_recv.req_base.req_sequence) {
+            /* all remaining wildcard receives were posted after the specific receive */
+            break;
+        }
+
+        if ((OMPI_ANY_SOURCE == req->req_recv.req_base.req_peer || req->req_recv.req_base.req_peer == peer) &&
+            mca_pml_ob1_match_hash_tag_match (req->req_recv.req_base.req_tag, tag)) {
+            wild = req;
+            break;
+        }
+    }
+
+    if (NULL != wild) {
+        opal_list_remove_item (&prq->wild, (opal_list_item_t *) wild);
+        --prq->size;
+        return wild;
+    }
+
+    if (NULL != specific) {
+        opal_list_remove_item (bucket, (opal_list_item_t *) specific);
+        --prq->size;
+    }
+
+    return specific;
+}
+
+static size_t mca_pml_ob1_match_hash_prq_size (void *queue)
+{
+    return ((mca_pml_ob1_match_hash_prq_t *) queue)->size;
+}
+
+static void mca_pml_ob1_match_hash_dump_req (mca_pml_ob1_recv_request_t *req)
+{
+    opal_output (0, "req %p peer %d tag %d req_seq %" PRIu64, (void *) req,
+                 req->req_recv.req_base.req_peer, req->req_recv.req_base.req_tag,
+                 req->req_recv.req_base.req_sequence);
+}
+
+static void mca_pml_ob1_match_hash_prq_dump (void *queue)
+{
+    mca_pml_ob1_match_hash_prq_t *prq = (mca_pml_ob1_match_hash_prq_t *) queue;
+    mca_pml_ob1_recv_request_t *req;
+
+    opal_output (0, "hash prq %p: %" PRIsize_t " receives", queue, prq->size);
+
+    for (int i = 0 ; i < MCA_PML_OB1_MATCH_HASH_BUCKETS ; ++i) {
+        OPAL_LIST_FOREACH(req, prq->buckets + i, mca_pml_ob1_recv_request_t) {
+            mca_pml_ob1_match_hash_dump_req (req);
+        }
+    }
+
+    OPAL_LIST_FOREACH(req, &prq->wild, mca_pml_ob1_recv_request_t) {
+        mca_pml_ob1_match_hash_dump_req (req);
+    }
+}
+
+static void *mca_pml_ob1_match_hash_umq_init (void)
+{
+    mca_pml_ob1_match_hash_umq_t *umq = malloc (sizeof (*umq));
+
+    if (NULL == umq) {
+        return NULL;
+    }
+
+    for (int i = 0 ; i < MCA_PML_OB1_MATCH_HASH_BUCKETS ; ++i) {
+        OBJ_CONSTRUCT(umq->buckets + i, opal_list_t);
+    }
+    OBJ_CONSTRUCT(&umq->spare, opal_list_t);
+    umq->arrival = 0;
+    umq->size = 0;
+
+    return umq;
+}
+
+static void mca_pml_ob1_match_hash_umq_destroy (void *queue)
+{
+    mca_pml_ob1_match_hash_umq_t *umq = (mca_pml_ob1_match_hash_umq_t *) queue;
+
+    for (int i = 0 ; i < MCA_PML_OB1_MATCH_HASH_BUCKETS ; ++i) {
+        OPAL_LIST_DESTRUCT(umq->buckets + i);
+    }
+    OPAL_LIST_DESTRUCT(&umq->spare);
+    free (umq);
+}
+
+static void mca_pml_ob1_match_hash_umq_append (void *queue, mca_pml_ob1_recv_frag_t *frag, int tag,
+                                               int peer)
+{
+    mca_pml_ob1_match_hash_umq_t *umq = (mca_pml_ob1_match_hash_umq_t *) queue;
+    mca_pml_ob1_match_hash_node_t *node;
+
+    node = (mca_pml_ob1_match_hash_node_t *) opal_list_remove_first (&umq->spare);
+    if (NULL == node) {
+        node = OBJ_NEW(mca_pml_ob1_match_hash_node_t);
+    }
+
+    node->frag = frag;
+    node->arrival = umq->arrival++;
+    node->tag = tag;
+    node->peer = peer;
+
+    opal_list_append (umq->buckets + mca_pml_ob1_match_hash_bucket (tag, peer), &node->super);
+    ++umq->size;
+}
+
+static mca_pml_ob1_recv_frag_t *mca_pml_ob1_match_hash_umq_find (void *queue, int tag, int peer,
+                                                                  mca_pml_ob1_match_hold_t *hold)
+{
+    mca_pml_ob1_match_hash_umq_t *umq = (mca_pml_ob1_match_hash_umq_t *) queue;
+    mca_pml_ob1_match_hash_node_t *node, *match = NULL;
+
+    if (0 == umq->size) {
+        return NULL;
+    }
+
+    if (!mca_pml_ob1_match_hash_is_wild (tag, peer)) {
+        OPAL_LIST_FOREACH(node, umq->buckets + mca_pml_ob1_match_hash_bucket (tag, peer),
+                          mca_pml_ob1_match_hash_node_t) {
+            if (node->tag == tag && node->peer == peer) {
+                match = node;
+                break;
+            }
+        }
+    } else {
+        /* the oldest matching fragment of every bucket is a candidate */
+        for (int i = 0 ; i < MCA_PML_OB1_MATCH_HASH_BUCKETS ; ++i) {
+            OPAL_LIST_FOREACH(node, umq->buckets + i, mca_pml_ob1_match_hash_node_t) {
+                if (match && node->arrival > match->arrival) {
+                    break;
+                }
+
+                if ((OMPI_ANY_SOURCE == peer || node->peer == peer) &&
+                    mca_pml_ob1_match_hash_tag_match (tag, node->tag)) {
+                    match = node;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (NULL == match) {
+        return NULL;
+    }
+
+    hold->elem = match;
+    return match->frag;
+}
+
+static void mca_pml_ob1_match_hash_umq_remove (void *queue, mca_pml_ob1_match_hold_t *hold)
+{
+    mca_pml_ob1_match_hash_umq_t *umq = (mca_pml_ob1_match_hash_umq_t *) queue;
+    mca_pml_ob1_match_hash_node_t *node = (mca_pml_ob1_match_hash_node_t *) hold->elem;
+
+    opal_list_remove_item (umq->buckets + mca_pml_ob1_match_hash_bucket (node->tag, node->peer),
+                           &node->super);
+    node->frag = NULL;
+    opal_list_append (&umq->spare, &node->super);
+    --umq->size;
+}
+
+static size_t mca_pml_ob1_match_hash_umq_size (void *queue)
+{
+    return ((mca_pml_ob1_match_hash_umq_t *) queue)->size;
+}
+
+static void mca_pml_ob1_match_hash_umq_dump (void *queue)
+{
+    mca_pml_ob1_match_hash_umq_t *umq = (mca_pml_ob1_match_hash_umq_t *) queue;
+    mca_pml_ob1_match_hash_node_t *node;
+
+    opal_output (0, "hash umq %p: %" PRIsize_t " fragments", queue, umq->size);
+
+    for (int i = 0 ; i < MCA_PML_OB1_MATCH_HASH_BUCKETS ; ++i) {
+        OPAL_LIST_FOREACH(node, umq->buckets + i, mca_pml_ob1_match_hash_node_t) {
+            opal_output (0, "frag %p peer %d tag %d arrival %" PRIu64, (void *) node->frag,
+                         node->peer, node->tag, node->arrival);
+        }
+    }
+}
+
+const mca_pml_ob1_match_engine_t mca_pml_ob1_match_hash = {
+    .name = "hash",
+    .prq_init = mca_pml_ob1_match_hash_prq_init,
+    .prq_destroy = mca_pml_ob1_match_hash_prq_destroy,
+    .prq_append = mca_pml_ob1_match_hash_prq_append,
+    .prq_cancel = mca_pml_ob1_match_hash_prq_cancel,
+    .prq_find_dequeue = mca_pml_ob1_match_hash_prq_find_dequeue,
+    .prq_size = mca_pml_ob1_match_hash_prq_size,
+    .prq_dump = mca_pml_ob1_match_hash_prq_dump,
+    .umq_init = mca_pml_ob1_match_hash_umq_init,
+    .umq_destroy = mca_pml_ob1_match_hash_umq_destroy,
+    .umq_append = mca_pml_ob1_match_hash_umq_append,
+    .umq_find = mca_pml_ob1_match_hash_umq_find,
+    .umq_remove = mca_pml_ob1_match_hash_umq_remove,
+    .umq_size = mca_pml_ob1_match_hash_umq_size,
+    .umq_dump = mca_pml_ob1_match_hash_umq_dump,
+};
@@ -88,22 +88,18 @@ append_frag_to_list(opal_list_t *queue, mca_btl_base_module_t *btl,
     opal_list_append(queue, (opal_list_item_t*)frag);
 }
 
-#if MCA_PML_OB1_CUSTOM_MATCH
-
 static void
-append_frag_to_umq(custom_match_umq *queue, mca_btl_base_module_t *btl,
+append_frag_to_umq(mca_pml_ob1_comm_t *comm, mca_btl_base_module_t *btl,
                    const mca_pml_ob1_match_hdr_t *hdr, const mca_btl_base_segment_t *segments,
                    size_t num_segments, mca_pml_ob1_recv_frag_t* frag)
 {
-  if(NULL == frag) {
-    MCA_PML_OB1_RECV_FRAG_ALLOC(frag);
-    MCA_PML_OB1_RECV_FRAG_INIT(frag, hdr, segments, num_segments, btl);
-  }
-  custom_match_umq_append(queue, hdr->hdr_tag, hdr->hdr_src, frag);
+    if(NULL == frag) {
+        MCA_PML_OB1_RECV_FRAG_ALLOC(frag);
+        MCA_PML_OB1_RECV_FRAG_INIT(frag, hdr, segments, num_segments, btl);
+    }
+    comm->match->umq_append(comm->umq, frag, hdr->hdr_tag, hdr->hdr_src);
 }
 
-#endif
-
 
 /**
  * Append an unexpected descriptor to an ordered queue.
@@ -320,14 +316,16 @@ mca_pml_ob1_recv_frag_match_proc (mca_btl_base_module_t *btl,
                                   const mca_btl_base_segment_t *segments,
                                   size_t num_segments,
                                   int type,
-                                  mca_pml_ob1_recv_frag_t *frag);
+                                  mca_pml_ob1_recv_frag_t *frag,
+                                  int held);
 
 static mca_pml_ob1_recv_request_t *match_one (mca_btl_base_module_t *btl,
                                               const mca_pml_ob1_match_hdr_t *hdr,
                                               const mca_btl_base_segment_t *segments,
                                               size_t num_segments, ompi_communicator_t *comm_ptr,
                                               mca_pml_ob1_comm_proc_t *proc,
-                                              mca_pml_ob1_recv_frag_t *frag);
+                                              mca_pml_ob1_recv_frag_t *frag,
+                                              int held);
 
 #if OPAL_ENABLE_FT_MPI
 static inline int pml_ob1_frag_is_revoked(ompi_communicator_t* ompi_comm, mca_pml_ob1_recv_frag_t* frag) {
@@ -461,6 +459,7 @@ void mca_pml_ob1_recv_frag_callback_match (mca_btl_base_module_t *btl,
     mca_pml_ob1_comm_proc_t *proc;
     size_t num_segments = descriptor->des_segment_count;
     size_t bytes_received = 0;
+    int held;
 
     assert(num_segments <= MCA_BTL_DES_MAX_SEGMENTS);
 
@@ -504,14 +503,14 @@ void mca_pml_ob1_recv_frag_callback_match (mca_btl_base_module_t *btl,
      * end points) from being processed, and potentially "losing"
      * the fragment.
      */
-    OB1_MATCHING_LOCK(&comm->matching_lock);
+    held = mca_pml_ob1_matching_lock_peer (comm, proc);
 
 #if OPAL_ENABLE_FT_MPI
     if( OPAL_UNLIKELY((ompi_comm_is_revoked(comm_ptr) && !ompi_request_tag_is_ft(hdr->hdr_tag)) ||
                       (ompi_comm_coll_revoked(comm_ptr) && ompi_request_tag_is_collective(hdr->hdr_tag))) ) {
         /* if it's a TYPE_MATCH, the sender is not expecting anything from us
          * so we are done. */
-        OPAL_THREAD_UNLOCK(&comm->matching_lock);
+        mca_pml_ob1_matching_unlock (comm, proc, held);
         OPAL_OUTPUT_VERBOSE((15, ompi_ftmpi_output_handle,
             "ob1_revoke_comm: dropping silently frag from %d", hdr->hdr_src));
         return;
@@ -529,7 +528,7 @@ void mca_pml_ob1_recv_frag_callback_match (mca_btl_base_module_t *btl,
             MCA_PML_OB1_RECV_FRAG_INIT(frag, hdr, segments, num_segments, btl);
             ompi_pml_ob1_append_frag_to_ordered_list(&proc->frags_cant_match, frag, proc->expected_sequence);
             SPC_RECORD(OMPI_SPC_OUT_OF_SEQUENCE, 1);
-            OB1_MATCHING_UNLOCK(&comm->matching_lock);
+            mca_pml_ob1_matching_unlock (comm, proc, held);
             return;
         }
 
@@ -544,7 +543,7 @@ void mca_pml_ob1_recv_frag_callback_match (mca_btl_base_module_t *btl,
     PERUSE_TRACE_MSG_EVENT(PERUSE_COMM_SEARCH_POSTED_Q_BEGIN, comm_ptr,
                            hdr->hdr_src, hdr->hdr_tag, PERUSE_RECV);
 
-    match = match_one(btl, hdr, segments, num_segments, comm_ptr, proc, NULL);
+    match = match_one(btl, hdr, segments, num_segments, comm_ptr, proc, NULL, held);
 
     /* The match is over. We generate the SEARCH_POSTED_Q_END here,
      * before going into check_cantmatch_for_match so we can make
@@ -554,7 +553,7 @@ void mca_pml_ob1_recv_frag_callback_match (mca_btl_base_module_t *btl,
                            hdr->hdr_src, hdr->hdr_tag, PERUSE_RECV);
 
     /* release matching lock before processing fragment */
-    OB1_MATCHING_UNLOCK(&comm->matching_lock);
+    mca_pml_ob1_matching_unlock (comm, proc, held);
 
     if(OPAL_LIKELY(match)) {
         bytes_received = segments->seg_len - OMPI_PML_OB1_MATCH_HDR_LEN;
@@ -617,21 +616,21 @@ void mca_pml_ob1_recv_frag_callback_match (mca_btl_base_module_t *btl,
      *
      * NOTE:
      * To optimize the number of lock used, mca_pml_ob1_recv_frag_match_proc()
-     * MUST be called with communicator lock and will RELEASE the lock. This is
+     * MUST be called with the matching lock(s) and will RELEASE them. This is
      * not ideal but it is better for the performance.
      */
     if(NULL != proc->frags_cant_match) {
         mca_pml_ob1_recv_frag_t* frag;
 
-        OB1_MATCHING_LOCK(&comm->matching_lock);
+        held = mca_pml_ob1_matching_lock_peer (comm, proc);
         if((frag = ompi_pml_ob1_check_cantmatch_for_match(proc))) {
             /* mca_pml_ob1_recv_frag_match_proc() will release the lock. */
             mca_pml_ob1_recv_frag_match_proc(frag->btl, comm_ptr, proc,
                                              &frag->hdr.hdr_match,
                                              frag->segments, frag->num_segments,
-                                             frag->hdr.hdr_match.hdr_common.hdr_type, frag);
+                                             frag->hdr.hdr_match.hdr_common.hdr_type, frag, held);
         } else {
-            OB1_MATCHING_UNLOCK(&comm->matching_lock);
+            mca_pml_ob1_matching_unlock (comm, proc, held);
         }
     }
 }
@@ -644,9 +643,9 @@ int mca_pml_ob1_merge_cant_match( ompi_communicator_t * ompi_comm )
     mca_pml_ob1_comm_t * pml_comm = (mca_pml_ob1_comm_t *)ompi_comm->c_pml_comm;
     mca_pml_ob1_recv_frag_t *frag, *frags_cant_match;
     mca_pml_ob1_comm_proc_t* proc;
-    int cnt = 0;
+    int cnt = 0, held;
 
-    OB1_MATCHING_LOCK(&pml_comm->matching_lock);
+    held = mca_pml_ob1_matching_lock_all (pml_comm);
     for (uint32_t i = 0; i < pml_comm->num_procs; i++) {
         if ((NULL == (proc = pml_comm->procs[i])) || (NULL != proc->frags_cant_match)) {
             continue;
@@ -660,12 +659,12 @@ int mca_pml_ob1_merge_cant_match( ompi_communicator_t * ompi_comm )
             mca_pml_ob1_recv_frag_match_proc(frag->btl, ompi_comm, proc,
                                              &frag->hdr.hdr_match,
                                              frag->segments, frag->num_segments,
-                                             frag->hdr.hdr_match.hdr_common.hdr_type, frag);
-            OB1_MATCHING_LOCK(&pml_comm->matching_lock);
+                                             frag->hdr.hdr_match.hdr_common.hdr_type, frag, held);
+            held = mca_pml_ob1_matching_lock_all (pml_comm);
             cnt++;
         }
     }
-    OB1_MATCHING_UNLOCK(&pml_comm->matching_lock);
+    mca_pml_ob1_matching_unlock (pml_comm, NULL, held);
     return cnt;
 }
 
@@ -864,7 +863,6 @@ static mca_pml_ob1_recv_request_t *match_incomming(const mca_pml_ob1_match_hdr_t
                                                    mca_pml_ob1_comm_t *comm,
                                                    mca_pml_ob1_comm_proc_t *proc)
 {
-#if !MCA_PML_OB1_CUSTOM_MATCH
     mca_pml_ob1_recv_request_t *specific_recv, *wild_recv;
     mca_pml_sequence_t wild_recv_seq, specific_recv_seq;
     int tag = hdr->hdr_tag;
@@ -897,6 +895,9 @@ static mca_pml_ob1_recv_request_t *match_incomming(const mca_pml_ob1_match_hdr_t
         req_tag = (*match)->req_recv.req_base.req_tag;
         if(req_tag == tag || (req_tag == OMPI_ANY_TAG && tag >= 0)) {
             opal_list_remove_item(queue, (opal_list_item_t*)(*match));
+            if (queue == &comm->wild_receives) {
+                mca_pml_ob1_matching_wild_update (comm, -1);
+            }
             PERUSE_TRACE_COMM_EVENT(PERUSE_COMM_REQ_REMOVE_FROM_POSTED_Q,
                     &((*match)->req_recv.req_base), PERUSE_RECV);
             return *match;
@@ -907,12 +908,8 @@ static mca_pml_ob1_recv_request_t *match_incomming(const mca_pml_ob1_match_hdr_t
     }
 
     return NULL;
-#else
-    return custom_match_prq_find_dequeue_verify(comm->prq, hdr->hdr_tag, hdr->hdr_src);
-#endif
 }
 
-#if !MCA_PML_OB1_CUSTOM_MATCH
 static mca_pml_ob1_recv_request_t *match_incomming_no_any_source (const mca_pml_ob1_match_hdr_t *hdr,
                                                                   mca_pml_ob1_comm_t *comm,
                                                                   mca_pml_ob1_comm_proc_t *proc)
@@ -933,14 +930,14 @@ static mca_pml_ob1_recv_request_t *match_incomming_no_any_source (const mca_pml_
 
     return NULL;
 }
-#endif
 
 static mca_pml_ob1_recv_request_t *match_one (mca_btl_base_module_t *btl,
                                               const mca_pml_ob1_match_hdr_t *hdr,
                                               const mca_btl_base_segment_t *segments,
                                               size_t num_segments, ompi_communicator_t *comm_ptr,
                                               mca_pml_ob1_comm_proc_t *proc,
-                                              mca_pml_ob1_recv_frag_t* frag)
+                                              mca_pml_ob1_recv_frag_t* frag,
+                                              int held)
 {
 #if SPC_ENABLE == 1
     opal_timer_t timer = 0;
@@ -951,15 +948,15 @@ static mca_pml_ob1_recv_request_t *match_one (mca_btl_base_module_t *btl,
     mca_pml_ob1_comm_t *comm = (mca_pml_ob1_comm_t *)comm_ptr->c_pml_comm;
 
     do {
-#if MCA_PML_OB1_CUSTOM_MATCH
-        match = match_incomming(hdr, comm, proc);
-#else
-        if (!OMPI_COMM_CHECK_ASSERT_NO_ANY_SOURCE (comm_ptr)) {
+        if (NULL != comm->match) {
+            match = comm->match->prq_find_dequeue(comm->prq, hdr->hdr_tag, hdr->hdr_src);
+        } else if (!OMPI_COMM_CHECK_ASSERT_NO_ANY_SOURCE (comm_ptr) &&
+                   (held & MCA_PML_OB1_MATCHING_LOCKED_COMM)) {
+            /* without the communicator lock no wildcard receive is posted */
             match = match_incomming(hdr, comm, proc);
         } else {
             match = match_incomming_no_any_source (hdr, comm, proc);
         }
-#endif
 
         /* if match found, process data */
         if(OPAL_LIKELY(NULL != match)) {
@@ -999,13 +996,13 @@ static mca_pml_ob1_recv_request_t *match_one (mca_btl_base_module_t *btl,
         }
 
         /* if no match found, place on unexpected queue */
-#if MCA_PML_OB1_CUSTOM_MATCH
-        append_frag_to_umq(comm->umq, btl, hdr, segments,
-                            num_segments, frag);
-#else
-        append_frag_to_list(&proc->unexpected_frags, btl, hdr, segments,
-                            num_segments, frag);
-#endif
+        if (NULL != comm->match) {
+            append_frag_to_umq(comm, btl, hdr, segments,
+                               num_segments, frag);
+        } else {
+            append_frag_to_list(&proc->unexpected_frags, btl, hdr, segments,
+                                num_segments, frag);
+        }
         SPC_RECORD(OMPI_SPC_UNEXPECTED, 1);
         SPC_RECORD(OMPI_SPC_UNEXPECTED_IN_QUEUE, 1);
         SPC_UPDATE_WATERMARK(OMPI_SPC_MAX_UNEXPECTED_IN_QUEUE, OMPI_SPC_UNEXPECTED_IN_QUEUE);
@@ -1058,6 +1055,7 @@ static int mca_pml_ob1_recv_frag_match (mca_btl_base_module_t *btl,
     ompi_communicator_t *comm_ptr;
     mca_pml_ob1_comm_t *comm;
     mca_pml_ob1_comm_proc_t *proc;
+    int held;
 
     /* communicator pointer */
     comm_ptr = ompi_comm_lookup(hdr->hdr_ctx);
@@ -1094,12 +1092,12 @@ static int mca_pml_ob1_recv_frag_match (mca_btl_base_module_t *btl,
      * end points) from being processed, and potentially "losing"
      * the fragment.
      */
-    OB1_MATCHING_LOCK(&comm->matching_lock);
+    held = mca_pml_ob1_matching_lock_peer (comm, proc);
 
 #if OPAL_ENABLE_FT_MPI
     if( OPAL_UNLIKELY((ompi_comm_is_revoked(comm_ptr) && !ompi_request_tag_is_ft(hdr->hdr_tag) )) ||
                       (ompi_comm_coll_revoked(comm_ptr) && ompi_request_tag_is_collective(hdr->hdr_tag)) ) {
-        OPAL_THREAD_UNLOCK(&comm->matching_lock);
+        mca_pml_ob1_matching_unlock (comm, proc, held);
         if( MCA_PML_OB1_HDR_TYPE_MATCH != hdr->hdr_common.hdr_type ) {
             assert( MCA_PML_OB1_HDR_TYPE_RGET == hdr->hdr_common.hdr_type ||
                     MCA_PML_OB1_HDR_TYPE_RNDV == hdr->hdr_common.hdr_type );
@@ -1132,7 +1130,7 @@ static int mca_pml_ob1_recv_frag_match (mca_btl_base_module_t *btl,
             SPC_RECORD(OMPI_SPC_OOS_IN_QUEUE, 1);
             SPC_UPDATE_WATERMARK(OMPI_SPC_MAX_OOS_IN_QUEUE, OMPI_SPC_OOS_IN_QUEUE);
 
-            OB1_MATCHING_UNLOCK(&comm->matching_lock);
+            mca_pml_ob1_matching_unlock (comm, proc, held);
             return OMPI_SUCCESS;
         }
     }
@@ -1140,7 +1138,7 @@ static int mca_pml_ob1_recv_frag_match (mca_btl_base_module_t *btl,
     /* mca_pml_ob1_recv_frag_match_proc() will release the lock. */
     return mca_pml_ob1_recv_frag_match_proc(btl, comm_ptr, proc, hdr,
                                             segments, num_segments,
-                                            type, NULL);
+                                            type, NULL, held);
 }
 
 
@@ -1148,8 +1146,8 @@ static int mca_pml_ob1_recv_frag_match (mca_btl_base_module_t *btl,
  * then try to match the next frag in sequence by looking into arrived
  * out of order frags in frags_cant_match list until it can't find one.
  *
- * ATTENTION: THIS FUNCTION MUST BE CALLED WITH COMMUNICATOR LOCK HELD.
- * THE LOCK WILL BE RELEASED UPON RETURN. USE WITH CARE. */
+ * ATTENTION: THIS FUNCTION MUST BE CALLED WITH THE MATCHING LOCKS HELD
+ * (held). THEY WILL BE RELEASED UPON RETURN. USE WITH CARE. */
 static int
 mca_pml_ob1_recv_frag_match_proc (mca_btl_base_module_t *btl,
                                   ompi_communicator_t* comm_ptr,
@@ -1158,7 +1156,8 @@ mca_pml_ob1_recv_frag_match_proc (mca_btl_base_module_t *btl,
                                   const mca_btl_base_segment_t *segments,
                                   size_t num_segments,
                                   int type,
-                                  mca_pml_ob1_recv_frag_t *frag)
+                                  mca_pml_ob1_recv_frag_t *frag,
+                                  int held)
 {
     /* local variables */
     mca_pml_ob1_comm_t *comm = (mca_pml_ob1_comm_t *)comm_ptr->c_pml_comm;
@@ -1183,7 +1182,7 @@ mca_pml_ob1_recv_frag_match_proc (mca_btl_base_module_t *btl,
     PERUSE_TRACE_MSG_EVENT(PERUSE_COMM_SEARCH_POSTED_Q_BEGIN, comm_ptr,
                            hdr->hdr_src, hdr->hdr_tag, PERUSE_RECV);
 
-    match = match_one(btl, hdr, segments, num_segments, comm_ptr, proc, frag);
+    match = match_one(btl, hdr, segments, num_segments, comm_ptr, proc, frag, held);
 
     /* The match is over. We generate the SEARCH_POSTED_Q_END here,
      * before going into check_cantmatch_for_match we can make a
@@ -1193,7 +1192,7 @@ mca_pml_ob1_recv_frag_match_proc (mca_btl_base_module_t *btl,
                            hdr->hdr_src, hdr->hdr_tag, PERUSE_RECV);
 
     /* release matching lock before processing fragment */
-    OB1_MATCHING_UNLOCK(&comm->matching_lock);
+    mca_pml_ob1_matching_unlock (comm, proc, held);
 
     if(OPAL_LIKELY(match)) {
         switch(type) {
@@ -1218,7 +1217,7 @@ mca_pml_ob1_recv_frag_match_proc (mca_btl_base_module_t *btl,
      * may now be used to form new matches
      */
     if(OPAL_UNLIKELY(NULL != proc->frags_cant_match)) {
-        OB1_MATCHING_LOCK(&comm->matching_lock);
+        held = mca_pml_ob1_matching_lock_peer (comm, proc);
         if((frag = ompi_pml_ob1_check_cantmatch_for_match(proc))) {
             hdr = &frag->hdr.hdr_match;
             segments = frag->segments;
@@ -1227,7 +1226,7 @@ mca_pml_ob1_recv_frag_match_proc (mca_btl_base_module_t *btl,
             type = hdr->hdr_common.hdr_type;
             goto match_this_frag;
         }
-        OB1_MATCHING_UNLOCK(&comm->matching_lock);
+        mca_pml_ob1_matching_unlock (comm, proc, held);
     }
 
     return OMPI_SUCCESS;
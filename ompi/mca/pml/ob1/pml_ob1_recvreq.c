@@ -35,6 +35,7 @@
 
 #include "opal/mca/mpool/mpool.h"
 #include "opal/util/arch.h"
+#include "opal/util/minmax.h"
 #include "ompi/runtime/ompi_spc.h"
 #include "ompi/mca/pml/pml.h"
 #include "ompi/mca/bml/bml.h"
@@ -44,6 +45,7 @@
 #include "pml_ob1_sendreq.h"
 #include "pml_ob1_rdmafrag.h"
 #include "pml_ob1_accelerator.h"
+#include "pml_ob1_smsc.h"
 #include "ompi/mca/bml/base/base.h"
 
 int mca_pml_ob1_accelerator_need_buffers(mca_pml_ob1_recv_request_t* recvreq,
@@ -99,28 +101,36 @@ static int mca_pml_ob1_recv_request_cancel(struct ompi_request_t* ompi_request,
     mca_pml_ob1_recv_request_t* request = (mca_pml_ob1_recv_request_t*)ompi_request;
     ompi_communicator_t *comm = request->req_recv.req_base.req_comm;
     mca_pml_ob1_comm_t *ob1_comm = comm->c_pml_comm;
-
-    /* The rest should be protected behind the match logic lock */
-    OB1_MATCHING_LOCK(&ob1_comm->matching_lock);
+    mca_pml_ob1_comm_proc_t *proc = NULL;
+    int held;
+
+    /* The rest should be protected behind the match logic lock. The wildcard
+     * receive queue is protected by the communicator lock alone. */
+    if( request->req_recv.req_base.req_peer == OMPI_ANY_SOURCE ) {
+        OB1_MATCHING_LOCK(&ob1_comm->matching_lock);
+        held = MCA_PML_OB1_MATCHING_LOCKED_COMM;
+    } else {
+        proc = mca_pml_ob1_peer_lookup (comm, request->req_recv.req_base.req_peer);
+        held = mca_pml_ob1_matching_lock_peer (ob1_comm, proc);
+    }
     if( REQUEST_COMPLETE(ompi_request) ) {
-        OB1_MATCHING_UNLOCK(&ob1_comm->matching_lock);
+        mca_pml_ob1_matching_unlock (ob1_comm, proc, held);
         return OMPI_SUCCESS;
     }
     if( !request->req_match_received ) { /* the match has not been already done */
         assert( OMPI_ANY_TAG == ompi_request->req_status.MPI_TAG ); /* not matched isn't it */
-#if MCA_PML_OB1_CUSTOM_MATCH
-        custom_match_prq_cancel(ob1_comm->prq, request);
-#else
-        if( request->req_recv.req_base.req_peer == OMPI_ANY_SOURCE ) {
+        if( NULL != ob1_comm->match ) {
+            ob1_comm->match->prq_cancel(ob1_comm->prq, request, request->req_recv.req_base.req_tag,
+                                        request->req_recv.req_base.req_peer);
+        } else if( request->req_recv.req_base.req_peer == OMPI_ANY_SOURCE ) {
             opal_list_remove_item( &ob1_comm->wild_receives, (opal_list_item_t*)request );
+            mca_pml_ob1_matching_wild_update (ob1_comm, -1);
         } else {
-            mca_pml_ob1_comm_proc_t* proc = mca_pml_ob1_peer_lookup (comm, request->req_recv.req_base.req_peer);
             opal_list_remove_item(&proc->specific_receives, (opal_list_item_t*)request);
         }
-#endif
         PERUSE_TRACE_COMM_EVENT( PERUSE_COMM_REQ_REMOVE_FROM_POSTED_Q,
                                 &(request->req_recv.req_base), PERUSE_RECV );
-        OB1_MATCHING_UNLOCK(&ob1_comm->matching_lock);
+        mca_pml_ob1_matching_unlock (ob1_comm, proc, held);
 #if OPAL_ENABLE_FT_MPI
         opal_output_verbose(10, ompi_ftmpi_output_handle,
                             "Recv_request_cancel: cancel granted for request %p because it has not matched\n",
@@ -128,7 +138,7 @@ static int mca_pml_ob1_recv_request_cancel(struct ompi_request_t* ompi_request,
 #endif
     }
     else { /* it has matched */
-        OB1_MATCHING_UNLOCK(&ob1_comm->matching_lock);
+        mca_pml_ob1_matching_unlock (ob1_comm, proc, held);
 #if OPAL_ENABLE_FT_MPI
         if( ompi_comm_is_proc_active( comm, request->req_recv.req_base.req_peer,
                                               OMPI_COMM_IS_INTER(comm) ) ) {
@@ -681,6 +691,92 @@ void mca_pml_ob1_recv_request_frag_copy_finished( mca_btl_base_module_t* btl,
     }
 }
 
+/**
+ * Copy a message described by the sender's io vector directly into the
+ * receive buffer with a single scatter-gather operation.
+ *
+ * @returns OMPI_SUCCESS if the message was delivered or an error if the
+ * message has to be delivered with the copy in/out protocol instead
+ */
+static int mca_pml_ob1_recv_request_get_iov (mca_pml_ob1_recv_request_t *recvreq,
+                                             mca_btl_base_module_t *btl,
+                                             const mca_pml_ob1_rget_hdr_t *hdr)
+{
+    ompi_proc_t *proc = (ompi_proc_t *) recvreq->req_recv.req_base.req_proc;
+    size_t msg_length = hdr->hdr_rndv.hdr_msg_length, local_count, remote_count, length;
+    struct iovec *local_iov, *remote_iov;
+    mca_bml_base_endpoint_t *bml_endpoint;
+    mca_smsc_endpoint_t *endpoint;
+    mca_bml_base_btl_t *bml_btl;
+    uint64_t count64;
+    int rc;
+
+    if (!mca_pml_ob1_smsc_iov_usable (proc, &recvreq->req_recv.req_base.req_convertor, msg_length)) {
+        return OMPI_ERR_NOT_SUPPORTED;
+    }
+
+    endpoint = mca_pml_ob1_smsc_get_endpoint (proc);
+    bml_endpoint = mca_bml_base_get_endpoint (proc);
+    bml_btl = mca_bml_base_btl_array_find (&bml_endpoint->btl_eager, btl);
+    if (OPAL_UNLIKELY(NULL == endpoint || NULL == bml_btl)) {
+        return OMPI_ERR_NOT_SUPPORTED;
+    }
+
+    memcpy (&count64, hdr + 1, sizeof (count64));
+    /* every entry describes at least one byte and the sender never uses more entries than
+     * the limit, anything else is a bogus header and gets the copy in/out protocol */
+    if (OPAL_UNLIKELY(0 == count64 || count64 > msg_length
+                      || count64 > MCA_PML_OB1_SMSC_IOV_LIMIT)) {
+        opal_output_verbose (10, mca_pml_ob1_output,
+                             "pml:ob1: rejecting a single-copy io vector of %" PRIu64
+                             " entries for a message of %" PRIsize_t " bytes", count64, msg_length);
+        return OMPI_ERR_BAD_PARAM;
+    }
+    remote_count = (size_t) count64;
+
+    remote_iov = (struct iovec *) malloc (remote_count * sizeof (*remote_iov));
+    if (OPAL_UNLIKELY(NULL == remote_iov)) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+
+    rc = MCA_SMSC_CALL(copy_from, endpoint, remote_iov, (void *)(intptr_t) hdr->hdr_src_ptr,
+                       remote_count * sizeof (*remote_iov), NULL);
+    if (OPAL_SUCCESS == rc) {
+        rc = mca_pml_ob1_smsc_build_iov (recvreq->req_recv.req_base.req_datatype,
+                                         recvreq->req_recv.req_base.req_count,
+                                         recvreq->req_recv.req_base.req_addr, 0,
+                                         &local_iov, &local_count);
+    }
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != rc)) {
+        free (remote_iov);
+        return rc;
+    }
+
+    /* a truncated receive only gets the data that fits into the receive buffer */
+    length = opal_min(msg_length, recvreq->req_bytes_expected);
+    mca_pml_ob1_smsc_truncate_iov (local_iov, &local_count, length);
+    mca_pml_ob1_smsc_truncate_iov (remote_iov, &remote_count, length);
+
+    rc = MCA_SMSC_CALL(copy_from_iov, endpoint, local_iov, local_count, remote_iov,
+                       remote_count, NULL);
+    free (local_iov);
+    free (remote_iov);
+    if (OPAL_UNLIKELY(OPAL_SUCCESS != rc)) {
+        /* nothing has been acknowledged yet so the data can still be sent the regular way */
+        return rc;
+    }
+
+    /* the entire message is accounted for. the sender releases its buffer on the fin */
+    OPAL_THREAD_ADD_FETCH_SIZE_T(&recvreq->req_bytes_received, msg_length);
+    SPC_USER_OR_MPI(recvreq->req_recv.req_base.req_tag, (ompi_spc_value_t)msg_length,
+                    OMPI_SPC_BYTES_RECEIVED_USER, OMPI_SPC_BYTES_RECEIVED_MPI);
+    mca_pml_ob1_send_fin (proc, bml_btl, hdr->hdr_frag, msg_length, 0, 0);
+
+    recv_request_pml_complete_check (recvreq);
+
+    return OMPI_SUCCESS;
+}
+
 /*
  * Update the recv request status to reflect the number of bytes
  * received and actually delivered to the application.
@@ -705,6 +801,15 @@ void mca_pml_ob1_recv_request_progress_rget( mca_pml_ob1_recv_request_t* recvreq
 
     MCA_PML_OB1_RECV_REQUEST_MATCHED(recvreq, &hdr->hdr_rndv.hdr_match);
 
+    if (hdr->hdr_rndv.hdr_match.hdr_common.hdr_flags & MCA_PML_OB1_HDR_FLAGS_IOV) {
+        /* the sender describes its buffer with an io vector. fall back on copy in/out
+         * if it can not be read directly */
+        if (OMPI_SUCCESS != mca_pml_ob1_recv_request_get_iov (recvreq, btl, hdr)) {
+            mca_pml_ob1_recv_request_ack(recvreq, btl, &hdr->hdr_rndv, 0);
+        }
+        return;
+    }
+
     /* if receive buffer is not contiguous we can't just RDMA read into it, so
      * fall back to copy in/out protocol. It is a pity because buffer on the
      * sender side is already registered. We need to be smarter here, perhaps
@@ -1133,24 +1238,22 @@ static inline void append_recv_req_to_queue(opal_list_t *queue,
  *  function has to be called with the communicator matching lock held.
 */
 
-#if MCA_PML_OB1_CUSTOM_MATCH
 static mca_pml_ob1_recv_frag_t*
 recv_req_match_specific_proc( const mca_pml_ob1_recv_request_t *req,
                               mca_pml_ob1_comm_proc_t *proc,
-                              custom_match_umq_node** hold_prev,
-                              custom_match_umq_node** hold_elem,
-                              int* hold_index)
-#else
-static mca_pml_ob1_recv_frag_t*
-recv_req_match_specific_proc( const mca_pml_ob1_recv_request_t *req,
-                              mca_pml_ob1_comm_proc_t *proc )
-#endif
+                              mca_pml_ob1_match_hold_t *hold )
 {
+    mca_pml_ob1_comm_t *comm = req->req_recv.req_base.req_comm->c_pml_comm;
+
     if (NULL == proc) {
         return NULL;
     }
 
-#if !MCA_PML_OB1_CUSTOM_MATCH
+    if (NULL != comm->match) {
+        return comm->match->umq_find(comm->umq, req->req_recv.req_base.req_tag,
+                                     req->req_recv.req_base.req_peer, hold);
+    }
+
     int tag = req->req_recv.req_base.req_tag;
     opal_list_t* unexpected_frags = &proc->unexpected_frags;
     mca_pml_ob1_recv_frag_t* frag;
@@ -1171,50 +1274,36 @@ recv_req_match_specific_proc( const mca_pml_ob1_recv_request_t *req,
         }
     }
     return NULL;
-#else
-    return custom_match_umq_find_verify_hold(req->req_recv.req_base.req_comm->c_pml_comm->umq,
-                                             req->req_recv.req_base.req_tag,
-                                             req->req_recv.req_base.req_peer,
-                                             hold_prev, hold_elem, hold_index);
-#endif
 }
 
 /*
  * this routine is used to try and match a wild posted receive - where
  * wild is determined by the value assigned to the source process
 */
-#if MCA_PML_OB1_CUSTOM_MATCH
 static mca_pml_ob1_recv_frag_t*
 recv_req_match_wild( mca_pml_ob1_recv_request_t* req,
                      mca_pml_ob1_comm_proc_t **p,
-                     custom_match_umq_node** hold_prev,
-                     custom_match_umq_node** hold_elem,
-                     int* hold_index)
-#else
-static mca_pml_ob1_recv_frag_t*
-recv_req_match_wild( mca_pml_ob1_recv_request_t* req,
-                     mca_pml_ob1_comm_proc_t **p)
-#endif
+                     mca_pml_ob1_match_hold_t *hold)
 {
     mca_pml_ob1_comm_t *comm = (mca_pml_ob1_comm_t *) req->req_recv.req_base.req_comm->c_pml_comm;
     mca_pml_ob1_comm_proc_t **procp = (mca_pml_ob1_comm_proc_t **) comm->procs;
 
-#if MCA_PML_OB1_CUSTOM_MATCH
-    mca_pml_ob1_recv_frag_t* frag;
-    frag = custom_match_umq_find_verify_hold (comm->umq, req->req_recv.req_base.req_tag,
-                                              req->req_recv.req_base.req_peer,
-                                              hold_prev, hold_elem, hold_index);
-
-    if (frag) {
-        *p = procp[frag->hdr.hdr_match.hdr_src];
-        req->req_recv.req_base.req_proc = procp[frag->hdr.hdr_match.hdr_src]->ompi_proc;
-        prepare_recv_req_converter(req);
-    } else {
-        *p = NULL;
+    if (NULL != comm->match) {
+        mca_pml_ob1_recv_frag_t* frag;
+        frag = comm->match->umq_find (comm->umq, req->req_recv.req_base.req_tag,
+                                      req->req_recv.req_base.req_peer, hold);
+
+        if (frag) {
+            *p = procp[frag->hdr.hdr_match.hdr_src];
+            req->req_recv.req_base.req_proc = procp[frag->hdr.hdr_match.hdr_src]->ompi_proc;
+            prepare_recv_req_converter(req);
+        } else {
+            *p = NULL;
+        }
+
+        return frag;
     }
 
-    return frag;
-#else
 
     /*
      * Loop over all the outstanding messages to find one that matches.
@@ -1228,7 +1317,7 @@ recv_req_match_wild( mca_pml_ob1_recv_request_t* req,
         mca_pml_ob1_recv_frag_t* frag;
 
         /* loop over messages from the current proc */
-        if((frag = recv_req_match_specific_proc(req, procp[i]))) {
+        if((frag = recv_req_match_specific_proc(req, procp[i], hold))) {
             *p = procp[i];
             comm->last_probed = i;
             req->req_recv.req_base.req_proc = procp[i]->ompi_proc;
@@ -1240,7 +1329,7 @@ recv_req_match_wild( mca_pml_ob1_recv_request_t* req,
         mca_pml_ob1_recv_frag_t* frag;
 
         /* loop over messages from the current proc */
-        if((frag = recv_req_match_specific_proc(req, procp[i]))) {
+        if((frag = recv_req_match_specific_proc(req, procp[i], hold))) {
             *p = procp[i];
             comm->last_probed = i;
             req->req_recv.req_base.req_proc = procp[i]->ompi_proc;
@@ -1251,7 +1340,6 @@ recv_req_match_wild( mca_pml_ob1_recv_request_t* req,
 
     *p = NULL;
     return NULL;
-#endif
 }
 
 
@@ -1262,13 +1350,9 @@ void mca_pml_ob1_recv_req_start(mca_pml_ob1_recv_request_t *req)
     mca_pml_ob1_comm_proc_t* proc;
     mca_pml_ob1_recv_frag_t* frag;
     mca_pml_ob1_hdr_t* hdr;
-#if MCA_PML_OB1_CUSTOM_MATCH
-    custom_match_umq_node* hold_prev;
-    custom_match_umq_node* hold_elem;
-    int hold_index;
-#else
+    mca_pml_ob1_match_hold_t hold;
     opal_list_t *queue;
-#endif
+    int held;
 
     /* init/re-init the request */
     req->req_lock = 0;
@@ -1282,7 +1366,13 @@ void mca_pml_ob1_recv_req_start(mca_pml_ob1_recv_request_t *req)
 
     MCA_PML_BASE_RECV_START(&req->req_recv);
 
-    OB1_MATCHING_LOCK(&ob1_comm->matching_lock);
+    if (OMPI_ANY_SOURCE == req->req_recv.req_base.req_peer) {
+        proc = NULL;
+        held = mca_pml_ob1_matching_lock_all (ob1_comm);
+    } else {
+        proc = mca_pml_ob1_peer_lookup (comm, req->req_recv.req_base.req_peer);
+        held = mca_pml_ob1_matching_lock_peer (ob1_comm, proc);
+    }
     /**
      * The laps of time between the ACTIVATE event and the SEARCH_UNEX one include
      * the cost of the request lock.
@@ -1290,8 +1380,15 @@ void mca_pml_ob1_recv_req_start(mca_pml_ob1_recv_request_t *req)
     PERUSE_TRACE_COMM_EVENT(PERUSE_COMM_SEARCH_UNEX_Q_BEGIN,
                             &(req->req_recv.req_base), PERUSE_RECV);
 
-    /* assign sequence number */
-    req->req_recv.req_base.req_sequence = ob1_comm->recv_sequence++;
+    /* assign sequence number. receives from different peers may be posted
+     * concurrently with peer_matching but the wildcard receives are ordered
+     * by the communicator lock. */
+    if (ob1_comm->peer_matching) {
+        req->req_recv.req_base.req_sequence =
+            (uint32_t) OPAL_THREAD_ADD_FETCH32((opal_atomic_int32_t *) &ob1_comm->recv_sequence, 1) - 1;
+    } else {
+        req->req_recv.req_base.req_sequence = ob1_comm->recv_sequence++;
+    }
 
 #if OPAL_ENABLE_FT_MPI
     /* if the communicator is not in a good state (revoked or coll_revoked), do not
@@ -1307,7 +1404,7 @@ void mca_pml_ob1_recv_req_start(mca_pml_ob1_recv_request_t *req)
             recv_request_pml_complete( req );
             PERUSE_TRACE_COMM_EVENT(PERUSE_COMM_SEARCH_UNEX_Q_END,
                                     &(req->req_recv.req_base), PERUSE_RECV);
-            OB1_MATCHING_UNLOCK(&ob1_comm->matching_lock);
+            mca_pml_ob1_matching_unlock (ob1_comm, proc, held);
             return;
         }
     }
@@ -1316,12 +1413,8 @@ void mca_pml_ob1_recv_req_start(mca_pml_ob1_recv_request_t *req)
 
     /* attempt to match posted recv */
     if(req->req_recv.req_base.req_peer == OMPI_ANY_SOURCE) {
-#if MCA_PML_OB1_CUSTOM_MATCH
-        frag = recv_req_match_wild(req, &proc, &hold_prev, &hold_elem, &hold_index);
-#else
-        frag = recv_req_match_wild(req, &proc);
+        frag = recv_req_match_wild(req, &proc, &hold);
         queue = &ob1_comm->wild_receives;
-#endif
 #if !OPAL_ENABLE_HETEROGENEOUS_SUPPORT
         /* As we are in a homogeneous environment we know that all remote
          * architectures are exactly the same as the local one. Therefore,
@@ -1334,16 +1427,19 @@ void mca_pml_ob1_recv_req_start(mca_pml_ob1_recv_request_t *req)
         }
 #endif  /* !OPAL_ENABLE_HETEROGENEOUS_SUPPORT */
     } else {
-        proc = mca_pml_ob1_peer_lookup (comm, req->req_recv.req_base.req_peer);
+        /* a persistent request restarted for the same peer keeps its convertor */
+        bool prepared = req->req_recv.req_base.req_ompi.req_persistent &&
+            req->req_recv.req_base.req_proc == proc->ompi_proc;
+
         req->req_recv.req_base.req_proc = proc->ompi_proc;
-#if MCA_PML_OB1_CUSTOM_MATCH
-        frag = recv_req_match_specific_proc(req, proc, &hold_prev, &hold_elem, &hold_index);
-#else
-        frag = recv_req_match_specific_proc(req, proc);
+        frag = recv_req_match_specific_proc(req, proc, &hold);
         queue = &proc->specific_receives;
-#endif
         /* wildcard recv will be prepared on match */
-        prepare_recv_req_converter(req);
+        if (prepared) {
+            restart_recv_req_converter(req);
+        } else {
+            prepare_recv_req_converter(req);
+        }
     }
 
     if(OPAL_UNLIKELY(NULL == frag)) {
@@ -1352,16 +1448,20 @@ void mca_pml_ob1_recv_req_start(mca_pml_ob1_recv_request_t *req)
         /* We didn't find any matches.  Record this irecv so we can match
            it when the message comes in. */
         if(OPAL_LIKELY(req->req_recv.req_base.req_type != MCA_PML_REQUEST_IPROBE &&
-                       req->req_recv.req_base.req_type != MCA_PML_REQUEST_IMPROBE))
-#if MCA_PML_OB1_CUSTOM_MATCH
-            custom_match_prq_append(ob1_comm->prq, req,
-                                    req->req_recv.req_base.req_tag,
-                                    req->req_recv.req_base.req_peer);
-#else
-            append_recv_req_to_queue(queue, req);
-#endif
+                       req->req_recv.req_base.req_type != MCA_PML_REQUEST_IMPROBE)) {
+            if (NULL != ob1_comm->match) {
+                ob1_comm->match->prq_append(ob1_comm->prq, req,
+                                            req->req_recv.req_base.req_tag,
+                                            req->req_recv.req_base.req_peer);
+            } else {
+                append_recv_req_to_queue(queue, req);
+                if (queue == &ob1_comm->wild_receives) {
+                    mca_pml_ob1_matching_wild_update (ob1_comm, 1);
+                }
+            }
+        }
         req->req_match_received = false;
-        OB1_MATCHING_UNLOCK(&ob1_comm->matching_lock);
+        mca_pml_ob1_matching_unlock (ob1_comm, proc, held);
     } else {
         if(OPAL_LIKELY(!IS_PROB_REQ(req))) {
             PERUSE_TRACE_COMM_EVENT(PERUSE_COMM_REQ_MATCH_UNEX,
@@ -1377,14 +1477,14 @@ void mca_pml_ob1_recv_req_start(mca_pml_ob1_recv_request_t *req)
             PERUSE_TRACE_COMM_EVENT(PERUSE_COMM_SEARCH_UNEX_Q_END,
                                     &(req->req_recv.req_base), PERUSE_RECV);
 
-#if MCA_PML_OB1_CUSTOM_MATCH
-            custom_match_umq_remove_hold(req->req_recv.req_base.req_comm->c_pml_comm->umq, hold_prev, hold_elem, hold_index);
-#else
-            opal_list_remove_item(&proc->unexpected_frags,
-                                  (opal_list_item_t*)frag);
-#endif
+            if (NULL != ob1_comm->match) {
+                ob1_comm->match->umq_remove(ob1_comm->umq, &hold);
+            } else {
+                opal_list_remove_item(&proc->unexpected_frags,
+                                      (opal_list_item_t*)frag);
+            }
             SPC_RECORD(OMPI_SPC_UNEXPECTED_IN_QUEUE, -1);
-            OB1_MATCHING_UNLOCK(&ob1_comm->matching_lock);
+            mca_pml_ob1_matching_unlock (ob1_comm, proc, held);
 
             switch(hdr->hdr_common.hdr_type) {
             case MCA_PML_OB1_HDR_TYPE_MATCH:
@@ -1413,21 +1513,21 @@ void mca_pml_ob1_recv_req_start(mca_pml_ob1_recv_request_t *req)
                "recreated" as a receive request, and the frag will be
                restarted with this request during mrecv */
 
-#if MCA_PML_OB1_CUSTOM_MATCH
-            custom_match_umq_remove_hold(req->req_recv.req_base.req_comm->c_pml_comm->umq, hold_prev, hold_elem, hold_index);
-#else
-            opal_list_remove_item(&proc->unexpected_frags,
-                                  (opal_list_item_t*)frag);
-#endif
+            if (NULL != ob1_comm->match) {
+                ob1_comm->match->umq_remove(ob1_comm->umq, &hold);
+            } else {
+                opal_list_remove_item(&proc->unexpected_frags,
+                                      (opal_list_item_t*)frag);
+            }
             SPC_RECORD(OMPI_SPC_UNEXPECTED_IN_QUEUE, -1);
-            OB1_MATCHING_UNLOCK(&ob1_comm->matching_lock);
+            mca_pml_ob1_matching_unlock (ob1_comm, proc, held);
 
             req->req_recv.req_base.req_addr = frag;
             mca_pml_ob1_recv_request_matched_probe(req, frag->btl,
                                                    frag->segments, frag->num_segments);
 
         } else {
-            OB1_MATCHING_UNLOCK(&ob1_comm->matching_lock);
+            mca_pml_ob1_matching_unlock (ob1_comm, proc, held);
             mca_pml_ob1_recv_request_matched_probe(req, frag->btl,
                                                    frag->segments, frag->num_segments);
         }
@@ -239,6 +239,21 @@ static inline void prepare_recv_req_converter(mca_pml_ob1_recv_request_t *req)
     }
 }
 
+/**
+ * Move the convertor prepared by the previous start of a persistent request
+ * back to the beginning of the user buffer.
+ */
+static inline void restart_recv_req_converter(mca_pml_ob1_recv_request_t *req)
+{
+    if( req->req_recv.req_base.req_datatype->super.size | req->req_recv.req_base.req_count ) {
+        size_t offset = 0;
+
+        opal_convertor_set_position(&req->req_recv.req_base.req_convertor, &offset);
+        opal_convertor_get_packed_size(&req->req_recv.req_base.req_convertor,
+                                       &req->req_bytes_expected);
+    }
+}
+
 #define MCA_PML_OB1_RECV_REQUEST_MATCHED(request, hdr) \
     recv_req_matched(request, hdr)
 
@@ -34,6 +34,7 @@
 #include "opal/prefetch.h"
 #include "opal/mca/mpool/mpool.h"
 #include "ompi/runtime/ompi_spc.h"
+#include "ompi/runtime/ompi_async_progress.h"
 #include "ompi/constants.h"
 #include "ompi/mca/pml/pml.h"
 #include "pml_ob1.h"
@@ -182,6 +183,7 @@ static void mca_pml_ob1_send_request_construct(mca_pml_ob1_send_request_t* req)
     req->req_rdma_cnt = 0;
     req->req_throttle_sends = false;
     req->rdma_frag = NULL;
+    req->req_sc_iov = NULL;
     OBJ_CONSTRUCT(&req->req_send_ranges, opal_list_t);
     OBJ_CONSTRUCT(&req->req_send_range_lock, opal_mutex_t);
 }
@@ -920,6 +922,112 @@ int mca_pml_ob1_send_request_start_rdma( mca_pml_ob1_send_request_t* sendreq,
         return rc;
     }
 
+    /* the completion depends on the receiver, progress it in the background */
+    ompi_async_progress_wakeup();
+
+    return OMPI_SUCCESS;
+}
+
+
+/**
+ *  Non-contiguous data to a local peer - describe the user buffer with an
+ *  io vector and let the receiver pull the data with a single-copy
+ *  scatter-gather operation.
+ */
+
+int mca_pml_ob1_send_request_start_iov( mca_pml_ob1_send_request_t* sendreq,
+                                        mca_bml_base_btl_t* bml_btl )
+{
+    const bool need_ext_match = MCA_PML_OB1_SEND_REQUEST_REQUIRES_EXT_MATCH(sendreq);
+    size_t hdr_size = sizeof (mca_pml_ob1_rget_hdr_t), iov_count;
+    mca_btl_base_descriptor_t *des;
+    mca_pml_ob1_rdma_frag_t *frag;
+    mca_pml_ob1_hdr_t *hdr;
+    mca_pml_ob1_rget_hdr_t *hdr_rget;
+    struct iovec *iov;
+    uint64_t iov_count64;
+    int rc;
+
+    rc = mca_pml_ob1_smsc_build_iov (sendreq->req_send.req_base.req_datatype,
+                                     sendreq->req_send.req_base.req_count,
+                                     sendreq->req_send.req_addr, mca_pml_ob1.smsc_iov_max,
+                                     &iov, &iov_count);
+    if (OMPI_SUCCESS != rc) {
+        /* too fragmented or no memory. use the regular rendezvous protocol */
+        return OMPI_ERR_NOT_SUPPORTED;
+    }
+
+    /* allocate an rdma fragment to keep track of the request size for use in the fin message */
+    MCA_PML_OB1_RDMA_FRAG_ALLOC(frag);
+    if (OPAL_UNLIKELY(NULL == frag)) {
+        free (iov);
+        return OPAL_ERR_OUT_OF_RESOURCE;
+    }
+
+    frag->rdma_req = sendreq;
+    frag->rdma_bml = bml_btl;
+    frag->rdma_length = sendreq->req_send.req_bytes_packed;
+    frag->rdma_bytes_remaining = sendreq->req_send.req_bytes_packed;
+    frag->cbfunc = mca_pml_ob1_rget_completion;
+
+    if (OPAL_UNLIKELY(need_ext_match)) {
+        hdr_size = sizeof (hdr->hdr_ext_rget);
+    }
+
+    /* the number of io vector entries follows the header */
+    hdr_size += sizeof (iov_count64);
+
+    mca_bml_base_alloc(bml_btl, &des, MCA_BTL_NO_ORDER, hdr_size,
+                       MCA_BTL_DES_FLAGS_PRIORITY | MCA_BTL_DES_FLAGS_BTL_OWNERSHIP |
+                       MCA_BTL_DES_FLAGS_SIGNAL);
+    if( OPAL_UNLIKELY(NULL == des) ) {
+        MCA_PML_OB1_RDMA_FRAG_RETURN(frag);
+        free (iov);
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+
+    /* the io vector must stay valid until the receiver has read it. it is released by
+     * mca_pml_ob1_free_rdma_resources */
+    sendreq->req_sc_iov = iov;
+    /* save the fragment for the fallback to copy in/out */
+    sendreq->rdma_frag = frag;
+
+    hdr = (mca_pml_ob1_hdr_t *) des->des_segments->seg_addr.pval;
+    if (need_ext_match) {
+        hdr_rget = &hdr->hdr_ext_rget.hdr_rget;
+        mca_pml_ob1_cid_hdr_prepare (&hdr->hdr_cid, sendreq->req_send.req_base.req_comm);
+    } else {
+        hdr_rget = &hdr->hdr_rget;
+    }
+
+    /* the source pointer refers to the io vector and not to the data */
+    iov_count64 = iov_count;
+    mca_pml_ob1_rget_hdr_prepare (hdr_rget, MCA_PML_OB1_HDR_FLAGS_IOV,
+                                  sendreq->ob1_proc->comm_index,
+                                  sendreq->req_send.req_base.req_comm->c_my_rank,
+                                  sendreq->req_send.req_base.req_tag,
+                                  (uint16_t)sendreq->req_send.req_base.req_sequence,
+                                  sendreq->req_send.req_bytes_packed, sendreq,
+                                  frag, iov, &iov_count64, sizeof (iov_count64));
+
+    ob1_hdr_hton(hdr, hdr->hdr_common.hdr_type, sendreq->req_send.req_base.req_proc);
+
+    des->des_cbfunc = mca_pml_ob1_send_ctl_completion;
+    des->des_cbdata = sendreq;
+
+    PERUSE_TRACE_COMM_EVENT( PERUSE_COMM_REQ_XFER_BEGIN,
+                             &(sendreq->req_send.req_base), PERUSE_SEND );
+
+    rc = mca_bml_base_send(bml_btl, des, hdr->hdr_common.hdr_type);
+    if (OPAL_UNLIKELY(rc < 0)) {
+        MCA_PML_OB1_RDMA_FRAG_RETURN(frag);
+        sendreq->rdma_frag = NULL;
+        free (sendreq->req_sc_iov);
+        sendreq->req_sc_iov = NULL;
+        mca_bml_base_free(bml_btl, des);
+        return rc;
+    }
+
     return OMPI_SUCCESS;
 }
 
@@ -1007,6 +1115,8 @@ int mca_pml_ob1_send_request_start_rndv( mca_pml_ob1_send_request_t* sendreq,
         if( OPAL_LIKELY( 1 == rc ) ) {
             mca_pml_ob1_rndv_completion_request( bml_btl, sendreq, size );
         }
+        /* the rest of the message waits for the ack of the receiver */
+        ompi_async_progress_wakeup();
         return OMPI_SUCCESS;
     }
     mca_bml_base_free(bml_btl, des );
@@ -32,6 +32,7 @@
 #include "pml_ob1_hdr.h"
 #include "pml_ob1_rdma.h"
 #include "pml_ob1_rdmafrag.h"
+#include "pml_ob1_smsc.h"
 #include "ompi/mca/bml/bml.h"
 #include "ompi/memchecker.h"
 
@@ -43,6 +44,12 @@ typedef enum {
     MCA_PML_OB1_SEND_PENDING_START
 } mca_pml_ob1_send_pending_t;
 
+struct mca_pml_ob1_send_request_t;
+
+/** Start the eager protocol of a request on a BTL */
+typedef int (*mca_pml_ob1_send_request_start_fn_t)(struct mca_pml_ob1_send_request_t *sendreq,
+                                                   mca_bml_base_btl_t *bml_btl, size_t size);
+
 struct mca_pml_ob1_send_request_t {
     mca_pml_base_send_request_t req_send;
     mca_bml_base_endpoint_t* req_endpoint;
@@ -58,6 +65,11 @@ struct mca_pml_ob1_send_request_t {
     opal_mutex_t req_send_range_lock;
     opal_list_t req_send_ranges;
     mca_pml_ob1_rdma_frag_t *rdma_frag;
+    /** io vector describing the user buffer to the peer (single-copy transfers) */
+    struct iovec *req_sc_iov;
+    /** eager BTL and protocol of a persistent request, selected on its first start */
+    mca_bml_base_btl_t *req_persist_btl;
+    mca_pml_ob1_send_request_start_fn_t req_persist_start;
     /** The size of this array is set from mca_pml_ob1.max_rdma_per_request */
     mca_pml_ob1_com_btl_t req_rdma[];
 };
@@ -159,6 +171,8 @@ get_request_from_send_pending(mca_pml_ob1_send_pending_t *type)
                                        0); /* convertor_flags */        \
         (sendreq)->req_recv.pval = NULL;                                \
         (sendreq)->ob1_proc = ob1_proc;                                 \
+        (sendreq)->req_persist_btl = NULL;                              \
+        (sendreq)->req_persist_start = NULL;                            \
     }
 
 #define MCA_PML_OB1_SEND_REQUEST_RESET(sendreq)                         \
@@ -181,6 +195,11 @@ static inline void mca_pml_ob1_free_rdma_resources (mca_pml_ob1_send_request_t*
         }
     }
     sendreq->req_rdma_cnt = 0;
+
+    if (NULL != sendreq->req_sc_iov) {
+        free(sendreq->req_sc_iov);
+        sendreq->req_sc_iov = NULL;
+    }
 }
 
 
@@ -386,6 +405,10 @@ int mca_pml_ob1_send_request_start_rndv(
     size_t size,
     int flags);
 
+int mca_pml_ob1_send_request_start_iov(
+    mca_pml_ob1_send_request_t* sendreq,
+    mca_bml_base_btl_t* bml_btl);
+
 static inline int
 mca_pml_ob1_send_request_start_btl( mca_pml_ob1_send_request_t* sendreq,
                                     mca_bml_base_btl_t* bml_btl )
@@ -451,6 +474,15 @@ mca_pml_ob1_send_request_start_btl( mca_pml_ob1_send_request_t* sendreq,
             if (sendreq->req_send.req_base.req_convertor.flags & CONVERTOR_ACCELERATOR) {
                 return mca_pml_ob1_send_request_start_accelerator(sendreq, bml_btl, size);
             }
+            if (mca_pml_ob1_smsc_iov_usable(sendreq->req_send.req_base.req_proc,
+                                            &sendreq->req_send.req_base.req_convertor,
+                                            sendreq->req_send.req_bytes_packed)) {
+                /* let the receiver copy directly out of the user buffer */
+                rc = mca_pml_ob1_send_request_start_iov(sendreq, bml_btl);
+                if (OMPI_ERR_NOT_SUPPORTED != rc) {
+                    return rc;
+                }
+            }
             rc = mca_pml_ob1_send_request_start_rndv(sendreq, bml_btl, size, 0);
         }
     }
@@ -458,8 +490,8 @@ mca_pml_ob1_send_request_start_btl( mca_pml_ob1_send_request_t* sendreq,
     return rc;
 }
 
-static inline int
-mca_pml_ob1_send_request_start_seq (mca_pml_ob1_send_request_t* sendreq, mca_bml_base_endpoint_t* endpoint, int32_t seqn)
+static inline void
+mca_pml_ob1_send_request_reset (mca_pml_ob1_send_request_t* sendreq, mca_bml_base_endpoint_t* endpoint, int32_t seqn)
 {
     sendreq->req_endpoint = endpoint;
     sendreq->req_state = 0;
@@ -470,6 +502,12 @@ mca_pml_ob1_send_request_start_seq (mca_pml_ob1_send_request_t* sendreq, mca_bml
     sendreq->req_send.req_base.req_sequence = seqn;
 
     MCA_PML_BASE_SEND_START( &sendreq->req_send );
+}
+
+static inline int
+mca_pml_ob1_send_request_start_seq (mca_pml_ob1_send_request_t* sendreq, mca_bml_base_endpoint_t* endpoint, int32_t seqn)
+{
+    mca_pml_ob1_send_request_reset (sendreq, endpoint, seqn);
 
     for(size_t i = 0; i < mca_bml_base_btl_array_get_size(&endpoint->btl_eager); i++) {
         mca_bml_base_btl_t* bml_btl;
@@ -530,6 +568,106 @@ mca_pml_ob1_send_request_start( mca_pml_ob1_send_request_t* sendreq )
     return mca_pml_ob1_send_request_start_seq (sendreq, endpoint, seqn);
 }
 
+/**
+ * Select the eager BTL and protocol of a persistent request. The selection is
+ * only cached for peers reachable through a single eager BTL and for messages
+ * sent eagerly without synchronization or buffering, for which it depends on
+ * nothing but the request and the BTL.
+ */
+static inline void
+mca_pml_ob1_send_request_persist_select (mca_pml_ob1_send_request_t* sendreq,
+                                         mca_bml_base_endpoint_t* endpoint)
+{
+    size_t size = sendreq->req_send.req_bytes_packed;
+    mca_bml_base_btl_t* bml_btl;
+    size_t eager_limit;
+
+    sendreq->req_persist_btl = NULL;
+    sendreq->req_persist_start = NULL;
+
+    if (1 != mca_bml_base_btl_array_get_size(&endpoint->btl_eager) ||
+        (sendreq->req_send.req_base.req_convertor.flags & CONVERTOR_ACCELERATOR)) {
+        return;
+    }
+    bml_btl = mca_bml_base_btl_array_get_index(&endpoint->btl_eager, 0);
+    eager_limit = bml_btl->btl->btl_eager_limit - sizeof(mca_pml_ob1_hdr_t);
+    if (size > eager_limit) {
+        return;
+    }
+
+    switch(sendreq->req_send.req_send_mode) {
+    case MCA_PML_BASE_SEND_COMPLETE:
+        sendreq->req_persist_start = mca_pml_ob1_send_request_start_prepare;
+        break;
+    case MCA_PML_BASE_SEND_READY:
+    case MCA_PML_BASE_SEND_STANDARD:
+        if (size != 0 && bml_btl->btl_flags & MCA_BTL_FLAGS_SEND_INPLACE) {
+            sendreq->req_persist_start = mca_pml_ob1_send_request_start_prepare;
+        } else {
+            sendreq->req_persist_start = mca_pml_ob1_send_request_start_copy;
+        }
+        break;
+    default:
+        return;
+    }
+    sendreq->req_persist_btl = bml_btl;
+}
+
+/**
+ * Start a persistent request. The convertor was prepared when the request was
+ * created, and the eager BTL and protocol are selected on the first start, so
+ * restarting a small message only resets the state of the request. The
+ * selection is made again if the BTLs of the peer changed.
+ */
+static inline int
+mca_pml_ob1_send_request_start_persistent( mca_pml_ob1_send_request_t* sendreq )
+{
+    mca_bml_base_endpoint_t *endpoint = mca_bml_base_get_endpoint (sendreq->req_send.req_base.req_proc);
+    mca_bml_base_btl_t *bml_btl = sendreq->req_persist_btl;
+    int32_t seqn;
+    int rc;
+
+    if (OPAL_UNLIKELY(NULL == endpoint)) {
+#if OPAL_ENABLE_FT_MPI
+        if (!sendreq->req_send.req_base.req_proc->proc_active) {
+            return MPI_ERR_PROC_FAILED;
+        }
+#endif /* OPAL_ENABLE_FT_MPI */
+        return OMPI_ERR_UNREACH;
+    }
+
+    if (OPAL_UNLIKELY(NULL == bml_btl || endpoint != sendreq->req_endpoint ||
+                      1 != mca_bml_base_btl_array_get_size(&endpoint->btl_eager) ||
+                      bml_btl != mca_bml_base_btl_array_get_index(&endpoint->btl_eager, 0))) {
+        mca_pml_ob1_send_request_persist_select (sendreq, endpoint);
+        if (NULL == sendreq->req_persist_btl) {
+            return mca_pml_ob1_send_request_start (sendreq);
+        }
+        bml_btl = sendreq->req_persist_btl;
+    }
+
+    seqn = OPAL_THREAD_ADD_FETCH32(&sendreq->ob1_proc->send_sequence, 1);
+    mca_pml_ob1_send_request_reset (sendreq, endpoint, seqn);
+
+    rc = sendreq->req_persist_start (sendreq, bml_btl, sendreq->req_send.req_bytes_packed);
+    if (OPAL_LIKELY(OMPI_SUCCESS == rc)) {
+        return rc;
+    }
+#if OPAL_ENABLE_FT_MPI
+    if (OPAL_UNLIKELY(OMPI_ERR_UNREACH == rc)) {
+        sendreq->req_send.req_base.req_ompi.req_status.MPI_ERROR = MPI_ERR_PROC_FAILED;
+        MCA_PML_OB1_SEND_REQUEST_MPI_COMPLETE(sendreq, false);
+        return MPI_SUCCESS;
+    }
+#endif /* OPAL_ENABLE_FT_MPI */
+    if (OMPI_ERR_OUT_OF_RESOURCE != rc) {
+        return rc;
+    }
+    /* the request is started, the pending list retries the first fragment */
+    add_request_to_send_pending(sendreq, MCA_PML_OB1_SEND_PENDING_START, true);
+    return OMPI_SUCCESS;
+}
+
 /**
  *  Initiate a put scheduled by the receiver.
  */
@@ -0,0 +1,123 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include "opal/class/opal_hash_table.h"
+#include "opal/mca/threads/mutex.h"
+#include "opal/util/minmax.h"
+
+#include "pml_ob1_smsc.h"
+
+/* single-copy endpoints indexed by proc */
+static opal_hash_table_t mca_pml_ob1_smsc_endpoints;
+static opal_mutex_t mca_pml_ob1_smsc_lock;
+
+int mca_pml_ob1_smsc_init(void)
+{
+    OBJ_CONSTRUCT(&mca_pml_ob1_smsc_endpoints, opal_hash_table_t);
+    OBJ_CONSTRUCT(&mca_pml_ob1_smsc_lock, opal_mutex_t);
+
+    return opal_hash_table_init(&mca_pml_ob1_smsc_endpoints, 32);
+}
+
+void mca_pml_ob1_smsc_fini(void)
+{
+    mca_smsc_endpoint_t *endpoint;
+    uint64_t key;
+
+    OPAL_HASH_TABLE_FOREACH(key, uint64, endpoint, &mca_pml_ob1_smsc_endpoints) {
+        if (NULL != endpoint) {
+            MCA_SMSC_CALL(return_endpoint, endpoint);
+        }
+    }
+
+    OBJ_DESTRUCT(&mca_pml_ob1_smsc_endpoints);
+    OBJ_DESTRUCT(&mca_pml_ob1_smsc_lock);
+}
+
+mca_smsc_endpoint_t *mca_pml_ob1_smsc_get_endpoint(ompi_proc_t *proc)
+{
+    mca_smsc_endpoint_t *endpoint = NULL;
+    uint64_t key = (uint64_t) (uintptr_t) proc;
+    int rc;
+
+    OPAL_THREAD_LOCK(&mca_pml_ob1_smsc_lock);
+    rc = opal_hash_table_get_value_uint64(&mca_pml_ob1_smsc_endpoints, key, (void **) &endpoint);
+    if (OPAL_SUCCESS != rc) {
+        /* also cache failures so they are not retried for every message */
+        endpoint = MCA_SMSC_CALL(get_endpoint, &proc->super);
+        (void) opal_hash_table_set_value_uint64(&mca_pml_ob1_smsc_endpoints, key, endpoint);
+    }
+    OPAL_THREAD_UNLOCK(&mca_pml_ob1_smsc_lock);
+
+    return endpoint;
+}
+
+int mca_pml_ob1_smsc_build_iov(ompi_datatype_t *datatype, size_t count, const void *addr,
+                               size_t max_count, struct iovec **iov_out, size_t *iov_count_out)
+{
+    struct iovec *iov = NULL, *tmp;
+    size_t iov_count = 0, iov_size = 0, length;
+    opal_convertor_t convertor;
+    int rc = OMPI_SUCCESS;
+    bool done = false;
+
+    OBJ_CONSTRUCT(&convertor, opal_convertor_t);
+    opal_convertor_copy_and_prepare_for_send(ompi_mpi_local_convertor, &datatype->super, count,
+                                             addr, 0, &convertor);
+
+    while (!done) {
+        uint32_t batch;
+
+        if (iov_count == iov_size) {
+            iov_size = iov_size ? iov_size * 2 : 64;
+            tmp = (struct iovec *) realloc(iov, iov_size * sizeof(*iov));
+            if (NULL == tmp) {
+                rc = OMPI_ERR_OUT_OF_RESOURCE;
+                break;
+            }
+            iov = tmp;
+        }
+
+        batch = (uint32_t) opal_min(iov_size - iov_count, UINT32_MAX);
+        done = (0 != opal_convertor_raw(&convertor, iov + iov_count, &batch, &length));
+        iov_count += batch;
+
+        if (max_count && iov_count > max_count) {
+            /* too fragmented. packing the data is faster */
+            rc = OMPI_ERR_NOT_SUPPORTED;
+            break;
+        }
+    }
+
+    OBJ_DESTRUCT(&convertor);
+
+    if (OMPI_SUCCESS != rc) {
+        free(iov);
+        return rc;
+    }
+
+    *iov_out = iov;
+    *iov_count_out = iov_count;
+
+    return OMPI_SUCCESS;
+}
+
+void mca_pml_ob1_smsc_truncate_iov(struct iovec *iov, size_t *iov_count, size_t size)
+{
+    for (size_t i = 0; i < *iov_count; ++i) {
+        if (iov[i].iov_len >= size) {
+            iov[i].iov_len = size;
+            *iov_count = i + 1;
+            return;
+        }
+        size -= iov[i].iov_len;
+    }
+}
@@ -0,0 +1,86 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/* Single-copy transfers of non-contiguous data between local processes. The sender describes
+ * its buffer with an io vector and the receiver copies the data directly into its own buffer
+ * with a single scatter-gather operation of the shared-memory single-copy framework. */
+
+#ifndef OMPI_PML_OB1_SMSC_H
+#define OMPI_PML_OB1_SMSC_H
+
+#include "ompi_config.h"
+
+#include <limits.h>
+
+#include "opal/mca/smsc/smsc.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/proc/proc.h"
+
+#include "pml_ob1.h"
+
+BEGIN_C_DECLS
+
+#if !defined(IOV_MAX)
+#    define IOV_MAX 1024
+#endif
+
+/**
+ * Most io vector entries of a single-copy transfer. The sender never describes its buffer
+ * with more entries (pml_ob1_smsc_iov_max is clamped to it) and the receiver rejects a
+ * header announcing more.
+ */
+#define MCA_PML_OB1_SMSC_IOV_LIMIT ((size_t) IOV_MAX * 1024)
+
+int mca_pml_ob1_smsc_init(void);
+void mca_pml_ob1_smsc_fini(void);
+
+/**
+ * Get the (cached) single-copy endpoint of a local peer
+ *
+ * @returns NULL if the peer can not be reached with single-copy
+ */
+mca_smsc_endpoint_t *mca_pml_ob1_smsc_get_endpoint(ompi_proc_t *proc);
+
+/**
+ * Describe the memory layout of a buffer with an io vector
+ *
+ * @param[in]  datatype   datatype of the buffer
+ * @param[in]  count      number of elements in the buffer
+ * @param[in]  addr       address of the buffer
+ * @param[in]  max_count  maximum number of io vector entries (0: no limit)
+ * @param[out] iov        io vector (must be freed by the caller)
+ * @param[out] iov_count  number of entries in the io vector
+ *
+ * @returns OMPI_ERR_NOT_SUPPORTED if more than max_count entries are needed
+ */
+int mca_pml_ob1_smsc_build_iov(ompi_datatype_t *datatype, size_t count, const void *addr,
+                               size_t max_count, struct iovec **iov, size_t *iov_count);
+
+/**
+ * Shorten an io vector so it describes at most size bytes
+ */
+void mca_pml_ob1_smsc_truncate_iov(struct iovec *iov, size_t *iov_count, size_t size);
+
+/**
+ * Check if a message can be delivered with a single-copy scatter-gather transfer
+ */
+static inline bool mca_pml_ob1_smsc_iov_usable(ompi_proc_t *proc, opal_convertor_t *convertor,
+                                               size_t size)
+{
+    return mca_pml_ob1.smsc_iov_min_size && size >= mca_pml_ob1.smsc_iov_min_size
+           && NULL != mca_smsc
+           && !mca_smsc_base_has_feature(MCA_SMSC_FEATURE_REQUIRE_REGISTATION)
+           && OPAL_PROC_ON_LOCAL_NODE(proc->super.proc_flags)
+           && (convertor->flags & CONVERTOR_HOMOGENEOUS)
+           && !(convertor->flags & (CONVERTOR_ACCELERATOR | CONVERTOR_ACCELERATOR_UNIFIED));
+}
+
+END_C_DECLS
+
+#endif /* OMPI_PML_OB1_SMSC_H */
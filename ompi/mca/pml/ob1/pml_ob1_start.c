@@ -96,7 +96,7 @@ int mca_pml_ob1_start(size_t count, ompi_request_t** requests)
                 /* reset the completion flag */
                 pml_request->req_pml_complete = false;
 
-                MCA_PML_OB1_SEND_REQUEST_START(sendreq, rc);
+                rc = mca_pml_ob1_send_request_start_persistent(sendreq);
                 if(rc != OMPI_SUCCESS)
                     return rc;
                 break;
@@ -0,0 +1,136 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include "opal/runtime/opal_progress.h"
+#include "opal/runtime/opal_progress_threads.h"
+#include "opal/sys/atomic.h"
+#include "opal/util/event.h"
+#include "opal/util/output.h"
+
+#include "ompi/constants.h"
+#include "ompi/runtime/ompi_async_progress.h"
+#include "ompi/runtime/params.h"
+
+/* consecutive idle calls to opal_progress before the thread goes back to
+ * sleep until its next tick */
+#define OMPI_ASYNC_PROGRESS_IDLE_CALLS 64
+
+bool ompi_async_progress_enabled = false;
+
+static const char *ompi_async_progress_name = "OMPI async progress thread";
+static opal_event_base_t *ompi_async_progress_base = NULL;
+static opal_event_t ompi_async_progress_tick;
+static struct timeval ompi_async_progress_interval;
+static volatile bool ompi_async_progress_running = false;
+/* set by the wakeups not yet seen by the thread */
+static opal_atomic_int32_t ompi_async_progress_pending = 0;
+/* opal_progress() calls counted when the thread last went to sleep */
+static uint32_t ompi_async_progress_last_calls = 0;
+/* consecutive ticks that found nothing to progress, only used by the thread */
+static int ompi_async_progress_idle_ticks = 0;
+
+/*
+ * The tick is not persistent: it is activated by ompi_async_progress_wakeup()
+ * and re-armed by the thread as long as some work moves forward, so the
+ * thread sleeps without any timer while no operation needs progress.
+ */
+static void ompi_async_progress_cb(int fd, short flags, void *arg)
+{
+    bool forced = 0 != opal_atomic_swap_32(&ompi_async_progress_pending, 0);
+    uint32_t calls = opal_progress_num_calls();
+    int idle = 0, events = 0, ret;
+
+    (void) fd;
+    (void) flags;
+    (void) arg;
+
+    if (forced) {
+        ompi_async_progress_idle_ticks = 0;
+    }
+
+    /* an application thread progressed since the last tick, it is waiting
+     * in MPI and does not need the help: check again on the next tick, the
+     * operations it waits for are still outstanding */
+    if (!forced && calls != ompi_async_progress_last_calls) {
+        ompi_async_progress_last_calls = calls;
+        ompi_async_progress_idle_ticks = 0;
+    } else {
+        while (ompi_async_progress_running && idle < OMPI_ASYNC_PROGRESS_IDLE_CALLS) {
+            ret = opal_progress();
+            if (ret > 0) {
+                events += ret;
+                idle = 0;
+            } else {
+                ++idle;
+            }
+        }
+        ompi_async_progress_last_calls = opal_progress_num_calls();
+
+        if (events > 0) {
+            ompi_async_progress_idle_ticks = 0;
+        } else if (++ompi_async_progress_idle_ticks >= ompi_mpi_async_progress_idle_ticks) {
+            /* nothing moved for a while, wait for the next wakeup */
+            return;
+        }
+    }
+
+    if (ompi_async_progress_running) {
+        opal_event_add(&ompi_async_progress_tick, &ompi_async_progress_interval);
+    }
+}
+
+int ompi_async_progress_init(void)
+{
+    if (!ompi_mpi_async_progress) {
+        return OMPI_SUCCESS;
+    }
+
+    ompi_async_progress_base = opal_progress_thread_init(ompi_async_progress_name);
+    if (NULL == ompi_async_progress_base) {
+        opal_output(0, "failed to start the asynchronous progress thread, continuing without it");
+        return OMPI_SUCCESS;
+    }
+
+    ompi_async_progress_interval.tv_sec = ompi_mpi_async_progress_interval / 1000000;
+    ompi_async_progress_interval.tv_usec = ompi_mpi_async_progress_interval % 1000000;
+    ompi_async_progress_running = true;
+    ompi_async_progress_last_calls = opal_progress_num_calls();
+    /* armed by the first wakeup */
+    opal_event_set(ompi_async_progress_base, &ompi_async_progress_tick, -1, 0,
+                   ompi_async_progress_cb, NULL);
+    opal_atomic_wmb();
+    ompi_async_progress_enabled = true;
+
+    return OMPI_SUCCESS;
+}
+
+void ompi_async_progress_finalize(void)
+{
+    if (!ompi_async_progress_enabled) {
+        return;
+    }
+
+    ompi_async_progress_enabled = false;
+    ompi_async_progress_running = false;
+    opal_atomic_wmb();
+
+    /* waits for a running tick to complete */
+    opal_event_del(&ompi_async_progress_tick);
+    (void) opal_progress_thread_finalize(ompi_async_progress_name);
+    ompi_async_progress_base = NULL;
+}
+
+void ompi_async_progress_signal(void)
+{
+    /* only the first wakeup since the last tick activates the event */
+    if (0 == opal_atomic_swap_32(&ompi_async_progress_pending, 1)) {
+        opal_event_active(&ompi_async_progress_tick, OPAL_EV_TIMEOUT, 1);
+    }
+}
@@ -0,0 +1,72 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#ifndef OMPI_ASYNC_PROGRESS_H
+#define OMPI_ASYNC_PROGRESS_H
+
+#include "ompi_config.h"
+
+#include "opal/include/opal/prefetch.h"
+
+BEGIN_C_DECLS
+
+/**
+ * Asynchronous progress thread
+ *
+ * With mpi_async_progress set, every process runs a thread calling
+ * opal_progress() while the application computes, so that the operations
+ * driven by the progress engine (nonblocking collectives, rendezvous
+ * protocols, partitioned transfers) move forward between MPI calls.
+ *
+ * The thread sleeps in the event base of an OPAL progress thread without
+ * any timer until a component starting an operation that needs progress
+ * calls ompi_async_progress_wakeup(). It then wakes up every
+ * mpi_async_progress_interval microseconds, and progresses when no
+ * application thread called opal_progress() since its previous wakeup,
+ * until the engine has been idle for a few consecutive calls. After
+ * mpi_async_progress_idle_ticks consecutive wakeups without any progress,
+ * the outstanding operations are assumed complete and the thread goes back
+ * to sleep until the next wakeup.
+ *
+ * The MPI layer is initialized thread-safe when the thread is enabled, so
+ * the thread costs the usual locking of MPI_THREAD_MULTIPLE. When it is
+ * disabled the only cost is the test in ompi_async_progress_wakeup().
+ */
+
+/**
+ * Whether the thread is running.
+ */
+OMPI_DECLSPEC extern bool ompi_async_progress_enabled;
+
+/**
+ * Start the thread, if requested. Called once the MPI layer is fully
+ * initialized.
+ */
+int ompi_async_progress_init(void);
+
+/**
+ * Stop the thread, before the MPI layer is torn down.
+ */
+void ompi_async_progress_finalize(void);
+
+OMPI_DECLSPEC void ompi_async_progress_signal(void);
+
+/**
+ * Start progressing now: some operation that needs progress was just
+ * started and the application is likely to go back to computing.
+ */
+static inline void ompi_async_progress_wakeup(void)
+{
+    if (OPAL_UNLIKELY(ompi_async_progress_enabled)) {
+        ompi_async_progress_signal();
+    }
+}
+
+END_C_DECLS
+
+#endif /* OMPI_ASYNC_PROGRESS_H */
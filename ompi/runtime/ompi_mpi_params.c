@@ -79,6 +79,10 @@ bool ompi_mpi_preconnect_mpi = false;
 bool ompi_async_mpi_init = false;
 bool ompi_async_mpi_finalize = false;
 
+bool ompi_mpi_async_progress = false;
+int ompi_mpi_async_progress_interval = 50;
+int ompi_mpi_async_progress_idle_ticks = 20;
+
 #define OMPI_ADD_PROCS_CUTOFF_DEFAULT 0
 uint32_t ompi_add_procs_cutoff = OMPI_ADD_PROCS_CUTOFF_DEFAULT;
 bool ompi_mpi_dynamics_enabled = true;
@@ -350,6 +354,36 @@ int ompi_mpi_register_params(void)
                                  MCA_BASE_VAR_SCOPE_READONLY,
                                  &ompi_async_mpi_finalize);
 
+    ompi_mpi_async_progress = false;
+    (void) mca_base_var_register("ompi", "mpi", NULL, "async_progress",
+                                 "Run a thread progressing the MPI communications while the application computes (the MPI library is then initialized thread-safe)",
+                                 MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
+                                 OPAL_INFO_LVL_5,
+                                 MCA_BASE_VAR_SCOPE_READONLY,
+                                 &ompi_mpi_async_progress);
+
+    ompi_mpi_async_progress_interval = 50;
+    (void) mca_base_var_register("ompi", "mpi", NULL, "async_progress_interval",
+                                 "Time between two wakeups of the asynchronous progress thread while some operation needs progress, in microseconds",
+                                 MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                 OPAL_INFO_LVL_5,
+                                 MCA_BASE_VAR_SCOPE_READONLY,
+                                 &ompi_mpi_async_progress_interval);
+    if (ompi_mpi_async_progress_interval < 1) {
+        ompi_mpi_async_progress_interval = 1;
+    }
+
+    ompi_mpi_async_progress_idle_ticks = 20;
+    (void) mca_base_var_register("ompi", "mpi", NULL, "async_progress_idle_ticks",
+                                 "Number of consecutive wakeups without any progress after which the asynchronous progress thread sleeps until the next operation needing progress is started",
+                                 MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                 OPAL_INFO_LVL_5,
+                                 MCA_BASE_VAR_SCOPE_READONLY,
+                                 &ompi_mpi_async_progress_idle_ticks);
+    if (ompi_mpi_async_progress_idle_ticks < 1) {
+        ompi_mpi_async_progress_idle_ticks = 1;
+    }
+
     value = mca_base_var_find ("opal", "opal", NULL, "abort_delay");
     if (0 <= value) {
         (void) mca_base_var_register_synonym(value, "ompi", "mpi", NULL, "abort_delay",
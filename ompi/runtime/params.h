@@ -159,6 +159,24 @@ OMPI_DECLSPEC extern bool ompi_async_mpi_init;
 /* EXPERIMENTAL: do not perform an RTE barrier at the beginning of MPI_Finalize */
 OMPI_DECLSPEC extern bool ompi_async_mpi_finalize;
 
+/**
+ * Whether a thread progresses the communications between MPI calls
+ * (see ompi_async_progress.h)
+ */
+OMPI_DECLSPEC extern bool ompi_mpi_async_progress;
+
+/**
+ * Time between two wakeups of the asynchronous progress thread, in
+ * microseconds
+ */
+OMPI_DECLSPEC extern int ompi_mpi_async_progress_interval;
+
+/**
+ * Consecutive wakeups without progress after which the asynchronous
+ * progress thread waits for the next ompi_async_progress_wakeup()
+ */
+OMPI_DECLSPEC extern int ompi_mpi_async_progress_idle_ticks;
+
 #if OPAL_ENABLE_FT_MPI
 OMPI_DECLSPEC extern int ompi_ftmpi_output_handle;
 OMPI_DECLSPEC extern bool ompi_ftmpi_enabled;
@@ -37,8 +37,10 @@
 #include "opal/datatype/opal_convertor.h"
 #include "opal/datatype/opal_convertor_internal.h"
 #include "opal/datatype/opal_datatype.h"
+#include "opal/datatype/opal_datatype_checkpoint.h"
 #include "opal/datatype/opal_datatype_checksum.h"
 #include "opal/datatype/opal_datatype_internal.h"
+#include "opal/datatype/opal_datatype_plan.h"
 #include "opal/datatype/opal_datatype_prototypes.h"
 #include "opal/mca/accelerator/accelerator.h"
 
@@ -397,6 +399,7 @@ static inline int opal_convertor_create_stack_at_begining(opal_convertor_t *conv
     convertor->stack_pos = 1;
     convertor->partial_length = 0;
     convertor->bConverted = 0;
+    convertor->flags &= ~CONVERTOR_STACK_STALE;
     /**
      * Fill the first position on the stack. This one correspond to the
      * last fake OPAL_DATATYPE_END_LOOP that we add to the data representation and
@@ -419,6 +422,39 @@ static inline int opal_convertor_create_stack_at_begining(opal_convertor_t *conv
     return OPAL_SUCCESS;
 }
 
+/**
+ * Move the stack of a non-contiguous convertor to position, from the closest checkpoint, from
+ * the current position when moving forward or from the beginning otherwise.
+ */
+static int32_t opal_convertor_position_stack(opal_convertor_t *convertor, size_t *position)
+{
+    int32_t rc = OPAL_SUCCESS;
+
+    if (0 == (*position)) {
+        return opal_convertor_create_stack_at_begining(convertor, opal_datatype_local_sizes);
+    }
+    /* start from the closest checkpoint, or from the beginning if we have to move back */
+    if (!opal_datatype_checkpoint_restore(convertor, *position)
+        && ((*position) < convertor->bConverted)) {
+        opal_convertor_create_stack_at_begining(convertor, opal_datatype_local_sizes);
+    }
+    if ((*position) != convertor->bConverted) {
+        rc = opal_convertor_generic_simple_position(convertor, position);
+    }
+    /**
+     * If we have a non-contiguous send convertor don't allow it move in the middle
+     * of a predefined datatype, it won't be able to copy out the left-overs
+     * anyway. Instead force the position to stay on predefined datatypes
+     * boundaries. As we allow partial predefined datatypes on the contiguous
+     * case, we should be accepted by any receiver convertor.
+     */
+    if (CONVERTOR_SEND & convertor->flags) {
+        convertor->bConverted -= convertor->partial_length;
+        convertor->partial_length = 0;
+    }
+    return rc;
+}
+
 int32_t opal_convertor_set_position_nocheck(opal_convertor_t *convertor, size_t *position)
 {
     int32_t rc;
@@ -432,30 +468,29 @@ int32_t opal_convertor_set_position_nocheck(opal_convertor_t *convertor, size_t
     if (OPAL_LIKELY(convertor->flags & OPAL_DATATYPE_FLAG_CONTIGUOUS)) {
         rc = opal_convertor_create_stack_with_pos_contig(convertor, (*position),
                                                          opal_datatype_local_sizes);
+    } else if (opal_datatype_plan_pack == convertor->fAdvance
+               || opal_datatype_plan_unpack == convertor->fAdvance) {
+        /* the plans copy from any byte position and only look at bConverted. The stack is
+         * left behind and rebuilt by opal_convertor_raw if it is ever needed. */
+        convertor->bConverted = *position;
+        convertor->partial_length = 0;
+        convertor->flags |= CONVERTOR_STACK_STALE;
+        rc = OPAL_SUCCESS;
     } else {
-        if ((0 == (*position)) || ((*position) < convertor->bConverted)) {
-            rc = opal_convertor_create_stack_at_begining(convertor, opal_datatype_local_sizes);
-            if (0 == (*position)) {
-                return rc;
-            }
-        }
-        rc = opal_convertor_generic_simple_position(convertor, position);
-        /**
-         * If we have a non-contiguous send convertor don't allow it move in the middle
-         * of a predefined datatype, it won't be able to copy out the left-overs
-         * anyway. Instead force the position to stay on predefined datatypes
-         * boundaries. As we allow partial predefined datatypes on the contiguous
-         * case, we should be accepted by any receiver convertor.
-         */
-        if (CONVERTOR_SEND & convertor->flags) {
-            convertor->bConverted -= convertor->partial_length;
-            convertor->partial_length = 0;
-        }
+        rc = opal_convertor_position_stack(convertor, position);
     }
     *position = convertor->bConverted;
     return rc;
 }
 
+int32_t opal_convertor_rebuild_stack(opal_convertor_t *convertor)
+{
+    size_t position = convertor->bConverted;
+
+    opal_convertor_create_stack_at_begining(convertor, opal_datatype_local_sizes);
+    return opal_convertor_position_stack(convertor, &position);
+}
+
 /**
  * Compute the remote size. If necessary remove the homogeneous flag
  * and redirect the convertor description toward the non-optimized
@@ -598,6 +633,8 @@ int32_t opal_convertor_prepare_for_recv(opal_convertor_t *convertor,
         } else {
             if (convertor->pDesc->flags & OPAL_DATATYPE_FLAG_CONTIGUOUS) {
                 convertor->fAdvance = opal_unpack_homogeneous_contig;
+            } else if (NULL != datatype->plan && !(convertor->flags & CONVERTOR_ACCELERATOR)) {
+                convertor->fAdvance = opal_datatype_plan_unpack;
             } else {
                 convertor->fAdvance = opal_generic_simple_unpack;
             }
@@ -649,6 +686,8 @@ int32_t opal_convertor_prepare_for_send(opal_convertor_t *convertor,
                 } else {
                     convertor->fAdvance = opal_pack_homogeneous_contig_with_gaps;
                 }
+            } else if (NULL != datatype->plan && !(convertor->flags & CONVERTOR_ACCELERATOR)) {
+                convertor->fAdvance = opal_datatype_plan_pack;
             } else {
                 convertor->fAdvance = opal_generic_simple_pack;
             }
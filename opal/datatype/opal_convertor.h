@@ -59,6 +59,7 @@ BEGIN_C_DECLS
 #define CONVERTOR_ACCELERATOR_UNIFIED    0x10000000
 #define CONVERTOR_HAS_REMOTE_SIZE        0x20000000
 #define CONVERTOR_SKIP_ACCELERATOR_INIT  0x40000000
+#define CONVERTOR_STACK_STALE            0x80000000 /* stack behind bConverted (pack plans) */
 
 union dt_elem_desc;
 typedef struct opal_convertor_t opal_convertor_t;
@@ -360,6 +361,11 @@ OPAL_DECLSPEC void opal_datatype_dump_stack(const dt_stack_t *pStack, int stack_
 OPAL_DECLSPEC int opal_convertor_generic_simple_position(opal_convertor_t *pConvertor,
                                                          size_t *position);
 
+/*
+ * Rebuild the stack of a convertor flagged CONVERTOR_STACK_STALE at its current position.
+ */
+OPAL_DECLSPEC int32_t opal_convertor_rebuild_stack(opal_convertor_t *convertor);
+
 END_C_DECLS
 
 #endif /* OPAL_CONVERTOR_H_HAS_BEEN_INCLUDED */
@@ -96,6 +96,11 @@ int32_t opal_convertor_raw(opal_convertor_t *pConvertor, struct iovec *iov, uint
         return 1; /* we're done */
     }
 
+    if (OPAL_UNLIKELY(pConvertor->flags & CONVERTOR_STACK_STALE)) {
+        /* moved by a pack plan, which does not maintain the stack */
+        opal_convertor_rebuild_stack(pConvertor);
+    }
+
     DO_DEBUG(opal_output(0, "opal_convertor_raw( %p, {%p, %" PRIu32 "}, %" PRIsize_t " )\n",
                          (void *) pConvertor, (void *) iov, *iov_count, *length););
 
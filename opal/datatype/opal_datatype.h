@@ -133,17 +133,20 @@ struct opal_datatype_t {
     dt_type_desc_t desc;             /**< the data description */
     dt_type_desc_t opt_desc; /**< short description of the data used when conversion is useless
                                   or in the send case (without conversion) */
-
+    /* --- cacheline 3 boundary (192 bytes) --- */
     size_t *ptypes; /**< array of basic predefined types that facilitate the computing
                          of the remote size in heterogeneous environments. The length of the
                          array is dependent on the maximum number of predefined datatypes of
                          all language interfaces (because Fortran is not known at the OPAL
                          layer). This field should never be initialized in homogeneous
                          environments */
-    /* --- cacheline 5 boundary (320 bytes) was 32-36 bytes ago --- */
+    struct opal_datatype_plan_t *plan; /**< flattened description used by homogeneous pack/unpack
+                                            (NULL if the datatype has no plan) */
+    struct opal_datatype_checkpoints_t *checkpoints; /**< convertor states used to reposition
+                                                          convertors (built on demand) */
 
-    /* size: 352, cachelines: 6, members: 15 */
-    /* last cacheline: 28-32 bytes */
+    /* size: 216, cachelines: 4, members: 18 */
+    /* last cacheline: 24 bytes */
 };
 
 typedef struct opal_datatype_t opal_datatype_t;
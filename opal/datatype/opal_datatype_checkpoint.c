@@ -0,0 +1,188 @@
+/* -*- Mode: C; c-basic-offset:4 ; -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "opal_config.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "opal/constants.h"
+#include "opal/datatype/opal_convertor.h"
+#include "opal/datatype/opal_datatype.h"
+#include "opal/datatype/opal_datatype_checkpoint.h"
+#include "opal/datatype/opal_datatype_internal.h"
+#include "opal/mca/threads/thread_usage.h"
+
+#if OPAL_ENABLE_DEBUG
+#    include "opal/util/output.h"
+
+#    define DO_DEBUG(INST)             \
+        if (opal_ddt_position_debug) { \
+            INST                       \
+        }
+#else
+#    define DO_DEBUG(INST)
+#endif /* OPAL_ENABLE_DEBUG */
+
+/* bound the memory used by the checkpoints of very large datatypes */
+#define OPAL_DATATYPE_CHECKPOINT_MAX 4096
+
+size_t opal_datatype_checkpoint_step = 64 * 1024;
+
+static void opal_datatype_checkpoints_construct(opal_datatype_checkpoints_t *checkpoints)
+{
+    checkpoints->step = 0;
+    checkpoints->count = 0;
+    checkpoints->depth = 0;
+    checkpoints->points = NULL;
+    checkpoints->stacks = NULL;
+}
+
+static void opal_datatype_checkpoints_destruct(opal_datatype_checkpoints_t *checkpoints)
+{
+    free(checkpoints->points);
+    free(checkpoints->stacks);
+}
+
+OBJ_CLASS_INSTANCE(opal_datatype_checkpoints_t, opal_object_t,
+                   opal_datatype_checkpoints_construct, opal_datatype_checkpoints_destruct);
+
+static opal_datatype_checkpoints_t *opal_datatype_checkpoint_build(const opal_datatype_t *pData)
+{
+    opal_datatype_checkpoints_t *checkpoints;
+    opal_convertor_t *scratch;
+    size_t step = opal_datatype_checkpoint_step;
+
+    if (pData->size / step > OPAL_DATATYPE_CHECKPOINT_MAX) {
+        step = pData->size / OPAL_DATATYPE_CHECKPOINT_MAX;
+    }
+
+    checkpoints = OBJ_NEW(opal_datatype_checkpoints_t);
+    if (NULL == checkpoints) {
+        return NULL;
+    }
+    scratch = opal_convertor_create(opal_local_arch, 0);
+    if (NULL == scratch) {
+        goto error;
+    }
+    scratch->flags |= CONVERTOR_SKIP_ACCELERATOR_INIT;
+    if (OPAL_SUCCESS != opal_convertor_prepare_for_recv(scratch, pData, 1, NULL)
+        || (scratch->flags & CONVERTOR_NO_OP) || scratch->use_desc != &pData->opt_desc) {
+        goto error;
+    }
+
+    checkpoints->step = step;
+    /* the saved stacks have the size of the stack of any convertor on the datatype */
+    checkpoints->depth = scratch->stack_size;
+    /* checkpoints at step, 2 * step, ... strictly inside the instance */
+    checkpoints->count = (uint32_t) ((pData->size - 1) / step);
+    checkpoints->points = (opal_datatype_checkpoint_t *) malloc(checkpoints->count
+                                                                * sizeof(opal_datatype_checkpoint_t));
+    checkpoints->stacks = (dt_stack_t *) malloc((size_t) checkpoints->count * checkpoints->depth
+                                                * sizeof(dt_stack_t));
+    if (NULL == checkpoints->points || NULL == checkpoints->stacks) {
+        goto error;
+    }
+
+    /* walk a single instance once, saving the state of the convertor on the way */
+    for (uint32_t i = 0; i < checkpoints->count; ++i) {
+        opal_datatype_checkpoint_t *point = checkpoints->points + i;
+        size_t position = (i + 1) * step;
+
+        opal_convertor_generic_simple_position(scratch, &position);
+        if (scratch->flags & CONVERTOR_COMPLETED || scratch->stack_pos >= checkpoints->depth) {
+            goto error;
+        }
+        /* keep the checkpoints on element boundaries, as send convertors do */
+        scratch->bConverted -= scratch->partial_length;
+        scratch->partial_length = 0;
+        point->bConverted = scratch->bConverted;
+        point->stack_pos = scratch->stack_pos;
+        memcpy(checkpoints->stacks + (size_t) i * checkpoints->depth, scratch->pStack,
+               (scratch->stack_pos + 1) * sizeof(dt_stack_t));
+    }
+    OBJ_RELEASE(scratch);
+
+    DO_DEBUG(opal_output(0, "position checkpoints for datatype %s: %u every %" PRIsize_t " bytes\n",
+                         pData->name, checkpoints->count, step););
+    return checkpoints;
+
+error:
+    if (NULL != scratch) {
+        OBJ_RELEASE(scratch);
+    }
+    OBJ_RELEASE(checkpoints);
+    return NULL;
+}
+
+bool opal_datatype_checkpoint_restore(opal_convertor_t *convertor, size_t position)
+{
+    opal_datatype_t *pData = (opal_datatype_t *) convertor->pDesc;
+    opal_datatype_checkpoints_t *checkpoints = pData->checkpoints;
+    const opal_datatype_checkpoint_t *point;
+    const dt_stack_t *stack;
+    size_t instance, offset, target;
+    ptrdiff_t disp;
+    uint32_t i;
+
+    if (0 == opal_datatype_checkpoint_step || !(convertor->flags & CONVERTOR_HOMOGENEOUS)
+        || convertor->use_desc != &pData->opt_desc) {
+        return false;
+    }
+    if (NULL == checkpoints) {
+        intptr_t expected = 0;
+
+        if (pData->size < 2 * opal_datatype_checkpoint_step) {
+            return false;
+        }
+        checkpoints = opal_datatype_checkpoint_build(pData);
+        if (NULL == checkpoints) {
+            return false;
+        }
+        /* the datatype is shared, another convertor may have built them first */
+        if (!OPAL_ATOMIC_COMPARE_EXCHANGE_STRONG_PTR((opal_atomic_intptr_t *) &pData->checkpoints,
+                                                     &expected, (intptr_t) checkpoints)) {
+            OBJ_RELEASE(checkpoints);
+            checkpoints = (opal_datatype_checkpoints_t *) expected;
+        }
+    }
+
+    instance = position / pData->size;
+    offset = position - instance * pData->size;
+    if (offset < checkpoints->step) {
+        return false;
+    }
+    i = (uint32_t) (offset / checkpoints->step - 1);
+    if (i >= checkpoints->count) {
+        i = checkpoints->count - 1;
+    }
+    point = checkpoints->points + i;
+    if (point->stack_pos >= convertor->stack_size) {
+        return false;
+    }
+    target = instance * pData->size + point->bConverted;
+    if (position >= convertor->bConverted && target <= convertor->bConverted) {
+        /* moving forward from the current position is shorter */
+        return false;
+    }
+
+    stack = checkpoints->stacks + (size_t) i * checkpoints->depth;
+    disp = (ptrdiff_t) instance * (pData->ub - pData->lb);
+    for (uint32_t j = 0; j <= point->stack_pos; ++j) {
+        convertor->pStack[j] = stack[j];
+        convertor->pStack[j].disp += disp;
+    }
+    convertor->pStack[0].count = convertor->count - instance;
+    convertor->stack_pos = point->stack_pos;
+    convertor->partial_length = 0;
+    convertor->bConverted = target;
+    convertor->flags &= ~CONVERTOR_COMPLETED;
+    return true;
+}
@@ -0,0 +1,69 @@
+/* -*- Mode: C; c-basic-offset:4 ; -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#ifndef OPAL_DATATYPE_CHECKPOINT_H_HAS_BEEN_INCLUDED
+#define OPAL_DATATYPE_CHECKPOINT_H_HAS_BEEN_INCLUDED
+
+#include "opal_config.h"
+
+#include "opal/class/opal_object.h"
+#include "opal/datatype/opal_convertor.h"
+
+BEGIN_C_DECLS
+
+/**
+ * Position checkpoints of a datatype
+ *
+ * Repositioning a convertor on a non-contiguous datatype walks the description
+ * from the beginning of the instance holding the position. For large datatypes
+ * this walk dominates the restart of pipelined protocols. The checkpoints hold
+ * the stack of a convertor on the element boundary preceding every step bytes
+ * of one instance of the datatype, so repositioning walks about step bytes at
+ * most.
+ *
+ * The checkpoints are built on the first repositioning of a convertor on the
+ * datatype, by positioning a scratch convertor on each of them, and cached on
+ * the datatype. They are only used by homogeneous convertors on the optimized
+ * description.
+ */
+struct opal_datatype_checkpoint_t {
+    size_t bConverted;  /**< position of the checkpoint in one instance */
+    uint32_t stack_pos; /**< top of the saved stack */
+};
+typedef struct opal_datatype_checkpoint_t opal_datatype_checkpoint_t;
+
+struct opal_datatype_checkpoints_t {
+    opal_object_t super;
+    size_t step;                       /**< bytes between two checkpoints */
+    uint32_t count;                    /**< number of checkpoints */
+    uint32_t depth;                    /**< stack entries saved with each checkpoint */
+    opal_datatype_checkpoint_t *points;
+    dt_stack_t *stacks;                /**< depth entries per checkpoint */
+};
+typedef struct opal_datatype_checkpoints_t opal_datatype_checkpoints_t;
+
+OPAL_DECLSPEC OBJ_CLASS_DECLARATION(opal_datatype_checkpoints_t);
+
+/**
+ * Bytes between two checkpoints (0 disables the checkpoints). Datatypes smaller
+ * than two steps have no checkpoints.
+ */
+OPAL_DECLSPEC extern size_t opal_datatype_checkpoint_step;
+
+/**
+ * Move a homogeneous convertor to the last checkpoint at or before the
+ * position, if it is closer than the current position of the convertor.
+ *
+ * @returns true if the convertor was moved.
+ */
+bool opal_datatype_checkpoint_restore(opal_convertor_t *convertor, size_t position);
+
+END_C_DECLS
+
+#endif /* OPAL_DATATYPE_CHECKPOINT_H_HAS_BEEN_INCLUDED */
@@ -25,6 +25,8 @@
 #include "opal/constants.h"
 #include "opal/datatype/opal_datatype.h"
 #include "opal/datatype/opal_datatype_internal.h"
+#include "opal/datatype/opal_datatype_checkpoint.h"
+#include "opal/datatype/opal_datatype_plan.h"
 
 /*
  * As the new type has the same commit state as the old one, I have to copy the fake
@@ -71,6 +73,13 @@ int32_t opal_datatype_clone(const opal_datatype_t *src_type, opal_datatype_t *de
             assert(0 == dest_type->opt_desc.length);
         }
     }
+    if (NULL != dest_type->plan) {
+        /* the plan is immutable, share it */
+        OBJ_RETAIN(dest_type->plan);
+    }
+    if (NULL != dest_type->checkpoints) {
+        OBJ_RETAIN(dest_type->checkpoints);
+    }
     dest_type->id = src_type->id; /* preserve the default id. This allow us to
                                    * copy predefined types. */
     return OPAL_SUCCESS;
@@ -28,6 +28,8 @@
 #include "opal/constants.h"
 #include "opal/datatype/opal_datatype.h"
 #include "opal/datatype/opal_datatype_internal.h"
+#include "opal/datatype/opal_datatype_checkpoint.h"
+#include "opal/datatype/opal_datatype_plan.h"
 #include "opal/prefetch.h"
 
 static void opal_datatype_construct(opal_datatype_t *pData)
@@ -55,6 +57,8 @@ static void opal_datatype_construct(opal_datatype_t *pData)
 
     pData->ptypes = NULL;
     pData->loops = 0;
+    pData->plan = NULL;
+    pData->checkpoints = NULL;
 }
 
 static void opal_datatype_destruct(opal_datatype_t *datatype)
@@ -85,6 +89,13 @@ static void opal_datatype_destruct(opal_datatype_t *datatype)
         datatype->ptypes = NULL;
     }
 
+    if (NULL != datatype->plan) {
+        OBJ_RELEASE(datatype->plan);
+    }
+    if (NULL != datatype->checkpoints) {
+        OBJ_RELEASE(datatype->checkpoints);
+    }
+
     /* make sure the name is set to empty */
     datatype->name[0] = '\0';
 }
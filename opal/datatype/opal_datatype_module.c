@@ -33,8 +33,13 @@
 
 #include "opal/datatype/opal_convertor_internal.h"
 #include "opal/datatype/opal_datatype.h"
+#include "opal/datatype/opal_datatype_checkpoint.h"
 #include "opal/datatype/opal_datatype_internal.h"
+#include "opal/datatype/opal_datatype_parallel.h"
+#include "opal/datatype/opal_datatype_plan.h"
+#include "opal/datatype/opal_datatype_simd.h"
 #include "opal/mca/base/mca_base_var.h"
+#include "opal/mca/base/mca_base_var_enum.h"
 #include "opal/runtime/opal.h"
 #include "opal/util/arch.h"
 #include "opal/util/output.h"
@@ -48,6 +53,13 @@ bool opal_ddt_copy_debug = false;
 bool opal_ddt_raw_debug = false;
 int opal_ddt_verbose = -1; /* Has the datatype verbose it's own output stream */
 
+static mca_base_var_enum_value_flag_t opal_datatype_simd_flags[] = {
+    {.flag = OPAL_DATATYPE_SIMD_SSE2, .string = "SSE2"},
+    {.flag = OPAL_DATATYPE_SIMD_AVX2, .string = "AVX2"},
+    {.flag = OPAL_DATATYPE_SIMD_AVX512, .string = "AVX512"},
+    {.flag = 0, .string = NULL},
+};
+
 /* Using this macro implies that at this point _all_ information needed
  * to fill up the datatype are known.
  * We fill all the static information, the pointer to desc.desc is setup
@@ -169,9 +181,69 @@ OPAL_DECLSPEC const opal_datatype_t *opal_datatype_basicDatatypes[OPAL_DATATYPE_
 
 int opal_datatype_register_params(void)
 {
-#if OPAL_ENABLE_DEBUG
+    mca_base_var_enum_flag_t *simd_enum = NULL;
     int ret;
 
+    ret = mca_base_var_register(
+        "opal", "mpi", NULL, "ddt_plan_max_blocks",
+        "Maximum number of blocks in the flattened pack plan of a datatype. Datatypes needing "
+        "more blocks are packed by interpreting their description (0 = disable pack plans)",
+        MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0, 0, OPAL_INFO_LVL_5,
+        MCA_BASE_VAR_SCOPE_LOCAL, &opal_datatype_plan_max_blocks);
+    if (0 > ret) {
+        return ret;
+    }
+
+    opal_datatype_simd_support = opal_datatype_simd_detect();
+    ret = mca_base_var_enum_create_flag("mpi_ddt_simd_support", opal_datatype_simd_flags,
+                                        &simd_enum);
+    if (OPAL_SUCCESS != ret) {
+        return ret;
+    }
+    ret = mca_base_var_register(
+        "opal", "mpi", NULL, "ddt_simd_support",
+        "Vector instructions used to pack and unpack vectors of small blocks, capped by the "
+        "capabilities of the processor",
+        MCA_BASE_VAR_TYPE_INT, &simd_enum->super, 0, 0, OPAL_INFO_LVL_5,
+        MCA_BASE_VAR_SCOPE_LOCAL, &opal_datatype_simd_support);
+    OBJ_RELEASE(simd_enum);
+    if (0 > ret) {
+        return ret;
+    }
+    opal_datatype_simd_init();
+
+    ret = mca_base_var_register(
+        "opal", "mpi", NULL, "ddt_pack_threads",
+        "Number of helper threads packing and unpacking the large pieces of non-contiguous "
+        "messages, such as MPI_Pack or buffered sends. Pieces smaller than twice "
+        "mpi_ddt_pack_thread_min_chunk, including the fragments of the PML pipeline, are packed "
+        "on the calling thread (0 = pack on the calling thread only)",
+        MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0, 0, OPAL_INFO_LVL_5,
+        MCA_BASE_VAR_SCOPE_LOCAL, &opal_datatype_parallel_threads);
+    if (0 > ret) {
+        return ret;
+    }
+
+    ret = mca_base_var_register(
+        "opal", "mpi", NULL, "ddt_pack_thread_min_chunk",
+        "Minimum number of bytes packed or unpacked by each helper thread (0 is treated as 1)",
+        MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, 0, OPAL_INFO_LVL_5,
+        MCA_BASE_VAR_SCOPE_LOCAL, &opal_datatype_parallel_min_chunk);
+    if (0 > ret) {
+        return ret;
+    }
+
+    ret = mca_base_var_register(
+        "opal", "mpi", NULL, "ddt_position_checkpoint_step",
+        "Distance in bytes between the saved convertor states used to reposition convertors "
+        "inside large non-contiguous datatypes (0 = always walk from the beginning)",
+        MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, 0, OPAL_INFO_LVL_5,
+        MCA_BASE_VAR_SCOPE_LOCAL, &opal_datatype_checkpoint_step);
+    if (0 > ret) {
+        return ret;
+    }
+
+#if OPAL_ENABLE_DEBUG
     ret = mca_base_var_register(
         "opal", "mpi", NULL, "ddt_unpack_debug",
         "Whether to output debugging information in the ddt unpack functions (nonzero = enabled)",
@@ -241,6 +313,7 @@ static void opal_datatype_finalize(void)
      */
     /* clear all master convertors */
     opal_convertor_destroy_masters();
+    opal_datatype_parallel_finalize();
 
     opal_output_close(opal_datatype_dfd);
     opal_datatype_dfd = -1;
@@ -29,6 +29,7 @@
 #include "opal/datatype/opal_convertor.h"
 #include "opal/datatype/opal_datatype.h"
 #include "opal/datatype/opal_datatype_internal.h"
+#include "opal/datatype/opal_datatype_plan.h"
 
 static int32_t opal_datatype_optimize_short(opal_datatype_t *pData, size_t count,
                                             dt_type_desc_t *pTypeDesc)
@@ -342,5 +343,6 @@ int32_t opal_datatype_commit(opal_datatype_t *pData)
         pLast->first_elem_disp = first_elem_disp;
         pLast->size = pData->size;
     }
-    return OPAL_SUCCESS;
+
+    return opal_datatype_plan_create(pData);
 }
@@ -0,0 +1,195 @@
+/* -*- Mode: C; c-basic-offset:4 ; -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "opal_config.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "opal/constants.h"
+#include "opal/datatype/opal_datatype_parallel.h"
+#include "opal/mca/threads/mutex.h"
+#include "opal/mca/threads/threads.h"
+#include "opal/sys/atomic.h"
+
+unsigned int opal_datatype_parallel_threads = 0;
+size_t opal_datatype_parallel_min_chunk = 1024 * 1024;
+
+struct opal_datatype_parallel_job_t {
+    opal_datatype_parallel_fn_t fn;
+    void *ctx;
+    size_t length;
+    size_t chunk;
+    opal_atomic_size_t next;     /**< first byte of the next chunk to process */
+    opal_atomic_int32_t active;  /**< helper threads still working on the job */
+};
+typedef struct opal_datatype_parallel_job_t opal_datatype_parallel_job_t;
+
+/*
+ * The helper threads are started on the first job and sleep on the condition
+ * between jobs. A single job runs at a time, a caller finding the pool busy
+ * processes its bytes itself. Every helper thread takes part in every job, so
+ * the job can live on the stack of the caller, which waits for all of them.
+ */
+static struct {
+    opal_mutex_t lock;
+    opal_cond_t cond;
+    opal_thread_t *threads;
+    unsigned int count;
+    uint64_t generation;
+    opal_datatype_parallel_job_t *job;
+    opal_atomic_int32_t busy;
+    bool initialized;
+    bool shutdown;
+} opal_datatype_parallel_pool = {.count = 0, .busy = 0, .initialized = false};
+
+static void opal_datatype_parallel_process(opal_datatype_parallel_job_t *job)
+{
+    for (;;) {
+        size_t first = opal_atomic_fetch_add_size_t(&job->next, job->chunk);
+        if (first >= job->length) {
+            return;
+        }
+        job->fn(job->ctx, first, job->length - first < job->chunk ? job->length - first : job->chunk);
+    }
+}
+
+static void *opal_datatype_parallel_worker(opal_object_t *obj)
+{
+    opal_datatype_parallel_job_t *job;
+    uint64_t seen = 0;
+
+    (void) obj;
+    opal_mutex_lock(&opal_datatype_parallel_pool.lock);
+    for (;;) {
+        while (!opal_datatype_parallel_pool.shutdown
+               && seen == opal_datatype_parallel_pool.generation) {
+            opal_cond_wait(&opal_datatype_parallel_pool.cond, &opal_datatype_parallel_pool.lock);
+        }
+        if (opal_datatype_parallel_pool.shutdown) {
+            break;
+        }
+        seen = opal_datatype_parallel_pool.generation;
+        job = opal_datatype_parallel_pool.job;
+        opal_mutex_unlock(&opal_datatype_parallel_pool.lock);
+
+        opal_datatype_parallel_process(job);
+        opal_atomic_wmb();
+        (void) opal_atomic_add_fetch_32(&job->active, -1);
+
+        opal_mutex_lock(&opal_datatype_parallel_pool.lock);
+    }
+    opal_mutex_unlock(&opal_datatype_parallel_pool.lock);
+
+    return NULL;
+}
+
+static void opal_datatype_parallel_start(void)
+{
+    opal_datatype_parallel_pool.initialized = true;
+    OBJ_CONSTRUCT(&opal_datatype_parallel_pool.lock, opal_mutex_t);
+    opal_cond_init(&opal_datatype_parallel_pool.cond);
+    opal_datatype_parallel_pool.shutdown = false;
+    opal_datatype_parallel_pool.generation = 0;
+
+    opal_datatype_parallel_pool.threads = calloc(opal_datatype_parallel_threads,
+                                                 sizeof(opal_thread_t));
+    if (NULL == opal_datatype_parallel_pool.threads) {
+        return;
+    }
+    for (unsigned int i = 0; i < opal_datatype_parallel_threads; ++i) {
+        opal_thread_t *thread = opal_datatype_parallel_pool.threads + i;
+
+        OBJ_CONSTRUCT(thread, opal_thread_t);
+        thread->t_run = opal_datatype_parallel_worker;
+        if (OPAL_SUCCESS != opal_thread_start(thread)) {
+            OBJ_DESTRUCT(thread);
+            break;
+        }
+        opal_datatype_parallel_pool.count++;
+    }
+}
+
+int opal_datatype_parallel_run(opal_datatype_parallel_fn_t fn, void *ctx, size_t length)
+{
+    opal_datatype_parallel_job_t job;
+    int32_t expected = 0;
+    size_t chunk;
+
+    if (0 == opal_datatype_parallel_threads || length < 2 * opal_datatype_parallel_min_chunk) {
+        return OPAL_ERR_NOT_AVAILABLE;
+    }
+    if (!opal_atomic_compare_exchange_strong_32(&opal_datatype_parallel_pool.busy, &expected, 1)) {
+        return OPAL_ERR_NOT_AVAILABLE;
+    }
+    if (!opal_datatype_parallel_pool.initialized) {
+        opal_datatype_parallel_start();
+    }
+    if (0 == opal_datatype_parallel_pool.count) {
+        opal_datatype_parallel_pool.busy = 0;
+        return OPAL_ERR_NOT_AVAILABLE;
+    }
+
+    /* a few chunks per thread to balance the load. A chunk of 0 bytes would never end the job,
+     * which tiny pieces or a min_chunk of 0 could produce. */
+    chunk = length / (4 * (opal_datatype_parallel_pool.count + 1));
+    if (chunk < opal_datatype_parallel_min_chunk) {
+        chunk = opal_datatype_parallel_min_chunk;
+    }
+    if (0 == chunk) {
+        chunk = 1;
+    }
+
+    job.fn = fn;
+    job.ctx = ctx;
+    job.length = length;
+    job.chunk = chunk;
+    job.next = 0;
+    job.active = (int32_t) opal_datatype_parallel_pool.count;
+    opal_atomic_wmb();
+
+    opal_mutex_lock(&opal_datatype_parallel_pool.lock);
+    opal_datatype_parallel_pool.job = &job;
+    opal_datatype_parallel_pool.generation++;
+    opal_cond_broadcast(&opal_datatype_parallel_pool.cond);
+    opal_mutex_unlock(&opal_datatype_parallel_pool.lock);
+
+    opal_datatype_parallel_process(&job);
+    while (0 < job.active) {
+        opal_atomic_rmb();
+    }
+    opal_atomic_mb();
+
+    opal_datatype_parallel_pool.busy = 0;
+    return OPAL_SUCCESS;
+}
+
+void opal_datatype_parallel_finalize(void)
+{
+    if (!opal_datatype_parallel_pool.initialized) {
+        return;
+    }
+
+    opal_mutex_lock(&opal_datatype_parallel_pool.lock);
+    opal_datatype_parallel_pool.shutdown = true;
+    opal_cond_broadcast(&opal_datatype_parallel_pool.cond);
+    opal_mutex_unlock(&opal_datatype_parallel_pool.lock);
+
+    for (unsigned int i = 0; i < opal_datatype_parallel_pool.count; ++i) {
+        opal_thread_join(opal_datatype_parallel_pool.threads + i, NULL);
+        OBJ_DESTRUCT(opal_datatype_parallel_pool.threads + i);
+    }
+    free(opal_datatype_parallel_pool.threads);
+    opal_datatype_parallel_pool.threads = NULL;
+    opal_datatype_parallel_pool.count = 0;
+
+    opal_cond_destroy(&opal_datatype_parallel_pool.cond);
+    OBJ_DESTRUCT(&opal_datatype_parallel_pool.lock);
+    opal_datatype_parallel_pool.initialized = false;
+}
@@ -0,0 +1,53 @@
+/* -*- Mode: C; c-basic-offset:4 ; -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#ifndef OPAL_DATATYPE_PARALLEL_H_HAS_BEEN_INCLUDED
+#define OPAL_DATATYPE_PARALLEL_H_HAS_BEEN_INCLUDED
+
+#include "opal_config.h"
+
+#include <stddef.h>
+
+BEGIN_C_DECLS
+
+/**
+ * Number of helper threads packing and unpacking large messages (0, the
+ * default, packs on the calling thread only). Only the pieces of at least
+ * twice opal_datatype_parallel_min_chunk bytes packed by a single call are
+ * split, such as MPI_Pack, MPI_Unpack and buffered sends. The fragments of
+ * the PML pipeline are smaller than that and stay on the calling thread.
+ */
+OPAL_DECLSPEC extern unsigned int opal_datatype_parallel_threads;
+
+/** Minimum number of bytes handled by each thread */
+OPAL_DECLSPEC extern size_t opal_datatype_parallel_min_chunk;
+
+/**
+ * Process the bytes [first, first + length) of a job. Chunks are processed
+ * concurrently and must be independent.
+ */
+typedef void (*opal_datatype_parallel_fn_t)(void *ctx, size_t first, size_t length);
+
+/**
+ * Split length bytes in chunks and process them with the helper threads and
+ * the calling thread. Returns when all the chunks are processed.
+ *
+ * @returns OPAL_SUCCESS when the job ran, OPAL_ERR_NOT_AVAILABLE when the
+ * helper threads are disabled, busy with another job or the job is too small
+ * to be split. The caller then processes the bytes itself.
+ */
+OPAL_DECLSPEC int opal_datatype_parallel_run(opal_datatype_parallel_fn_t fn, void *ctx,
+                                             size_t length);
+
+/** Stop the helper threads */
+void opal_datatype_parallel_finalize(void);
+
+END_C_DECLS
+
+#endif /* OPAL_DATATYPE_PARALLEL_H_HAS_BEEN_INCLUDED */
@@ -0,0 +1,590 @@
+/* -*- Mode: C; c-basic-offset:4 ; -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "opal_config.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "opal/constants.h"
+#include "opal/datatype/opal_convertor.h"
+#include "opal/datatype/opal_datatype.h"
+#include "opal/datatype/opal_datatype_internal.h"
+#include "opal/datatype/opal_datatype_parallel.h"
+#include "opal/datatype/opal_datatype_plan.h"
+#include "opal/datatype/opal_datatype_simd.h"
+
+#if OPAL_ENABLE_DEBUG
+#    include "opal/util/output.h"
+
+#    define DO_DEBUG(INST)         \
+        if (opal_ddt_pack_debug) { \
+            INST                   \
+        }
+#else
+#    define DO_DEBUG(INST)
+#endif /* OPAL_ENABLE_DEBUG */
+
+unsigned int opal_datatype_plan_max_blocks = 1024;
+
+static void opal_datatype_plan_construct(opal_datatype_plan_t *plan)
+{
+    plan->group_count = 0;
+    plan->block_count = 0;
+    plan->groups = NULL;
+    plan->blocks = NULL;
+}
+
+static void opal_datatype_plan_destruct(opal_datatype_plan_t *plan)
+{
+    free(plan->groups);
+    free(plan->blocks);
+}
+
+OBJ_CLASS_INSTANCE(opal_datatype_plan_t, opal_object_t, opal_datatype_plan_construct,
+                   opal_datatype_plan_destruct);
+
+static int opal_datatype_plan_add_group(opal_datatype_plan_t *plan, uint32_t *group_max,
+                                        size_t repeat, ptrdiff_t stride)
+{
+    opal_datatype_plan_group_t *group;
+
+    if (plan->group_count == *group_max) {
+        uint32_t new_max = 2 * (*group_max);
+        void *tmp = realloc(plan->groups, new_max * sizeof(opal_datatype_plan_group_t));
+        if (NULL == tmp) {
+            return OPAL_ERR_OUT_OF_RESOURCE;
+        }
+        plan->groups = (opal_datatype_plan_group_t *) tmp;
+        *group_max = new_max;
+    }
+
+    group = plan->groups + plan->group_count++;
+    group->stride = stride;
+    group->repeat = repeat;
+    group->size = 0;
+    group->offset = 0;
+    group->first_block = plan->block_count;
+    group->blocks = 0;
+
+    return OPAL_SUCCESS;
+}
+
+static int opal_datatype_plan_add_block(opal_datatype_plan_t *plan, uint32_t *block_max,
+                                        ptrdiff_t disp, size_t length, size_t repeat,
+                                        ptrdiff_t stride)
+{
+    opal_datatype_plan_group_t *group = plan->groups + plan->group_count - 1;
+    opal_datatype_plan_block_t *block;
+
+    if (0 == length || 0 == repeat) {
+        return OPAL_SUCCESS;
+    }
+
+    /* contiguous copies are a single larger copy */
+    if (1 == repeat || (ptrdiff_t) length == stride) {
+        length *= repeat;
+        repeat = 1;
+        stride = 0;
+    }
+
+    group->size += length * repeat;
+
+    if (0 != group->blocks) {
+        block = plan->blocks + plan->block_count - 1;
+        if (1 == repeat && 1 == block->repeat && (block->disp + (ptrdiff_t) block->length) == disp) {
+            /* extends the previous block */
+            block->length += length;
+            return OPAL_SUCCESS;
+        }
+        if (1 == repeat && length == block->length) {
+            /* one more copy of the previous block */
+            if (1 == block->repeat && disp != block->disp) {
+                block->stride = disp - block->disp;
+                block->repeat = 2;
+                return OPAL_SUCCESS;
+            }
+            if (1 < block->repeat && (block->disp + (ptrdiff_t) block->repeat * block->stride) == disp) {
+                block->repeat++;
+                return OPAL_SUCCESS;
+            }
+        }
+    }
+
+    if (plan->block_count == *block_max) {
+        uint32_t new_max;
+        void *tmp;
+
+        if (*block_max >= opal_datatype_plan_max_blocks) {
+            return OPAL_ERR_NOT_SUPPORTED;
+        }
+        new_max = 2 * (*block_max);
+        if (new_max > opal_datatype_plan_max_blocks) {
+            new_max = opal_datatype_plan_max_blocks;
+        }
+        tmp = realloc(plan->blocks, new_max * sizeof(opal_datatype_plan_block_t));
+        if (NULL == tmp) {
+            return OPAL_ERR_OUT_OF_RESOURCE;
+        }
+        plan->blocks = (opal_datatype_plan_block_t *) tmp;
+        *block_max = new_max;
+    }
+
+    block = plan->blocks + plan->block_count++;
+    block->disp = disp;
+    block->stride = stride;
+    block->length = length;
+    block->repeat = repeat;
+    block->offset = 0;
+    group->blocks++;
+
+    return OPAL_SUCCESS;
+}
+
+/**
+ * Lower the description elements [pos, end) displaced by disp. Loops that only
+ * contain data become groups, loops of loops are unrolled. Data elements outside
+ * of a loop are added to a group with a single iteration (flat_open is set while
+ * such a group is the last one).
+ */
+static int opal_datatype_plan_lower(opal_datatype_plan_t *plan, uint32_t *group_max,
+                                    uint32_t *block_max, bool *flat_open,
+                                    const dt_elem_desc_t *desc, uint32_t pos, uint32_t end,
+                                    ptrdiff_t disp)
+{
+    int rc;
+
+    while (pos < end) {
+        const dt_elem_desc_t *pElem = desc + pos;
+
+        if (pElem->elem.common.flags & OPAL_DATATYPE_FLAG_DATA) {
+            const ddt_elem_desc_t *elem = &pElem->elem;
+
+            if (!*flat_open) {
+                rc = opal_datatype_plan_add_group(plan, group_max, 1, 0);
+                if (OPAL_SUCCESS != rc) {
+                    return rc;
+                }
+                *flat_open = true;
+            }
+            rc = opal_datatype_plan_add_block(plan, block_max, disp + elem->disp,
+                                              elem->blocklen * opal_datatype_basicDatatypes[elem->common.type]->size,
+                                              elem->count, elem->extent);
+            if (OPAL_SUCCESS != rc) {
+                return rc;
+            }
+            ++pos;
+            continue;
+        }
+
+        if (OPAL_DATATYPE_LOOP == pElem->elem.common.type) {
+            const ddt_loop_desc_t *loop = &pElem->loop;
+            const ddt_endloop_desc_t *end_loop = &desc[pos + loop->items].end_loop;
+            bool only_data = true;
+
+            for (uint32_t i = pos + 1; i < pos + loop->items; ++i) {
+                if (!(desc[i].elem.common.flags & OPAL_DATATYPE_FLAG_DATA)) {
+                    only_data = false;
+                    break;
+                }
+            }
+
+            if (loop->common.flags & OPAL_DATATYPE_FLAG_CONTIGUOUS) {
+                /* each iteration is contiguous */
+                if (!*flat_open) {
+                    rc = opal_datatype_plan_add_group(plan, group_max, 1, 0);
+                    if (OPAL_SUCCESS != rc) {
+                        return rc;
+                    }
+                    *flat_open = true;
+                }
+                rc = opal_datatype_plan_add_block(plan, block_max, disp + end_loop->first_elem_disp,
+                                                  end_loop->size, loop->loops, loop->extent);
+            } else if (only_data && 1 < loop->loops) {
+                rc = opal_datatype_plan_add_group(plan, group_max, loop->loops, loop->extent);
+                for (uint32_t i = pos + 1; i < pos + loop->items && OPAL_SUCCESS == rc; ++i) {
+                    const ddt_elem_desc_t *elem = &desc[i].elem;
+                    rc = opal_datatype_plan_add_block(plan, block_max, disp + elem->disp,
+                                                      elem->blocklen * opal_datatype_basicDatatypes[elem->common.type]->size,
+                                                      elem->count, elem->extent);
+                }
+                /* the following data elements need a new group */
+                *flat_open = false;
+            } else {
+                rc = OPAL_SUCCESS;
+                for (uint32_t i = 0; i < loop->loops && OPAL_SUCCESS == rc; ++i) {
+                    rc = opal_datatype_plan_lower(plan, group_max, block_max, flat_open, desc,
+                                                  pos + 1, pos + loop->items,
+                                                  disp + (ptrdiff_t) i * loop->extent);
+                }
+            }
+            if (OPAL_SUCCESS != rc) {
+                return rc;
+            }
+            pos += loop->items + 1;
+            continue;
+        }
+
+        /* end of the description */
+        ++pos;
+    }
+
+    return OPAL_SUCCESS;
+}
+
+int32_t opal_datatype_plan_create(opal_datatype_t *datatype)
+{
+    uint32_t group_max = 4, block_max = 4;
+    bool flat_open = false;
+    const dt_type_desc_t *desc = &datatype->opt_desc;
+    opal_datatype_plan_t *plan;
+    size_t offset = 0;
+    int rc;
+
+    if (0 == opal_datatype_plan_max_blocks || NULL != datatype->plan || 0 == datatype->size
+        || (datatype->flags & OPAL_DATATYPE_FLAG_CONTIGUOUS)) {
+        return OPAL_SUCCESS;
+    }
+    if (0 == desc->used) {
+        desc = &datatype->desc;
+    }
+
+    plan = OBJ_NEW(opal_datatype_plan_t);
+    if (NULL == plan) {
+        return OPAL_ERR_OUT_OF_RESOURCE;
+    }
+    if (block_max > opal_datatype_plan_max_blocks) {
+        block_max = opal_datatype_plan_max_blocks;
+    }
+    plan->groups = (opal_datatype_plan_group_t *) malloc(group_max * sizeof(opal_datatype_plan_group_t));
+    plan->blocks = (opal_datatype_plan_block_t *) malloc(block_max * sizeof(opal_datatype_plan_block_t));
+    if (NULL == plan->groups || NULL == plan->blocks) {
+        OBJ_RELEASE(plan);
+        return OPAL_ERR_OUT_OF_RESOURCE;
+    }
+
+    rc = opal_datatype_plan_lower(plan, &group_max, &block_max, &flat_open, desc->desc, 0,
+                                  desc->used, 0);
+    if (OPAL_SUCCESS != rc) {
+        OBJ_RELEASE(plan);
+        /* too complex for a plan, keep using the description */
+        return (OPAL_ERR_NOT_SUPPORTED == rc) ? OPAL_SUCCESS : rc;
+    }
+
+    /* packed offsets of the groups and blocks. empty groups are removed as the position
+     * lookup relies on increasing offsets. */
+    uint32_t used_groups = 0;
+    for (uint32_t i = 0; i < plan->group_count; ++i) {
+        opal_datatype_plan_group_t *group = plan->groups + i;
+        size_t block_offset = 0;
+
+        if (0 == group->blocks || 0 == group->repeat) {
+            continue;
+        }
+        for (uint32_t j = 0; j < group->blocks; ++j) {
+            opal_datatype_plan_block_t *block = plan->blocks + group->first_block + j;
+            block->offset = block_offset;
+            block_offset += block->length * block->repeat;
+        }
+        group->offset = offset;
+        offset += group->size * group->repeat;
+        plan->groups[used_groups++] = *group;
+    }
+    plan->group_count = used_groups;
+
+    if (offset != datatype->size || 0 == plan->group_count) {
+        DO_DEBUG(opal_output(0, "plan for datatype %s covers %" PRIsize_t " bytes instead of %" PRIsize_t "\n",
+                             datatype->name, offset, datatype->size););
+        OBJ_RELEASE(plan);
+        return OPAL_SUCCESS;
+    }
+
+    DO_DEBUG(opal_output(0, "plan for datatype %s: %u groups %u blocks\n", datatype->name,
+                         plan->group_count, plan->block_count););
+
+    datatype->plan = plan;
+    return OPAL_SUCCESS;
+}
+
+void opal_datatype_plan_locate(const opal_datatype_plan_t *plan, size_t size, size_t position,
+                               size_t *instance, uint32_t *group, size_t *iteration,
+                               uint32_t *block, size_t *copy, size_t *offset)
+{
+    const opal_datatype_plan_group_t *pGroup;
+    const opal_datatype_plan_block_t *pBlock;
+    uint32_t low, high;
+
+    *instance = position / size;
+    position -= *instance * size;
+
+    /* last group starting at or before the position */
+    low = 0;
+    high = plan->group_count - 1;
+    while (low < high) {
+        uint32_t mid = (low + high + 1) / 2;
+        if (plan->groups[mid].offset <= position) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    pGroup = plan->groups + low;
+    *group = low;
+    position -= pGroup->offset;
+    *iteration = position / pGroup->size;
+    position -= *iteration * pGroup->size;
+
+    low = pGroup->first_block;
+    high = pGroup->first_block + pGroup->blocks - 1;
+    while (low < high) {
+        uint32_t mid = (low + high + 1) / 2;
+        if (plan->blocks[mid].offset <= position) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    pBlock = plan->blocks + low;
+    *block = low;
+    position -= pBlock->offset;
+    *copy = position / pBlock->length;
+    *offset = position - *copy * pBlock->length;
+}
+
+/* copy loops specialized for the most common block lengths */
+#define OPAL_DATATYPE_PLAN_COPY(LENGTH)                  \
+    do {                                                 \
+        for (size_t _i = 0; _i < count; ++_i) {          \
+            if (pack) {                                  \
+                memcpy(packed, memory, (LENGTH));        \
+            } else {                                     \
+                memcpy(memory, packed, (LENGTH));        \
+            }                                            \
+            packed += (LENGTH);                          \
+            memory += stride;                            \
+        }                                                \
+    } while (0)
+
+/* gather or scatter vectors of 4 and 8 byte blocks with the vector instructions */
+static inline bool opal_datatype_plan_copy_simd(unsigned char *memory, unsigned char *packed,
+                                                size_t length, ptrdiff_t stride, size_t count,
+                                                const bool pack)
+{
+    opal_datatype_strided_fn_t fn;
+
+    if (count < OPAL_DATATYPE_SIMD_MIN_BLOCKS || stride == (ptrdiff_t) length) {
+        return false;
+    }
+    if (4 == length) {
+        fn = pack ? opal_datatype_simd.gather4 : opal_datatype_simd.scatter4;
+    } else {
+        fn = pack ? opal_datatype_simd.gather8 : opal_datatype_simd.scatter8;
+    }
+    if (NULL == fn) {
+        return false;
+    }
+    if (pack) {
+        fn(packed, memory, stride, count);
+    } else {
+        fn(memory, packed, stride, count);
+    }
+    return true;
+}
+
+static inline void opal_datatype_plan_copy(unsigned char *memory, unsigned char *packed,
+                                           size_t length, ptrdiff_t stride, size_t count,
+                                           const bool pack)
+{
+    switch (length) {
+    case 4:
+        if (!opal_datatype_plan_copy_simd(memory, packed, 4, stride, count, pack)) {
+            OPAL_DATATYPE_PLAN_COPY(4);
+        }
+        break;
+    case 8:
+        if (!opal_datatype_plan_copy_simd(memory, packed, 8, stride, count, pack)) {
+            OPAL_DATATYPE_PLAN_COPY(8);
+        }
+        break;
+    case 16:
+        OPAL_DATATYPE_PLAN_COPY(16);
+        break;
+    case 32:
+        OPAL_DATATYPE_PLAN_COPY(32);
+        break;
+    case 64:
+        OPAL_DATATYPE_PLAN_COPY(64);
+        break;
+    default:
+        OPAL_DATATYPE_PLAN_COPY(length);
+    }
+}
+
+/* copy up to length packed bytes starting at a packed position, returns the bytes copied */
+static inline size_t opal_datatype_plan_copy_range(const opal_datatype_t *pData,
+                                                   unsigned char *pBaseBuf, size_t count,
+                                                   size_t position, unsigned char *packed,
+                                                   size_t length, const bool pack)
+{
+    const opal_datatype_plan_t *plan = pData->plan;
+    const ptrdiff_t extent = pData->ub - pData->lb;
+    const opal_datatype_plan_group_t *pGroup;
+    const opal_datatype_plan_block_t *pBlock;
+    size_t instance, iteration, copy, offset, space = length;
+    uint32_t group, block;
+
+    /* the position is recomputed from the packed offset so no stack is needed */
+    opal_datatype_plan_locate(plan, pData->size, position, &instance, &group, &iteration, &block,
+                              &copy, &offset);
+    pGroup = plan->groups + group;
+    pBlock = plan->blocks + block;
+
+    while (0 != space && instance < count) {
+        unsigned char *memory = pBaseBuf + (ptrdiff_t) instance * extent
+                                + (ptrdiff_t) iteration * pGroup->stride + pBlock->disp
+                                + (ptrdiff_t) copy * pBlock->stride;
+
+        if (0 != offset || space < pBlock->length) {
+            /* partial copy */
+            size_t bytes = pBlock->length - offset;
+            if (bytes > space) {
+                bytes = space;
+            }
+            if (pack) {
+                memcpy(packed, memory + offset, bytes);
+            } else {
+                memcpy(memory + offset, packed, bytes);
+            }
+            packed += bytes;
+            space -= bytes;
+            offset += bytes;
+            if (offset < pBlock->length) {
+                break;
+            }
+            offset = 0;
+            ++copy;
+        } else {
+            size_t copies = pBlock->repeat - copy;
+            if (copies * pBlock->length > space) {
+                copies = space / pBlock->length;
+            }
+            opal_datatype_plan_copy(memory, packed, pBlock->length, pBlock->stride, copies, pack);
+            packed += copies * pBlock->length;
+            space -= copies * pBlock->length;
+            copy += copies;
+        }
+
+        if (copy < pBlock->repeat) {
+            continue;
+        }
+        /* next block, iteration, group and instance */
+        copy = 0;
+        if (++block < pGroup->first_block + pGroup->blocks) {
+            ++pBlock;
+            continue;
+        }
+        if (++iteration == pGroup->repeat) {
+            iteration = 0;
+            if (++group == plan->group_count) {
+                group = 0;
+                ++instance;
+            }
+            pGroup = plan->groups + group;
+        }
+        block = pGroup->first_block;
+        pBlock = plan->blocks + block;
+    }
+
+    return length - space;
+}
+
+struct opal_datatype_plan_job_t {
+    const opal_datatype_t *pData;
+    unsigned char *pBaseBuf;
+    size_t count;
+    size_t position;
+    unsigned char *packed;
+};
+typedef struct opal_datatype_plan_job_t opal_datatype_plan_job_t;
+
+static void opal_datatype_plan_pack_chunk(void *ctx, size_t first, size_t length)
+{
+    opal_datatype_plan_job_t *job = (opal_datatype_plan_job_t *) ctx;
+    (void) opal_datatype_plan_copy_range(job->pData, job->pBaseBuf, job->count, job->position + first,
+                                         job->packed + first, length, true);
+}
+
+static void opal_datatype_plan_unpack_chunk(void *ctx, size_t first, size_t length)
+{
+    opal_datatype_plan_job_t *job = (opal_datatype_plan_job_t *) ctx;
+    (void) opal_datatype_plan_copy_range(job->pData, job->pBaseBuf, job->count, job->position + first,
+                                         job->packed + first, length, false);
+}
+
+static inline int32_t opal_datatype_plan_advance(opal_convertor_t *pConvertor, struct iovec *iov,
+                                                 uint32_t *out_size, size_t *max_data,
+                                                 const bool pack)
+{
+    const opal_datatype_t *pData = pConvertor->pDesc;
+    size_t total = 0, end = pData->size * pConvertor->count;
+    uint32_t iov_count;
+
+    DO_DEBUG(opal_output(0, "plan %s( %p, {%p, %lu}, %u ) position %" PRIsize_t "\n",
+                         pack ? "pack" : "unpack", (void *) pConvertor->pBaseBuf,
+                         (void *) iov[0].iov_base, (unsigned long) iov[0].iov_len, *out_size,
+                         pConvertor->bConverted););
+
+    for (iov_count = 0; iov_count < *out_size && pConvertor->bConverted + total < end;
+         ++iov_count) {
+        size_t position = pConvertor->bConverted + total;
+        opal_datatype_plan_job_t job = {.pData = pData,
+                                        .pBaseBuf = pConvertor->pBaseBuf,
+                                        .count = pConvertor->count,
+                                        .position = position,
+                                        .packed = (unsigned char *) iov[iov_count].iov_base};
+
+        if (iov[iov_count].iov_len > end - position) {
+            iov[iov_count].iov_len = end - position;
+        }
+        /* very large pieces are split between the helper threads, if any */
+        if (OPAL_SUCCESS
+            != opal_datatype_parallel_run(pack ? opal_datatype_plan_pack_chunk
+                                               : opal_datatype_plan_unpack_chunk,
+                                          &job, iov[iov_count].iov_len)) {
+            iov[iov_count].iov_len = opal_datatype_plan_copy_range(pData, pConvertor->pBaseBuf,
+                                                                   pConvertor->count, position,
+                                                                   job.packed,
+                                                                   iov[iov_count].iov_len, pack);
+        }
+        total += iov[iov_count].iov_len;
+    }
+
+    *max_data = total;
+    *out_size = iov_count;
+    pConvertor->bConverted += total;
+    pConvertor->flags |= CONVERTOR_STACK_STALE;
+    if (pConvertor->bConverted == pConvertor->local_size) {
+        pConvertor->flags |= CONVERTOR_COMPLETED;
+        return 1;
+    }
+    return 0;
+}
+
+int32_t opal_datatype_plan_pack(opal_convertor_t *pConvertor, struct iovec *iov,
+                                uint32_t *out_size, size_t *max_data)
+{
+    return opal_datatype_plan_advance(pConvertor, iov, out_size, max_data, true);
+}
+
+int32_t opal_datatype_plan_unpack(opal_convertor_t *pConvertor, struct iovec *iov,
+                                  uint32_t *out_size, size_t *max_data)
+{
+    return opal_datatype_plan_advance(pConvertor, iov, out_size, max_data, false);
+}
@@ -0,0 +1,101 @@
+/* -*- Mode: C; c-basic-offset:4 ; -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#ifndef OPAL_DATATYPE_PLAN_H_HAS_BEEN_INCLUDED
+#define OPAL_DATATYPE_PLAN_H_HAS_BEEN_INCLUDED
+
+#include "opal_config.h"
+
+#include "opal/class/opal_object.h"
+#include "opal/datatype/opal_convertor.h"
+
+BEGIN_C_DECLS
+
+/**
+ * A pack plan is a flattened form of the optimized description of a committed
+ * datatype. Instead of interpreting the description with a stack, the pack and
+ * unpack functions walk a list of groups. Each group is repeated with a constant
+ * stride and holds a list of run-length encoded blocks of contiguous bytes:
+ *
+ *   for each group g
+ *     for r in [0, g.repeat)
+ *       for each block b of g
+ *         for j in [0, b.repeat)
+ *           copy b.length bytes at r * g.stride + b.disp + j * b.stride
+ *
+ * The plan describes one instance of the datatype. It is only used by homogeneous
+ * convertors on host memory, where packing is a plain byte copy.
+ */
+struct opal_datatype_plan_block_t {
+    ptrdiff_t disp;   /**< displacement of the first copy */
+    ptrdiff_t stride; /**< distance between two copies */
+    size_t length;    /**< bytes in each copy */
+    size_t repeat;    /**< number of copies */
+    size_t offset;    /**< packed bytes before this block in one iteration of the group */
+};
+typedef struct opal_datatype_plan_block_t opal_datatype_plan_block_t;
+
+struct opal_datatype_plan_group_t {
+    ptrdiff_t stride;     /**< distance between two iterations */
+    size_t repeat;        /**< number of iterations */
+    size_t size;          /**< packed bytes in one iteration */
+    size_t offset;        /**< packed bytes before this group in one instance of the datatype */
+    uint32_t first_block; /**< index of the first block of the group */
+    uint32_t blocks;      /**< number of blocks in the group */
+};
+typedef struct opal_datatype_plan_group_t opal_datatype_plan_group_t;
+
+struct opal_datatype_plan_t {
+    opal_object_t super;
+    uint32_t group_count;
+    uint32_t block_count;
+    opal_datatype_plan_group_t *groups;
+    opal_datatype_plan_block_t *blocks;
+};
+typedef struct opal_datatype_plan_t opal_datatype_plan_t;
+
+OPAL_DECLSPEC OBJ_CLASS_DECLARATION(opal_datatype_plan_t);
+
+/**
+ * Maximum number of blocks in a plan (0 disables the plans). Datatypes that need
+ * more blocks are packed by interpreting their description.
+ */
+OPAL_DECLSPEC extern unsigned int opal_datatype_plan_max_blocks;
+
+/**
+ * Build the plan of a committed datatype and cache it on the datatype. Failing to
+ * build a plan is not an error, the datatype then has no plan.
+ */
+int32_t opal_datatype_plan_create(opal_datatype_t *datatype);
+
+/**
+ * Locate a packed position in the plan
+ *
+ * @param[in]  plan      pack plan
+ * @param[in]  size      size of the datatype
+ * @param[in]  position  packed position
+ * @param[out] instance  datatype instance
+ * @param[out] group     group index
+ * @param[out] iteration iteration of the group
+ * @param[out] block     block index
+ * @param[out] copy      copy of the block
+ * @param[out] offset    offset in the copy
+ */
+void opal_datatype_plan_locate(const opal_datatype_plan_t *plan, size_t size, size_t position,
+                               size_t *instance, uint32_t *group, size_t *iteration,
+                               uint32_t *block, size_t *copy, size_t *offset);
+
+int32_t opal_datatype_plan_pack(opal_convertor_t *pConvertor, struct iovec *iov,
+                                uint32_t *out_size, size_t *max_data);
+int32_t opal_datatype_plan_unpack(opal_convertor_t *pConvertor, struct iovec *iov,
+                                  uint32_t *out_size, size_t *max_data);
+
+END_C_DECLS
+
+#endif /* OPAL_DATATYPE_PLAN_H_HAS_BEEN_INCLUDED */
@@ -251,8 +251,15 @@ int opal_convertor_generic_simple_position(opal_convertor_t *pConvertor, size_t
                 } else {
                     assert(OPAL_DATATYPE_LOOP == description[pStack->index].loop.common.type);
                     pStack->disp += description[pStack->index].loop.extent;
-                    pos_desc = pStack->index; /* go back to the loop start itself to give a chance
-                                               * to move forward by entire loops */
+                    /* go back to the loop start itself, with the remaining iterations, to give
+                     * a chance to move forward by entire loops */
+                    pos_desc = pStack->index;
+                    count_desc = pStack->count;
+                    base_pointer = pConvertor->pBaseBuf + pStack->disp;
+                    pConvertor->stack_pos--;
+                    pStack--;
+                    pElem = &(description[pos_desc]);
+                    continue;
                 }
             }
             base_pointer = pConvertor->pBaseBuf + pStack->disp;
@@ -264,7 +271,6 @@ int opal_convertor_generic_simple_position(opal_convertor_t *pConvertor, size_t
                                  (unsigned long) iov_len_local););
         }
         if (OPAL_DATATYPE_LOOP == pElem->elem.common.type) {
-            ptrdiff_t local_disp = (ptrdiff_t) base_pointer;
             ddt_endloop_desc_t *end_loop = (ddt_endloop_desc_t *) (pElem + pElem->loop.items);
             size_t full_loops = iov_len_local / end_loop->size;
             full_loops = count_desc <= full_loops ? count_desc : full_loops;
@@ -279,9 +285,8 @@ int opal_convertor_generic_simple_position(opal_convertor_t *pConvertor, size_t
                 }
                 /* Save the stack with the correct last_count value. */
             }
-            local_disp = (ptrdiff_t) base_pointer - local_disp;
             PUSH_STACK(pStack, pConvertor->stack_pos, pos_desc, OPAL_DATATYPE_LOOP, count_desc,
-                       pStack->disp + local_disp);
+                       base_pointer - pConvertor->pBaseBuf);
             pos_desc++;
         update_loop_description: /* update the current state */
             base_pointer = pConvertor->pBaseBuf + pStack->disp;
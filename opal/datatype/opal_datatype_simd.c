@@ -0,0 +1,323 @@
+/* -*- Mode: C; c-basic-offset:4 ; -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "opal_config.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "opal/datatype/opal_datatype_simd.h"
+
+opal_datatype_simd_kernels_t opal_datatype_simd = {NULL, NULL, NULL, NULL};
+int opal_datatype_simd_support = 0;
+
+/*
+ * The kernels are compiled with function level target attributes so that a
+ * single object carries all the variants and the selection is made at runtime
+ * from the processor features, like the op/avx component does with its
+ * per-instruction-set libraries.
+ */
+#if defined(__x86_64__) && defined(__GNUC__)
+#    define OPAL_DATATYPE_SIMD_X86 1
+#    include <immintrin.h>
+#else
+#    define OPAL_DATATYPE_SIMD_X86 0
+#endif
+
+#if OPAL_DATATYPE_SIMD_X86
+
+static void opal_datatype_simd_cpuid(uint32_t eax, uint32_t ecx, uint32_t *abcd)
+{
+    uint32_t ebx = 0, edx = 0;
+    __asm__("cpuid" : "+b"(ebx), "+a"(eax), "+c"(ecx), "=d"(edx));
+    abcd[0] = eax;
+    abcd[1] = ebx;
+    abcd[2] = ecx;
+    abcd[3] = edx;
+}
+
+static uint64_t opal_datatype_simd_xgetbv(void)
+{
+    uint32_t eax, edx;
+    __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64_t) edx << 32) | eax;
+}
+
+int opal_datatype_simd_detect(void)
+{
+    const uint32_t osxsave_mask = (1U << 27); /* OSXSAVE (EAX = 1) : ECX */
+    const uint32_t avx2_mask = (1U << 5);     /* AVX2    (EAX = 7, ECX = 0) : EBX */
+    const uint32_t avx512f_mask = (1U << 16); /* AVX512F (EAX = 7, ECX = 0) : EBX */
+    int flags = OPAL_DATATYPE_SIMD_SSE2; /* part of the x86_64 baseline */
+    uint32_t abcd[4];
+    uint64_t xcr0;
+
+    opal_datatype_simd_cpuid(0, 0, abcd);
+    if (abcd[0] < 7) {
+        return flags;
+    }
+    opal_datatype_simd_cpuid(1, 0, abcd);
+    if (!(abcd[2] & osxsave_mask)) {
+        return flags;
+    }
+    /* the operating system must save the vector registers */
+    xcr0 = opal_datatype_simd_xgetbv();
+    opal_datatype_simd_cpuid(7, 0, abcd);
+    if ((xcr0 & 0x6) == 0x6 && (abcd[1] & avx2_mask)) {
+        flags |= OPAL_DATATYPE_SIMD_AVX2;
+    }
+    if ((xcr0 & 0xe6) == 0xe6 && (abcd[1] & avx512f_mask)) {
+        flags |= OPAL_DATATYPE_SIMD_AVX512;
+    }
+    return flags;
+}
+
+/* SSE2: two 8 byte blocks per step, no gather or scatter instructions */
+static void opal_datatype_gather8_sse2(unsigned char *dst, const unsigned char *src,
+                                       ptrdiff_t stride, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 2 <= count; i += 2) {
+        __m128d v = _mm_load_sd((const double *) src);
+        v = _mm_loadh_pd(v, (const double *) (src + stride));
+        _mm_storeu_pd((double *) dst, v);
+        src += 2 * stride;
+        dst += 16;
+    }
+    if (i < count) {
+        memcpy(dst, src, 8);
+    }
+}
+
+static void opal_datatype_scatter8_sse2(unsigned char *dst, const unsigned char *src,
+                                        ptrdiff_t stride, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 2 <= count; i += 2) {
+        __m128d v = _mm_loadu_pd((const double *) src);
+        _mm_storel_pd((double *) dst, v);
+        _mm_storeh_pd((double *) (dst + stride), v);
+        src += 16;
+        dst += 2 * stride;
+    }
+    if (i < count) {
+        memcpy(dst, src, 8);
+    }
+}
+
+/* AVX2: hardware gathers, the scatters extract the lanes of a wide load */
+__attribute__((target("avx2"))) static void
+opal_datatype_gather4_avx2(unsigned char *dst, const unsigned char *src, ptrdiff_t stride,
+                           size_t count)
+{
+    const __m256i index = _mm256_set_epi64x(3 * stride, 2 * stride, stride, 0);
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm256_i64gather_epi32((const int *) src, index, 1);
+        _mm_storeu_si128((__m128i *) dst, v);
+        src += 4 * stride;
+        dst += 16;
+    }
+    for (; i < count; ++i) {
+        memcpy(dst, src, 4);
+        src += stride;
+        dst += 4;
+    }
+}
+
+__attribute__((target("avx2"))) static void
+opal_datatype_gather8_avx2(unsigned char *dst, const unsigned char *src, ptrdiff_t stride,
+                           size_t count)
+{
+    const __m256i index = _mm256_set_epi64x(3 * stride, 2 * stride, stride, 0);
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m256i v = _mm256_i64gather_epi64((const long long *) src, index, 1);
+        _mm256_storeu_si256((__m256i *) dst, v);
+        src += 4 * stride;
+        dst += 32;
+    }
+    for (; i < count; ++i) {
+        memcpy(dst, src, 8);
+        src += stride;
+        dst += 8;
+    }
+}
+
+__attribute__((target("avx2"))) static void
+opal_datatype_scatter4_avx2(unsigned char *dst, const unsigned char *src, ptrdiff_t stride,
+                            size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *) src);
+        int32_t lane[4] = {_mm_cvtsi128_si32(v), _mm_extract_epi32(v, 1), _mm_extract_epi32(v, 2),
+                           _mm_extract_epi32(v, 3)};
+        memcpy(dst, &lane[0], 4);
+        memcpy(dst + stride, &lane[1], 4);
+        memcpy(dst + 2 * stride, &lane[2], 4);
+        memcpy(dst + 3 * stride, &lane[3], 4);
+        src += 16;
+        dst += 4 * stride;
+    }
+    for (; i < count; ++i) {
+        memcpy(dst, src, 4);
+        src += 4;
+        dst += stride;
+    }
+}
+
+__attribute__((target("avx2"))) static void
+opal_datatype_scatter8_avx2(unsigned char *dst, const unsigned char *src, ptrdiff_t stride,
+                            size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i *) src);
+        __m128i lo = _mm256_castsi256_si128(v), hi = _mm256_extracti128_si256(v, 1);
+        _mm_storel_epi64((__m128i *) dst, lo);
+        _mm_storeh_pd((double *) (dst + stride), _mm_castsi128_pd(lo));
+        _mm_storel_epi64((__m128i *) (dst + 2 * stride), hi);
+        _mm_storeh_pd((double *) (dst + 3 * stride), _mm_castsi128_pd(hi));
+        src += 32;
+        dst += 4 * stride;
+    }
+    for (; i < count; ++i) {
+        memcpy(dst, src, 8);
+        src += 8;
+        dst += stride;
+    }
+}
+
+/* AVX-512: hardware gathers and scatters, eight blocks per step */
+#    define OPAL_DATATYPE_SIMD_INDEX512(STRIDE)                                            \
+        _mm512_set_epi64(7 * (STRIDE), 6 * (STRIDE), 5 * (STRIDE), 4 * (STRIDE), 3 * (STRIDE), \
+                         2 * (STRIDE), (STRIDE), 0)
+
+__attribute__((target("avx512f"))) static void
+opal_datatype_gather4_avx512(unsigned char *dst, const unsigned char *src, ptrdiff_t stride,
+                             size_t count)
+{
+    const __m512i index = OPAL_DATATYPE_SIMD_INDEX512(stride);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = _mm512_i64gather_epi32(index, (const void *) src, 1);
+        _mm256_storeu_si256((__m256i *) dst, v);
+        src += 8 * stride;
+        dst += 32;
+    }
+    for (; i < count; ++i) {
+        memcpy(dst, src, 4);
+        src += stride;
+        dst += 4;
+    }
+}
+
+__attribute__((target("avx512f"))) static void
+opal_datatype_gather8_avx512(unsigned char *dst, const unsigned char *src, ptrdiff_t stride,
+                             size_t count)
+{
+    const __m512i index = OPAL_DATATYPE_SIMD_INDEX512(stride);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m512i v = _mm512_i64gather_epi64(index, (const void *) src, 1);
+        _mm512_storeu_si512((void *) dst, v);
+        src += 8 * stride;
+        dst += 64;
+    }
+    for (; i < count; ++i) {
+        memcpy(dst, src, 8);
+        src += stride;
+        dst += 8;
+    }
+}
+
+__attribute__((target("avx512f"))) static void
+opal_datatype_scatter4_avx512(unsigned char *dst, const unsigned char *src, ptrdiff_t stride,
+                              size_t count)
+{
+    const __m512i index = OPAL_DATATYPE_SIMD_INDEX512(stride);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *) src);
+        _mm512_i64scatter_epi32((void *) dst, index, v, 1);
+        src += 32;
+        dst += 8 * stride;
+    }
+    for (; i < count; ++i) {
+        memcpy(dst, src, 4);
+        src += 4;
+        dst += stride;
+    }
+}
+
+__attribute__((target("avx512f"))) static void
+opal_datatype_scatter8_avx512(unsigned char *dst, const unsigned char *src, ptrdiff_t stride,
+                              size_t count)
+{
+    const __m512i index = OPAL_DATATYPE_SIMD_INDEX512(stride);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m512i v = _mm512_loadu_si512((const void *) src);
+        _mm512_i64scatter_epi64((void *) dst, index, v, 1);
+        src += 64;
+        dst += 8 * stride;
+    }
+    for (; i < count; ++i) {
+        memcpy(dst, src, 8);
+        src += 8;
+        dst += stride;
+    }
+}
+
+void opal_datatype_simd_init(void)
+{
+    int flags = opal_datatype_simd_support & opal_datatype_simd_detect();
+
+    memset(&opal_datatype_simd, 0, sizeof(opal_datatype_simd));
+    if (flags & OPAL_DATATYPE_SIMD_AVX512) {
+        opal_datatype_simd.gather4 = opal_datatype_gather4_avx512;
+        opal_datatype_simd.gather8 = opal_datatype_gather8_avx512;
+        opal_datatype_simd.scatter4 = opal_datatype_scatter4_avx512;
+        opal_datatype_simd.scatter8 = opal_datatype_scatter8_avx512;
+    } else if (flags & OPAL_DATATYPE_SIMD_AVX2) {
+        opal_datatype_simd.gather4 = opal_datatype_gather4_avx2;
+        opal_datatype_simd.gather8 = opal_datatype_gather8_avx2;
+        opal_datatype_simd.scatter4 = opal_datatype_scatter4_avx2;
+        opal_datatype_simd.scatter8 = opal_datatype_scatter8_avx2;
+    } else if (flags & OPAL_DATATYPE_SIMD_SSE2) {
+        opal_datatype_simd.gather8 = opal_datatype_gather8_sse2;
+        opal_datatype_simd.scatter8 = opal_datatype_scatter8_sse2;
+    }
+}
+
+#else /* OPAL_DATATYPE_SIMD_X86 */
+
+int opal_datatype_simd_detect(void)
+{
+    return 0;
+}
+
+void opal_datatype_simd_init(void)
+{
+    memset(&opal_datatype_simd, 0, sizeof(opal_datatype_simd));
+}
+
+#endif /* OPAL_DATATYPE_SIMD_X86 */
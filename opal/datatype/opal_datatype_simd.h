@@ -0,0 +1,60 @@
+/* -*- Mode: C; c-basic-offset:4 ; -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#ifndef OPAL_DATATYPE_SIMD_H_HAS_BEEN_INCLUDED
+#define OPAL_DATATYPE_SIMD_H_HAS_BEEN_INCLUDED
+
+#include "opal_config.h"
+
+#include <stddef.h>
+
+BEGIN_C_DECLS
+
+#define OPAL_DATATYPE_SIMD_SSE2   0x001
+#define OPAL_DATATYPE_SIMD_AVX2   0x002
+#define OPAL_DATATYPE_SIMD_AVX512 0x004
+
+/**
+ * Strided copy kernel. A gather copies count blocks, each stride bytes apart
+ * in src, to consecutive locations in dst. A scatter copies count consecutive
+ * blocks of src to dst, stride bytes apart.
+ */
+typedef void (*opal_datatype_strided_fn_t)(unsigned char *dst, const unsigned char *src,
+                                           ptrdiff_t stride, size_t count);
+
+/**
+ * Kernels for vectors of small blocks (one float or one double every N
+ * elements). NULL when the processor has no suitable instructions, in which
+ * case the block is copied with memcpy.
+ */
+struct opal_datatype_simd_kernels_t {
+    opal_datatype_strided_fn_t gather4;
+    opal_datatype_strided_fn_t gather8;
+    opal_datatype_strided_fn_t scatter4;
+    opal_datatype_strided_fn_t scatter8;
+};
+typedef struct opal_datatype_simd_kernels_t opal_datatype_simd_kernels_t;
+
+OPAL_DECLSPEC extern opal_datatype_simd_kernels_t opal_datatype_simd;
+
+/** Instruction sets usable by the kernels (OPAL_DATATYPE_SIMD_* flags) */
+OPAL_DECLSPEC extern int opal_datatype_simd_support;
+
+/** Minimum number of blocks for which the kernels are used */
+#define OPAL_DATATYPE_SIMD_MIN_BLOCKS 8
+
+/** Instruction sets supported by the processor */
+OPAL_DECLSPEC int opal_datatype_simd_detect(void);
+
+/** Select the kernels matching opal_datatype_simd_support */
+OPAL_DECLSPEC void opal_datatype_simd_init(void);
+
+END_C_DECLS
+
+#endif /* OPAL_DATATYPE_SIMD_H_HAS_BEEN_INCLUDED */
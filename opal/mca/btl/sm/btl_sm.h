@@ -45,6 +45,12 @@
 #ifdef HAVE_UNISTD_H
 #    include <unistd.h>
 #endif /* HAVE_UNISTD_H */
+#ifdef HAVE_LINUX_FUTEX_H
+#    include <limits.h>
+#    include <linux/futex.h>
+#    include <sys/syscall.h>
+#    include <time.h>
+#endif /* HAVE_LINUX_FUTEX_H */
 
 #include "opal/mca/shmem/base/base.h"
 
@@ -161,6 +167,26 @@ static inline bool mca_btl_is_self_endpoint(mca_btl_base_endpoint_t *endpoint) {
     return endpoint->peer_smp_rank == MCA_BTL_SM_LOCAL_RANK;
 }
 
+/**
+ * Wake up a peer blocked waiting for messages (see btl_sm_idle_spin_count)
+ *
+ * @param fifo (IN)     fifo of the peer
+ *
+ * Must be called once the message is visible to the peer.
+ */
+static inline void mca_btl_sm_wake_peer(struct sm_fifo_t *fifo)
+{
+#ifdef HAVE_LINUX_FUTEX_H
+    if (OPAL_UNLIKELY(mca_btl_sm_component.idle_spin_count)) {
+        /* order the write of the message with the read of the sleeping flag */
+        opal_atomic_mb();
+        if (fifo->sleeping && opal_atomic_swap_32(&fifo->sleeping, 0)) {
+            (void) syscall(SYS_futex, (void *) &fifo->sleeping, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+        }
+    }
+#endif /* HAVE_LINUX_FUTEX_H */
+}
+
 END_C_DECLS
 
 #endif
@@ -32,6 +32,7 @@
  */
 #include "opal_config.h"
 
+#include "opal/mca/base/mca_base_pvar.h"
 #include "opal/mca/btl/base/btl_base_error.h"
 #include "opal/mca/threads/mutex.h"
 #include "opal/util/output.h"
@@ -186,6 +187,70 @@ static int mca_btl_sm_component_register(void)
                                            MCA_BASE_VAR_SCOPE_LOCAL,
                                            &mca_btl_sm_component.fbox_size);
 
+    mca_btl_sm_component.fbox_max_size = 32768;
+    (void) mca_base_component_var_register(&mca_btl_sm_component.super.btl_version,
+                                           "fbox_max_size",
+                                           "Size of the fast transfer buffers given to peers "
+                                           "that often send messages too large for a "
+                                           "regular fast transfer buffer. Set to fbox_size or "
+                                           "less to disable (default: 32k)",
+                                           MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0,
+                                           MCA_BASE_VAR_FLAG_SETTABLE, OPAL_INFO_LVL_5,
+                                           MCA_BASE_VAR_SCOPE_LOCAL,
+                                           &mca_btl_sm_component.fbox_max_size);
+
+    mca_btl_sm_component.fbox_max_grown = 4;
+    (void) mca_base_component_var_register(&mca_btl_sm_component.super.btl_version,
+                                           "fbox_max_grown",
+                                           "Maximum number of fbox_max_size eager send "
+                                           "buffers to allocate (default: 4)",
+                                           MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0,
+                                           MCA_BASE_VAR_FLAG_SETTABLE, OPAL_INFO_LVL_5,
+                                           MCA_BASE_VAR_SCOPE_LOCAL,
+                                           &mca_btl_sm_component.fbox_max_grown);
+
+    mca_btl_sm_component.doorbell_min_peers = 64;
+    (void) mca_base_component_var_register(&mca_btl_sm_component.super.btl_version,
+                                           "doorbell_min_peers",
+                                           "Minimum number of local peers before senders flag "
+                                           "the fast boxes they write to in a bitmap of the "
+                                           "receiver, so that the receiver only polls the fast "
+                                           "boxes of active peers. Must be set the same on all "
+                                           "the local processes. 0 disables the bitmap "
+                                           "(default: 64)",
+                                           MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0,
+                                           MCA_BASE_VAR_FLAG_SETTABLE, OPAL_INFO_LVL_5,
+                                           MCA_BASE_VAR_SCOPE_LOCAL,
+                                           &mca_btl_sm_component.doorbell_min_peers);
+
+    mca_btl_sm_component.idle_spin_count = 0;
+    (void) mca_base_component_var_register(&mca_btl_sm_component.super.btl_version,
+                                           "idle_spin_count",
+                                           "Number of consecutive polls that find nothing to "
+                                           "do, in this component and in the rest of the "
+                                           "progress engine, before this process blocks "
+                                           "until a local peer sends it something. Saves "
+                                           "CPU time on "
+                                           "oversubscribed nodes at the cost of the wake-up "
+                                           "latency. Must be set the same on all the local "
+                                           "processes. 0 disables blocking (default: 0)",
+                                           MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0,
+                                           MCA_BASE_VAR_FLAG_SETTABLE, OPAL_INFO_LVL_5,
+                                           MCA_BASE_VAR_SCOPE_LOCAL,
+                                           &mca_btl_sm_component.idle_spin_count);
+
+    mca_btl_sm_component.idle_timeout = 1000;
+    (void) mca_base_component_var_register(&mca_btl_sm_component.super.btl_version,
+                                           "idle_timeout",
+                                           "Maximum time (in microseconds) to block at once "
+                                           "when idle_spin_count is set, so that the other "
+                                           "sources of progress are still polled "
+                                           "(default: 1000)",
+                                           MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0,
+                                           MCA_BASE_VAR_FLAG_SETTABLE, OPAL_INFO_LVL_5,
+                                           MCA_BASE_VAR_SCOPE_LOCAL,
+                                           &mca_btl_sm_component.idle_timeout);
+
     if (0 == access("/dev/shm", W_OK)) {
         mca_btl_sm_component.backing_directory = "/dev/shm";
     } else {
@@ -199,6 +264,45 @@ static int mca_btl_sm_component_register(void)
         MCA_BASE_VAR_TYPE_STRING, NULL, 0, 0, OPAL_INFO_LVL_3, MCA_BASE_VAR_SCOPE_READONLY,
         &mca_btl_sm_component.backing_directory);
 
+    /* performance variables */
+    mca_btl_sm_component.fbox_hits = 0;
+    (void) mca_base_component_pvar_register(&mca_btl_sm_component.super.btl_version, "fbox_hits",
+                                            "Number of messages sent through a fast transfer "
+                                            "buffer",
+                                            OPAL_INFO_LVL_4, MCA_BASE_PVAR_CLASS_COUNTER,
+                                            MCA_BASE_VAR_TYPE_UINT64_T, NULL,
+                                            MCA_BASE_VAR_BIND_NO_OBJECT,
+                                            MCA_BASE_PVAR_FLAG_READONLY
+                                                | MCA_BASE_PVAR_FLAG_CONTINUOUS,
+                                            NULL, NULL, NULL,
+                                            (void *) &mca_btl_sm_component.fbox_hits);
+
+    mca_btl_sm_component.fbox_misses = 0;
+    (void) mca_base_component_pvar_register(&mca_btl_sm_component.super.btl_version,
+                                            "fbox_misses",
+                                            "Number of messages sent through a fragment "
+                                            "because no fast transfer buffer was set up for "
+                                            "the peer, it was full or the message was too large",
+                                            OPAL_INFO_LVL_4, MCA_BASE_PVAR_CLASS_COUNTER,
+                                            MCA_BASE_VAR_TYPE_UINT64_T, NULL,
+                                            MCA_BASE_VAR_BIND_NO_OBJECT,
+                                            MCA_BASE_PVAR_FLAG_READONLY
+                                                | MCA_BASE_PVAR_FLAG_CONTINUOUS,
+                                            NULL, NULL, NULL,
+                                            (void *) &mca_btl_sm_component.fbox_misses);
+
+    mca_btl_sm_component.fbox_reclaimed = 0;
+    (void) mca_base_component_pvar_register(&mca_btl_sm_component.super.btl_version,
+                                            "fbox_reclaimed",
+                                            "Number of fast transfer buffers taken away from a "
+                                            "peer to be reused",
+                                            OPAL_INFO_LVL_4, MCA_BASE_PVAR_CLASS_COUNTER,
+                                            MCA_BASE_VAR_TYPE_UNSIGNED_LONG, NULL,
+                                            MCA_BASE_VAR_BIND_NO_OBJECT,
+                                            MCA_BASE_PVAR_FLAG_READONLY
+                                                | MCA_BASE_PVAR_FLAG_CONTINUOUS,
+                                            NULL, NULL, NULL, &mca_btl_sm_component.fbox_reclaimed);
+
     mca_btl_sm.super.btl_exclusivity = MCA_BTL_EXCLUSIVITY_HIGH;
 
     mca_btl_sm.super.btl_eager_limit = 4 * 1024;
@@ -232,6 +336,7 @@ static int mca_btl_sm_component_open(void)
     OBJ_CONSTRUCT(&mca_btl_sm_component.sm_frags_user, opal_free_list_t);
     OBJ_CONSTRUCT(&mca_btl_sm_component.sm_frags_max_send, opal_free_list_t);
     OBJ_CONSTRUCT(&mca_btl_sm_component.sm_fboxes, opal_free_list_t);
+    OBJ_CONSTRUCT(&mca_btl_sm_component.sm_fboxes_grown, opal_free_list_t);
     OBJ_CONSTRUCT(&mca_btl_sm_component.lock, opal_mutex_t);
     OBJ_CONSTRUCT(&mca_btl_sm_component.pending_endpoints, opal_list_t);
     OBJ_CONSTRUCT(&mca_btl_sm_component.pending_fragments, opal_list_t);
@@ -249,6 +354,7 @@ static int mca_btl_sm_component_close(void)
     OBJ_DESTRUCT(&mca_btl_sm_component.sm_frags_user);
     OBJ_DESTRUCT(&mca_btl_sm_component.sm_frags_max_send);
     OBJ_DESTRUCT(&mca_btl_sm_component.sm_fboxes);
+    OBJ_DESTRUCT(&mca_btl_sm_component.sm_fboxes_grown);
     OBJ_DESTRUCT(&mca_btl_sm_component.lock);
     OBJ_DESTRUCT(&mca_btl_sm_component.pending_endpoints);
     OBJ_DESTRUCT(&mca_btl_sm_component.pending_fragments);
@@ -324,6 +430,12 @@ mca_btl_sm_component_init(int *num_btls, bool enable_progress_threads, bool enab
 
     component->fbox_size = (component->fbox_size + MCA_BTL_SM_FBOX_ALIGNMENT_MASK)
                            & ~MCA_BTL_SM_FBOX_ALIGNMENT_MASK;
+    component->fbox_max_size = (component->fbox_max_size + MCA_BTL_SM_FBOX_ALIGNMENT_MASK)
+                               & ~MCA_BTL_SM_FBOX_ALIGNMENT_MASK;
+    if (0 == component->fbox_max_grown) {
+        /* disable growing fast boxes */
+        component->fbox_max_size = component->fbox_size;
+    }
 
     if (component->segment_size > (1ul << MCA_BTL_SM_OFFSET_BITS)) {
         component->segment_size = 2ul << MCA_BTL_SM_OFFSET_BITS;
@@ -331,6 +443,23 @@ mca_btl_sm_component_init(int *num_btls, bool enable_progress_threads, bool enab
 
     /* no fast boxes allocated initially */
     component->num_fbox_in_endpoints = 0;
+    component->num_fbox_retiring = 0;
+
+#ifndef HAVE_LINUX_FUTEX_H
+    if (component->idle_spin_count) {
+        BTL_VERBOSE(("blocking when idle is not supported on this platform"));
+        component->idle_spin_count = 0;
+    }
+#endif
+    component->idle_polls = 0;
+
+    /* the doorbell follows the fifo at the start of the segment */
+    component->my_doorbell = NULL;
+    component->doorbell_words = 0;
+    if (component->doorbell_min_peers
+        && (unsigned int) MCA_BTL_SM_NUM_LOCAL_PEERS >= component->doorbell_min_peers) {
+        component->doorbell_words = MCA_BTL_SM_DOORBELL_WORDS(MCA_BTL_SM_NUM_LOCAL_PEERS + 1);
+    }
 
     bool have_smsc = (NULL != mca_smsc);
     if (have_smsc) {
@@ -395,6 +524,13 @@ mca_btl_sm_component_init(int *num_btls, bool enable_progress_threads, bool enab
     /* initialize my fifo */
     sm_fifo_init((struct sm_fifo_t *) component->my_segment);
 
+    if (component->doorbell_words) {
+        component->my_doorbell = (opal_atomic_int64_t *) (component->my_segment
+                                                          + MCA_BTL_SM_FIFO_SIZE);
+        memset((void *) component->my_doorbell, 0,
+               MCA_BTL_SM_DOORBELL_SIZE(component->doorbell_words));
+    }
+
     rc = mca_btl_base_sm_modex_send();
     if (OPAL_SUCCESS != rc) {
         BTL_VERBOSE(("Error sending modex"));
@@ -456,12 +592,147 @@ void mca_btl_sm_poll_handle_frag(mca_btl_sm_hdr_t *hdr, struct mca_btl_base_endp
         mca_btl_sm_endpoint_setup_fbox_recv(endpoint, relative2virtual(hdr->fbox_base));
         mca_btl_sm_component.fbox_in_endpoints[mca_btl_sm_component.num_fbox_in_endpoints++]
             = endpoint;
+        if (NULL != mca_btl_sm_component.my_doorbell) {
+            /* the sender may have flagged the fast box before it was set up here */
+            mca_btl_sm_fbox_ring_doorbell(mca_btl_sm_component.my_doorbell,
+                                          endpoint->peer_smp_rank);
+        }
     }
 
     hdr->flags = MCA_BTL_SM_FLAG_COMPLETE;
     sm_fifo_write_back(hdr, endpoint);
 }
 
+/**
+ * Retire the fast box of the least active peer
+ *
+ * @param hot (IN)      Sm BTL endpoint that could not get a fast box
+ * @param size (IN)     size of the fast boxes to consider
+ *
+ * The activity of a peer is the number of fragments sent to it since the last time this
+ * function was called. {hot} has had fbox_threshold sends since the last time it tried to
+ * get a fast box so only peers with fewer sends than that are considered. This is called
+ * with the component lock held.
+ */
+void mca_btl_sm_fbox_reclaim(mca_btl_base_endpoint_t *hot, unsigned int size)
+{
+    mca_btl_sm_component_t *component = &mca_btl_sm_component;
+    mca_btl_base_endpoint_t *victim = NULL;
+    size_t min_sends = component->fbox_threshold;
+
+    for (int i = 0; i < (int) (1 + MCA_BTL_SM_NUM_LOCAL_PEERS); ++i) {
+        mca_btl_base_endpoint_t *ep = component->endpoints + i;
+        size_t send_count, sends;
+
+        if (ep == hot || NULL == ep->fbox_out.buffer || size != ep->fbox_out.size) {
+            continue;
+        }
+
+        send_count = ep->send_count;
+        sends = send_count - ep->fbox_out.last_send_count;
+        ep->fbox_out.last_send_count = send_count;
+
+        /* a peer with data still in its fast box can not be retired right now */
+        if (sends < min_sends && ep->fbox_out.startp[0] == ep->fbox_out.end) {
+            min_sends = sends;
+            victim = ep;
+        }
+    }
+
+    if (NULL != victim) {
+        BTL_VERBOSE(("retiring fast box of peer %d (%u sends) for peer %d", victim->peer_smp_rank,
+                     (unsigned int) min_sends, hot->peer_smp_rank));
+        (void) mca_btl_sm_fbox_retire(victim);
+    }
+}
+
+/**
+ * Return the retired fast boxes released by the receivers to the free lists
+ */
+void mca_btl_sm_fbox_check_retired(void)
+{
+    mca_btl_sm_component_t *component = &mca_btl_sm_component;
+
+    OPAL_THREAD_LOCK(&component->lock);
+    for (int i = 0; i < (int) (1 + MCA_BTL_SM_NUM_LOCAL_PEERS); ++i) {
+        mca_btl_base_endpoint_t *ep = component->endpoints + i;
+
+        if (NULL == ep->fbox_out.fbox || NULL != ep->fbox_out.buffer
+            || MCA_BTL_SM_FBOX_RELEASED != ep->fbox_out.startp[0]) {
+            continue;
+        }
+
+        opal_atomic_rmb();
+        opal_free_list_return(ep->fbox_out.size == component->fbox_size
+                                  ? &component->sm_fboxes
+                                  : &component->sm_fboxes_grown,
+                              ep->fbox_out.fbox);
+        ep->fbox_out.fbox = NULL;
+        ++component->fbox_reclaimed;
+        (void) opal_atomic_add_fetch_32(&component->num_fbox_retiring, -1);
+    }
+    OPAL_THREAD_UNLOCK(&component->lock);
+}
+
+/**
+ * Ask the sender of the least active fast box this process polls to retire it
+ *
+ * Called when a peer could not setup a fast box because this process does not accept any
+ * more of them. Only fast boxes that received fewer than fbox_threshold messages since the
+ * last check are considered.
+ */
+void mca_btl_sm_fbox_request_retire(void)
+{
+    mca_btl_sm_component_t *component = &mca_btl_sm_component;
+    mca_btl_base_endpoint_t *victim = NULL;
+    size_t min_recvs = component->fbox_threshold;
+
+    component->my_fifo->fbox_wanted = 0;
+
+    for (unsigned int i = 0; i < component->num_fbox_in_endpoints; ++i) {
+        mca_btl_base_endpoint_t *ep = component->fbox_in_endpoints[i];
+        size_t recvs = ep->fbox_in.recv_count - ep->fbox_in.last_recv_count;
+
+        ep->fbox_in.last_recv_count = ep->fbox_in.recv_count;
+        if (recvs < min_recvs) {
+            min_recvs = recvs;
+            victim = ep;
+        }
+    }
+
+    if (NULL != victim) {
+        BTL_VERBOSE(("asking peer %d to retire its fast box", victim->peer_smp_rank));
+        victim->fbox_in.startp[MCA_BTL_SM_FBOX_RETIRE_REQUEST] = 1;
+        opal_atomic_wmb();
+        victim->fifo->fbox_retire = 1;
+        mca_btl_sm_wake_peer(victim->fifo);
+    }
+}
+
+/**
+ * Retire the fast boxes the receivers asked to be retired
+ */
+void mca_btl_sm_fbox_check_retire_requests(void)
+{
+    mca_btl_sm_component_t *component = &mca_btl_sm_component;
+
+    component->my_fifo->fbox_retire = 0;
+    opal_atomic_rmb();
+
+    for (int i = 0; i < (int) (1 + MCA_BTL_SM_NUM_LOCAL_PEERS); ++i) {
+        mca_btl_base_endpoint_t *ep = component->endpoints + i;
+
+        if (NULL == ep->fbox_out.buffer || !ep->fbox_out.startp[MCA_BTL_SM_FBOX_RETIRE_REQUEST]) {
+            continue;
+        }
+
+        if (!mca_btl_sm_fbox_retire(ep)) {
+            /* the receiver has not caught up yet. try again later */
+            component->my_fifo->fbox_retire = 1;
+        }
+    }
+}
+
 static int mca_btl_sm_poll_fifo(void)
 {
     struct mca_btl_base_endpoint_t *endpoint;
@@ -537,6 +808,76 @@ static void mca_btl_sm_progress_endpoints(void)
     OPAL_THREAD_UNLOCK(&mca_btl_sm_component.lock);
 }
 
+#ifdef HAVE_LINUX_FUTEX_H
+/* check if anything is waiting for this process without consuming it */
+static bool mca_btl_sm_has_work(void)
+{
+    mca_btl_sm_component_t *component = &mca_btl_sm_component;
+    struct sm_fifo_t *fifo = component->my_fifo;
+
+    if (SM_FIFO_FREE != fifo->fifo_head || fifo->fbox_wanted || fifo->fbox_retire
+        || component->num_fbox_retiring || opal_list_get_size(&component->pending_endpoints)) {
+        return true;
+    }
+
+    if (NULL != component->my_doorbell) {
+        for (unsigned int i = 0; i < component->doorbell_words; ++i) {
+            if (component->my_doorbell[i]) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    for (unsigned int i = 0; i < component->num_fbox_in_endpoints; ++i) {
+        mca_btl_base_endpoint_t *ep = component->fbox_in_endpoints[i];
+        unsigned int start = ep->fbox_in.start & MCA_BTL_SM_FBOX_OFFSET_MASK;
+        const mca_btl_sm_fbox_hdr_t hdr = mca_btl_sm_fbox_read_header(
+            MCA_BTL_SM_FBOX_HDR(ep->fbox_in.buffer + start));
+
+        if (0 != hdr.data.tag && hdr.data.seq == ep->fbox_in.seq) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Block until a local peer sends something to this process
+ *
+ * @param lock (IN)     progress lock (held)
+ *
+ * The sleeping flag in the fifo tells the peers to wake this process up (see
+ * mca_btl_sm_wake_peer). It is set before checking for incoming messages one last time so
+ * that a message can not slip in unnoticed. The progress lock is released before blocking
+ * so that other threads can still progress and block as well.
+ */
+static void mca_btl_sm_idle_wait(opal_atomic_int32_t *lock)
+{
+    mca_btl_sm_component_t *component = &mca_btl_sm_component;
+    struct sm_fifo_t *fifo = component->my_fifo;
+    struct timespec timeout = {.tv_sec = component->idle_timeout / 1000000,
+                               .tv_nsec = (component->idle_timeout % 1000000) * 1000};
+
+    component->idle_polls = 0;
+
+    fifo->sleeping = 1;
+    opal_atomic_mb();
+
+    if (mca_btl_sm_has_work()) {
+        /* also wakes up any other thread blocked in here */
+        mca_btl_sm_wake_peer(fifo);
+        *lock = 0;
+        return;
+    }
+
+    *lock = 0;
+    (void) syscall(SYS_futex, (void *) &fifo->sleeping, FUTEX_WAIT, 1, &timeout, NULL, 0);
+}
+#endif /* HAVE_LINUX_FUTEX_H */
+
 static int mca_btl_sm_component_progress(void)
 {
     static opal_atomic_int32_t lock = 0;
@@ -555,13 +896,36 @@ static int mca_btl_sm_component_progress(void)
 
     mca_btl_sm_progress_endpoints();
 
-    if (SM_FIFO_FREE == mca_btl_sm_component.my_fifo->fifo_head) {
-        lock = 0;
-        return count;
+    if (OPAL_UNLIKELY(mca_btl_sm_component.my_fifo->fbox_wanted)) {
+        mca_btl_sm_fbox_request_retire();
     }
 
-    count += mca_btl_sm_poll_fifo();
-    opal_atomic_mb();
+    if (OPAL_UNLIKELY(mca_btl_sm_component.my_fifo->fbox_retire)) {
+        mca_btl_sm_fbox_check_retire_requests();
+    }
+
+    if (OPAL_UNLIKELY(mca_btl_sm_component.num_fbox_retiring)) {
+        mca_btl_sm_fbox_check_retired();
+    }
+
+    if (SM_FIFO_FREE != mca_btl_sm_component.my_fifo->fifo_head) {
+        count += mca_btl_sm_poll_fifo();
+        opal_atomic_mb();
+    }
+
+#ifdef HAVE_LINUX_FUTEX_H
+    if (OPAL_UNLIKELY(mca_btl_sm_component.idle_spin_count)) {
+        /* only block when the other components had nothing to do either: the
+         * previous call to opal_progress() reported no event */
+        if (count || 0 == opal_progress_idle_calls()) {
+            mca_btl_sm_component.idle_polls = 0;
+        } else if (++mca_btl_sm_component.idle_polls >= mca_btl_sm_component.idle_spin_count) {
+            mca_btl_sm_idle_wait(&lock);
+            return 0;
+        }
+    }
+#endif /* HAVE_LINUX_FUTEX_H */
+
     lock = 0;
 
     return count;
@@ -28,18 +28,29 @@
  *  and BTL pair at startup.
  */
 
+/* value written by the receiver in place of the start offset once it no longer uses a retired
+ * fast box. a valid start offset is never smaller than MCA_BTL_SM_FBOX_ALIGNMENT. */
+#define MCA_BTL_SM_FBOX_RELEASED 0
+
+/* the first MCA_BTL_SM_FBOX_ALIGNMENT bytes of a fast box hold the start offset (written by the
+ * receiver), the size of the fast box (written by the sender) and whether the receiver wants the
+ * fast box to be retired */
+#define MCA_BTL_SM_FBOX_RETIRE_REQUEST 2
+
 static inline void mca_btl_sm_endpoint_setup_fbox_recv(struct mca_btl_base_endpoint_t *endpoint,
                                                        void *base)
 {
     endpoint->fbox_in.startp = (uint32_t *) base;
     endpoint->fbox_in.start = MCA_BTL_SM_FBOX_ALIGNMENT;
+    endpoint->fbox_in.size = endpoint->fbox_in.startp[1];
     endpoint->fbox_in.seq = 0;
     opal_atomic_wmb();
     endpoint->fbox_in.buffer = base;
 }
 
 static inline void mca_btl_sm_endpoint_setup_fbox_send(struct mca_btl_base_endpoint_t *endpoint,
-                                                       opal_free_list_item_t *fbox)
+                                                       opal_free_list_item_t *fbox,
+                                                       unsigned int size)
 {
     void *base = fbox->ptr;
 
@@ -47,8 +58,12 @@ static inline void mca_btl_sm_endpoint_setup_fbox_send(struct mca_btl_base_endpo
     endpoint->fbox_out.end = MCA_BTL_SM_FBOX_ALIGNMENT;
     endpoint->fbox_out.startp = (uint32_t *) base;
     endpoint->fbox_out.startp[0] = MCA_BTL_SM_FBOX_ALIGNMENT;
+    endpoint->fbox_out.startp[1] = size;
+    endpoint->fbox_out.size = size;
     endpoint->fbox_out.seq = 0;
     endpoint->fbox_out.fbox = fbox;
+    endpoint->fbox_out.last_send_count = endpoint->send_count;
+    endpoint->fbox_out.grow_score = 0;
 
     /* zero out the first header in the fast box */
     memset((char *) base + MCA_BTL_SM_FBOX_ALIGNMENT, 0, MCA_BTL_SM_FBOX_ALIGNMENT);
@@ -90,7 +105,53 @@ typedef union mca_btl_sm_fbox_hdr_t {
 /** macro for checking if the high bit is set */
 #define MCA_BTL_SM_FBOX_OFFSET_HBS(v) (!!((v) &MCA_BTL_SM_FBOX_HB_MASK))
 
+/* the doorbell holds one bit per local process (64 per word) and is padded to a cache line */
+#define MCA_BTL_SM_DOORBELL_WORDS(n) (((n) + 63) >> 6)
+#define MCA_BTL_SM_DOORBELL_SIZE(words) ((((words) * sizeof(int64_t)) + 63) & ~(size_t) 63)
+
+/**
+ * Flag the fast box of a local process in a doorbell
+ *
+ * @param doorbell (IN) doorbell of the receiving process
+ * @param rank (IN)     local rank of the process that wrote to the fast box
+ *
+ * Must be called after the message has been written to the fast box. The bit is only set
+ * if the receiver has already cleared it so that busy senders do not keep pulling the
+ * cache line away from each other.
+ */
+static inline void mca_btl_sm_fbox_ring_doorbell(opal_atomic_int64_t *doorbell, unsigned int rank)
+{
+    const int64_t bit = (int64_t) 1 << (rank & 63);
+
+    doorbell += rank >> 6;
+
+    /* order the write of the message with the read of the doorbell */
+    opal_atomic_mb();
+    if (!(*doorbell & bit)) {
+        (void) opal_atomic_fetch_or_64(doorbell, bit);
+    }
+}
+
+/* index of the lowest bit set in a (non-zero) doorbell word */
+static inline unsigned int mca_btl_sm_doorbell_lowbit(uint64_t bits)
+{
+#if OPAL_C_HAVE_BUILTIN_CTZLL
+    return (unsigned int) __builtin_ctzll(bits);
+#else
+    unsigned int index = 0;
+
+    for (; !(bits & 1); bits >>= 1, ++index)
+        ;
+
+    return index;
+#endif
+}
+
 void mca_btl_sm_poll_handle_frag(mca_btl_sm_hdr_t *hdr, mca_btl_base_endpoint_t *endpoint);
+void mca_btl_sm_fbox_reclaim(mca_btl_base_endpoint_t *hot, unsigned int size);
+void mca_btl_sm_fbox_check_retired(void);
+void mca_btl_sm_fbox_request_retire(void);
+void mca_btl_sm_fbox_check_retire_requests(void);
 
 static inline void mca_btl_sm_fbox_set_header(mca_btl_sm_fbox_hdr_t *hdr, uint16_t tag,
                                               uint16_t seq, uint32_t size)
@@ -113,26 +174,94 @@ static inline mca_btl_sm_fbox_hdr_t mca_btl_sm_fbox_read_header(mca_btl_sm_fbox_
     return tmp;
 }
 
+/**
+ * Retire the send fast box of a peer
+ *
+ * @param ep (IN)       Sm BTL endpoint
+ *
+ * The fast box can only be retired once the peer has consumed all the data in it so that
+ * the fragments sent through the fifo afterwards can not overtake it. The peer is told to
+ * stop polling the fast box with an empty 0xfe message. The fast box stays attached to the
+ * endpoint until the peer releases it (see mca_btl_sm_fbox_check_retired).
+ *
+ * @returns true if the fast box was retired
+ */
+static inline bool mca_btl_sm_fbox_retire(mca_btl_base_endpoint_t *ep)
+{
+    bool retired = false;
+
+    OPAL_THREAD_LOCK(&ep->lock);
+    if (NULL != ep->fbox_out.buffer && ep->fbox_out.startp[0] == ep->fbox_out.end) {
+        unsigned int end = ep->fbox_out.end & MCA_BTL_SM_FBOX_OFFSET_MASK;
+
+        opal_atomic_rmb();
+        mca_btl_sm_fbox_set_header(MCA_BTL_SM_FBOX_HDR(ep->fbox_out.buffer + end), 0xfe,
+                                   ep->fbox_out.seq++, 0);
+        opal_atomic_wmb();
+        ep->fbox_out.buffer = NULL;
+        (void) opal_atomic_add_fetch_32(&mca_btl_sm_component.num_fbox_retiring, 1);
+        retired = true;
+    }
+    OPAL_THREAD_UNLOCK(&ep->lock);
+
+    if (retired && NULL != ep->doorbell) {
+        mca_btl_sm_fbox_ring_doorbell(ep->doorbell, MCA_BTL_SM_LOCAL_RANK);
+    }
+
+    return retired;
+}
+
+/* a message of the given size did not fit in the fast box of the peer. if this happens for a
+ * sizable fraction of the messages sent to the peer (each miss counts for two, each hit takes
+ * one off) and the message would fit in a grown fast box then swap the fast box for a grown one. */
+static inline void mca_btl_sm_fbox_check_grow(mca_btl_base_endpoint_t *ep, size_t size)
+{
+    mca_btl_sm_component_t *component = &mca_btl_sm_component;
+
+    if (ep->fbox_out.size >= component->fbox_max_size || size > (component->fbox_max_size >> 2)) {
+        return;
+    }
+
+    ep->fbox_out.grow_score += 2;
+    if (ep->fbox_out.grow_score >= (int) (2 * component->fbox_threshold)) {
+        ep->fbox_out.grow = true;
+        if (mca_btl_sm_fbox_retire(ep)) {
+            ep->fbox_out.grow_score = 0;
+        }
+    }
+}
+
 /* attempt to reserve a contiguous segment from the remote ep */
 static inline bool mca_btl_sm_fbox_sendi(mca_btl_base_endpoint_t *ep, unsigned char tag,
                                          void *restrict header, const size_t header_size,
                                          void *restrict payload, const size_t payload_size)
 {
-    const unsigned int fbox_size = mca_btl_sm_component.fbox_size;
     size_t size = header_size + payload_size;
-    unsigned int start, end, buffer_free;
+    unsigned int fbox_size, start, end, buffer_free;
     size_t data_size = size;
     unsigned char *dst, *data;
     bool hbs, hbm;
 
+    if (OPAL_UNLIKELY(NULL == ep->fbox_out.buffer)) {
+        return false;
+    }
+
     /* don't try to use the per-peer buffer for messages that will fill up more than 25% of the
      * buffer */
-    if (OPAL_UNLIKELY(NULL == ep->fbox_out.buffer || size > (fbox_size >> 2))) {
+    if (OPAL_UNLIKELY(size > (ep->fbox_out.size >> 2))) {
+        mca_btl_sm_fbox_check_grow(ep, size);
         return false;
     }
 
     OPAL_THREAD_LOCK(&ep->lock);
 
+    /* the fast box may have been retired (and possibly replaced) since the checks above */
+    fbox_size = ep->fbox_out.size;
+    if (OPAL_UNLIKELY(NULL == ep->fbox_out.buffer || size > (fbox_size >> 2))) {
+        OPAL_THREAD_UNLOCK(&ep->lock);
+        return false;
+    }
+
     /* the high bit helps determine if the buffer is empty or full */
     hbs = MCA_BTL_SM_FBOX_OFFSET_HBS(ep->fbox_out.end);
     hbm = MCA_BTL_SM_FBOX_OFFSET_HBS(ep->fbox_out.start) == hbs;
@@ -219,87 +348,225 @@ static inline bool mca_btl_sm_fbox_sendi(mca_btl_base_endpoint_t *ep, unsigned c
     /* align the buffer */
     ep->fbox_out.end = ((uint32_t) hbs << 31) | end;
     opal_atomic_wmb();
+
+    if (ep->fbox_out.grow_score) {
+        --ep->fbox_out.grow_score;
+    }
     OPAL_THREAD_UNLOCK(&ep->lock);
 
+    if (NULL != ep->doorbell) {
+        mca_btl_sm_fbox_ring_doorbell(ep->doorbell, MCA_BTL_SM_LOCAL_RANK);
+    }
+
+    mca_btl_sm_wake_peer(ep->fifo);
+
+    (void) OPAL_THREAD_ADD_FETCH_SIZE_T(&ep->send_count, 1);
+    if (0xfe != tag) {
+        (void) opal_atomic_add_fetch_64((opal_atomic_int64_t *) &mca_btl_sm_component.fbox_hits,
+                                        1);
+    }
+
     return true;
 }
 
-static inline bool mca_btl_sm_check_fboxes(void)
+/* stop polling a fast box retired by the sender and hand it back */
+static inline void mca_btl_sm_fbox_release_recv(unsigned int index)
+{
+    mca_btl_sm_component_t *component = &mca_btl_sm_component;
+    mca_btl_base_endpoint_t *ep = component->fbox_in_endpoints[index];
+
+    component->fbox_in_endpoints[index]
+        = component->fbox_in_endpoints[--component->num_fbox_in_endpoints];
+    ep->fbox_in.buffer = NULL;
+
+    /* this process will accept another fast box */
+    (void) opal_atomic_add_fetch_32(&component->my_fifo->fbox_available, 1);
+
+    opal_atomic_mb();
+    ep->fbox_in.startp[0] = MCA_BTL_SM_FBOX_RELEASED;
+}
+
+/* stop polling the fast box of a peer that was found through the doorbell */
+static inline void mca_btl_sm_fbox_release_recv_ep(mca_btl_base_endpoint_t *ep)
+{
+    unsigned int index = 0;
+
+    while (mca_btl_sm_component.fbox_in_endpoints[index] != ep) {
+        ++index;
+    }
+
+    mca_btl_sm_fbox_release_recv(index);
+}
+
+/**
+ * Process the messages waiting in the fast box of a peer
+ *
+ * @param ep (IN)       Sm BTL endpoint
+ * @param retired (OUT) set to true if the sender retired the fast box
+ *
+ * At most MCA_BTL_SM_POLL_COUNT + 1 messages are processed at once.
+ *
+ * @returns the number of messages processed
+ */
+static inline int mca_btl_sm_poll_fbox(mca_btl_base_endpoint_t *ep, bool *retired)
 {
-    const unsigned int fbox_size = mca_btl_sm_component.fbox_size;
+    const unsigned int fbox_size = ep->fbox_in.size;
+    unsigned int start = ep->fbox_in.start & MCA_BTL_SM_FBOX_OFFSET_MASK;
+
+    /* save the current high bit state */
+    bool hbs = MCA_BTL_SM_FBOX_OFFSET_HBS(ep->fbox_in.start);
+    int poll_count;
+
+    *retired = false;
+
+    for (poll_count = 0; poll_count <= MCA_BTL_SM_POLL_COUNT; ++poll_count) {
+        const mca_btl_sm_fbox_hdr_t hdr = mca_btl_sm_fbox_read_header(
+            MCA_BTL_SM_FBOX_HDR(ep->fbox_in.buffer + start));
+
+        /* check for a valid tag a sequence number */
+        if (0 == hdr.data.tag || hdr.data.seq != ep->fbox_in.seq) {
+            break;
+        }
+
+        ++ep->fbox_in.seq;
+
+        /* force all prior reads to complete before continuing */
+        opal_atomic_rmb();
+
+        BTL_VERBOSE(
+            ("got frag from %d with header {.tag = %d, .size = %d, .seq = %u} from offset %u",
+             ep->peer_smp_rank, hdr.data.tag, hdr.data.size, hdr.data.seq, start));
+
+        /* the 0xff tag indicates we should skip the rest of the buffer */
+        if (OPAL_LIKELY((0xfe & hdr.data.tag) != 0xfe)) {
+            mca_btl_base_segment_t segment;
+            const mca_btl_active_message_callback_t *reg = mca_btl_base_active_message_trigger
+                                                           + hdr.data.tag;
+            mca_btl_base_receive_descriptor_t desc = {.endpoint = ep,
+                                                      .des_segments = &segment,
+                                                      .des_segment_count = 1,
+                                                      .tag = hdr.data.tag,
+                                                      .cbdata = reg->cbdata};
+
+            /* fragment fits entirely in the remaining buffer space. some
+             * btl users do not handle fragmented data so we can't split
+             * the fragment without introducing another copy here. this
+             * limitation has not appeared to cause any performance
+             * degradation. */
+            segment.seg_len = hdr.data.size;
+            segment.seg_addr.pval = (void *) (ep->fbox_in.buffer + start + sizeof(hdr));
+
+            /* call the registered callback function */
+            reg->cbfunc(&mca_btl_sm.super, &desc);
+        } else if (OPAL_UNLIKELY(0xfe == hdr.data.tag && 0 == hdr.data.size)) {
+            /* the sender retired the fast box. nothing follows this message */
+            *retired = true;
+            return poll_count;
+        } else if (OPAL_LIKELY(0xfe == hdr.data.tag)) {
+            /* process fragment header */
+            fifo_value_t *value = (fifo_value_t *) (ep->fbox_in.buffer + start + sizeof(hdr));
+            mca_btl_sm_hdr_t *sm_hdr = relative2virtual(*value);
+            mca_btl_sm_poll_handle_frag(sm_hdr, ep);
+        }
+
+        start = (start + hdr.data.size + sizeof(hdr) + MCA_BTL_SM_FBOX_ALIGNMENT_MASK)
+                & ~MCA_BTL_SM_FBOX_ALIGNMENT_MASK;
+        if (OPAL_UNLIKELY(fbox_size == start)) {
+            /* jump to the beginning of the buffer */
+            start = MCA_BTL_SM_FBOX_ALIGNMENT;
+            /* toggle the high bit */
+            hbs = !hbs;
+        }
+    }
+
+    if (poll_count) {
+        BTL_VERBOSE(("left off at offset %u (hbs: %d)", start, hbs));
+
+        ep->fbox_in.recv_count += poll_count;
+
+        /* save where we left off */
+        /* let the sender know where we stopped */
+        opal_atomic_mb();
+        ep->fbox_in.start = ep->fbox_in.startp[0] = ((uint32_t) hbs << 31) | start;
+    }
+
+    return poll_count;
+}
+
+/**
+ * Poll only the fast boxes flagged in the doorbell of this process
+ *
+ * Each doorbell word is cleared before the fast boxes it flags are polled so a message
+ * written afterwards flags its fast box again. A fast box that may still hold messages
+ * after polling is flagged again by this process.
+ */
+static inline bool mca_btl_sm_check_doorbell(void)
+{
+    mca_btl_sm_component_t *component = &mca_btl_sm_component;
     bool processed = false;
 
-    for (unsigned int i = 0; i < mca_btl_sm_component.num_fbox_in_endpoints; ++i) {
-        mca_btl_base_endpoint_t *ep = mca_btl_sm_component.fbox_in_endpoints[i];
-        unsigned int start = ep->fbox_in.start & MCA_BTL_SM_FBOX_OFFSET_MASK;
+    for (unsigned int i = 0; i < component->doorbell_words; ++i) {
+        uint64_t bits;
+
+        if (0 == component->my_doorbell[i]) {
+            continue;
+        }
 
-        /* save the current high bit state */
-        bool hbs = MCA_BTL_SM_FBOX_OFFSET_HBS(ep->fbox_in.start);
-        int poll_count;
+        bits = (uint64_t) opal_atomic_swap_64(component->my_doorbell + i, 0);
+        /* the clearing store must be ordered before the loads of the fast boxes, or a
+         * doorbell rung in between is lost */
+        opal_atomic_mb();
 
-        for (poll_count = 0; poll_count <= MCA_BTL_SM_POLL_COUNT; ++poll_count) {
-            const mca_btl_sm_fbox_hdr_t hdr = mca_btl_sm_fbox_read_header(
-                MCA_BTL_SM_FBOX_HDR(ep->fbox_in.buffer + start));
+        while (bits) {
+            unsigned int rank = (i << 6) + mca_btl_sm_doorbell_lowbit(bits);
+            mca_btl_base_endpoint_t *ep = component->endpoints + rank;
+            bool retired;
+            int poll_count;
 
-            /* check for a valid tag a sequence number */
-            if (0 == hdr.data.tag || hdr.data.seq != ep->fbox_in.seq) {
-                break;
+            bits &= bits - 1;
+
+            /* the fast box is not set up yet (this process flags it once it is) or was
+             * already released */
+            if (NULL == ep->fbox_in.buffer) {
+                continue;
             }
 
-            ++ep->fbox_in.seq;
-
-            /* force all prior reads to complete before continuing */
-            opal_atomic_rmb();
-
-            BTL_VERBOSE(
-                ("got frag from %d with header {.tag = %d, .size = %d, .seq = %u} from offset %u",
-                 ep->peer_smp_rank, hdr.data.tag, hdr.data.size, hdr.data.seq, start));
-
-            /* the 0xff tag indicates we should skip the rest of the buffer */
-            if (OPAL_LIKELY((0xfe & hdr.data.tag) != 0xfe)) {
-                mca_btl_base_segment_t segment;
-                const mca_btl_active_message_callback_t *reg = mca_btl_base_active_message_trigger
-                                                               + hdr.data.tag;
-                mca_btl_base_receive_descriptor_t desc = {.endpoint = ep,
-                                                          .des_segments = &segment,
-                                                          .des_segment_count = 1,
-                                                          .tag = hdr.data.tag,
-                                                          .cbdata = reg->cbdata};
-
-                /* fragment fits entirely in the remaining buffer space. some
-                 * btl users do not handle fragmented data so we can't split
-                 * the fragment without introducing another copy here. this
-                 * limitation has not appeared to cause any performance
-                 * degradation. */
-                segment.seg_len = hdr.data.size;
-                segment.seg_addr.pval = (void *) (ep->fbox_in.buffer + start + sizeof(hdr));
-
-                /* call the registered callback function */
-                reg->cbfunc(&mca_btl_sm.super, &desc);
-            } else if (OPAL_LIKELY(0xfe == hdr.data.tag)) {
-                /* process fragment header */
-                fifo_value_t *value = (fifo_value_t *) (ep->fbox_in.buffer + start + sizeof(hdr));
-                mca_btl_sm_hdr_t *sm_hdr = relative2virtual(*value);
-                mca_btl_sm_poll_handle_frag(sm_hdr, ep);
+            poll_count = mca_btl_sm_poll_fbox(ep, &retired);
+            if (OPAL_UNLIKELY(retired)) {
+                mca_btl_sm_fbox_release_recv_ep(ep);
+                processed = true;
+                continue;
             }
 
-            start = (start + hdr.data.size + sizeof(hdr) + MCA_BTL_SM_FBOX_ALIGNMENT_MASK)
-                    & ~MCA_BTL_SM_FBOX_ALIGNMENT_MASK;
-            if (OPAL_UNLIKELY(fbox_size == start)) {
-                /* jump to the beginning of the buffer */
-                start = MCA_BTL_SM_FBOX_ALIGNMENT;
-                /* toggle the high bit */
-                hbs = !hbs;
+            if (poll_count > MCA_BTL_SM_POLL_COUNT) {
+                mca_btl_sm_fbox_ring_doorbell(component->my_doorbell, rank);
             }
+
+            processed |= (0 != poll_count);
         }
+    }
 
-        if (poll_count) {
-            BTL_VERBOSE(("left off at offset %u (hbs: %d)", start, hbs));
+    return processed;
+}
+
+static inline bool mca_btl_sm_check_fboxes(void)
+{
+    bool processed = false;
+
+    if (NULL != mca_btl_sm_component.my_doorbell) {
+        return mca_btl_sm_check_doorbell();
+    }
 
-            /* save where we left off */
-            /* let the sender know where we stopped */
-            opal_atomic_mb();
-            ep->fbox_in.start = ep->fbox_in.startp[0] = ((uint32_t) hbs << 31) | start;
+    for (unsigned int i = 0; i < mca_btl_sm_component.num_fbox_in_endpoints; ++i) {
+        mca_btl_base_endpoint_t *ep = mca_btl_sm_component.fbox_in_endpoints[i];
+        bool retired;
+
+        if (mca_btl_sm_poll_fbox(ep, &retired)) {
+            processed = true;
+        }
+
+        if (OPAL_UNLIKELY(retired)) {
+            mca_btl_sm_fbox_release_recv(i--);
             processed = true;
         }
     }
@@ -310,32 +577,69 @@ static inline bool mca_btl_sm_check_fboxes(void)
 
 static inline void mca_btl_sm_try_fbox_setup(mca_btl_base_endpoint_t *ep, mca_btl_sm_hdr_t *hdr)
 {
-    if (OPAL_UNLIKELY(NULL == ep->fbox_out.buffer
-                      && mca_btl_sm_component.fbox_threshold
-                             == OPAL_THREAD_ADD_FETCH_SIZE_T(&ep->send_count, 1))) {
-        /* protect access to mca_btl_sm_component.segment_offset */
-        OPAL_THREAD_LOCK(&mca_btl_sm_component.lock);
-
-        /* verify the remote side will accept another fbox */
-        if (0 <= opal_atomic_add_fetch_32(&ep->fifo->fbox_available, -1)) {
-            opal_free_list_item_t *fbox = opal_free_list_get(&mca_btl_sm_component.sm_fboxes);
-
-            if (NULL != fbox) {
-                /* zero out the fast box */
-                memset(fbox->ptr, 0, mca_btl_sm_component.fbox_size);
-                mca_btl_sm_endpoint_setup_fbox_send(ep, fbox);
-
-                hdr->flags |= MCA_BTL_SM_FLAG_SETUP_FBOX;
-                hdr->fbox_base = virtual2relative((char *) ep->fbox_out.buffer);
+    mca_btl_sm_component_t *component = &mca_btl_sm_component;
+    size_t send_count = OPAL_THREAD_ADD_FETCH_SIZE_T(&ep->send_count, 1);
+
+    /* try again every fbox_threshold sends. a fast box can not be setup while the peer still
+     * polls a previously retired one */
+    if (OPAL_LIKELY(0 == component->fbox_threshold || 0 != send_count % component->fbox_threshold
+                    || NULL != ep->fbox_out.fbox)) {
+        return;
+    }
+
+    /* protect access to mca_btl_sm_component.segment_offset. the lock is already held when
+     * pending fragments are progressed so don't wait for it: the next attempt will do */
+    if (OPAL_THREAD_TRYLOCK(&component->lock)) {
+        return;
+    }
+
+    if (OPAL_UNLIKELY(NULL != ep->fbox_out.fbox)) {
+        OPAL_THREAD_UNLOCK(&component->lock);
+        return;
+    }
+
+    /* verify the remote side will accept another fbox */
+    if (0 <= opal_atomic_add_fetch_32(&ep->fifo->fbox_available, -1)) {
+        opal_free_list_item_t *fbox = NULL;
+        unsigned int size = component->fbox_size;
+
+        if (ep->fbox_out.grow) {
+            fbox = opal_free_list_get(&component->sm_fboxes_grown);
+            if (NULL == fbox) {
+                /* make room for later and settle for a regular fast box for now */
+                mca_btl_sm_fbox_reclaim(ep, component->fbox_max_size);
+                ep->fbox_out.grow = false;
             } else {
-                opal_atomic_add_fetch_32(&ep->fifo->fbox_available, 1);
+                size = component->fbox_max_size;
             }
+        }
 
-            opal_atomic_wmb();
+        if (NULL == fbox) {
+            fbox = opal_free_list_get(&component->sm_fboxes);
+        }
+
+        if (NULL != fbox) {
+            /* zero out the fast box */
+            memset(fbox->ptr, 0, size);
+            mca_btl_sm_endpoint_setup_fbox_send(ep, fbox, size);
+
+            hdr->flags |= MCA_BTL_SM_FLAG_SETUP_FBOX;
+            hdr->fbox_base = virtual2relative((char *) ep->fbox_out.buffer);
+        } else {
+            /* all fast boxes are in use. take one away from a peer that is colder than
+             * this one so it can be used the next time */
+            mca_btl_sm_fbox_reclaim(ep, component->fbox_size);
+            opal_atomic_add_fetch_32(&ep->fifo->fbox_available, 1);
         }
 
-        OPAL_THREAD_UNLOCK(&mca_btl_sm_component.lock);
+        opal_atomic_wmb();
+    } else {
+        opal_atomic_add_fetch_32(&ep->fifo->fbox_available, 1);
+        /* let the peer know that it should make room by retiring the fast box of a cold peer */
+        ep->fifo->fbox_wanted = 1;
     }
+
+    OPAL_THREAD_UNLOCK(&component->lock);
 }
 
 #endif /* MCA_BTL_SM_FBOX_H */
@@ -114,6 +114,9 @@ static inline void sm_fifo_init(sm_fifo_t *fifo)
     fifo->fifo_head = SM_FIFO_FREE;
     fifo->fifo_tail = SM_FIFO_FREE;
     fifo->fbox_available = mca_btl_sm_component.fbox_max;
+    fifo->fbox_wanted = 0;
+    fifo->fbox_retire = 0;
+    fifo->sleeping = 0;
     mca_btl_sm_component.my_fifo = fifo;
 }
 
@@ -135,6 +138,7 @@ static inline void sm_fifo_write(sm_fifo_t *fifo, fifo_value_t value)
     }
 
     opal_atomic_wmb();
+    mca_btl_sm_wake_peer(fifo);
 }
 
 /**
@@ -155,11 +159,18 @@ static inline bool sm_fifo_write_ep(mca_btl_sm_hdr_t *hdr, struct mca_btl_base_e
         /* if there is a fast box for this peer then use the fast box to send the fragment header.
          * this is done to ensure fragment ordering */
         opal_atomic_wmb();
-        return mca_btl_sm_fbox_sendi(ep, 0xfe, &rhdr, sizeof(rhdr), NULL, 0);
+        if (!mca_btl_sm_fbox_sendi(ep, 0xfe, &rhdr, sizeof(rhdr), NULL, 0)) {
+            return false;
+        }
+        (void) opal_atomic_add_fetch_64((opal_atomic_int64_t *) &mca_btl_sm_component.fbox_misses,
+                                        1);
+        return true;
     }
     mca_btl_sm_try_fbox_setup(ep, hdr);
     hdr->next = SM_FIFO_FREE;
     sm_fifo_write(ep->fifo, rhdr);
+    (void) opal_atomic_add_fetch_64((opal_atomic_int64_t *) &mca_btl_sm_component.fbox_misses,
+                                    1);
 
     return true;
 }
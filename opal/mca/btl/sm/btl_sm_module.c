@@ -81,10 +81,15 @@ static int sm_btl_first_time_init(mca_btl_sm_t *sm_btl, int n)
         return OPAL_ERR_OUT_OF_RESOURCE;
     }
 
-    component->mpool = mca_mpool_basic_create((void *) (component->my_segment
-                                                        + MCA_BTL_SM_FIFO_SIZE),
+    /* the fifo and the doorbell (if any) are at the start of the segment */
+    size_t reserved = MCA_BTL_SM_FIFO_SIZE;
+    if (component->doorbell_words) {
+        reserved += MCA_BTL_SM_DOORBELL_SIZE(component->doorbell_words);
+    }
+
+    component->mpool = mca_mpool_basic_create((void *) (component->my_segment + reserved),
                                               (unsigned long) (mca_btl_sm_component.segment_size
-                                                               - MCA_BTL_SM_FIFO_SIZE),
+                                                               - reserved),
                                               64);
     if (NULL == component->mpool) {
         free(component->endpoints);
@@ -99,6 +104,17 @@ static int sm_btl_first_time_init(mca_btl_sm_t *sm_btl, int n)
         return rc;
     }
 
+    if (mca_btl_sm_component.fbox_max_size > mca_btl_sm_component.fbox_size) {
+        rc = opal_free_list_init(&component->sm_fboxes_grown, sizeof(opal_free_list_item_t), 8,
+                                 OBJ_CLASS(opal_free_list_item_t),
+                                 mca_btl_sm_component.fbox_max_size, opal_cache_line_size, 0,
+                                 mca_btl_sm_component.fbox_max_grown, 1, component->mpool, 0,
+                                 NULL, NULL, NULL);
+        if (OPAL_SUCCESS != rc) {
+            return rc;
+        }
+    }
+
     /* initialize fragment descriptor free lists */
     /* initialize free list for small send and inline fragments */
     rc = opal_free_list_init(&component->sm_frags_user, sizeof(mca_btl_sm_frag_t),
@@ -206,6 +222,10 @@ static int init_sm_endpoint(struct mca_btl_base_endpoint_t **ep_out, struct opal
     }
 
     ep->fifo = (struct sm_fifo_t *) ep->segment_base;
+    ep->doorbell = NULL;
+    if (component->doorbell_words) {
+        ep->doorbell = (opal_atomic_int64_t *) (ep->segment_base + MCA_BTL_SM_FIFO_SIZE);
+    }
 
     return OPAL_SUCCESS;
 }
@@ -503,6 +523,7 @@ static void mca_btl_sm_endpoint_constructor(mca_btl_sm_endpoint_t *ep)
     OBJ_CONSTRUCT(&ep->pending_frags, opal_list_t);
     OBJ_CONSTRUCT(&ep->pending_frags_lock, opal_mutex_t);
     ep->fifo = NULL;
+    ep->doorbell = NULL;
     ep->fbox_out.fbox = NULL;
 }
 
@@ -526,7 +547,10 @@ static void mca_btl_sm_endpoint_destructor(mca_btl_sm_endpoint_t *ep)
     }
 
     if (ep->fbox_out.fbox) {
-        opal_free_list_return(&mca_btl_sm_component.sm_fboxes, ep->fbox_out.fbox);
+        opal_free_list_return(ep->fbox_out.size == mca_btl_sm_component.fbox_size
+                                  ? &mca_btl_sm_component.sm_fboxes
+                                  : &mca_btl_sm_component.sm_fboxes_grown,
+                              ep->fbox_out.fbox);
     }
 
     if (ep->smsc_endpoint) {
@@ -538,6 +562,7 @@ static void mca_btl_sm_endpoint_destructor(mca_btl_sm_endpoint_t *ep)
     ep->fbox_out.fbox = NULL;
     ep->segment_base = NULL;
     ep->fifo = NULL;
+    ep->doorbell = NULL;
 }
 
 OBJ_CLASS_INSTANCE(mca_btl_sm_endpoint_t, opal_list_item_t, mca_btl_sm_endpoint_constructor,
@@ -55,6 +55,16 @@ int mca_btl_sm_send(struct mca_btl_base_module_t *btl, struct mca_btl_base_endpo
     /* clear the complete flag if it has been set */
     frag->hdr->flags &= ~MCA_BTL_SM_FLAG_COMPLETE;
 
+    /* copy the data into the fast box if it fits. this saves the peer from having to return the
+     * fragment. the emulated rdma operations (MCA_BTL_TAG_SM) need the fragment back. */
+    if (MCA_BTL_TAG_SM != tag && !(frag->hdr->flags & MCA_BTL_SM_FLAG_SINGLE_COPY)
+        && 0 == opal_list_get_size(&endpoint->pending_frags)
+        && mca_btl_sm_fbox_sendi(endpoint, tag, frag->segments[0].seg_addr.pval, total_size, NULL,
+                                 0)) {
+        mca_btl_sm_frag_complete(frag);
+        return OPAL_SUCCESS;
+    }
+
     /* post the relative address of the descriptor into the peer's fifo */
     if (opal_list_get_size(&endpoint->pending_frags) || !sm_fifo_write_ep(frag->hdr, endpoint)) {
         if (frag->base.des_cbfunc) {
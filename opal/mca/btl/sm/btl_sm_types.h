@@ -57,15 +57,25 @@ typedef struct mca_btl_base_endpoint_t {
         unsigned char *buffer; /**< starting address of peer's fast box out */
         uint32_t *startp;
         unsigned int start;
+        unsigned int size;      /**< size of the fast box */
         uint16_t seq;
+        size_t recv_count;      /**< number of messages received through the fast box */
+        size_t last_recv_count; /**< recv_count the last time the activity of this peer
+                                 *   was checked */
     } fbox_in;
 
     struct {
         unsigned char *buffer; /**< starting address of peer's fast box in */
         uint32_t *startp;      /**< pointer to location storing start offset */
         unsigned int start, end;
+        unsigned int size; /**< size of the fast box */
         uint16_t seq;
-        opal_free_list_item_t *fbox; /**< fast-box free list item */
+        opal_free_list_item_t *fbox; /**< fast-box free list item (still set while a retired
+                                      *   fast box waits to be released by the peer) */
+        size_t last_send_count; /**< send_count the last time the activity of this peer was
+                                 *   checked */
+        int grow_score;         /**< how often messages were too large for the fast box */
+        bool grow;              /**< use a grown fast box for this peer */
     } fbox_out;
 
     uint16_t peer_smp_rank;        /**< my peer's SMP process rank.  Used for accessing
@@ -75,6 +85,7 @@ typedef struct mca_btl_base_endpoint_t {
                                     *   of this process) */
 
     struct sm_fifo_t *fifo; /**< */
+    opal_atomic_int64_t *doorbell; /**< peer's doorbell (NULL if not used) */
 
     opal_mutex_t lock; /**< lock to protect endpoint structures from concurrent
                         *   access */
@@ -110,11 +121,28 @@ struct mca_btl_sm_component_t {
     opal_free_list_t sm_frags_max_send; /**< free list of sm max send frags (large fragments) */
     opal_free_list_t sm_frags_user;     /**< free list of small inline frags */
     opal_free_list_t sm_fboxes;         /**< free list of available fast-boxes */
+    opal_free_list_t sm_fboxes_grown;   /**< free list of available grown fast-boxes */
 
     unsigned int
         fbox_threshold; /**< number of sends required before we setup a send fast box for a peer */
     unsigned int fbox_max;  /**< maximum number of send fast boxes to allocate */
     unsigned int fbox_size; /**< size of each peer fast box allocation */
+    unsigned int fbox_max_size;  /**< size of grown fast boxes */
+    unsigned int fbox_max_grown; /**< maximum number of grown fast boxes to allocate */
+    opal_atomic_int32_t num_fbox_retiring; /**< number of retired fast boxes not yet released */
+
+    unsigned int doorbell_min_peers; /**< minimum number of local peers to use doorbells */
+    unsigned int doorbell_words;     /**< number of words in the doorbell (0: no doorbell) */
+    opal_atomic_int64_t *my_doorbell; /**< senders flag their fast box in here when writing
+                                       *   to it (one bit per local rank) */
+
+    unsigned int idle_spin_count; /**< number of idle polls before blocking (0: never block) */
+    unsigned int idle_timeout;    /**< maximum time to block at once (microseconds) */
+    unsigned int idle_polls;      /**< number of consecutive idle polls */
+
+    opal_atomic_uint64_t fbox_hits;   /**< number of messages sent through a fast box */
+    opal_atomic_uint64_t fbox_misses; /**< number of messages sent through the fifo */
+    unsigned long fbox_reclaimed; /**< number of fast boxes retired and reused */
 
     int single_copy_mechanism; /**< single copy mechanism to use */
 
@@ -232,6 +260,12 @@ struct sm_fifo_t {
     atomic_fifo_value_t fifo_head;
     atomic_fifo_value_t fifo_tail;
     opal_atomic_int32_t fbox_available;
+    /** a peer could not setup a fast box because no more are accepted */
+    opal_atomic_int32_t fbox_wanted;
+    /** a peer asked for one of the fast boxes it polls to be retired */
+    opal_atomic_int32_t fbox_retire;
+    /** futex word: set while this process is (about to be) blocked waiting for messages */
+    opal_atomic_int32_t sleeping;
 };
 typedef struct sm_fifo_t sm_fifo_t;
 
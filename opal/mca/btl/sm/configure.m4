@@ -22,6 +22,9 @@
 AC_DEFUN([MCA_opal_btl_sm_CONFIG],[
     AC_CONFIG_FILES([opal/mca/btl/sm/Makefile])
 
+    # futexes are used to block idle processes (optional)
+    AC_CHECK_HEADERS([linux/futex.h])
+
     # always happy
     $1
 
@@ -339,6 +339,413 @@ static void fake_rdma_complete(mca_btl_base_module_t *btl, mca_btl_base_endpoint
                   frag->cb.data, rc);
 }
 
+/*
+ * Striped puts. A large put is cut in pieces, one per endpoint connected to
+ * the peer, in proportion to the bandwidth of their BTL. The piece sent on
+ * the endpoint of the put completes locally as any put, the others complete
+ * when the target acknowledges them (see btl_tcp_hdr.h). The completion
+ * callback of the put is called once all the pieces are complete.
+ *
+ * The pieces waiting for their acknowledgment are kept on the list of their
+ * endpoint, so that they fail when the connection is closed, and the cookie
+ * of an acknowledgment is only used once found on that list. Acknowledgments
+ * that could not be allocated on the target are retried from a timer.
+ */
+
+#define MCA_BTL_TCP_STRIPE_MAX 16
+
+typedef struct mca_btl_tcp_put_stripe_t mca_btl_tcp_put_stripe_t;
+
+typedef struct {
+    opal_list_item_t super;
+    mca_btl_tcp_put_stripe_t *stripe;
+} mca_btl_tcp_put_stripe_piece_t;
+
+struct mca_btl_tcp_put_stripe_t {
+    opal_atomic_int32_t pending; /**< pieces not completed yet */
+    int rc;
+    mca_btl_base_module_t *btl;
+    struct mca_btl_base_endpoint_t *endpoint;
+    void *local_address;
+    mca_btl_base_rdma_completion_fn_t cbfunc;
+    void *cbcontext;
+    void *cbdata;
+    mca_btl_tcp_put_stripe_piece_t pieces[MCA_BTL_TCP_STRIPE_MAX]; /**< pieces sent to the other
+                                                                        endpoints */
+};
+
+/* acknowledgment waiting for a fragment on the target */
+typedef struct {
+    opal_list_item_t super;
+    uint64_t cookie;
+} mca_btl_tcp_put_stripe_ack_t;
+
+static OBJ_CLASS_INSTANCE(mca_btl_tcp_put_stripe_ack_t, opal_list_item_t, NULL, NULL);
+
+static void mca_btl_tcp_put_stripe_piece_complete(mca_btl_tcp_put_stripe_t *stripe, int rc)
+{
+    if (OPAL_SUCCESS != rc) {
+        stripe->rc = rc;
+    }
+    if (0 == opal_atomic_add_fetch_32(&stripe->pending, -1)) {
+        stripe->cbfunc(stripe->btl, stripe->endpoint, stripe->local_address, NULL,
+                       stripe->cbcontext, stripe->cbdata, stripe->rc);
+        for (int i = 0; i < MCA_BTL_TCP_STRIPE_MAX; i++) {
+            OBJ_DESTRUCT(&stripe->pieces[i]);
+        }
+        free(stripe);
+    }
+}
+
+/*
+ * Remove a piece from the pieces of the endpoint waiting for their
+ * acknowledgment. Returns the piece, or NULL if it is not on the list: it
+ * was already completed by someone else, or the cookie is bogus.
+ */
+static mca_btl_tcp_put_stripe_piece_t *
+mca_btl_tcp_put_stripe_piece_take(struct mca_btl_base_endpoint_t *endpoint, uint64_t cookie)
+{
+    mca_btl_tcp_put_stripe_piece_t *piece, *found = NULL;
+
+    OPAL_THREAD_LOCK(&endpoint->endpoint_stripe_lock);
+    OPAL_LIST_FOREACH (piece, &endpoint->endpoint_stripe_pieces, mca_btl_tcp_put_stripe_piece_t) {
+        if ((uint64_t) (uintptr_t) piece == cookie) {
+            opal_list_remove_item(&endpoint->endpoint_stripe_pieces, &piece->super);
+            found = piece;
+            break;
+        }
+    }
+    OPAL_THREAD_UNLOCK(&endpoint->endpoint_stripe_lock);
+    return found;
+}
+
+static void mca_btl_tcp_put_stripe_piece_fail(struct mca_btl_base_endpoint_t *endpoint,
+                                              mca_btl_tcp_put_stripe_piece_t *piece, int rc)
+{
+    if (NULL != mca_btl_tcp_put_stripe_piece_take(endpoint, (uint64_t) (uintptr_t) piece)) {
+        mca_btl_tcp_put_stripe_piece_complete(piece->stripe, rc);
+    }
+}
+
+/* completion of the piece sent on the endpoint of the put */
+static void mca_btl_tcp_put_stripe_local_complete(mca_btl_base_module_t *btl,
+                                                  mca_btl_base_endpoint_t *endpoint,
+                                                  mca_btl_base_descriptor_t *desc, int rc)
+{
+    mca_btl_tcp_put_stripe_piece_complete((mca_btl_tcp_put_stripe_t *) desc->des_cbdata, rc);
+}
+
+/* the other pieces complete with the acknowledgment of the target, unless they
+ * could not be sent */
+static void mca_btl_tcp_put_stripe_remote_sent(mca_btl_base_module_t *btl,
+                                               mca_btl_base_endpoint_t *endpoint,
+                                               mca_btl_base_descriptor_t *desc, int rc)
+{
+    if (OPAL_SUCCESS != rc) {
+        mca_btl_tcp_put_stripe_piece_fail(endpoint,
+                                          (mca_btl_tcp_put_stripe_piece_t *) desc->des_cbdata, rc);
+    }
+}
+
+static void mca_btl_tcp_put_stripe_ack_sent(mca_btl_base_module_t *btl,
+                                            mca_btl_base_endpoint_t *endpoint,
+                                            mca_btl_base_descriptor_t *desc, int rc)
+{
+}
+
+void mca_btl_tcp_put_stripe_acked(struct mca_btl_base_endpoint_t *endpoint, uint64_t cookie)
+{
+    mca_btl_tcp_put_stripe_piece_t *piece = mca_btl_tcp_put_stripe_piece_take(endpoint, cookie);
+
+    if (OPAL_UNLIKELY(NULL == piece)) {
+        BTL_VERBOSE(("unknown or failed striped put piece acknowledged"));
+        return;
+    }
+    mca_btl_tcp_put_stripe_piece_complete(piece->stripe, OPAL_SUCCESS);
+}
+
+/*
+ * Send the acknowledgment of a piece. Returns OPAL_ERR_OUT_OF_RESOURCE if no
+ * fragment is available. An acknowledgment that cannot be sent on the
+ * connection is dropped, the origin fails the piece when the connection is
+ * closed.
+ */
+static int mca_btl_tcp_put_stripe_send_ack(struct mca_btl_base_endpoint_t *endpoint,
+                                           uint64_t cookie)
+{
+    mca_btl_tcp_frag_t *frag = NULL;
+
+    MCA_BTL_TCP_FRAG_ALLOC_USER(frag);
+    if (OPAL_UNLIKELY(NULL == frag)) {
+        return OPAL_ERR_OUT_OF_RESOURCE;
+    }
+
+    frag->segments[0].seg_addr.lval = cookie;
+    frag->segments[0].seg_len = 0;
+    if (endpoint->endpoint_nbo) {
+        MCA_BTL_BASE_SEGMENT_HTON(frag->segments[0]);
+    }
+    frag->base.des_segments = frag->segments;
+    frag->base.des_segment_count = 1;
+    frag->base.order = MCA_BTL_NO_ORDER;
+    frag->base.des_flags = MCA_BTL_DES_FLAGS_BTL_OWNERSHIP | MCA_BTL_DES_SEND_ALWAYS_CALLBACK;
+    frag->base.des_cbfunc = mca_btl_tcp_put_stripe_ack_sent;
+
+    frag->btl = endpoint->endpoint_btl;
+    frag->endpoint = endpoint;
+    frag->rc = 0;
+    frag->iov_idx = 0;
+    frag->iov_cnt = 2;
+    frag->iov_ptr = frag->iov;
+    frag->iov[0].iov_base = (IOVBASE_TYPE *) &frag->hdr;
+    frag->iov[0].iov_len = sizeof(frag->hdr);
+    frag->iov[1].iov_base = (IOVBASE_TYPE *) frag->segments;
+    frag->iov[1].iov_len = sizeof(mca_btl_base_segment_t);
+    frag->hdr.base.tag = MCA_BTL_TAG_BTL;
+    frag->hdr.type = MCA_BTL_TCP_HDR_TYPE_PUT_ACK;
+    frag->hdr.count = 1;
+    frag->hdr.size = 0;
+    if (endpoint->endpoint_nbo) {
+        MCA_BTL_TCP_HDR_HTON(frag->hdr);
+    }
+    if (mca_btl_tcp_endpoint_send(endpoint, frag) < 0) {
+        MCA_BTL_TCP_FRAG_RETURN(frag);
+    }
+    return OPAL_SUCCESS;
+}
+
+static void mca_btl_tcp_put_stripe_ack_retry(int fd, short flags, void *context);
+
+/* queue an acknowledgment for the timer, with the stripe lock held */
+static void mca_btl_tcp_put_stripe_ack_defer(struct mca_btl_base_endpoint_t *endpoint,
+                                             mca_btl_tcp_put_stripe_ack_t *ack)
+{
+    struct timeval delay = {0, 1000};
+
+    opal_list_prepend(&endpoint->endpoint_stripe_acks, &ack->super);
+    if (!endpoint->endpoint_stripe_ack_armed) {
+        endpoint->endpoint_stripe_ack_armed = true;
+        opal_event_evtimer_set(mca_btl_tcp_event_base, &endpoint->endpoint_stripe_ack_event,
+                               mca_btl_tcp_put_stripe_ack_retry, endpoint);
+        opal_event_add(&endpoint->endpoint_stripe_ack_event, &delay);
+    }
+}
+
+static void mca_btl_tcp_put_stripe_ack_retry(int fd, short flags, void *context)
+{
+    struct mca_btl_base_endpoint_t *endpoint = (struct mca_btl_base_endpoint_t *) context;
+    mca_btl_tcp_put_stripe_ack_t *ack;
+
+    OPAL_THREAD_LOCK(&endpoint->endpoint_stripe_lock);
+    endpoint->endpoint_stripe_ack_armed = false;
+    /* the lock is not held while sending, the send path may close the endpoint */
+    while (NULL
+           != (ack = (mca_btl_tcp_put_stripe_ack_t *) opal_list_remove_first(
+                   &endpoint->endpoint_stripe_acks))) {
+        OPAL_THREAD_UNLOCK(&endpoint->endpoint_stripe_lock);
+        if (OPAL_SUCCESS != mca_btl_tcp_put_stripe_send_ack(endpoint, ack->cookie)) {
+            OPAL_THREAD_LOCK(&endpoint->endpoint_stripe_lock);
+            mca_btl_tcp_put_stripe_ack_defer(endpoint, ack);
+            break;
+        }
+        OBJ_RELEASE(ack);
+        OPAL_THREAD_LOCK(&endpoint->endpoint_stripe_lock);
+    }
+    OPAL_THREAD_UNLOCK(&endpoint->endpoint_stripe_lock);
+}
+
+void mca_btl_tcp_put_stripe_ack(struct mca_btl_base_endpoint_t *endpoint, uint64_t cookie)
+{
+    mca_btl_tcp_put_stripe_ack_t *ack;
+
+    if (OPAL_LIKELY(OPAL_SUCCESS == mca_btl_tcp_put_stripe_send_ack(endpoint, cookie))) {
+        return;
+    }
+    ack = OBJ_NEW(mca_btl_tcp_put_stripe_ack_t);
+    if (OPAL_UNLIKELY(NULL == ack)) {
+        BTL_ERROR(("cannot allocate the acknowledgment of a striped put"));
+        return;
+    }
+    ack->cookie = cookie;
+    OPAL_THREAD_LOCK(&endpoint->endpoint_stripe_lock);
+    mca_btl_tcp_put_stripe_ack_defer(endpoint, ack);
+    OPAL_THREAD_UNLOCK(&endpoint->endpoint_stripe_lock);
+}
+
+void mca_btl_tcp_put_stripe_close(struct mca_btl_base_endpoint_t *endpoint)
+{
+    mca_btl_tcp_put_stripe_piece_t *piece;
+    opal_list_t failed;
+
+    OBJ_CONSTRUCT(&failed, opal_list_t);
+    OPAL_THREAD_LOCK(&endpoint->endpoint_stripe_lock);
+    opal_list_join(&failed, opal_list_get_end(&failed), &endpoint->endpoint_stripe_pieces);
+    /* the acknowledgments are lost with the connection */
+    if (endpoint->endpoint_stripe_ack_armed) {
+        opal_event_del(&endpoint->endpoint_stripe_ack_event);
+        endpoint->endpoint_stripe_ack_armed = false;
+    }
+    OPAL_LIST_DESTRUCT(&endpoint->endpoint_stripe_acks);
+    OBJ_CONSTRUCT(&endpoint->endpoint_stripe_acks, opal_list_t);
+    OPAL_THREAD_UNLOCK(&endpoint->endpoint_stripe_lock);
+
+    while (NULL != (piece = (mca_btl_tcp_put_stripe_piece_t *) opal_list_remove_first(&failed))) {
+        mca_btl_tcp_put_stripe_piece_complete(piece->stripe, OPAL_ERR_UNREACH);
+    }
+    OBJ_DESTRUCT(&failed);
+}
+
+/*
+ * Prepare the frag of a piece of a striped put. The pieces sent to other
+ * endpoints than the one of the put carry the cookie of the stripe in a
+ * second segment.
+ */
+static void mca_btl_tcp_put_stripe_frag(mca_btl_tcp_frag_t *frag,
+                                        struct mca_btl_base_endpoint_t *endpoint,
+                                        mca_btl_tcp_put_stripe_t *stripe,
+                                        mca_btl_tcp_put_stripe_piece_t *piece, unsigned char *local,
+                                        uint64_t remote_address, size_t size)
+{
+    bool remote = (NULL != piece);
+
+    frag->segments[0].seg_addr.lval = remote_address;
+    frag->segments[0].seg_len = size;
+    frag->segments[1].seg_addr.lval = (uint64_t) (uintptr_t) piece;
+    frag->segments[1].seg_len = 0;
+    if (endpoint->endpoint_nbo) {
+        MCA_BTL_BASE_SEGMENT_HTON(frag->segments[0]);
+        MCA_BTL_BASE_SEGMENT_HTON(frag->segments[1]);
+    }
+
+    frag->base.des_segments = frag->segments;
+    frag->base.des_segment_count = 1;
+    frag->base.order = MCA_BTL_NO_ORDER;
+    frag->base.des_flags = MCA_BTL_DES_FLAGS_BTL_OWNERSHIP | MCA_BTL_DES_SEND_ALWAYS_CALLBACK;
+    frag->base.des_cbfunc = remote ? mca_btl_tcp_put_stripe_remote_sent
+                                   : mca_btl_tcp_put_stripe_local_complete;
+    frag->base.des_cbdata = remote ? (void *) piece : (void *) stripe;
+
+    frag->btl = endpoint->endpoint_btl;
+    frag->endpoint = endpoint;
+    frag->rc = 0;
+    frag->iov_idx = 0;
+    frag->iov_cnt = 3;
+    frag->iov_ptr = frag->iov;
+    frag->iov[0].iov_base = (IOVBASE_TYPE *) &frag->hdr;
+    frag->iov[0].iov_len = sizeof(frag->hdr);
+    frag->iov[1].iov_base = (IOVBASE_TYPE *) frag->segments;
+    frag->iov[1].iov_len = (remote ? 2 : 1) * sizeof(mca_btl_base_segment_t);
+    frag->iov[2].iov_base = (IOVBASE_TYPE *) local;
+    frag->iov[2].iov_len = size;
+    frag->hdr.base.tag = MCA_BTL_TAG_BTL;
+    frag->hdr.type = remote ? MCA_BTL_TCP_HDR_TYPE_PUT_STRIPE : MCA_BTL_TCP_HDR_TYPE_PUT;
+    frag->hdr.count = remote ? 2 : 1;
+    frag->hdr.size = (uint32_t) size;
+    if (endpoint->endpoint_nbo) {
+        MCA_BTL_TCP_HDR_HTON(frag->hdr);
+    }
+}
+
+/*
+ * Stripe the put over the endpoints connected to the peer. Returns
+ * OPAL_ERR_NOT_AVAILABLE, without side effect, if the put should go
+ * through a single endpoint.
+ */
+static int mca_btl_tcp_put_striped(mca_btl_base_module_t *btl,
+                                   struct mca_btl_base_endpoint_t *endpoint, void *local_address,
+                                   uint64_t remote_address, size_t size,
+                                   mca_btl_base_rdma_completion_fn_t cbfunc, void *cbcontext,
+                                   void *cbdata)
+{
+    struct mca_btl_base_endpoint_t *endpoints[MCA_BTL_TCP_STRIPE_MAX];
+    mca_btl_tcp_frag_t *frags[MCA_BTL_TCP_STRIPE_MAX];
+    mca_btl_tcp_proc_t *proc = endpoint->endpoint_proc;
+    mca_btl_tcp_put_stripe_t *stripe;
+    uint64_t bandwidth = 0;
+    size_t offset, length;
+    int count = 1, i;
+
+    /* the endpoint of the put comes first, and sends the last piece */
+    endpoints[0] = endpoint;
+    OPAL_THREAD_LOCK(&proc->proc_lock);
+    for (size_t n = 0; n < proc->proc_endpoint_count && count < MCA_BTL_TCP_STRIPE_MAX; n++) {
+        struct mca_btl_base_endpoint_t *peer = proc->proc_endpoints[n];
+        if (peer != endpoint && MCA_BTL_TCP_CONNECTED == peer->endpoint_state) {
+            endpoints[count++] = peer;
+        }
+    }
+    OPAL_THREAD_UNLOCK(&proc->proc_lock);
+    if (count < 2) {
+        return OPAL_ERR_NOT_AVAILABLE;
+    }
+
+    for (i = 0; i < count; i++) {
+        MCA_BTL_TCP_FRAG_ALLOC_USER(frags[i]);
+        if (OPAL_UNLIKELY(NULL == frags[i])) {
+            while (i-- > 0) {
+                MCA_BTL_TCP_FRAG_RETURN(frags[i]);
+            }
+            return OPAL_ERR_NOT_AVAILABLE;
+        }
+        bandwidth += endpoints[i]->endpoint_btl->super.btl_bandwidth;
+    }
+    stripe = (mca_btl_tcp_put_stripe_t *) malloc(sizeof(*stripe));
+    if (OPAL_UNLIKELY(NULL == stripe)) {
+        for (i = 0; i < count; i++) {
+            MCA_BTL_TCP_FRAG_RETURN(frags[i]);
+        }
+        return OPAL_ERR_NOT_AVAILABLE;
+    }
+    /* one more than the pieces, until they are all handed to their endpoint */
+    stripe->pending = count + 1;
+    stripe->rc = OPAL_SUCCESS;
+    stripe->btl = btl;
+    stripe->endpoint = endpoint;
+    stripe->local_address = local_address;
+    stripe->cbfunc = cbfunc;
+    stripe->cbcontext = cbcontext;
+    stripe->cbdata = cbdata;
+    for (i = 0; i < MCA_BTL_TCP_STRIPE_MAX; i++) {
+        OBJ_CONSTRUCT(&stripe->pieces[i], opal_list_item_t);
+        stripe->pieces[i].stripe = stripe;
+    }
+
+    offset = 0;
+    for (i = count - 1; i >= 0; i--) {
+        mca_btl_tcp_put_stripe_piece_t *piece = NULL;
+
+        if (0 == i) {
+            length = size - offset;
+        } else {
+            if (0 != bandwidth) {
+                length = (size_t) ((double) size * endpoints[i]->endpoint_btl->super.btl_bandwidth
+                                   / (double) bandwidth);
+            } else {
+                length = size / count;
+            }
+            /* waits for its acknowledgment from now on, which may come before the send returns */
+            piece = &stripe->pieces[i];
+            OPAL_THREAD_LOCK(&endpoints[i]->endpoint_stripe_lock);
+            opal_list_append(&endpoints[i]->endpoint_stripe_pieces, &piece->super);
+            OPAL_THREAD_UNLOCK(&endpoints[i]->endpoint_stripe_lock);
+        }
+        mca_btl_tcp_put_stripe_frag(frags[i], endpoints[i], stripe, piece,
+                                    (unsigned char *) local_address + offset,
+                                    remote_address + offset, length);
+        offset += length;
+        if (mca_btl_tcp_endpoint_send(endpoints[i], frags[i]) < 0) {
+            MCA_BTL_TCP_FRAG_RETURN(frags[i]);
+            if (NULL != piece) {
+                mca_btl_tcp_put_stripe_piece_fail(endpoints[i], piece, OPAL_ERR_UNREACH);
+            } else {
+                mca_btl_tcp_put_stripe_piece_complete(stripe, OPAL_ERR_UNREACH);
+            }
+        }
+    }
+    mca_btl_tcp_put_stripe_piece_complete(stripe, OPAL_SUCCESS);
+    return OPAL_SUCCESS;
+}
+
 /**
  * Initiate an asynchronous put.
  */
@@ -354,6 +761,14 @@ int mca_btl_tcp_put(mca_btl_base_module_t *btl, struct mca_btl_base_endpoint_t *
     mca_btl_tcp_frag_t *frag = NULL;
     int i;
 
+    if (0 < mca_btl_tcp_component.tcp_stripe_min_size
+        && size >= (size_t) mca_btl_tcp_component.tcp_stripe_min_size
+        && OPAL_SUCCESS
+               == mca_btl_tcp_put_striped(btl, endpoint, local_address, remote_address, size,
+                                          cbfunc, cbcontext, cbdata)) {
+        return OPAL_SUCCESS;
+    }
+
     MCA_BTL_TCP_FRAG_ALLOC_USER(frag);
     if (OPAL_UNLIKELY(NULL == frag)) {
         return OPAL_ERR_OUT_OF_RESOURCE;
@@ -484,6 +899,10 @@ int mca_btl_tcp_finalize(struct mca_btl_base_module_t *btl)
     mca_btl_tcp_module_t *tcp_btl = (mca_btl_tcp_module_t *) btl;
     opal_list_item_t *item;
 
+#if MCA_BTL_TCP_EPOLL
+    /* the I/O threads may still be using the endpoints */
+    mca_btl_tcp_epoll_finalize();
+#endif /* MCA_BTL_TCP_EPOLL */
     /* Don't lock the tcp_endpoints_mutex, at this point a single
      * thread should be active.
      */
@@ -103,6 +103,9 @@ struct mca_btl_tcp_component_t {
     int tcp_free_list_max;                  /**< maximum size of free lists */
     int tcp_free_list_inc;       /**< number of elements to alloc when growing free lists */
     int tcp_endpoint_cache;      /**< amount of cache on each endpoint */
+    int tcp_send_batch;          /**< max number of frags gathered in a single write */
+    int tcp_zcopy_threshold;     /**< min size of a MSG_ZEROCOPY write (0 disables them) */
+    int tcp_stripe_min_size;     /**< min size of a put striped over all connections to the peer */
     opal_proc_table_t tcp_procs; /**< hash table of tcp proc structures */
     opal_mutex_t tcp_lock;       /**< lock for accessing module state */
     opal_list_t tcp_events;
@@ -133,6 +136,7 @@ struct mca_btl_tcp_component_t {
     opal_free_list_t tcp_frag_user;
 
     int tcp_enable_progress_thread; /** Support for tcp progress thread flag */
+    int tcp_epoll_threads;          /** I/O threads of the epoll engine (0 uses libevent) */
 
     opal_event_t tcp_recv_thread_async_event;
     opal_mutex_t tcp_frag_eager_mutex;
@@ -262,6 +266,24 @@ int mca_btl_tcp_put(mca_btl_base_module_t *btl, struct mca_btl_base_endpoint_t *
                     int order, mca_btl_base_rdma_completion_fn_t cbfunc, void *cbcontext,
                     void *cbdata);
 
+/**
+ * Target side of a striped put: acknowledge the piece identified by the
+ * cookie once its data has been received on the endpoint.
+ */
+void mca_btl_tcp_put_stripe_ack(struct mca_btl_base_endpoint_t *endpoint, uint64_t cookie);
+
+/**
+ * Origin side of a striped put: the piece identified by the cookie has been
+ * acknowledged by the target on the endpoint.
+ */
+void mca_btl_tcp_put_stripe_acked(struct mca_btl_base_endpoint_t *endpoint, uint64_t cookie);
+
+/**
+ * The connection of the endpoint is closed: fail the pieces of striped puts
+ * waiting for their acknowledgment and drop the acknowledgments not sent yet.
+ */
+void mca_btl_tcp_put_stripe_close(struct mca_btl_base_endpoint_t *endpoint);
+
 /**
  * Initiate an asynchronous get.
  */
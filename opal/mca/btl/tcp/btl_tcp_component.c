@@ -82,6 +82,7 @@
 #include "btl_tcp.h"
 #include "btl_tcp_addr.h"
 #include "btl_tcp_endpoint.h"
+#include "btl_tcp_epoll.h"
 #include "btl_tcp_frag.h"
 #include "btl_tcp_proc.h"
 #include "opal/constants.h"
@@ -270,6 +271,26 @@ static int mca_btl_tcp_component_register(void)
         " Every read will read the expected data plus the amount of the"
         " endpoint_cache",
         30 * 1024, OPAL_INFO_LVL_4, &mca_btl_tcp_component.tcp_endpoint_cache);
+    mca_btl_tcp_param_register_int(
+        "send_batch",
+        "The maximum number of pending fragments of a connection gathered into a"
+        " single write, to reduce the number of syscalls when many small messages"
+        " are queued. 1 writes the fragments one at a time.",
+        1, OPAL_INFO_LVL_4, &mca_btl_tcp_component.tcp_send_batch);
+    mca_btl_tcp_param_register_int(
+        "zerocopy_threshold",
+        "Writes of at least this many bytes use MSG_ZEROCOPY, avoiding the copy"
+        " of the data into the kernel. The fragments are completed once the"
+        " kernel reports that it has released their buffers. Only available on"
+        " Linux 4.14 and later. 0 disables zero-copy writes.",
+        0, OPAL_INFO_LVL_4, &mca_btl_tcp_component.tcp_zcopy_threshold);
+    mca_btl_tcp_param_register_int(
+        "stripe_min_size",
+        "Puts of at least this many bytes are cut in pieces sent concurrently"
+        " over all the connected links and interfaces to the peer, in proportion"
+        " to their bandwidth, so that a single large message is not limited to"
+        " the throughput of one socket. 0 disables the striping.",
+        0, OPAL_INFO_LVL_4, &mca_btl_tcp_component.tcp_stripe_min_size);
     mca_btl_tcp_param_register_int("use_nagle",
                                    "Whether to use Nagle's algorithm or not (using Nagle's "
                                    "algorithm may increase short message latency)",
@@ -305,6 +326,15 @@ static int mca_btl_tcp_component_register(void)
     /* Check if we should support async progress */
     mca_btl_tcp_param_register_int("progress_thread", NULL, 0, OPAL_INFO_LVL_1,
                                    &mca_btl_tcp_component.tcp_enable_progress_thread);
+    mca_btl_tcp_param_register_int(
+        "epoll_threads",
+        "With the progress thread enabled, the number of I/O threads progressing"
+        " the established connections with edge-triggered epoll instead of"
+        " libevent. Each connection is owned by one I/O thread, and the"
+        " completed fragments are handed back to the threads calling the"
+        " progress engine. Only available on Linux. 0 keeps all the connections"
+        " on libevent.",
+        0, OPAL_INFO_LVL_4, &mca_btl_tcp_component.tcp_epoll_threads);
     mca_btl_tcp_component.report_all_unfound_interfaces = false;
     (void) mca_base_component_var_register(
         &mca_btl_tcp_component.super.btl_version, "warn_all_unfound_interfaces",
@@ -403,6 +433,9 @@ static int mca_btl_tcp_component_close(void)
 {
     mca_btl_tcp_event_t *event, *next;
 
+#if MCA_BTL_TCP_EPOLL
+    mca_btl_tcp_epoll_finalize();
+#endif /* MCA_BTL_TCP_EPOLL */
     /**
      * If we have a progress thread we should shut it down before
      * moving forward with the TCP tearing down process.
@@ -1153,6 +1186,14 @@ socket_binded:
             /* We have async progress, the rest of the library should now protect itself against
              * races */
             opal_set_using_threads(true);
+#if MCA_BTL_TCP_EPOLL
+            if (0 < mca_btl_tcp_component.tcp_epoll_threads
+                && OPAL_SUCCESS
+                       != (rc = mca_btl_tcp_epoll_init(mca_btl_tcp_component.tcp_epoll_threads))) {
+                /* the connections are progressed by the libevent progress thread */
+                BTL_ERROR(("BTL TCP epoll engine initialization failed (%d)", rc));
+            }
+#endif /* MCA_BTL_TCP_EPOLL */
         }
     } else {
     move_forward_with_no_thread:
@@ -1313,6 +1354,12 @@ mca_btl_base_module_t **mca_btl_tcp_component_init(int *num_btl_modules,
                 |= MCA_BTL_FLAGS_BTL_PROGRESS_THREAD_ENABLED;
         }
     }
+#if MCA_BTL_TCP_EPOLL
+    /* the fragments completed by the I/O threads are handed back here */
+    if (0 < mca_btl_tcp_epoll_nthreads) {
+        mca_btl_tcp_component.super.btl_progress = mca_btl_tcp_epoll_progress;
+    }
+#endif /* MCA_BTL_TCP_EPOLL */
 
     /* Avoid a race in wire-up when using threads (progress or user)
        and multiple BTL modules.  The details of the race are in
@@ -86,6 +86,9 @@ static void mca_btl_tcp_endpoint_construct(mca_btl_tcp_endpoint_t *endpoint)
     endpoint->endpoint_sd_next = -1;
     endpoint->endpoint_send_frag = 0;
     endpoint->endpoint_recv_frag = 0;
+#if MCA_BTL_TCP_EPOLL
+    endpoint->endpoint_recv_held = NULL;
+#endif /* MCA_BTL_TCP_EPOLL */
     endpoint->endpoint_state = MCA_BTL_TCP_CLOSED;
     endpoint->endpoint_retries = 0;
     endpoint->endpoint_nbo = false;
@@ -95,6 +98,23 @@ static void mca_btl_tcp_endpoint_construct(mca_btl_tcp_endpoint_t *endpoint)
     endpoint->endpoint_cache_length = 0;
 #endif /* MCA_BTL_TCP_ENDPOINT_CACHE */
     OBJ_CONSTRUCT(&endpoint->endpoint_frags, opal_list_t);
+#if MCA_BTL_TCP_ZEROCOPY
+    endpoint->endpoint_zcopy = false;
+    endpoint->endpoint_zcopy_next = 0;
+    endpoint->endpoint_zcopy_done = 0;
+    endpoint->endpoint_zcopy_ahead = NULL;
+    endpoint->endpoint_zcopy_ahead_count = 0;
+    endpoint->endpoint_zcopy_ahead_size = 0;
+    OBJ_CONSTRUCT(&endpoint->endpoint_zcopy_frags, opal_list_t);
+#endif /* MCA_BTL_TCP_ZEROCOPY */
+#if MCA_BTL_TCP_EPOLL
+    endpoint->endpoint_epoll_thread = NULL;
+    endpoint->endpoint_epoll = false;
+#endif /* MCA_BTL_TCP_EPOLL */
+    OBJ_CONSTRUCT(&endpoint->endpoint_stripe_pieces, opal_list_t);
+    OBJ_CONSTRUCT(&endpoint->endpoint_stripe_acks, opal_list_t);
+    endpoint->endpoint_stripe_ack_armed = false;
+    OBJ_CONSTRUCT(&endpoint->endpoint_stripe_lock, opal_mutex_t);
     OBJ_CONSTRUCT(&endpoint->endpoint_send_lock, opal_mutex_t);
     OBJ_CONSTRUCT(&endpoint->endpoint_recv_lock, opal_mutex_t);
 }
@@ -108,6 +128,14 @@ static void mca_btl_tcp_endpoint_destruct(mca_btl_tcp_endpoint_t *endpoint)
     mca_btl_tcp_endpoint_close(endpoint);
     mca_btl_tcp_proc_remove(endpoint->endpoint_proc, endpoint);
     OBJ_DESTRUCT(&endpoint->endpoint_frags);
+#if MCA_BTL_TCP_ZEROCOPY
+    OBJ_DESTRUCT(&endpoint->endpoint_zcopy_frags);
+    free(endpoint->endpoint_zcopy_ahead);
+#endif /* MCA_BTL_TCP_ZEROCOPY */
+    mca_btl_tcp_put_stripe_close(endpoint);
+    OBJ_DESTRUCT(&endpoint->endpoint_stripe_pieces);
+    OPAL_LIST_DESTRUCT(&endpoint->endpoint_stripe_acks);
+    OBJ_DESTRUCT(&endpoint->endpoint_stripe_lock);
     OBJ_DESTRUCT(&endpoint->endpoint_send_lock);
     OBJ_DESTRUCT(&endpoint->endpoint_recv_lock);
 }
@@ -121,6 +149,9 @@ static int mca_btl_tcp_endpoint_start_connect(mca_btl_base_endpoint_t *);
 static void mca_btl_tcp_endpoint_connected(mca_btl_base_endpoint_t *);
 static void mca_btl_tcp_endpoint_recv_handler(int sd, short flags, void *user);
 static void mca_btl_tcp_endpoint_send_handler(int sd, short flags, void *user);
+#if MCA_BTL_TCP_ZEROCOPY
+static void mca_btl_tcp_endpoint_zcopy_progress(mca_btl_base_endpoint_t *btl_endpoint);
+#endif /* MCA_BTL_TCP_ZEROCOPY */
 
 /*
  * diagnostics
@@ -382,7 +413,15 @@ int mca_btl_tcp_endpoint_send(mca_btl_base_endpoint_t *btl_endpoint, mca_btl_tcp
                 MCA_BTL_TCP_ENDPOINT_DUMP(10, btl_endpoint, true,
                                           "event_add(send) [endpoint_send]");
                 frag->base.des_flags |= MCA_BTL_DES_SEND_ALWAYS_CALLBACK;
+#if MCA_BTL_TCP_EPOLL
+                if (btl_endpoint->endpoint_epoll) {
+                    mca_btl_tcp_epoll_kick(btl_endpoint);
+                } else {
+                    MCA_BTL_TCP_ACTIVATE_EVENT(&btl_endpoint->endpoint_send_event, 0);
+                }
+#else
                 MCA_BTL_TCP_ACTIVATE_EVENT(&btl_endpoint->endpoint_send_event, 0);
+#endif /* MCA_BTL_TCP_EPOLL */
             }
         } else {
             MCA_BTL_TCP_ENDPOINT_DUMP(10, btl_endpoint, true,
@@ -542,6 +581,16 @@ void mca_btl_tcp_endpoint_close(mca_btl_base_endpoint_t *btl_endpoint)
     }
     MCA_BTL_TCP_ENDPOINT_DUMP(1, btl_endpoint, false, "event_del(send) [close]");
     opal_event_del(&btl_endpoint->endpoint_send_event);
+#if MCA_BTL_TCP_EPOLL
+    mca_btl_tcp_epoll_del(btl_endpoint);
+    /* nothing else is read on this connection, the held fragment does not
+     * need a replacement anymore */
+    if (NULL != btl_endpoint->endpoint_recv_held) {
+        mca_btl_tcp_epoll_recv_done(btl_endpoint->endpoint_epoll_thread,
+                                    btl_endpoint->endpoint_recv_held);
+        btl_endpoint->endpoint_recv_held = NULL;
+    }
+#endif /* MCA_BTL_TCP_EPOLL */
 
 #if MCA_BTL_TCP_ENDPOINT_CACHE
     free(btl_endpoint->endpoint_cache);
@@ -564,6 +613,24 @@ void mca_btl_tcp_endpoint_close(mca_btl_base_endpoint_t *btl_endpoint)
 
     CLOSE_THE_SOCKET(btl_endpoint->endpoint_sd);
     btl_endpoint->endpoint_sd = -1;
+    /* the acknowledgments of the striped puts will not come on this connection */
+    mca_btl_tcp_put_stripe_close(btl_endpoint);
+#if MCA_BTL_TCP_ZEROCOPY
+    /* the completions of the zero-copy writes are lost with the socket. The
+     * fragments were entirely handed to the kernel, complete them as such. */
+    btl_endpoint->endpoint_zcopy = false;
+    while (!opal_list_is_empty(&btl_endpoint->endpoint_zcopy_frags)) {
+        mca_btl_tcp_frag_t *frag = (mca_btl_tcp_frag_t *) opal_list_remove_first(
+            &btl_endpoint->endpoint_zcopy_frags);
+        frag->zcopy = false;
+        if (NULL != frag->base.des_cbfunc) {
+            frag->base.des_cbfunc(&frag->btl->super, frag->endpoint, &frag->base, frag->rc);
+        }
+        if (frag->base.des_flags & MCA_BTL_DES_FLAGS_BTL_OWNERSHIP) {
+            MCA_BTL_TCP_FRAG_RETURN(frag);
+        }
+    }
+#endif /* MCA_BTL_TCP_ZEROCOPY */
     /**
      * If we keep failing to connect to the peer let the caller know about
      * this situation by triggering the callback on all pending fragments and
@@ -608,6 +675,43 @@ static void mca_btl_tcp_endpoint_connected(mca_btl_base_endpoint_t *btl_endpoint
     btl_endpoint->endpoint_retries = 0;
     MCA_BTL_TCP_ENDPOINT_DUMP(1, btl_endpoint, true, "READY [endpoint_connected]");
 
+#if MCA_BTL_TCP_ZEROCOPY
+    /* the kernel numbers the zero-copy writes of each socket from 0 */
+    btl_endpoint->endpoint_zcopy_next = 0;
+    btl_endpoint->endpoint_zcopy_done = 0;
+    btl_endpoint->endpoint_zcopy_ahead_count = 0;
+    btl_endpoint->endpoint_zcopy = false;
+    if (0 < mca_btl_tcp_component.tcp_zcopy_threshold) {
+        int optval = 1;
+        if (setsockopt(btl_endpoint->endpoint_sd, SOL_SOCKET, SO_ZEROCOPY, (char *) &optval,
+                       sizeof(optval))
+            < 0) {
+            OPAL_OUTPUT_VERBOSE((20, opal_btl_base_framework.framework_output,
+                                 "btl:tcp: setsockopt(SO_ZEROCOPY) failed: %s (%d)",
+                                 strerror(opal_socket_errno), opal_socket_errno));
+        } else {
+            btl_endpoint->endpoint_zcopy = true;
+        }
+    }
+#endif /* MCA_BTL_TCP_ZEROCOPY */
+
+#if MCA_BTL_TCP_EPOLL
+    if (0 < mca_btl_tcp_epoll_nthreads) {
+        /* hand the socket over to its I/O thread. It is reported writable
+         * once registered, which starts the pending sends. */
+        opal_event_del(&btl_endpoint->endpoint_recv_event);
+        if (OPAL_SUCCESS == mca_btl_tcp_epoll_add(btl_endpoint)) {
+            if (NULL == btl_endpoint->endpoint_send_frag) {
+                btl_endpoint->endpoint_send_frag = (mca_btl_tcp_frag_t *) opal_list_remove_first(
+                    &btl_endpoint->endpoint_frags);
+            }
+            return;
+        }
+        /* keep the connection on libevent */
+        opal_event_add(&btl_endpoint->endpoint_recv_event, 0);
+    }
+#endif /* MCA_BTL_TCP_EPOLL */
+
     if (opal_list_get_size(&btl_endpoint->endpoint_frags) > 0) {
         if (NULL == btl_endpoint->endpoint_send_frag) {
             btl_endpoint->endpoint_send_frag = (mca_btl_tcp_frag_t *) opal_list_remove_first(
@@ -934,6 +1038,151 @@ static int mca_btl_tcp_endpoint_complete_connect(mca_btl_base_endpoint_t *btl_en
     return OPAL_ERROR;
 }
 
+static inline mca_btl_tcp_frag_t *
+mca_btl_tcp_endpoint_recv_frag_alloc(mca_btl_base_endpoint_t *btl_endpoint)
+{
+    mca_btl_tcp_frag_t *frag;
+
+    if (mca_btl_tcp_module.super.btl_max_send_size > mca_btl_tcp_module.super.btl_eager_limit) {
+        MCA_BTL_TCP_FRAG_ALLOC_MAX(frag);
+    } else {
+        MCA_BTL_TCP_FRAG_ALLOC_EAGER(frag);
+    }
+    if (NULL != frag) {
+        MCA_BTL_TCP_FRAG_INIT_DST(frag, btl_endpoint);
+    }
+    return frag;
+}
+
+/*
+ * Trigger the upper layer for a received fragment. The fragment is not
+ * returned.
+ */
+void mca_btl_tcp_endpoint_recv_complete(mca_btl_tcp_frag_t *frag)
+{
+    if (MCA_BTL_TCP_HDR_TYPE_SEND == frag->hdr.type) {
+        mca_btl_active_message_callback_t *reg = mca_btl_base_active_message_trigger
+                                                 + frag->hdr.base.tag;
+        const mca_btl_base_receive_descriptor_t desc
+            = {.endpoint = frag->endpoint,
+               .des_segments = frag->base.des_segments,
+               .des_segment_count = frag->base.des_segment_count,
+               .tag = frag->hdr.base.tag,
+               .cbdata = reg->cbdata};
+        reg->cbfunc(&frag->btl->super, &desc);
+    } else if (MCA_BTL_TCP_HDR_TYPE_PUT_STRIPE == frag->hdr.type) {
+        mca_btl_tcp_put_stripe_ack(frag->endpoint, frag->segments[1].seg_addr.lval);
+    } else if (MCA_BTL_TCP_HDR_TYPE_PUT_ACK == frag->hdr.type) {
+        mca_btl_tcp_put_stripe_acked(frag->endpoint, frag->segments[0].seg_addr.lval);
+    }
+}
+
+/*
+ * Complete a received fragment. On the I/O threads of the epoll engine the
+ * fragments reaching the upper layer are queued for the progress function,
+ * and a new fragment is returned for the data left in the cache. If no new
+ * fragment is available the received one is held on the endpoint and NULL
+ * is returned: its callback must not run on the I/O thread, and the
+ * connection is not read until the fragments queued for the progress
+ * function are returned.
+ */
+static inline mca_btl_tcp_frag_t *
+mca_btl_tcp_endpoint_recv_done(mca_btl_base_endpoint_t *btl_endpoint, mca_btl_tcp_frag_t *frag,
+                               bool deferred)
+{
+#if MCA_BTL_TCP_EPOLL
+    if (deferred
+        && (MCA_BTL_TCP_HDR_TYPE_SEND == frag->hdr.type
+            || MCA_BTL_TCP_HDR_TYPE_PUT_ACK == frag->hdr.type)) {
+        mca_btl_tcp_frag_t *next = mca_btl_tcp_endpoint_recv_frag_alloc(btl_endpoint);
+
+        if (OPAL_UNLIKELY(NULL == next)) {
+            btl_endpoint->endpoint_recv_held = frag;
+            return NULL;
+        }
+        mca_btl_tcp_epoll_recv_done(btl_endpoint->endpoint_epoll_thread, frag);
+        return next;
+    }
+#endif /* MCA_BTL_TCP_EPOLL */
+    mca_btl_tcp_endpoint_recv_complete(frag);
+    return frag;
+}
+
+/*
+ * Receive on a connected endpoint, with the recv lock held. Returns true if
+ * the last read completed a fragment, in which case more data may be waiting
+ * on the socket.
+ */
+static bool mca_btl_tcp_endpoint_recv_frags(mca_btl_base_endpoint_t *btl_endpoint, bool deferred)
+{
+    mca_btl_tcp_frag_t *frag;
+    bool completed;
+
+#if MCA_BTL_TCP_EPOLL
+    if (NULL != btl_endpoint->endpoint_recv_held) {
+        /* release the held fragment once it can be replaced */
+        frag = mca_btl_tcp_endpoint_recv_frag_alloc(btl_endpoint);
+        if (NULL == frag) {
+            mca_btl_tcp_epoll_kick(btl_endpoint);
+            return false;
+        }
+        mca_btl_tcp_epoll_recv_done(btl_endpoint->endpoint_epoll_thread,
+                                    btl_endpoint->endpoint_recv_held);
+        btl_endpoint->endpoint_recv_held = NULL;
+    } else
+#endif /* MCA_BTL_TCP_EPOLL */
+    {
+        frag = btl_endpoint->endpoint_recv_frag;
+        if (NULL == frag) {
+            frag = mca_btl_tcp_endpoint_recv_frag_alloc(btl_endpoint);
+            if (NULL == frag) {
+#if MCA_BTL_TCP_EPOLL
+                /* the data stays on the socket, no new edge would report it */
+                if (deferred) {
+                    mca_btl_tcp_epoll_kick(btl_endpoint);
+                }
+#endif /* MCA_BTL_TCP_EPOLL */
+                return false;
+            }
+        }
+    }
+
+#if MCA_BTL_TCP_ENDPOINT_CACHE
+    assert(0 == btl_endpoint->endpoint_cache_length);
+data_still_pending_on_endpoint:
+#endif /* MCA_BTL_TCP_ENDPOINT_CACHE */
+    /* check for completion of non-blocking recv on the current fragment */
+    if (mca_btl_tcp_frag_recv(frag, btl_endpoint->endpoint_sd) == false) {
+        btl_endpoint->endpoint_recv_frag = frag;
+        completed = false;
+    } else {
+        btl_endpoint->endpoint_recv_frag = NULL;
+        frag = mca_btl_tcp_endpoint_recv_done(btl_endpoint, frag, deferred);
+#if MCA_BTL_TCP_EPOLL
+        if (OPAL_UNLIKELY(NULL == frag)) {
+            /* come back once the progress function returned some fragments */
+            mca_btl_tcp_epoll_kick(btl_endpoint);
+            return false;
+        }
+#endif /* MCA_BTL_TCP_EPOLL */
+        completed = true;
+#if MCA_BTL_TCP_ENDPOINT_CACHE
+        if (0 != btl_endpoint->endpoint_cache_length) {
+            /* If the cache still contain some data we can reuse the same fragment
+             * until we flush it completely.
+             */
+            MCA_BTL_TCP_FRAG_INIT_DST(frag, btl_endpoint);
+            goto data_still_pending_on_endpoint;
+        }
+#endif /* MCA_BTL_TCP_ENDPOINT_CACHE */
+        MCA_BTL_TCP_FRAG_RETURN(frag);
+    }
+#if MCA_BTL_TCP_ENDPOINT_CACHE
+    assert(0 == btl_endpoint->endpoint_cache_length);
+#endif /* MCA_BTL_TCP_ENDPOINT_CACHE */
+    return completed;
+}
+
 /*
  * A file descriptor is available/ready for recv. Check the state
  * of the socket and take the appropriate action.
@@ -1004,62 +1253,13 @@ static void mca_btl_tcp_endpoint_recv_handler(int sd, short flags, void *user)
         OPAL_THREAD_UNLOCK(&btl_endpoint->endpoint_recv_lock);
         return;
     }
-    case MCA_BTL_TCP_CONNECTED: {
-        mca_btl_tcp_frag_t *frag;
-
-        frag = btl_endpoint->endpoint_recv_frag;
-        if (NULL == frag) {
-            if (mca_btl_tcp_module.super.btl_max_send_size
-                > mca_btl_tcp_module.super.btl_eager_limit) {
-                MCA_BTL_TCP_FRAG_ALLOC_MAX(frag);
-            } else {
-                MCA_BTL_TCP_FRAG_ALLOC_EAGER(frag);
-            }
-
-            if (NULL == frag) {
-                OPAL_THREAD_UNLOCK(&btl_endpoint->endpoint_recv_lock);
-                return;
-            }
-            MCA_BTL_TCP_FRAG_INIT_DST(frag, btl_endpoint);
-        }
-
-#if MCA_BTL_TCP_ENDPOINT_CACHE
-        assert(0 == btl_endpoint->endpoint_cache_length);
-    data_still_pending_on_endpoint:
-#endif /* MCA_BTL_TCP_ENDPOINT_CACHE */
-        /* check for completion of non-blocking recv on the current fragment */
-        if (mca_btl_tcp_frag_recv(frag, btl_endpoint->endpoint_sd) == false) {
-            btl_endpoint->endpoint_recv_frag = frag;
-        } else {
-            btl_endpoint->endpoint_recv_frag = NULL;
-            if (MCA_BTL_TCP_HDR_TYPE_SEND == frag->hdr.type) {
-                mca_btl_active_message_callback_t *reg = mca_btl_base_active_message_trigger
-                                                         + frag->hdr.base.tag;
-                const mca_btl_base_receive_descriptor_t desc
-                    = {.endpoint = btl_endpoint,
-                       .des_segments = frag->base.des_segments,
-                       .des_segment_count = frag->base.des_segment_count,
-                       .tag = frag->hdr.base.tag,
-                       .cbdata = reg->cbdata};
-                reg->cbfunc(&frag->btl->super, &desc);
-            }
-#if MCA_BTL_TCP_ENDPOINT_CACHE
-            if (0 != btl_endpoint->endpoint_cache_length) {
-                /* If the cache still contain some data we can reuse the same fragment
-                 * until we flush it completely.
-                 */
-                MCA_BTL_TCP_FRAG_INIT_DST(frag, btl_endpoint);
-                goto data_still_pending_on_endpoint;
-            }
-#endif /* MCA_BTL_TCP_ENDPOINT_CACHE */
-            MCA_BTL_TCP_FRAG_RETURN(frag);
-        }
-#if MCA_BTL_TCP_ENDPOINT_CACHE
-        assert(0 == btl_endpoint->endpoint_cache_length);
-#endif /* MCA_BTL_TCP_ENDPOINT_CACHE */
+    case MCA_BTL_TCP_CONNECTED:
+        (void) mca_btl_tcp_endpoint_recv_frags(btl_endpoint, false);
         OPAL_THREAD_UNLOCK(&btl_endpoint->endpoint_recv_lock);
+#if MCA_BTL_TCP_ZEROCOPY
+        mca_btl_tcp_endpoint_zcopy_progress(btl_endpoint);
+#endif /* MCA_BTL_TCP_ZEROCOPY */
         break;
-    }
     case MCA_BTL_TCP_CLOSED:
         /* This is a thread-safety issue. As multiple threads are allowed
          * to generate events (in the lib event) we endup with several
@@ -1078,6 +1278,69 @@ static void mca_btl_tcp_endpoint_recv_handler(int sd, short flags, void *user)
     }
 }
 
+/*
+ * Send handler of the batched writes, called with the send lock held.
+ * Releases the lock before completing the fragments, or queues them for the
+ * progress function when deferred.
+ */
+static void mca_btl_tcp_endpoint_send_batched(mca_btl_base_endpoint_t *btl_endpoint, bool deferred)
+{
+    mca_btl_tcp_frag_t *frag;
+    opal_list_t done;
+
+    OBJ_CONSTRUCT(&done, opal_list_t);
+    mca_btl_tcp_frag_send_batch(btl_endpoint, &done);
+
+    /* the zero-copy completions still expected make the socket report an
+     * error, they are harvested from the receive handler */
+    if (!deferred && NULL == btl_endpoint->endpoint_send_frag) {
+        MCA_BTL_TCP_ENDPOINT_DUMP(10, btl_endpoint, false,
+                                  "event_del(send) [endpoint_send_batched]");
+        opal_event_del(&btl_endpoint->endpoint_send_event);
+    }
+    OPAL_THREAD_UNLOCK(&btl_endpoint->endpoint_send_lock);
+
+    while (NULL != (frag = (mca_btl_tcp_frag_t *) opal_list_remove_first(&done))) {
+        int btl_ownership = (frag->base.des_flags & MCA_BTL_DES_FLAGS_BTL_OWNERSHIP);
+
+        assert(frag->base.des_flags & MCA_BTL_DES_SEND_ALWAYS_CALLBACK);
+#if MCA_BTL_TCP_EPOLL
+        if (deferred) {
+            mca_btl_tcp_epoll_send_done(btl_endpoint->endpoint_epoll_thread, frag);
+            continue;
+        }
+#endif /* MCA_BTL_TCP_EPOLL */
+        if (NULL != frag->base.des_cbfunc) {
+            frag->base.des_cbfunc(&frag->btl->super, frag->endpoint, &frag->base, frag->rc);
+        }
+        if (btl_ownership) {
+            MCA_BTL_TCP_FRAG_RETURN(frag);
+        }
+    }
+    OBJ_DESTRUCT(&done);
+}
+
+#if MCA_BTL_TCP_ZEROCOPY
+/*
+ * Complete the fragments released by the kernel since the last write. The
+ * notifications are queued on the error queue of the socket, which wakes up
+ * the receive event: the send event is not kept armed for them. If another
+ * thread holds the send lock, it harvests them at the end of its write.
+ */
+static void mca_btl_tcp_endpoint_zcopy_progress(mca_btl_base_endpoint_t *btl_endpoint)
+{
+    if (!btl_endpoint->endpoint_zcopy || OPAL_THREAD_TRYLOCK(&btl_endpoint->endpoint_send_lock)) {
+        return;
+    }
+    if (MCA_BTL_TCP_CONNECTED != btl_endpoint->endpoint_state
+        || opal_list_is_empty(&btl_endpoint->endpoint_zcopy_frags)) {
+        OPAL_THREAD_UNLOCK(&btl_endpoint->endpoint_send_lock);
+        return;
+    }
+    mca_btl_tcp_endpoint_send_batched(btl_endpoint, false);
+}
+#endif /* MCA_BTL_TCP_ZEROCOPY */
+
 /*
  * A file descriptor is available/ready for send. Check the state
  * of the socket and take the appropriate action.
@@ -1097,6 +1360,10 @@ static void mca_btl_tcp_endpoint_send_handler(int sd, short flags, void *user)
         mca_btl_tcp_endpoint_complete_connect(btl_endpoint);
         break;
     case MCA_BTL_TCP_CONNECTED:
+        if (MCA_BTL_TCP_ENDPOINT_BATCHED(btl_endpoint)) {
+            mca_btl_tcp_endpoint_send_batched(btl_endpoint, false);
+            return;
+        }
         /* complete the current send */
         while (NULL != btl_endpoint->endpoint_send_frag) {
             mca_btl_tcp_frag_t *frag = btl_endpoint->endpoint_send_frag;
@@ -1149,3 +1416,54 @@ static void mca_btl_tcp_endpoint_send_handler(int sd, short flags, void *user)
     }
     OPAL_THREAD_UNLOCK(&btl_endpoint->endpoint_send_lock);
 }
+
+#if MCA_BTL_TCP_EPOLL
+/* fragments received in a row on a connection before yielding to the others
+ * owned by the same I/O thread */
+#    define MCA_BTL_TCP_ENDPOINT_RECV_BUDGET 64
+
+/*
+ * Handlers of the I/O threads of the epoll engine. The sockets are watched
+ * for edges: they are read until drained and written until full, and the
+ * locks are never given up on, as no notification would follow.
+ */
+void mca_btl_tcp_endpoint_recv_ready(mca_btl_base_endpoint_t *btl_endpoint)
+{
+    int budget = MCA_BTL_TCP_ENDPOINT_RECV_BUDGET;
+
+    OPAL_THREAD_LOCK(&btl_endpoint->endpoint_recv_lock);
+    while (MCA_BTL_TCP_CONNECTED == btl_endpoint->endpoint_state && btl_endpoint->endpoint_epoll
+           && mca_btl_tcp_endpoint_recv_frags(btl_endpoint, true)) {
+        if (0 == --budget) {
+            /* come back after the other connections */
+            mca_btl_tcp_epoll_kick(btl_endpoint);
+            break;
+        }
+    }
+    OPAL_THREAD_UNLOCK(&btl_endpoint->endpoint_recv_lock);
+}
+
+void mca_btl_tcp_endpoint_send_ready(mca_btl_base_endpoint_t *btl_endpoint)
+{
+    OPAL_THREAD_LOCK(&btl_endpoint->endpoint_send_lock);
+    if (MCA_BTL_TCP_CONNECTED != btl_endpoint->endpoint_state || !btl_endpoint->endpoint_epoll) {
+        OPAL_THREAD_UNLOCK(&btl_endpoint->endpoint_send_lock);
+        return;
+    }
+    if (MCA_BTL_TCP_ENDPOINT_BATCHED(btl_endpoint)) {
+        mca_btl_tcp_endpoint_send_batched(btl_endpoint, true);
+        return;
+    }
+    while (NULL != btl_endpoint->endpoint_send_frag) {
+        mca_btl_tcp_frag_t *frag = btl_endpoint->endpoint_send_frag;
+
+        if (mca_btl_tcp_frag_send(frag, btl_endpoint->endpoint_sd) == false) {
+            break;
+        }
+        btl_endpoint->endpoint_send_frag = (mca_btl_tcp_frag_t *) opal_list_remove_first(
+            &btl_endpoint->endpoint_frags);
+        mca_btl_tcp_epoll_send_done(btl_endpoint->endpoint_epoll_thread, frag);
+    }
+    OPAL_THREAD_UNLOCK(&btl_endpoint->endpoint_send_lock);
+}
+#endif /* MCA_BTL_TCP_EPOLL */
@@ -22,6 +22,7 @@
 #define MCA_BTL_TCP_ENDPOINT_H
 
 #include "btl_tcp.h"
+#include "btl_tcp_epoll.h"
 #include "btl_tcp_frag.h"
 #include "opal/class/opal_list.h"
 #include "opal/util/event.h"
@@ -63,9 +64,31 @@ struct mca_btl_base_endpoint_t {
 #endif /* MCA_BTL_TCP_ENDPOINT_CACHE */
     struct mca_btl_tcp_frag_t *endpoint_send_frag; /**< current send frag being processed */
     struct mca_btl_tcp_frag_t *endpoint_recv_frag; /**< current recv frag being processed */
+#if MCA_BTL_TCP_EPOLL
+    struct mca_btl_tcp_frag_t *endpoint_recv_held; /**< received frag waiting for a replacement
+                                                        on the I/O thread */
+#endif /* MCA_BTL_TCP_EPOLL */
     mca_btl_tcp_state_t endpoint_state;            /**< current state of the connection */
     uint32_t endpoint_retries;                     /**< number of connection retries attempted */
     opal_list_t endpoint_frags;                    /**< list of pending frags to send */
+#if MCA_BTL_TCP_ZEROCOPY
+    bool endpoint_zcopy;              /**< MSG_ZEROCOPY enabled on the socket */
+    uint32_t endpoint_zcopy_next;     /**< id of the next zero-copy write */
+    uint32_t endpoint_zcopy_done;     /**< zero-copy writes before this id are completed */
+    uint32_t *endpoint_zcopy_ahead;   /**< [first, end) ranges completed after a missing one */
+    int endpoint_zcopy_ahead_count;   /**< number of ranges in endpoint_zcopy_ahead */
+    int endpoint_zcopy_ahead_size;    /**< capacity of endpoint_zcopy_ahead, in ranges */
+    opal_list_t endpoint_zcopy_frags; /**< written frags waiting for their zero-copy completion */
+#endif /* MCA_BTL_TCP_ZEROCOPY */
+#if MCA_BTL_TCP_EPOLL
+    struct mca_btl_tcp_epoll_thread_t *endpoint_epoll_thread; /**< I/O thread of the endpoint */
+    bool endpoint_epoll; /**< socket progressed by the I/O thread instead of libevent */
+#endif /* MCA_BTL_TCP_EPOLL */
+    opal_list_t endpoint_stripe_pieces; /**< pieces of striped puts waiting for their ack */
+    opal_list_t endpoint_stripe_acks;   /**< acks of striped puts waiting for a fragment */
+    opal_event_t endpoint_stripe_ack_event; /**< timer retrying the acks */
+    bool endpoint_stripe_ack_armed;         /**< the timer is pending */
+    opal_mutex_t endpoint_stripe_lock;      /**< protects the stripe lists and timer */
     opal_mutex_t endpoint_send_lock;    /**< lock for concurrent access to endpoint state */
     opal_mutex_t endpoint_recv_lock;    /**< lock for concurrent access to endpoint state */
     opal_event_t endpoint_accept_event; /**< event for async processing of accept requests */
@@ -78,6 +101,14 @@ typedef struct mca_btl_base_endpoint_t mca_btl_base_endpoint_t;
 typedef mca_btl_base_endpoint_t mca_btl_tcp_endpoint_t;
 OBJ_CLASS_DECLARATION(mca_btl_tcp_endpoint_t);
 
+/* does the send handler of the endpoint go through mca_btl_tcp_frag_send_batch ? */
+#if MCA_BTL_TCP_ZEROCOPY
+#    define MCA_BTL_TCP_ENDPOINT_BATCHED(ep) \
+        (1 < mca_btl_tcp_component.tcp_send_batch || (ep)->endpoint_zcopy)
+#else
+#    define MCA_BTL_TCP_ENDPOINT_BATCHED(ep) (1 < mca_btl_tcp_component.tcp_send_batch)
+#endif /* MCA_BTL_TCP_ZEROCOPY */
+
 /* Magic socket handshake string */
 extern const char mca_btl_tcp_magic_id_string[MCA_BTL_TCP_MAGIC_STRING_LENGTH];
 
@@ -91,6 +122,11 @@ void mca_btl_tcp_endpoint_close(mca_btl_base_endpoint_t *);
 int mca_btl_tcp_endpoint_send(mca_btl_base_endpoint_t *, struct mca_btl_tcp_frag_t *);
 void mca_btl_tcp_endpoint_accept(mca_btl_base_endpoint_t *, struct sockaddr *, int);
 void mca_btl_tcp_endpoint_shutdown(mca_btl_base_endpoint_t *);
+void mca_btl_tcp_endpoint_recv_complete(struct mca_btl_tcp_frag_t *);
+#if MCA_BTL_TCP_EPOLL
+void mca_btl_tcp_endpoint_recv_ready(mca_btl_base_endpoint_t *);
+void mca_btl_tcp_endpoint_send_ready(mca_btl_base_endpoint_t *);
+#endif /* MCA_BTL_TCP_EPOLL */
 
 /*
  * Diagnostics: change this to "1" to enable the function
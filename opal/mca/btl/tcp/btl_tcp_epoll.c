@@ -0,0 +1,241 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "opal_config.h"
+
+#include "btl_tcp_epoll.h"
+
+#if MCA_BTL_TCP_EPOLL
+
+#    include <errno.h>
+#    include <stdlib.h>
+#    include <string.h>
+#    include <sys/epoll.h>
+#    include <sys/eventfd.h>
+#    ifdef HAVE_UNISTD_H
+#        include <unistd.h>
+#    endif
+
+#    include "opal/constants.h"
+#    include "opal/mca/btl/base/btl_base_error.h"
+#    include "opal/util/fd.h"
+
+#    include "btl_tcp.h"
+#    include "btl_tcp_endpoint.h"
+#    include "btl_tcp_frag.h"
+
+/* events harvested by a single epoll_wait */
+#    define MCA_BTL_TCP_EPOLL_MAX_EVENTS 64
+
+/* a connection is watched for both directions for its whole lifetime, the
+ * edges make the unneeded notifications cheap */
+#    define MCA_BTL_TCP_EPOLL_EVENTS (EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET)
+
+int mca_btl_tcp_epoll_nthreads = 0;
+
+static mca_btl_tcp_epoll_thread_t *mca_btl_tcp_epoll_threads = NULL;
+static int mca_btl_tcp_epoll_started = 0;
+static opal_atomic_int32_t mca_btl_tcp_epoll_next = 0;
+static volatile bool mca_btl_tcp_epoll_running = false;
+/* written once to wake up all the I/O threads on shutdown */
+static int mca_btl_tcp_epoll_stop_fd = -1;
+
+static void *mca_btl_tcp_epoll_engine(opal_object_t *obj)
+{
+    mca_btl_tcp_epoll_thread_t *thread = (mca_btl_tcp_epoll_thread_t *) ((opal_thread_t *) obj)
+                                             ->t_arg;
+    struct epoll_event events[MCA_BTL_TCP_EPOLL_MAX_EVENTS];
+
+    while (mca_btl_tcp_epoll_running) {
+        int nevents = epoll_wait(thread->epoll_fd, events, MCA_BTL_TCP_EPOLL_MAX_EVENTS, -1);
+
+        if (nevents < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            BTL_ERROR(("epoll_wait failed: %s (%d)", strerror(errno), errno));
+            break;
+        }
+        for (int i = 0; i < nevents; i++) {
+            mca_btl_base_endpoint_t *endpoint = (mca_btl_base_endpoint_t *) events[i].data.ptr;
+
+            if (NULL == endpoint) {
+                continue; /* shutdown notification */
+            }
+            /* a held fragment is retried on any event, the kicks mostly
+             * report the socket as writable */
+            if ((events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+                || NULL != endpoint->endpoint_recv_held) {
+                mca_btl_tcp_endpoint_recv_ready(endpoint);
+            }
+            /* the zero-copy completions are reported as errors */
+            if (events[i].events & (EPOLLOUT | EPOLLERR)) {
+                mca_btl_tcp_endpoint_send_ready(endpoint);
+            }
+        }
+    }
+    return NULL;
+}
+
+int mca_btl_tcp_epoll_init(int nthreads)
+{
+    struct epoll_event event = {.events = EPOLLIN, .data.ptr = NULL};
+    int rc;
+
+    mca_btl_tcp_epoll_stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (mca_btl_tcp_epoll_stop_fd < 0) {
+        BTL_ERROR(("eventfd failed: %s (%d)", strerror(errno), errno));
+        return OPAL_ERROR;
+    }
+    mca_btl_tcp_epoll_threads = (mca_btl_tcp_epoll_thread_t *)
+        calloc(nthreads, sizeof(mca_btl_tcp_epoll_thread_t));
+    if (NULL == mca_btl_tcp_epoll_threads) {
+        close(mca_btl_tcp_epoll_stop_fd);
+        mca_btl_tcp_epoll_stop_fd = -1;
+        return OPAL_ERR_OUT_OF_RESOURCE;
+    }
+
+    mca_btl_tcp_epoll_running = true;
+    for (int i = 0; i < nthreads; i++) {
+        mca_btl_tcp_epoll_thread_t *thread = mca_btl_tcp_epoll_threads + i;
+
+        OBJ_CONSTRUCT(&thread->thread, opal_thread_t);
+        OBJ_CONSTRUCT(&thread->recv_done, opal_fifo_t);
+        OBJ_CONSTRUCT(&thread->send_done, opal_fifo_t);
+        thread->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (thread->epoll_fd < 0
+            || 0 != epoll_ctl(thread->epoll_fd, EPOLL_CTL_ADD, mca_btl_tcp_epoll_stop_fd, &event)) {
+            BTL_ERROR(("epoll setup failed: %s (%d)", strerror(errno), errno));
+            rc = OPAL_ERROR;
+            goto error;
+        }
+        thread->thread.t_run = mca_btl_tcp_epoll_engine;
+        thread->thread.t_arg = thread;
+        if (OPAL_SUCCESS != (rc = opal_thread_start(&thread->thread))) {
+            BTL_ERROR(("BTL TCP epoll thread initialization failed (%d)", rc));
+            goto error;
+        }
+        mca_btl_tcp_epoll_started++;
+    }
+    mca_btl_tcp_epoll_nthreads = nthreads;
+    return OPAL_SUCCESS;
+
+error:
+    /* release the thread that failed, then stop the others */
+    if (0 <= mca_btl_tcp_epoll_threads[mca_btl_tcp_epoll_started].epoll_fd) {
+        close(mca_btl_tcp_epoll_threads[mca_btl_tcp_epoll_started].epoll_fd);
+    }
+    OBJ_DESTRUCT(&mca_btl_tcp_epoll_threads[mca_btl_tcp_epoll_started].thread);
+    OBJ_DESTRUCT(&mca_btl_tcp_epoll_threads[mca_btl_tcp_epoll_started].recv_done);
+    OBJ_DESTRUCT(&mca_btl_tcp_epoll_threads[mca_btl_tcp_epoll_started].send_done);
+    mca_btl_tcp_epoll_finalize();
+    return rc;
+}
+
+void mca_btl_tcp_epoll_finalize(void)
+{
+    uint64_t stop = 1;
+    void *ret = NULL; /* not currently used */
+
+    if (NULL == mca_btl_tcp_epoll_threads) {
+        return;
+    }
+    mca_btl_tcp_epoll_nthreads = 0;
+    mca_btl_tcp_epoll_running = false;
+    (void) opal_fd_write(mca_btl_tcp_epoll_stop_fd, sizeof(stop), &stop);
+    for (int i = 0; i < mca_btl_tcp_epoll_started; i++) {
+        opal_thread_join(&mca_btl_tcp_epoll_threads[i].thread, &ret);
+    }
+    /* the fragments still queued belong to the free lists, they are released
+     * with them */
+    for (int i = 0; i < mca_btl_tcp_epoll_started; i++) {
+        close(mca_btl_tcp_epoll_threads[i].epoll_fd);
+        OBJ_DESTRUCT(&mca_btl_tcp_epoll_threads[i].thread);
+        OBJ_DESTRUCT(&mca_btl_tcp_epoll_threads[i].recv_done);
+        OBJ_DESTRUCT(&mca_btl_tcp_epoll_threads[i].send_done);
+    }
+    close(mca_btl_tcp_epoll_stop_fd);
+    mca_btl_tcp_epoll_stop_fd = -1;
+    free(mca_btl_tcp_epoll_threads);
+    mca_btl_tcp_epoll_threads = NULL;
+    mca_btl_tcp_epoll_started = 0;
+}
+
+int mca_btl_tcp_epoll_add(mca_btl_base_endpoint_t *endpoint)
+{
+    struct epoll_event event = {.events = MCA_BTL_TCP_EPOLL_EVENTS, .data.ptr = endpoint};
+
+    /* an endpoint keeps its I/O thread across reconnections */
+    if (NULL == endpoint->endpoint_epoll_thread) {
+        uint32_t next = (uint32_t) opal_atomic_fetch_add_32(&mca_btl_tcp_epoll_next, 1);
+        endpoint->endpoint_epoll_thread = mca_btl_tcp_epoll_threads
+                                          + next % (uint32_t) mca_btl_tcp_epoll_nthreads;
+    }
+    if (0 != epoll_ctl(endpoint->endpoint_epoll_thread->epoll_fd, EPOLL_CTL_ADD,
+                       endpoint->endpoint_sd, &event)) {
+        BTL_ERROR(("epoll_ctl(EPOLL_CTL_ADD) failed: %s (%d)", strerror(errno), errno));
+        return OPAL_ERROR;
+    }
+    endpoint->endpoint_epoll = true;
+    return OPAL_SUCCESS;
+}
+
+void mca_btl_tcp_epoll_del(mca_btl_base_endpoint_t *endpoint)
+{
+    struct epoll_event event = {.events = 0, .data.ptr = NULL};
+
+    if (!endpoint->endpoint_epoll) {
+        return;
+    }
+    endpoint->endpoint_epoll = false;
+    if (NULL != mca_btl_tcp_epoll_threads) {
+        (void) epoll_ctl(endpoint->endpoint_epoll_thread->epoll_fd, EPOLL_CTL_DEL,
+                         endpoint->endpoint_sd, &event);
+    }
+}
+
+void mca_btl_tcp_epoll_kick(mca_btl_base_endpoint_t *endpoint)
+{
+    struct epoll_event event = {.events = MCA_BTL_TCP_EPOLL_EVENTS, .data.ptr = endpoint};
+
+    /* modifying the registration reports the socket again if it is ready,
+     * otherwise its next edge will */
+    (void) epoll_ctl(endpoint->endpoint_epoll_thread->epoll_fd, EPOLL_CTL_MOD,
+                     endpoint->endpoint_sd, &event);
+}
+
+int mca_btl_tcp_epoll_progress(void)
+{
+    mca_btl_tcp_frag_t *frag;
+    int count = 0;
+
+    for (int i = 0; i < mca_btl_tcp_epoll_nthreads; i++) {
+        mca_btl_tcp_epoll_thread_t *thread = mca_btl_tcp_epoll_threads + i;
+
+        while (NULL != (frag = (mca_btl_tcp_frag_t *) opal_fifo_pop_atomic(&thread->send_done))) {
+            int btl_ownership = (frag->base.des_flags & MCA_BTL_DES_FLAGS_BTL_OWNERSHIP);
+
+            if (NULL != frag->base.des_cbfunc) {
+                frag->base.des_cbfunc(&frag->btl->super, frag->endpoint, &frag->base, frag->rc);
+            }
+            if (btl_ownership) {
+                MCA_BTL_TCP_FRAG_RETURN(frag);
+            }
+            count++;
+        }
+        while (NULL != (frag = (mca_btl_tcp_frag_t *) opal_fifo_pop_atomic(&thread->recv_done))) {
+            mca_btl_tcp_endpoint_recv_complete(frag);
+            MCA_BTL_TCP_FRAG_RETURN(frag);
+            count++;
+        }
+    }
+    return count;
+}
+
+#endif /* MCA_BTL_TCP_EPOLL */
@@ -0,0 +1,119 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#ifndef MCA_BTL_TCP_EPOLL_H
+#define MCA_BTL_TCP_EPOLL_H
+
+#include "opal_config.h"
+
+#include "opal/class/opal_fifo.h"
+#include "opal/mca/threads/threads.h"
+#include "opal/runtime/opal_progress.h"
+
+/**
+ * Native epoll progress engine.
+ *
+ * With the progress thread enabled, the connected sockets can be taken away
+ * from libevent and handed to a set of I/O threads, each waiting on its own
+ * edge-triggered epoll set. Every connection is owned by a single I/O thread,
+ * chosen round-robin on its first connection, which reads and writes it. The
+ * connection handshake and the listen sockets stay on the libevent progress
+ * thread.
+ *
+ * The fragments completed by an I/O thread are not handed to the upper layer
+ * from the I/O thread: they are queued on lock-free queues of the thread and
+ * their callbacks are triggered by the progress function of the component,
+ * from the threads calling opal_progress.
+ */
+#if defined(HAVE_SYS_EPOLL_H) && defined(HAVE_SYS_EVENTFD_H)
+#    define MCA_BTL_TCP_EPOLL 1
+#else
+#    define MCA_BTL_TCP_EPOLL 0
+#endif
+
+BEGIN_C_DECLS
+
+#if MCA_BTL_TCP_EPOLL
+
+struct mca_btl_base_endpoint_t;
+struct mca_btl_tcp_frag_t;
+
+struct mca_btl_tcp_epoll_thread_t {
+    opal_thread_t thread;
+    int epoll_fd;          /**< epoll set of the connections owned by the thread */
+    opal_fifo_t recv_done; /**< received fragments waiting for their callback */
+    opal_fifo_t send_done; /**< sent fragments waiting for their completion */
+};
+typedef struct mca_btl_tcp_epoll_thread_t mca_btl_tcp_epoll_thread_t;
+
+/**
+ * Number of running I/O threads, 0 when the connections are progressed by
+ * libevent.
+ */
+extern int mca_btl_tcp_epoll_nthreads;
+
+/**
+ * Start the I/O threads. Called once the progress thread is running.
+ */
+int mca_btl_tcp_epoll_init(int nthreads);
+
+/**
+ * Stop the I/O threads. The connections are not progressed anymore, and the
+ * fragments not yet completed are dropped.
+ */
+void mca_btl_tcp_epoll_finalize(void);
+
+/**
+ * Move a newly connected endpoint from libevent to the epoll set of its I/O
+ * thread. Called with the send lock of the endpoint held.
+ */
+int mca_btl_tcp_epoll_add(struct mca_btl_base_endpoint_t *endpoint);
+
+/**
+ * Remove the socket of the endpoint from its epoll set, before closing it.
+ */
+void mca_btl_tcp_epoll_del(struct mca_btl_base_endpoint_t *endpoint);
+
+/**
+ * Notify the I/O thread owning the endpoint that fragments are waiting to be
+ * sent, or that a received fragment is held on the endpoint. Called with the
+ * send or the recv lock of the endpoint held.
+ */
+void mca_btl_tcp_epoll_kick(struct mca_btl_base_endpoint_t *endpoint);
+
+/**
+ * Progress function of the component: trigger the callbacks of the
+ * fragments completed by the I/O threads.
+ */
+int mca_btl_tcp_epoll_progress(void);
+
+/**
+ * Queue a completed fragment for its callback on the MPI side. Called by the
+ * I/O thread owning the endpoint of the fragment, which also cuts short the
+ * back-off of the progress function.
+ */
+static inline void mca_btl_tcp_epoll_recv_done(mca_btl_tcp_epoll_thread_t *thread,
+                                               struct mca_btl_tcp_frag_t *frag)
+{
+    opal_fifo_push_atomic(&thread->recv_done, (opal_list_item_t *) frag);
+    opal_progress_poll_now(mca_btl_tcp_epoll_progress);
+}
+
+static inline void mca_btl_tcp_epoll_send_done(mca_btl_tcp_epoll_thread_t *thread,
+                                               struct mca_btl_tcp_frag_t *frag)
+{
+    opal_fifo_push_atomic(&thread->send_done, (opal_list_item_t *) frag);
+    opal_progress_poll_now(mca_btl_tcp_epoll_progress);
+}
+
+#endif /* MCA_BTL_TCP_EPOLL */
+
+END_C_DECLS
+
+#endif /* MCA_BTL_TCP_EPOLL_H */
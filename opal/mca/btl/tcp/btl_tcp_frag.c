@@ -42,6 +42,12 @@
 #ifdef HAVE_UNISTD_H
 #    include <unistd.h>
 #endif /* HAVE_UNISTD_H */
+#ifdef HAVE_NETINET_IN_H
+#    include <netinet/in.h>
+#endif
+#ifdef HAVE_LINUX_ERRQUEUE_H
+#    include <linux/errqueue.h>
+#endif
 
 #include "opal/mca/btl/base/btl_base_error.h"
 #include "opal/opal_socket_errno.h"
@@ -56,18 +62,27 @@ static void mca_btl_tcp_frag_eager_constructor(mca_btl_tcp_frag_t *frag)
 {
     frag->size = mca_btl_tcp_module.super.btl_eager_limit;
     frag->my_list = &mca_btl_tcp_component.tcp_frag_eager;
+#if MCA_BTL_TCP_ZEROCOPY
+    frag->zcopy = false;
+#endif
 }
 
 static void mca_btl_tcp_frag_max_constructor(mca_btl_tcp_frag_t *frag)
 {
     frag->size = mca_btl_tcp_module.super.btl_max_send_size;
     frag->my_list = &mca_btl_tcp_component.tcp_frag_max;
+#if MCA_BTL_TCP_ZEROCOPY
+    frag->zcopy = false;
+#endif
 }
 
 static void mca_btl_tcp_frag_user_constructor(mca_btl_tcp_frag_t *frag)
 {
     frag->size = 0;
     frag->my_list = &mca_btl_tcp_component.tcp_frag_user;
+#if MCA_BTL_TCP_ZEROCOPY
+    frag->zcopy = false;
+#endif
 }
 
 OBJ_CLASS_INSTANCE(mca_btl_tcp_frag_t, mca_btl_base_descriptor_t, NULL, NULL);
@@ -156,6 +171,257 @@ bool mca_btl_tcp_frag_send(mca_btl_tcp_frag_t *frag, int sd)
     return (frag->iov_cnt == 0);
 }
 
+/*
+ * Account for cnt bytes written from the fragment. Returns the bytes left
+ * for the fragments following it.
+ */
+static ssize_t mca_btl_tcp_frag_advance(mca_btl_tcp_frag_t *frag, ssize_t cnt)
+{
+    while (0 != frag->iov_cnt) {
+        if (cnt < (ssize_t) frag->iov_ptr->iov_len) {
+            frag->iov_ptr->iov_base = (opal_iov_base_ptr_t)(
+                ((unsigned char *) frag->iov_ptr->iov_base) + cnt);
+            frag->iov_ptr->iov_len -= cnt;
+            return 0;
+        }
+        cnt -= frag->iov_ptr->iov_len;
+        frag->iov_ptr++;
+        frag->iov_idx++;
+        frag->iov_cnt--;
+    }
+    return cnt;
+}
+
+#if MCA_BTL_TCP_ZEROCOPY
+/*
+ * Record the completion of the zero-copy writes [first, last]. The writes
+ * are completed in order, unless the kernel still holds a retransmitted
+ * buffer: the ranges completed after a missing one are kept aside until it
+ * is reported.
+ */
+static void mca_btl_tcp_frag_zcopy_completed(mca_btl_base_endpoint_t *btl_endpoint,
+                                             uint32_t first, uint32_t last)
+{
+    uint32_t end = last + 1, *ahead;
+    int count = btl_endpoint->endpoint_zcopy_ahead_count;
+
+    /* the ids wrap around */
+    if ((int32_t)(end - btl_endpoint->endpoint_zcopy_done) <= 0) {
+        return;
+    }
+    if ((int32_t)(first - btl_endpoint->endpoint_zcopy_done) > 0) {
+        if (count == btl_endpoint->endpoint_zcopy_ahead_size) {
+            int size = 0 < count ? 2 * count : 4;
+
+            ahead = realloc(btl_endpoint->endpoint_zcopy_ahead, 2 * size * sizeof(uint32_t));
+            if (NULL == ahead) {
+                BTL_ERROR(("cannot record the zero-copy writes %u to %u", first, last));
+                return;
+            }
+            btl_endpoint->endpoint_zcopy_ahead = ahead;
+            btl_endpoint->endpoint_zcopy_ahead_size = size;
+        }
+        ahead = btl_endpoint->endpoint_zcopy_ahead + 2 * count;
+        ahead[0] = first;
+        ahead[1] = end;
+        btl_endpoint->endpoint_zcopy_ahead_count = count + 1;
+        return;
+    }
+
+    btl_endpoint->endpoint_zcopy_done = end;
+    /* pick up the ranges that now follow the completed ones */
+    for (int i = 0; i < count;) {
+        ahead = btl_endpoint->endpoint_zcopy_ahead + 2 * i;
+        if ((int32_t)(ahead[0] - btl_endpoint->endpoint_zcopy_done) > 0) {
+            ++i;
+            continue;
+        }
+        if ((int32_t)(ahead[1] - btl_endpoint->endpoint_zcopy_done) > 0) {
+            btl_endpoint->endpoint_zcopy_done = ahead[1];
+        }
+        /* replace the range by the last one and start over, it may extend the completed ones */
+        --count;
+        memcpy(ahead, btl_endpoint->endpoint_zcopy_ahead + 2 * count, 2 * sizeof(uint32_t));
+        i = 0;
+    }
+    btl_endpoint->endpoint_zcopy_ahead_count = count;
+}
+
+/*
+ * Read the zero-copy notifications from the error queue of the socket, and
+ * move the fragments whose zero-copy writes are all completed to the done
+ * list. The kernel numbers the MSG_ZEROCOPY writes of a socket from 0 and
+ * reports ranges of completed writes.
+ */
+static void mca_btl_tcp_frag_zcopy_harvest(mca_btl_base_endpoint_t *btl_endpoint,
+                                           opal_list_t *done)
+{
+    char control[CMSG_SPACE(sizeof(struct sock_extended_err) + sizeof(struct sockaddr_storage))];
+    struct sock_extended_err *serr;
+    struct cmsghdr *cmsg;
+    struct msghdr msg;
+    mca_btl_tcp_frag_t *frag;
+
+    if (opal_list_is_empty(&btl_endpoint->endpoint_zcopy_frags)) {
+        return;
+    }
+    for (;;) {
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if (recvmsg(btl_endpoint->endpoint_sd, &msg, MSG_ERRQUEUE) < 0) {
+            /* EWOULDBLOCK: nothing more to read. Errors on the socket itself are
+             * reported by the next write or read. */
+            break;
+        }
+        for (cmsg = CMSG_FIRSTHDR(&msg); NULL != cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (!(SOL_IP == cmsg->cmsg_level && IP_RECVERR == cmsg->cmsg_type)
+                && !(SOL_IPV6 == cmsg->cmsg_level && IPV6_RECVERR == cmsg->cmsg_type)) {
+                continue;
+            }
+            serr = (struct sock_extended_err *) CMSG_DATA(cmsg);
+            if (SO_EE_ORIGIN_ZEROCOPY != serr->ee_origin || 0 != serr->ee_errno) {
+                continue;
+            }
+            /* the writes in [ee_info, ee_data] are completed */
+            mca_btl_tcp_frag_zcopy_completed(btl_endpoint, serr->ee_info, serr->ee_data);
+        }
+    }
+
+    while (!opal_list_is_empty(&btl_endpoint->endpoint_zcopy_frags)) {
+        frag = (mca_btl_tcp_frag_t *) opal_list_get_first(&btl_endpoint->endpoint_zcopy_frags);
+        /* the ids wrap around */
+        if ((int32_t)(btl_endpoint->endpoint_zcopy_done - frag->zcopy_id) <= 0) {
+            break;
+        }
+        opal_list_remove_first(&btl_endpoint->endpoint_zcopy_frags);
+        frag->zcopy = false;
+        opal_list_append(done, (opal_list_item_t *) frag);
+    }
+}
+#endif /* MCA_BTL_TCP_ZEROCOPY */
+
+/*
+ * Write the current send fragment of the endpoint together with the
+ * fragments queued behind it, up to btl_tcp_send_batch fragments per
+ * syscall, until the socket is full or nothing is left to send. Writes
+ * larger than btl_tcp_zerocopy_threshold use MSG_ZEROCOPY. The fragments
+ * completely written (and released by the kernel for zero-copy writes) are
+ * moved to the done list, for the caller to complete them once it has
+ * released the send lock, which must be held during the call.
+ */
+void mca_btl_tcp_frag_send_batch(mca_btl_base_endpoint_t *btl_endpoint, opal_list_t *done)
+{
+    struct iovec iov[MCA_BTL_TCP_FRAG_BATCH_IOVEC_NUMBER];
+    int batch = mca_btl_tcp_component.tcp_send_batch, flags = 0;
+    mca_btl_tcp_frag_t *frag, *next;
+    struct msghdr msg;
+    size_t length;
+    ssize_t cnt, written;
+    int nfrags;
+#if MCA_BTL_TCP_ZEROCOPY
+    bool zcopy_enobufs = false;
+    uint32_t zcopy_id = 0;
+
+    mca_btl_tcp_frag_zcopy_harvest(btl_endpoint, done);
+#endif /* MCA_BTL_TCP_ZEROCOPY */
+
+    while (NULL != (frag = btl_endpoint->endpoint_send_frag)) {
+        /* gather the fragments to write */
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        length = 0;
+        nfrags = 0;
+        next = (mca_btl_tcp_frag_t *) opal_list_get_first(&btl_endpoint->endpoint_frags);
+        for (;;) {
+            for (uint32_t i = 0; i < frag->iov_cnt; i++) {
+                iov[msg.msg_iovlen++] = frag->iov_ptr[i];
+                length += frag->iov_ptr[i].iov_len;
+            }
+            if (++nfrags >= batch
+                || next == (mca_btl_tcp_frag_t *) opal_list_get_end(&btl_endpoint->endpoint_frags)
+                || msg.msg_iovlen + next->iov_cnt > MCA_BTL_TCP_FRAG_BATCH_IOVEC_NUMBER) {
+                break;
+            }
+            frag = next;
+            next = (mca_btl_tcp_frag_t *) opal_list_get_next((opal_list_item_t *) next);
+        }
+
+#if MCA_BTL_TCP_ZEROCOPY
+        flags = 0;
+        if (btl_endpoint->endpoint_zcopy && !zcopy_enobufs
+            && length >= (size_t) mca_btl_tcp_component.tcp_zcopy_threshold) {
+            flags = MSG_ZEROCOPY;
+        }
+#endif /* MCA_BTL_TCP_ZEROCOPY */
+        cnt = sendmsg(btl_endpoint->endpoint_sd, &msg, flags);
+        if (cnt < 0) {
+            switch (opal_socket_errno) {
+            case EINTR:
+                continue;
+            case EWOULDBLOCK:
+                return;
+#if MCA_BTL_TCP_ZEROCOPY
+            case ENOBUFS:
+                /* out of the memory for pinned pages of the socket, copy instead */
+                if (MSG_ZEROCOPY == flags) {
+                    zcopy_enobufs = true;
+                    continue;
+                }
+#endif /* MCA_BTL_TCP_ZEROCOPY */
+                /* fall through */
+            default:
+                BTL_PEER_ERROR(btl_endpoint->endpoint_proc->proc_opal,
+                               ("mca_btl_tcp_frag_send_batch: sendmsg failed: %s (%d)",
+                                strerror(opal_socket_errno), opal_socket_errno));
+                /* send_lock held by caller */
+                btl_endpoint->endpoint_state = MCA_BTL_TCP_FAILED;
+                mca_btl_tcp_endpoint_close(btl_endpoint);
+                return;
+            }
+        }
+#if MCA_BTL_TCP_ZEROCOPY
+        if (MSG_ZEROCOPY == flags) {
+            zcopy_id = btl_endpoint->endpoint_zcopy_next++;
+        }
+#endif /* MCA_BTL_TCP_ZEROCOPY */
+        OPAL_OUTPUT_VERBOSE((100, opal_btl_base_framework.framework_output,
+                             "%s:%d write %ld bytes of %d frags on socket %d\n", __FILE__, __LINE__,
+                             (long) cnt, nfrags, btl_endpoint->endpoint_sd));
+        written = cnt;
+
+        /* distribute the written bytes over the fragments, in order */
+        while (NULL != (frag = btl_endpoint->endpoint_send_frag)) {
+#if MCA_BTL_TCP_ZEROCOPY
+            if (MSG_ZEROCOPY == flags && 0 < cnt) {
+                frag->zcopy = true;
+                frag->zcopy_id = zcopy_id;
+            }
+#endif /* MCA_BTL_TCP_ZEROCOPY */
+            cnt = mca_btl_tcp_frag_advance(frag, cnt);
+            if (0 != frag->iov_cnt) {
+                break;
+            }
+            btl_endpoint->endpoint_send_frag = (mca_btl_tcp_frag_t *) opal_list_remove_first(
+                &btl_endpoint->endpoint_frags);
+#if MCA_BTL_TCP_ZEROCOPY
+            if (frag->zcopy) {
+                opal_list_append(&btl_endpoint->endpoint_zcopy_frags, (opal_list_item_t *) frag);
+                continue;
+            }
+#endif /* MCA_BTL_TCP_ZEROCOPY */
+            opal_list_append(done, (opal_list_item_t *) frag);
+        }
+        if ((size_t) written < length) {
+            /* short write, the socket is full */
+            break;
+        }
+    }
+#if MCA_BTL_TCP_ZEROCOPY
+    mca_btl_tcp_frag_zcopy_harvest(btl_endpoint, done);
+#endif /* MCA_BTL_TCP_ZEROCOPY */
+}
+
 bool mca_btl_tcp_frag_recv(mca_btl_tcp_frag_t *frag, int sd)
 {
     mca_btl_base_endpoint_t *btl_endpoint = frag->endpoint;
@@ -289,6 +555,7 @@ advance_iov_position:
             }
             break;
         case MCA_BTL_TCP_HDR_TYPE_PUT:
+        case MCA_BTL_TCP_HDR_TYPE_PUT_STRIPE:
             if (frag->iov_idx == 1) {
                 frag->iov[1].iov_base = (IOVBASE_TYPE *) frag->segments;
                 frag->iov[1].iov_len = frag->hdr.count * sizeof(mca_btl_base_segment_t);
@@ -306,6 +573,17 @@ advance_iov_position:
                 goto repeat;
             }
             break;
+        case MCA_BTL_TCP_HDR_TYPE_PUT_ACK:
+            if (frag->iov_idx == 1) {
+                frag->iov[1].iov_base = (IOVBASE_TYPE *) frag->segments;
+                frag->iov[1].iov_len = sizeof(mca_btl_base_segment_t);
+                frag->iov_cnt++;
+                goto repeat;
+            }
+            if (btl_endpoint->endpoint_nbo) {
+                MCA_BTL_BASE_SEGMENT_NTOH(frag->segments[0]);
+            }
+            break;
         case MCA_BTL_TCP_HDR_TYPE_GET:
         default:
             break;
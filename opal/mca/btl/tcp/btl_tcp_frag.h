@@ -24,6 +24,7 @@
 
 #include "opal_config.h"
 
+#include <limits.h>
 #ifdef HAVE_SYS_TYPES_H
 #    include <sys/types.h>
 #endif
@@ -33,6 +34,9 @@
 #ifdef HAVE_NET_UIO_H
 #    include <net/uio.h>
 #endif
+#ifdef HAVE_SYS_SOCKET_H
+#    include <sys/socket.h>
+#endif
 
 #include "btl_tcp.h"
 #include "btl_tcp_hdr.h"
@@ -41,6 +45,19 @@ BEGIN_C_DECLS
 
 #define MCA_BTL_TCP_FRAG_IOVEC_NUMBER 4
 
+/* upper bound of the iovecs gathered by a batched write */
+#if defined(IOV_MAX) && IOV_MAX < 64
+#    define MCA_BTL_TCP_FRAG_BATCH_IOVEC_NUMBER IOV_MAX
+#else
+#    define MCA_BTL_TCP_FRAG_BATCH_IOVEC_NUMBER 64
+#endif
+
+#if defined(HAVE_LINUX_ERRQUEUE_H) && defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY)
+#    define MCA_BTL_TCP_ZEROCOPY 1
+#else
+#    define MCA_BTL_TCP_ZEROCOPY 0
+#endif
+
 /**
  * TCP fragment derived type.
  */
@@ -57,6 +74,10 @@ struct mca_btl_tcp_frag_t {
     size_t size;
     uint16_t next_step;
     int rc;
+#if MCA_BTL_TCP_ZEROCOPY
+    bool zcopy;        /**< some bytes were written with MSG_ZEROCOPY */
+    uint32_t zcopy_id; /**< last zero-copy write carrying bytes of the fragment */
+#endif
     opal_free_list_t *my_list;
     /* fake rdma completion */
     struct {
@@ -121,6 +142,7 @@ OBJ_CLASS_DECLARATION(mca_btl_tcp_frag_user_t);
 
 bool mca_btl_tcp_frag_send(mca_btl_tcp_frag_t *, int sd);
 bool mca_btl_tcp_frag_recv(mca_btl_tcp_frag_t *, int sd);
+void mca_btl_tcp_frag_send_batch(struct mca_btl_base_endpoint_t *btl_endpoint, opal_list_t *done);
 size_t mca_btl_tcp_frag_dump(mca_btl_tcp_frag_t *frag, char *msg, char *buf, size_t length);
 END_C_DECLS
 #endif
@@ -44,6 +44,16 @@ BEGIN_C_DECLS
  * of a FIN message can simply close the socket and mark the endpoint as closed
  * without error, and without answering a FIN message itself.
  */
+#define MCA_BTL_TCP_HDR_TYPE_PUT_STRIPE 5
+#define MCA_BTL_TCP_HDR_TYPE_PUT_ACK    6
+/* A put striped over several connections is cut in pieces. The piece sent on
+ * the connection of the put is a MCA_BTL_TCP_HDR_TYPE_PUT message, the others
+ * are MCA_BTL_TCP_HDR_TYPE_PUT_STRIPE messages carrying a second segment with
+ * a cookie and no data. The target answers each of them once its data is in
+ * place, with a MCA_BTL_TCP_HDR_TYPE_PUT_ACK message holding the cookie in its
+ * only segment: the completion of the put may be notified to the target on the
+ * connection of the put, which is not ordered with the others.
+ */
 
 struct mca_btl_tcp_hdr_t {
     mca_btl_base_header_t base;
@@ -37,5 +37,9 @@ AC_DEFUN([MCA_opal_btl_tcp_CONFIG],[
 #include <netinet/in.h>
 #endif
 		   ])
+    # zero-copy completions are read from the socket error queue (Linux)
+    AC_CHECK_HEADERS([linux/errqueue.h])
+    # native epoll progress engine (Linux)
+    AC_CHECK_HEADERS([sys/epoll.h sys/eventfd.h])
     OPAL_SUMMARY_ADD([Transports], [TCP], [], [$opal_btl_tcp_happy])
 ])dnl
@@ -19,4 +19,13 @@ extern mca_base_framework_t opal_smsc_base_framework;
 int mca_smsc_base_select(void);
 void mca_smsc_base_register_default_params(mca_smsc_component_t *component, int default_priority);
 
+/**
+ * @brief Scatter-gather copy from a peer using the contiguous copy_from function
+ *
+ * Implementation of copy_from_iov for components that can not do better. See smsc.h.
+ */
+int mca_smsc_base_copy_from_iov(mca_smsc_endpoint_t *endpoint, struct iovec *local_iov,
+                                size_t local_count, struct iovec *remote_iov, size_t remote_count,
+                                void *reg_data);
+
 #endif /* OPAL_MCA_SMSC_BASE_BASE_H */
@@ -0,0 +1,50 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "opal_config.h"
+
+#include "opal/mca/smsc/base/base.h"
+#include "opal/mca/smsc/smsc.h"
+#include "opal/util/minmax.h"
+
+int mca_smsc_base_copy_from_iov(mca_smsc_endpoint_t *endpoint, struct iovec *local_iov,
+                                size_t local_count, struct iovec *remote_iov, size_t remote_count,
+                                void *reg_data)
+{
+    size_t local_index = 0, remote_index = 0;
+
+    while (local_index < local_count && remote_index < remote_count) {
+        size_t size = opal_min(local_iov[local_index].iov_len, remote_iov[remote_index].iov_len);
+
+        if (size > 0) {
+            int rc = MCA_SMSC_CALL(copy_from, endpoint, local_iov[local_index].iov_base,
+                                   remote_iov[remote_index].iov_base, size, reg_data);
+            if (OPAL_SUCCESS != rc) {
+                return rc;
+            }
+        }
+
+        /* advance both io vectors past the copied data */
+        local_iov[local_index].iov_base = (void *) ((uintptr_t) local_iov[local_index].iov_base
+                                                    + size);
+        local_iov[local_index].iov_len -= size;
+        remote_iov[remote_index].iov_base = (void *) ((uintptr_t) remote_iov[remote_index].iov_base
+                                                      + size);
+        remote_iov[remote_index].iov_len -= size;
+
+        if (0 == local_iov[local_index].iov_len) {
+            ++local_index;
+        }
+        if (0 == remote_iov[remote_index].iov_len) {
+            ++remote_index;
+        }
+    }
+
+    return OPAL_SUCCESS;
+}
@@ -22,6 +22,9 @@ int mca_smsc_cma_copy_to(mca_smsc_endpoint_t *endpoint, void *local_address, voi
                          size_t size, void *reg_handle);
 int mca_smsc_cma_copy_from(mca_smsc_endpoint_t *endpoint, void *local_address, void *remote_address,
                            size_t size, void *reg_handle);
+int mca_smsc_cma_copy_from_iov(mca_smsc_endpoint_t *endpoint, struct iovec *local_iov,
+                               size_t local_count, struct iovec *remote_iov, size_t remote_count,
+                               void *reg_handle);
 
 /* unsupported interfaces defined to support MCA direct */
 void *mca_smsc_cma_map_peer_region(mca_smsc_endpoint_t *endpoint, uint64_t flags,
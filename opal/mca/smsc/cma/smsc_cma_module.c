@@ -20,6 +20,9 @@
 #include "opal/mca/pmix/pmix-internal.h"
 #include "opal/mca/smsc/base/base.h"
 #include "opal/mca/smsc/cma/smsc_cma_internal.h"
+#include "opal/util/minmax.h"
+
+#include <limits.h>
 
 #if HAVE_LINUX_KCMP_H
 #    include <linux/kcmp.h>       /* kcmp: Definition of KCMP_* constants */
@@ -213,6 +216,69 @@ int mca_smsc_cma_copy_from(mca_smsc_endpoint_t *endpoint, void *local_address, v
     return OPAL_SUCCESS;
 }
 
+/* skip the first {length} bytes of an io vector. returns the index of the first entry that still
+ * holds data */
+static size_t mca_smsc_cma_iov_skip(struct iovec *iov, size_t index, size_t count, size_t length)
+{
+    for (; index < count; ++index) {
+        if (iov[index].iov_len > length) {
+            mca_smsc_cma_iov_advance(iov + index, length);
+            break;
+        }
+        length -= iov[index].iov_len;
+    }
+
+    return index;
+}
+
+int mca_smsc_cma_copy_from_iov(mca_smsc_endpoint_t *endpoint, struct iovec *local_iov,
+                               size_t local_count, struct iovec *remote_iov, size_t remote_count,
+                               void *reg_handle)
+{
+    /* ignore the registration handle as it is not used for CMA */
+    (void) reg_handle;
+
+    mca_smsc_cma_endpoint_t *cma_endpoint = (mca_smsc_cma_endpoint_t *) endpoint;
+    size_t local_index = 0, remote_index = 0;
+
+    /* the kernel scatters and gathers at most IOV_MAX entries on each side per call and may
+     * stop at any iovec boundary (see mca_smsc_cma_copy_from) */
+    while (local_index < local_count && remote_index < remote_count) {
+        unsigned long local_iovcnt = opal_min(local_count - local_index, IOV_MAX);
+        unsigned long remote_iovcnt = opal_min(remote_count - remote_index, IOV_MAX);
+        ssize_t ret;
+
+        ret = process_vm_readv(cma_endpoint->pid, local_iov + local_index, local_iovcnt,
+                               remote_iov + remote_index, remote_iovcnt, 0);
+        if (0 > ret) {
+            OPAL_OUTPUT_VERBOSE((MCA_BASE_VERBOSE_ERROR, opal_smsc_base_framework.framework_output,
+                                 "CMA vector read failed, errno = %d", errno));
+            return OPAL_ERROR;
+        }
+
+        if (0 == ret) {
+            /* only zero-length entries at the front of one of the batches */
+            size_t prev_local = local_index, prev_remote = remote_index;
+
+            while (local_index < local_count && 0 == local_iov[local_index].iov_len) {
+                ++local_index;
+            }
+            while (remote_index < remote_count && 0 == remote_iov[remote_index].iov_len) {
+                ++remote_index;
+            }
+            if (prev_local == local_index && prev_remote == remote_index) {
+                return OPAL_ERROR;
+            }
+            continue;
+        }
+
+        local_index = mca_smsc_cma_iov_skip(local_iov, local_index, local_count, (size_t) ret);
+        remote_index = mca_smsc_cma_iov_skip(remote_iov, remote_index, remote_count, (size_t) ret);
+    }
+
+    return OPAL_SUCCESS;
+}
+
 /* unsupported interfaces defined to support MCA direct */
 void *mca_smsc_cma_map_peer_region(mca_smsc_endpoint_t *endpoint, uint64_t flags,
                                    void *remote_address, size_t size, void **local_mapping)
@@ -238,4 +304,5 @@ mca_smsc_module_t mca_smsc_cma_module = {
     .return_endpoint = mca_smsc_cma_return_endpoint,
     .copy_to = mca_smsc_cma_copy_to,
     .copy_from = mca_smsc_cma_copy_from,
+    .copy_from_iov = mca_smsc_cma_copy_from_iov,
 };
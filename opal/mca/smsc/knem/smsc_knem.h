@@ -22,6 +22,9 @@ int mca_smsc_knem_copy_to(mca_smsc_endpoint_t *endpoint, void *local_address, vo
                           size_t size, void *reg_data);
 int mca_smsc_knem_copy_from(mca_smsc_endpoint_t *endpoint, void *local_address,
                             void *remote_address, size_t size, void *reg_data);
+int mca_smsc_knem_copy_from_iov(mca_smsc_endpoint_t *endpoint, struct iovec *local_iov,
+                                size_t local_count, struct iovec *remote_iov, size_t remote_count,
+                                void *reg_data);
 
 void *mca_smsc_knem_register_region(void *local_address, size_t size);
 void mca_smsc_knem_deregister_region(void *reg_data);
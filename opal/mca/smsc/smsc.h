@@ -24,6 +24,10 @@
 #include "opal/class/opal_object.h"
 #include "opal/util/proc.h"
 
+#ifdef HAVE_SYS_UIO_H
+#    include <sys/uio.h>
+#endif
+
 #define MCA_SMSC_BASE_MAJOR_VERSION 1
 #define MCA_SMSC_BASE_MINOR_VERSION 0
 #define MCA_SMSC_BASE_PATCH_VERSION 0
@@ -74,6 +78,24 @@ typedef void (*mca_smsc_module_return_endpoint_fn_t)(mca_smsc_endpoint_t *endpoi
 typedef int (*mca_smsc_module_copy_fn_t)(mca_smsc_endpoint_t *endpoint, void *local_address,
                                          void *remote_address, size_t size, void *reg_data);
 
+/**
+ * @brief Scatter-gather copy from a peer process.
+ *
+ * @param(in) endpoint      shared-memory single-copy endpoint
+ * @param(in) local_iov     local regions to copy to
+ * @param(in) local_count   number of local regions
+ * @param(in) remote_iov    remote regions to copy from
+ * @param(in) remote_count  number of remote regions
+ * @param(in) reg_data      pointer to memory containing registration data (if required)
+ *
+ * Both io vectors must describe the same number of bytes. The boundaries of the local and
+ * remote regions do not need to match. The io vectors may be modified by this call.
+ */
+typedef int (*mca_smsc_module_copy_iov_fn_t)(mca_smsc_endpoint_t *endpoint,
+                                             struct iovec *local_iov, size_t local_count,
+                                             struct iovec *remote_iov, size_t remote_count,
+                                             void *reg_data);
+
 /**
  * @brief Map a peer's memory onto local memory.
  *
@@ -156,6 +178,8 @@ struct mca_smsc_module_t {
     mca_smsc_module_copy_fn_t copy_to;
     /** Copy data from a peer's memory space. */
     mca_smsc_module_copy_fn_t copy_from;
+    /** Copy non-contiguous data from a peer's memory space. */
+    mca_smsc_module_copy_iov_fn_t copy_from_iov;
 
     /* Defined if MCA_SMSC_FEATURE_CAN_MAP is set. */
     /** Map a peer memory region into this processes address space. The module is allowed to cache
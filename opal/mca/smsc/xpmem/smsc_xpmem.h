@@ -24,6 +24,10 @@ int mca_smsc_xpmem_copy_to(mca_smsc_endpoint_t *endpoint, void *local_address, v
 int mca_smsc_xpmem_copy_from(mca_smsc_endpoint_t *endpoint, void *local_address,
                              void *remote_address, size_t size, void *reg_handle);
 
+int mca_smsc_xpmem_copy_from_iov(mca_smsc_endpoint_t *endpoint, struct iovec *local_iov,
+                                 size_t local_count, struct iovec *remote_iov, size_t remote_count,
+                                 void *reg_handle);
+
 /**
  * @brief Map a peer memory region into this processes address space.
  *
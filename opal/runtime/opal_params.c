@@ -77,6 +77,20 @@ int opal_register_params(void)
                                 &opal_progress_yield_when_idle);
 #endif
 
+    opal_progress_max_backoff = 0;
+    ret = mca_base_var_register("opal", "opal", "progress", "max_backoff",
+                                "Maximum number of calls to the progress engine a progress "
+                                "callback reporting no events is skipped for. The number of "
+                                "skipped calls doubles each time the callback is found idle and "
+                                "is reset when it reports events (0 = poll every callback on "
+                                "every call)",
+                                MCA_BASE_VAR_TYPE_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                OPAL_INFO_LVL_8, MCA_BASE_VAR_SCOPE_LOCAL,
+                                &opal_progress_max_backoff);
+    if (0 > ret) {
+        return ret;
+    }
+
 #if OPAL_ENABLE_DEBUG
     opal_progress_debug = false;
     ret = mca_base_var_register("opal", "opal", "progress", "debug",
@@ -27,7 +27,14 @@
 
 #include "opal_config.h"
 
+#include <stdio.h>
+#include <string.h>
+#ifdef HAVE_DLFCN_H
+#    include <dlfcn.h>
+#endif
+
 #include "opal/constants.h"
+#include "opal/mca/base/mca_base_pvar.h"
 #include "opal/mca/base/mca_base_var.h"
 #include "opal/mca/threads/threads.h"
 #include "opal/mca/timer/base/base.h"
@@ -36,6 +43,7 @@
 #include "opal/runtime/opal_progress.h"
 #include "opal/util/event.h"
 #include "opal/util/output.h"
+#include "opal/util/printf.h"
 
 #define OPAL_PROGRESS_USE_TIMERS       (OPAL_TIMER_CYCLE_SUPPORTED || OPAL_TIMER_USEC_SUPPORTED)
 #define OPAL_PROGRESS_ONLY_USEC_NATIVE (OPAL_TIMER_USEC_NATIVE && !OPAL_TIMER_CYCLE_NATIVE)
@@ -44,29 +52,65 @@
 bool opal_progress_debug = false;
 #endif
 
+/* number of callbacks reported by the progress pvars */
+#define OPAL_PROGRESS_PVAR_COUNT 32
+
 /*
  * default parameters
  */
 static int opal_progress_event_flag = OPAL_EVLOOP_ONCE | OPAL_EVLOOP_NONBLOCK;
 int opal_progress_spin_count = 10000;
+int opal_progress_max_backoff = 0;
 
 /*
  * Local variables
  */
 static opal_atomic_lock_t progress_lock;
 
+/**
+ * Scheduling state of a progress callback. An entry is created the first
+ * time a callback is registered and is kept, with its statistics, until
+ * the progress engine is finalized. The counters are updated without
+ * atomics by the threads calling opal_progress(), they are only loosely
+ * accurate when several threads progress concurrently.
+ */
+typedef struct opal_progress_entry_t {
+    opal_progress_callback_t cb;
+    int32_t skip;      /**< calls to opal_progress left before the next poll */
+    int32_t interval;  /**< current back-off of an idle callback */
+    opal_atomic_int32_t poll_now; /**< set by opal_progress_poll_now(), cleared by the poll */
+    uint64_t calls;    /**< polls of the callback */
+    uint64_t events;   /**< events reported by the callback */
+    opal_timer_t time; /**< time spent in the callback */
+    char name[64];     /**< symbol of the callback, or its address */
+    struct opal_progress_entry_t *next;
+} opal_progress_entry_t;
+
+/* all the entries ever registered, in registration order */
+static opal_progress_entry_t *entries = NULL;
+static opal_progress_entry_t **entries_tail = &entries;
+
 /* callbacks to progress */
-static volatile opal_progress_callback_t *callbacks = NULL;
+static opal_progress_entry_t *volatile *callbacks = NULL;
 static size_t callbacks_len = 0;
 static size_t callbacks_size = 0;
 
-static volatile opal_progress_callback_t *callbacks_lp = NULL;
+static opal_progress_entry_t *volatile *callbacks_lp = NULL;
 static size_t callbacks_lp_len = 0;
 static size_t callbacks_lp_size = 0;
 
+/* started pvar handles: the callbacks are counted and timed while there
+ * is at least one */
+static opal_atomic_int32_t progress_pvar_users = 0;
+
 /* do we want to yield() if nothing happened */
 bool opal_progress_yield_when_idle = false;
 
+/* calls to opal_progress(), loosely counted */
+static uint32_t num_calls = 0;
+/* consecutive calls to opal_progress() without events, loosely counted */
+static uint32_t idle_calls = 0;
+
 #if OPAL_PROGRESS_USE_TIMERS
 static opal_timer_t event_progress_last_time = 0;
 static opal_timer_t event_progress_delta = 0;
@@ -97,12 +141,16 @@ static int fake_cb(void)
     return 0;
 }
 
+static opal_progress_entry_t fake_entry = {.cb = fake_cb};
+
 static int _opal_progress_unregister(opal_progress_callback_t cb,
-                                     volatile opal_progress_callback_t *callback_array,
+                                     opal_progress_entry_t *volatile *callback_array,
                                      size_t *callback_array_len);
 
 static void opal_progress_finalize(void)
 {
+    opal_progress_entry_t *entry;
+
     /* free memory associated with the callbacks */
     opal_atomic_lock(&progress_lock);
 
@@ -116,9 +164,229 @@ static void opal_progress_finalize(void)
     free((void *) callbacks_lp);
     callbacks_lp = NULL;
 
+    while (NULL != (entry = entries)) {
+        entries = entry->next;
+        free(entry);
+    }
+    entries_tail = &entries;
+
     opal_atomic_unlock(&progress_lock);
 }
 
+static int opal_progress_pvar_notify(mca_base_pvar_t *pvar, mca_base_pvar_event_t event,
+                                     void *obj, int *count)
+{
+    (void) pvar;
+    (void) obj;
+
+    switch (event) {
+    case MCA_BASE_PVAR_HANDLE_BIND:
+        *count = OPAL_PROGRESS_PVAR_COUNT;
+        break;
+    case MCA_BASE_PVAR_HANDLE_START:
+        (void) opal_atomic_add_fetch_32(&progress_pvar_users, 1);
+        break;
+    case MCA_BASE_PVAR_HANDLE_STOP:
+        (void) opal_atomic_sub_fetch_32(&progress_pvar_users, 1);
+        break;
+    default:
+        break;
+    }
+
+    return OPAL_SUCCESS;
+}
+
+/* the values are reported per callback, in registration order */
+static int opal_progress_pvar_get(const mca_base_pvar_t *pvar, void *value, void *obj)
+{
+    unsigned long long *values = (unsigned long long *) value;
+    opal_progress_entry_t *entry = entries;
+    uintptr_t which = (uintptr_t) pvar->ctx;
+
+    (void) obj;
+
+    if (3 == which) {
+        /* the index of each callback, named by the enumerator */
+        int *states = (int *) value;
+
+        for (int i = 0; i < OPAL_PROGRESS_PVAR_COUNT; ++i) {
+            states[i] = (NULL != entry) ? i : -1;
+            entry = (NULL != entry) ? entry->next : NULL;
+        }
+        return OPAL_SUCCESS;
+    }
+
+    for (int i = 0; i < OPAL_PROGRESS_PVAR_COUNT; ++i) {
+        if (NULL == entry) {
+            values[i] = 0;
+            continue;
+        }
+        if (0 == which) {
+            values[i] = entry->calls;
+        } else if (1 == which) {
+            values[i] = entry->events;
+        } else {
+#if OPAL_PROGRESS_USE_TIMERS && !OPAL_PROGRESS_ONLY_USEC_NATIVE
+            /* cycles to microseconds */
+            values[i] = (unsigned long long) ((double) entry->time * 1000000.0
+                                              / (double) opal_timer_base_get_freq());
+#else
+            values[i] = entry->time;
+#endif
+        }
+        entry = entry->next;
+    }
+
+    return OPAL_SUCCESS;
+}
+
+/*
+ * Enumerator of the callbacks reported by the pvars: the value of a
+ * callback is its index in the pvar arrays, its string the name of the
+ * function.
+ */
+static opal_progress_entry_t *opal_progress_entry_at(int index)
+{
+    opal_progress_entry_t *entry = entries;
+
+    if (index < 0 || index >= OPAL_PROGRESS_PVAR_COUNT) {
+        return NULL;
+    }
+    for (int i = 0; i < index && NULL != entry; ++i) {
+        entry = entry->next;
+    }
+    return entry;
+}
+
+static int opal_progress_enum_get_count(mca_base_var_enum_t *self, int *count)
+{
+    *count = 0;
+    for (opal_progress_entry_t *entry = entries;
+         NULL != entry && *count < OPAL_PROGRESS_PVAR_COUNT; entry = entry->next) {
+        ++*count;
+    }
+    return OPAL_SUCCESS;
+}
+
+static int opal_progress_enum_get_value(mca_base_var_enum_t *self, int index, int *value,
+                                        const char **string_value)
+{
+    opal_progress_entry_t *entry = opal_progress_entry_at(index);
+
+    if (NULL == entry) {
+        return OPAL_ERR_VALUE_OUT_OF_BOUNDS;
+    }
+    *value = index;
+    *string_value = entry->name;
+    return OPAL_SUCCESS;
+}
+
+static int opal_progress_enum_vfs(mca_base_var_enum_t *self, const char *string_value, int *value)
+{
+    int i = 0;
+
+    for (opal_progress_entry_t *entry = entries; NULL != entry && i < OPAL_PROGRESS_PVAR_COUNT;
+         entry = entry->next, ++i) {
+        if (0 == strcmp(entry->name, string_value)) {
+            *value = i;
+            return OPAL_SUCCESS;
+        }
+    }
+    return OPAL_ERR_VALUE_OUT_OF_BOUNDS;
+}
+
+static int opal_progress_enum_sfv(mca_base_var_enum_t *self, const int value, char **string_value)
+{
+    opal_progress_entry_t *entry = opal_progress_entry_at(value);
+
+    if (NULL == entry) {
+        return OPAL_ERR_VALUE_OUT_OF_BOUNDS;
+    }
+    if (string_value) {
+        *string_value = strdup(entry->name);
+    }
+    return OPAL_SUCCESS;
+}
+
+static int opal_progress_enum_dump(mca_base_var_enum_t *self, char **out)
+{
+    char *tmp;
+    int i = 0;
+
+    *out = strdup("");
+    for (opal_progress_entry_t *entry = entries;
+         NULL != *out && NULL != entry && i < OPAL_PROGRESS_PVAR_COUNT; entry = entry->next, ++i) {
+        if (0 > opal_asprintf(&tmp, "%s%s%d: %s", *out, i ? ", " : "", i, entry->name)) {
+            tmp = NULL;
+        }
+        free(*out);
+        *out = tmp;
+    }
+    return *out ? OPAL_SUCCESS : OPAL_ERR_OUT_OF_RESOURCE;
+}
+
+static mca_base_var_enum_t opal_progress_callback_enum
+    = {.super = OPAL_OBJ_STATIC_INIT(opal_object_t),
+       .enum_is_static = true,
+       .enum_name = "progress_callbacks",
+       .get_count = opal_progress_enum_get_count,
+       .get_value = opal_progress_enum_get_value,
+       .value_from_string = opal_progress_enum_vfs,
+       .string_from_value = opal_progress_enum_sfv,
+       .dump = opal_progress_enum_dump};
+
+static void opal_progress_entry_set_name(opal_progress_entry_t *entry)
+{
+#if defined(HAVE_DLFCN_H) && defined(HAVE_DLADDR)
+    Dl_info info;
+
+    if (0 != dladdr(*(void **) &entry->cb, &info) && NULL != info.dli_sname) {
+        snprintf(entry->name, sizeof(entry->name), "%s", info.dli_sname);
+        return;
+    }
+#endif
+    snprintf(entry->name, sizeof(entry->name), "%p", *(void **) &entry->cb);
+}
+
+static void opal_progress_register_pvars(void)
+{
+    (void) mca_base_pvar_register("opal", "opal", "progress", "callback_names",
+                                  "Index of each progress callback in the other progress "
+                                  "variables, in registration order (-1 for none). The "
+                                  "enumerator of the variable gives the name of the callbacks",
+                                  OPAL_INFO_LVL_5, MCA_BASE_PVAR_CLASS_STATE,
+                                  MCA_BASE_VAR_TYPE_INT, &opal_progress_callback_enum,
+                                  MCA_BASE_VAR_BIND_NO_OBJECT, MCA_BASE_PVAR_FLAG_READONLY,
+                                  opal_progress_pvar_get, NULL, opal_progress_pvar_notify,
+                                  (void *) (uintptr_t) 3);
+    (void) mca_base_pvar_register("opal", "opal", "progress", "callback_calls",
+                                  "Number of times each progress callback was polled, in "
+                                  "registration order",
+                                  OPAL_INFO_LVL_5, MCA_BASE_PVAR_CLASS_COUNTER,
+                                  MCA_BASE_VAR_TYPE_UNSIGNED_LONG_LONG, NULL,
+                                  MCA_BASE_VAR_BIND_NO_OBJECT, MCA_BASE_PVAR_FLAG_READONLY,
+                                  opal_progress_pvar_get, NULL, opal_progress_pvar_notify,
+                                  (void *) (uintptr_t) 0);
+    (void) mca_base_pvar_register("opal", "opal", "progress", "callback_events",
+                                  "Number of events reported by each progress callback, in "
+                                  "registration order",
+                                  OPAL_INFO_LVL_5, MCA_BASE_PVAR_CLASS_COUNTER,
+                                  MCA_BASE_VAR_TYPE_UNSIGNED_LONG_LONG, NULL,
+                                  MCA_BASE_VAR_BIND_NO_OBJECT, MCA_BASE_PVAR_FLAG_READONLY,
+                                  opal_progress_pvar_get, NULL, opal_progress_pvar_notify,
+                                  (void *) (uintptr_t) 1);
+#if OPAL_PROGRESS_USE_TIMERS
+    (void) mca_base_pvar_register("opal", "opal", "progress", "callback_time",
+                                  "Time spent in each progress callback in microseconds, in "
+                                  "registration order",
+                                  OPAL_INFO_LVL_5, MCA_BASE_PVAR_CLASS_TIMER,
+                                  MCA_BASE_VAR_TYPE_UNSIGNED_LONG_LONG, NULL,
+                                  MCA_BASE_VAR_BIND_NO_OBJECT, MCA_BASE_PVAR_FLAG_READONLY,
+                                  opal_progress_pvar_get, NULL, opal_progress_pvar_notify,
+                                  (void *) (uintptr_t) 2);
+#endif
+}
+
 /* init the progress engine - called from orte_init */
 int opal_progress_init(void)
 {
@@ -148,11 +416,11 @@ int opal_progress_init(void)
     }
 
     for (size_t i = 0; i < callbacks_size; ++i) {
-        callbacks[i] = fake_cb;
+        callbacks[i] = &fake_entry;
     }
 
     for (size_t i = 0; i < callbacks_lp_size; ++i) {
-        callbacks_lp[i] = fake_cb;
+        callbacks_lp[i] = &fake_entry;
     }
 
     OPAL_OUTPUT(
@@ -162,6 +430,10 @@ int opal_progress_init(void)
     OPAL_OUTPUT((debug_output, "progress: initialized num users to: %d", num_event_users));
     OPAL_OUTPUT(
         (debug_output, "progress: initialized poll rate to: %ld", (long) event_progress_delta));
+    OPAL_OUTPUT((debug_output, "progress: initialized max backoff to: %d",
+                 opal_progress_max_backoff));
+
+    opal_progress_register_pvars();
 
     opal_finalize_register_cleanup(opal_progress_finalize);
 
@@ -202,6 +474,62 @@ static int opal_progress_events(void)
     return events;
 }
 
+static inline opal_timer_t opal_progress_time(void)
+{
+#if OPAL_PROGRESS_ONLY_USEC_NATIVE
+    return opal_timer_base_get_usec();
+#elif OPAL_PROGRESS_USE_TIMERS
+    return opal_timer_base_get_cycles();
+#else
+    return 0;
+#endif
+}
+
+/*
+ * Poll a callback unless it is backing off. An idle callback is skipped
+ * for twice as many calls each time it reports nothing, up to
+ * opal_progress_max_backoff calls, and goes back to being polled on every
+ * call as soon as it reports events or opal_progress_poll_now() is called
+ * for it.
+ */
+static inline int opal_progress_call(opal_progress_entry_t *entry, bool timed)
+{
+    opal_timer_t start = 0;
+    int events;
+
+    if (entry->poll_now) {
+        /* cleared before the poll, so that a request made while the callback
+         * runs is kept for the next call */
+        (void) opal_atomic_swap_32(&entry->poll_now, 0);
+        entry->interval = 0;
+    } else if (entry->skip > 0) {
+        --entry->skip;
+        return 0;
+    }
+
+    if (timed) {
+        start = opal_progress_time();
+    }
+    events = entry->cb();
+    if (timed) {
+        entry->time += opal_progress_time() - start;
+    }
+
+    ++entry->calls;
+    if (events > 0) {
+        entry->events += events;
+        entry->interval = 0;
+    } else if (opal_progress_max_backoff > 0) {
+        entry->interval = (0 == entry->interval) ? 1 : 2 * entry->interval;
+        if (entry->interval > opal_progress_max_backoff) {
+            entry->interval = opal_progress_max_backoff;
+        }
+        entry->skip = entry->interval;
+    }
+
+    return events;
+}
+
 /*
  * Progress the event library and any functions that have registered to
  * be called.  We don't propagate errors from the progress functions,
@@ -215,13 +543,21 @@ static int opal_progress_events(void)
  */
 int opal_progress(void)
 {
-    static uint32_t num_calls = 0;
+    bool tracked = opal_progress_max_backoff > 0 || progress_pvar_users > 0;
+    bool timed = OPAL_PROGRESS_USE_TIMERS && progress_pvar_users > 0;
     size_t i;
     int events = 0;
 
-    /* progress all registered callbacks */
-    for (i = 0; i < callbacks_len; ++i) {
-        events += (callbacks[i])();
+    /* progress all registered callbacks. Without back-off and statistics
+     * the callbacks are simply called in turn. */
+    if (OPAL_LIKELY(!tracked)) {
+        for (i = 0; i < callbacks_len; ++i) {
+            events += callbacks[i]->cb();
+        }
+    } else {
+        for (i = 0; i < callbacks_len; ++i) {
+            events += opal_progress_call(callbacks[i], timed);
+        }
     }
 
     /* Run low priority callbacks and events once every 8 calls to opal_progress().
@@ -232,7 +568,7 @@ int opal_progress(void)
      */
     if (((num_calls++) & 0x7) == 0) {
         for (i = 0; i < callbacks_lp_len; ++i) {
-            events += (callbacks_lp[i])();
+            events += tracked ? opal_progress_call(callbacks_lp[i], timed) : callbacks_lp[i]->cb();
         }
 
         opal_progress_events();
@@ -240,6 +576,12 @@ int opal_progress(void)
         opal_progress_events();
     }
 
+    if (events > 0) {
+        idle_calls = 0;
+    } else {
+        ++idle_calls;
+    }
+
     if (opal_progress_yield_when_idle && events <= 0) {
         /* If there is nothing to do - yield the processor - otherwise
          * we could consume the processor for the entire time slice. If
@@ -254,6 +596,16 @@ int opal_progress(void)
     return events;
 }
 
+uint32_t opal_progress_num_calls(void)
+{
+    return num_calls;
+}
+
+uint32_t opal_progress_idle_calls(void)
+{
+    return idle_calls;
+}
+
 int opal_progress_set_event_flag(int flag)
 {
     int tmp = opal_progress_event_flag;
@@ -354,10 +706,10 @@ void opal_progress_set_event_poll_rate(int polltime)
 }
 
 static int opal_progress_find_cb(opal_progress_callback_t cb,
-                                 volatile opal_progress_callback_t *cbs, size_t cbs_len)
+                                 opal_progress_entry_t *volatile *cbs, size_t cbs_len)
 {
     for (size_t i = 0; i < cbs_len; ++i) {
-        if (cbs[i] == cb) {
+        if (cbs[i]->cb == cb) {
             return (int) i;
         }
     }
@@ -365,21 +717,48 @@ static int opal_progress_find_cb(opal_progress_callback_t cb,
     return OPAL_ERR_NOT_FOUND;
 }
 
+static opal_progress_entry_t *opal_progress_find_entry(opal_progress_callback_t cb)
+{
+    for (opal_progress_entry_t *entry = entries; NULL != entry; entry = entry->next) {
+        if (entry->cb == cb) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
 static int _opal_progress_register(opal_progress_callback_t cb,
-                                   volatile opal_progress_callback_t **cbs, size_t *cbs_size,
+                                   opal_progress_entry_t *volatile **cbs, size_t *cbs_size,
                                    size_t *cbs_len)
 {
+    opal_progress_entry_t *entry;
     int ret = OPAL_SUCCESS;
 
     if (OPAL_ERR_NOT_FOUND != opal_progress_find_cb(cb, *cbs, *cbs_len)) {
         return OPAL_SUCCESS;
     }
 
+    /* a callback registered again keeps its statistics */
+    entry = opal_progress_find_entry(cb);
+    if (NULL == entry) {
+        entry = (opal_progress_entry_t *) calloc(1, sizeof(*entry));
+        if (NULL == entry) {
+            return OPAL_ERR_TEMP_OUT_OF_RESOURCE;
+        }
+        entry->cb = cb;
+        opal_progress_entry_set_name(entry);
+        opal_atomic_wmb();
+        *entries_tail = entry;
+        entries_tail = &entry->next;
+    }
+    entry->skip = entry->interval = 0;
+
     /* see if we need to allocate more space */
     if (*cbs_len + 1 > *cbs_size) {
-        opal_progress_callback_t *tmp, *old;
+        opal_progress_entry_t **tmp, **old;
 
-        tmp = (opal_progress_callback_t *) malloc(sizeof(tmp[0]) * 2 * *cbs_size);
+        tmp = (opal_progress_entry_t **) malloc(sizeof(tmp[0]) * 2 * *cbs_size);
         if (tmp == NULL) {
             return OPAL_ERR_TEMP_OUT_OF_RESOURCE;
         }
@@ -390,14 +769,14 @@ static int _opal_progress_register(opal_progress_callback_t cb,
         }
 
         for (size_t i = *cbs_len; i < 2 * *cbs_size; ++i) {
-            tmp[i] = fake_cb;
+            tmp[i] = &fake_entry;
         }
 
         opal_atomic_wmb();
 
         /* swap out callback array */
-        old = (opal_progress_callback_t *) opal_atomic_swap_ptr((opal_atomic_intptr_t *) cbs,
-                                                                (intptr_t) tmp);
+        old = (opal_progress_entry_t **) opal_atomic_swap_ptr((opal_atomic_intptr_t *) cbs,
+                                                              (intptr_t) tmp);
 
         opal_atomic_wmb();
 
@@ -405,7 +784,7 @@ static int _opal_progress_register(opal_progress_callback_t cb,
         *cbs_size *= 2;
     }
 
-    cbs[0][*cbs_len] = cb;
+    cbs[0][*cbs_len] = entry;
     ++*cbs_len;
 
     opal_atomic_wmb();
@@ -444,7 +823,7 @@ int opal_progress_register_lp(opal_progress_callback_t cb)
 }
 
 static int _opal_progress_unregister(opal_progress_callback_t cb,
-                                     volatile opal_progress_callback_t *callback_array,
+                                     opal_progress_entry_t *volatile *callback_array,
                                      size_t *callback_array_len)
 {
     int ret = opal_progress_find_cb(cb, callback_array, *callback_array_len);
@@ -464,7 +843,7 @@ static int _opal_progress_unregister(opal_progress_callback_t cb,
     }
 
     --*callback_array_len;
-    callback_array[*callback_array_len] = fake_cb;
+    callback_array[*callback_array_len] = &fake_entry;
 
     return OPAL_SUCCESS;
 }
@@ -487,3 +866,16 @@ int opal_progress_unregister(opal_progress_callback_t cb)
 
     return ret;
 }
+
+void opal_progress_poll_now(opal_progress_callback_t cb)
+{
+    /* the entries are never removed before finalize, the list can be
+     * walked without the lock */
+    opal_progress_entry_t *entry = opal_progress_find_entry(cb);
+
+    /* the back-off state belongs to the threads calling opal_progress(),
+     * only the flag is written here */
+    if (NULL != entry) {
+        entry->poll_now = 1;
+    }
+}
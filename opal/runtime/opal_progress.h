@@ -58,10 +58,33 @@ OPAL_DECLSPEC int opal_progress_init(void);
  * into the event library is greater than the progress tick rate (by
  * default, 10ms).
  *
+ * When opal_progress_max_backoff is set, a callback reporting no events is
+ * skipped for an exponentially growing number of calls (up to
+ * opal_progress_max_backoff), and is polled on every call again as soon as
+ * it reports events or opal_progress_poll_now() is called for it.
+ *
  * Returns 0 if no progress has been observed, non-zero otherwise.
  */
 OPAL_DECLSPEC int opal_progress(void);
 
+/**
+ * Number of calls to opal_progress()
+ *
+ * The count is not maintained atomically and wraps around, it is only
+ * meant to tell whether some thread called opal_progress() since a
+ * previous reading.
+ */
+OPAL_DECLSPEC uint32_t opal_progress_num_calls(void);
+
+/**
+ * Number of consecutive calls to opal_progress() that reported no event
+ *
+ * Loosely maintained like opal_progress_num_calls(). A callback deciding
+ * to block can check that the whole progress engine, and not only its own
+ * component, was idle during the previous calls.
+ */
+OPAL_DECLSPEC uint32_t opal_progress_idle_calls(void);
+
 /**
  * Control how the event library is called
  *
@@ -169,12 +192,26 @@ OPAL_DECLSPEC int opal_progress_register_lp(opal_progress_callback_t cb);
  */
 OPAL_DECLSPEC int opal_progress_unregister(opal_progress_callback_t cb);
 
+/**
+ * Poll a callback on the next call to opal_progress()
+ *
+ * Cancel the back-off of a registered callback, for components that know
+ * new work is waiting for their progress function (a request was posted,
+ * a completion was queued by another thread). Cheap enough to be called
+ * on every such occasion, does nothing if the callback is not registered.
+ */
+OPAL_DECLSPEC void opal_progress_poll_now(opal_progress_callback_t cb);
+
 #if OPAL_ENABLE_DEBUG
 OPAL_DECLSPEC extern bool opal_progress_debug;
 #endif
 
 OPAL_DECLSPEC extern int opal_progress_spin_count;
 
+/* maximum number of calls an idle callback is skipped for, 0 disables the
+ * back-off */
+OPAL_DECLSPEC extern int opal_progress_max_backoff;
+
 /* do we want to call sched_yield() if nothing happened */
 OPAL_DECLSPEC extern bool opal_progress_yield_when_idle;
 
@@ -0,0 +1,238 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ompi/datatype/ompi_datatype.h"
+#include "opal/datatype/opal_convertor.h"
+#include "opal/datatype/opal_datatype_parallel.h"
+#include "opal/runtime/opal.h"
+#include "opal/sys/atomic.h"
+#include "opal/util/minmax.h"
+
+/**
+ * Pack and unpack a few MB with mpi_ddt_pack_threads helper threads and
+ * compare the result with a pack on the calling thread only: in a single
+ * call, in pieces of odd lengths that are still large enough to be split,
+ * and with convertors restarted in the middle of the data with
+ * set_position. The helper threads only split the pack plans. The split of
+ * the jobs is also checked directly, every byte must be processed exactly
+ * once.
+ */
+
+#define THREADS   3
+#define MIN_CHUNK (256 * 1024)
+#define COUNT     2
+
+/* pieces of at least two chunks, so that they are split, not multiple of the element size */
+#define PIECE (3 * MIN_CHUNK + 4099)
+
+static ompi_datatype_t *create_datatype(void)
+{
+    int lengths[4] = {1, 3, 2, 5}, displs[4] = {0, 2, 7, 11};
+    ompi_datatype_t *indexed, *vector;
+
+    /* 44 bytes every 80, 2.2 MB per instance */
+    ompi_datatype_create_indexed(4, lengths, displs, MPI_INT, &indexed);
+    ompi_datatype_create_hvector(50000, 1, 20 * sizeof(int), indexed, &vector);
+    ompi_datatype_commit(&vector);
+    ompi_datatype_destroy(&indexed);
+    return vector;
+}
+
+static size_t pack_range(opal_convertor_t *convertor, unsigned char *packed, size_t length)
+{
+    struct iovec iov = {.iov_base = packed, .iov_len = length};
+    uint32_t iov_count = 1;
+    size_t max_data = length;
+
+    opal_convertor_pack(convertor, &iov, &iov_count, &max_data);
+    return max_data;
+}
+
+static size_t unpack_range(opal_convertor_t *convertor, unsigned char *packed, size_t length)
+{
+    struct iovec iov = {.iov_base = packed, .iov_len = length};
+    uint32_t iov_count = 1;
+    size_t max_data = length;
+
+    opal_convertor_unpack(convertor, &iov, &iov_count, &max_data);
+    return max_data;
+}
+
+/* pack or unpack total bytes in pieces of at most piece bytes, starting at position */
+static size_t copy_pieces(ompi_datatype_t *datatype, void *buffer, unsigned char *packed,
+                          size_t position, size_t total, size_t piece, bool pack)
+{
+    opal_convertor_t *convertor = opal_convertor_create(opal_local_arch, 0);
+    size_t done = position, length;
+
+    if (pack) {
+        opal_convertor_prepare_for_send(convertor, &(datatype->super), COUNT, buffer);
+    } else {
+        opal_convertor_prepare_for_recv(convertor, &(datatype->super), COUNT, buffer);
+    }
+    if (0 != position) {
+        opal_convertor_set_position(convertor, &done);
+    }
+    while (done < total) {
+        length = opal_min(piece, total - done);
+        length = pack ? pack_range(convertor, packed + done, length)
+                      : unpack_range(convertor, packed + done, length);
+        if (0 == length) {
+            break;
+        }
+        done += length;
+    }
+    OBJ_RELEASE(convertor);
+    return done;
+}
+
+static int check(ompi_datatype_t *datatype, const char *name, size_t position, size_t piece,
+                 const unsigned char *reference, const int *send_buffer, const int *unpacked,
+                 size_t extent, size_t total)
+{
+    unsigned char *packed = malloc(total);
+    int *recv_buffer = malloc(extent * COUNT);
+    size_t done;
+    int errors = 0;
+
+    memset(packed, 0, total);
+    done = copy_pieces(datatype, (void *) send_buffer, packed, position, total, piece, true);
+    if (done != total || 0 != memcmp(packed + position, reference + position, total - position)) {
+        printf("%s: pack error from %" PRIsize_t " in pieces of %" PRIsize_t "\n", name,
+               position, piece);
+        errors++;
+    }
+
+    /* a fresh convertor unpacks the bytes before the restart point */
+    memset(recv_buffer, 0xff, extent * COUNT);
+    memcpy(packed, reference, total);
+    if (0 != position) {
+        copy_pieces(datatype, recv_buffer, packed, 0, position, total, false);
+    }
+    done = copy_pieces(datatype, recv_buffer, packed, position, total, piece, false);
+    if (done != total || 0 != memcmp(recv_buffer, unpacked, extent * COUNT)) {
+        printf("%s: unpack error from %" PRIsize_t " in pieces of %" PRIsize_t "\n", name,
+               position, piece);
+        errors++;
+    }
+
+    free(packed);
+    free(recv_buffer);
+    return errors;
+}
+
+static opal_atomic_int32_t *coverage;
+
+static void count_bytes(void *ctx, size_t first, size_t length)
+{
+    (void) ctx;
+    for (size_t i = first; i < first + length; i++) {
+        opal_atomic_add_fetch_32(coverage + i, 1);
+    }
+}
+
+/* every byte of a job is processed exactly once, whatever the length */
+static int check_split(size_t length)
+{
+    int errors = 0;
+
+    coverage = calloc(length, sizeof(*coverage));
+    if (OPAL_SUCCESS != opal_datatype_parallel_run(count_bytes, NULL, length)) {
+        printf("job of %" PRIsize_t " bytes not run by the helper threads\n", length);
+        errors++;
+    } else {
+        for (size_t i = 0; i < length; i++) {
+            if (1 != coverage[i]) {
+                printf("job of %" PRIsize_t " bytes: byte %" PRIsize_t " processed %d times\n",
+                       length, i, (int) coverage[i]);
+                errors++;
+                break;
+            }
+        }
+    }
+    free((void *) coverage);
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t size, total, min_chunk, extent_size, position;
+    int *send_buffer, *recv_buffer, errors = 0;
+    unsigned char *reference;
+    unsigned int threads;
+    ompi_datatype_t *datatype;
+    ptrdiff_t lb, extent;
+
+    opal_init(NULL, NULL);
+    ompi_datatype_init();
+
+    threads = opal_datatype_parallel_threads;
+    min_chunk = opal_datatype_parallel_min_chunk;
+    opal_datatype_parallel_threads = 0;
+    opal_datatype_parallel_min_chunk = MIN_CHUNK;
+
+    datatype = create_datatype();
+    if (NULL == datatype->super.plan) {
+        printf("no pack plan for the datatype\n");
+        errors++;
+    }
+    ompi_datatype_type_size(datatype, &size);
+    ompi_datatype_get_extent(datatype, &lb, &extent);
+    extent_size = (size_t) extent;
+    total = size * COUNT;
+
+    send_buffer = malloc(extent_size * COUNT);
+    recv_buffer = malloc(extent_size * COUNT);
+    for (size_t i = 0; i < extent_size * COUNT / sizeof(int); i++) {
+        send_buffer[i] = (int) i;
+        recv_buffer[i] = -1;
+    }
+    reference = malloc(total);
+
+    /* reference pack and unpack on the calling thread only */
+    copy_pieces(datatype, send_buffer, reference, 0, total, total, true);
+    copy_pieces(datatype, recv_buffer, reference, 0, total, total, false);
+
+    opal_datatype_parallel_threads = THREADS;
+
+    errors += check_split(2 * MIN_CHUNK);
+    errors += check_split(total + 13);
+
+    /* the whole message in one call */
+    errors += check(datatype, "single call", 0, total, reference, send_buffer, recv_buffer,
+                    extent_size, total);
+    /* partial lengths, the last piece is shorter */
+    errors += check(datatype, "pieces", 0, PIECE, reference, send_buffer, recv_buffer,
+                    extent_size, total);
+    /* restarted in the middle of an element of the first instance and of the second one */
+    position = size / 3 + 2;
+    errors += check(datatype, "restart", position, PIECE, reference, send_buffer, recv_buffer,
+                    extent_size, total);
+    position = size + size / 2 + 6;
+    errors += check(datatype, "restart", position, total, reference, send_buffer, recv_buffer,
+                    extent_size, total);
+
+    opal_datatype_parallel_threads = threads;
+    opal_datatype_parallel_min_chunk = min_chunk;
+
+    ompi_datatype_destroy(&datatype);
+    free(send_buffer);
+    free(recv_buffer);
+    free(reference);
+
+    printf("Found %d errors\n", errors);
+    opal_finalize_util();
+
+    return (0 == errors ? 0 : -1);
+}
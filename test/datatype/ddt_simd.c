@@ -0,0 +1,241 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ompi/datatype/ompi_datatype.h"
+#include "opal/datatype/opal_convertor.h"
+#include "opal/datatype/opal_datatype_simd.h"
+#include "opal/runtime/opal.h"
+
+/**
+ * Force each level of mpi_ddt_simd_support the processor can run and check
+ * the vector gather and scatter kernels, directly and through the convertor,
+ * against a scalar copy of the same blocks. The block counts straddle the
+ * width of the vectors and OPAL_DATATYPE_SIMD_MIN_BLOCKS, the buffers are
+ * not aligned and the strides include large and negative ones.
+ */
+
+static const size_t counts[] = {7, 8, 9, 17};
+static const ptrdiff_t strides[] = {2, 3, 16, 4096, -1, -3, -4096};
+static const size_t misalign[] = {0, 1, 3};
+
+#define NUM(a) (sizeof(a) / sizeof((a)[0]))
+
+static const struct {
+    int flag;
+    const char *name;
+} levels[] = {
+    {0, "none"},
+    {OPAL_DATATYPE_SIMD_SSE2, "sse2"},
+    {OPAL_DATATYPE_SIMD_AVX2, "avx2"},
+    {OPAL_DATATYPE_SIMD_AVX512, "avx512"},
+};
+
+/* size of a buffer holding count blocks of length bytes, stride bytes apart */
+static size_t span(size_t length, ptrdiff_t stride, size_t count)
+{
+    size_t step = (size_t) (stride < 0 ? -stride : stride);
+
+    return (count - 1) * step + length + 8;
+}
+
+/* address of the first block, the blocks of a negative stride go down from the end */
+static unsigned char *first_block(unsigned char *buffer, ptrdiff_t stride, size_t count)
+{
+    return stride < 0 ? buffer + (count - 1) * (size_t) -stride : buffer;
+}
+
+static void fill(unsigned char *buffer, size_t size, unsigned char seed)
+{
+    for (size_t i = 0; i < size; i++) {
+        buffer[i] = (unsigned char) (i * 7 + seed);
+    }
+}
+
+static void scalar_gather(unsigned char *dst, const unsigned char *src, size_t length,
+                          ptrdiff_t stride, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        memcpy(dst + i * length, src + (ptrdiff_t) i * stride, length);
+    }
+}
+
+static void scalar_scatter(unsigned char *dst, const unsigned char *src, size_t length,
+                           ptrdiff_t stride, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        memcpy(dst + (ptrdiff_t) i * stride, src + i * length, length);
+    }
+}
+
+static int check_kernels(const char *level, size_t length, ptrdiff_t stride, size_t count,
+                         size_t offset)
+{
+    opal_datatype_strided_fn_t gather, scatter;
+    size_t size = span(length, stride, count), packed_size = count * length;
+    unsigned char *memory, *packed, *expected;
+    int errors = 0;
+
+    gather = 4 == length ? opal_datatype_simd.gather4 : opal_datatype_simd.gather8;
+    scatter = 4 == length ? opal_datatype_simd.scatter4 : opal_datatype_simd.scatter8;
+
+    memory = malloc(size + offset);
+    packed = malloc(packed_size + offset);
+    expected = malloc(size + offset);
+
+    if (NULL != gather) {
+        fill(memory + offset, size, 1);
+        memset(packed, 0, packed_size + offset);
+        memset(expected, 0, packed_size);
+        scalar_gather(expected, first_block(memory + offset, stride, count), length, stride,
+                      count);
+        gather(packed + offset, first_block(memory + offset, stride, count), stride, count);
+        if (0 != memcmp(packed + offset, expected, packed_size)) {
+            printf("%s: gather%" PRIsize_t " error, stride %ld count %" PRIsize_t
+                   " offset %" PRIsize_t "\n",
+                   level, length, (long) stride, count, offset);
+            errors++;
+        }
+    }
+
+    if (NULL != scatter) {
+        fill(packed + offset, packed_size, 2);
+        memset(memory, 0xff, size + offset);
+        memset(expected, 0xff, size + offset);
+        scalar_scatter(first_block(expected + offset, stride, count), packed + offset, length,
+                       stride, count);
+        scatter(first_block(memory + offset, stride, count), packed + offset, stride, count);
+        if (0 != memcmp(memory, expected, size + offset)) {
+            printf("%s: scatter%" PRIsize_t " error, stride %ld count %" PRIsize_t
+                   " offset %" PRIsize_t "\n",
+                   level, length, (long) stride, count, offset);
+            errors++;
+        }
+    }
+
+    free(memory);
+    free(packed);
+    free(expected);
+    return errors;
+}
+
+static int check_convertor(const char *level, size_t length, ptrdiff_t stride, size_t count,
+                           size_t offset)
+{
+    size_t size = span(length, stride, count), packed_size = count * length, max_data;
+    unsigned char *memory, *packed, *expected;
+    opal_convertor_t *convertor;
+    ompi_datatype_t *datatype;
+    uint32_t iov_count;
+    struct iovec iov;
+    int errors = 0;
+
+    /* one float or one double every stride bytes */
+    ompi_datatype_create_hvector((int) count, 1, stride, 4 == length ? MPI_FLOAT : MPI_DOUBLE,
+                                 &datatype);
+    ompi_datatype_commit(&datatype);
+
+    memory = malloc(size + offset);
+    packed = malloc(packed_size + offset);
+    expected = malloc(size + offset);
+
+    /* pack */
+    fill(memory + offset, size, 3);
+    memset(packed, 0, packed_size + offset);
+    scalar_gather(expected, first_block(memory + offset, stride, count), length, stride,
+                  count);
+    convertor = opal_convertor_create(opal_local_arch, 0);
+    opal_convertor_prepare_for_send(convertor, &(datatype->super), 1,
+                                    first_block(memory + offset, stride, count));
+    iov.iov_base = packed + offset;
+    iov.iov_len = max_data = packed_size;
+    iov_count = 1;
+    opal_convertor_pack(convertor, &iov, &iov_count, &max_data);
+    if (max_data != packed_size || 0 != memcmp(packed + offset, expected, packed_size)) {
+        printf("%s: pack error, length %" PRIsize_t " stride %ld count %" PRIsize_t
+               " offset %" PRIsize_t "\n",
+               level, length, (long) stride, count, offset);
+        errors++;
+    }
+    OBJ_RELEASE(convertor);
+
+    /* unpack: only the blocks are written */
+    fill(packed + offset, packed_size, 4);
+    memset(memory, 0xff, size + offset);
+    memset(expected, 0xff, size + offset);
+    scalar_scatter(first_block(expected + offset, stride, count), packed + offset, length,
+                   stride, count);
+    convertor = opal_convertor_create(opal_local_arch, 0);
+    opal_convertor_prepare_for_recv(convertor, &(datatype->super), 1,
+                                    first_block(memory + offset, stride, count));
+    iov.iov_base = packed + offset;
+    iov.iov_len = max_data = packed_size;
+    iov_count = 1;
+    opal_convertor_unpack(convertor, &iov, &iov_count, &max_data);
+    if (max_data != packed_size || 0 != memcmp(memory, expected, size + offset)) {
+        printf("%s: unpack error, length %" PRIsize_t " stride %ld count %" PRIsize_t
+               " offset %" PRIsize_t "\n",
+               level, length, (long) stride, count, offset);
+        errors++;
+    }
+    OBJ_RELEASE(convertor);
+
+    ompi_datatype_destroy(&datatype);
+    free(memory);
+    free(packed);
+    free(expected);
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    int support, detected, errors = 0;
+
+    opal_init(NULL, NULL);
+    ompi_datatype_init();
+
+    support = opal_datatype_simd_support;
+    detected = opal_datatype_simd_detect();
+
+    for (size_t l = 0; l < NUM(levels); l++) {
+        if (0 != levels[l].flag && !(detected & levels[l].flag)) {
+            printf("%s: not supported by the processor, skipped\n", levels[l].name);
+            continue;
+        }
+        opal_datatype_simd_support = levels[l].flag;
+        opal_datatype_simd_init();
+
+        for (size_t length = 4; length <= 8; length += 4) {
+            for (size_t c = 0; c < NUM(counts); c++) {
+                for (size_t s = 0; s < NUM(strides); s++) {
+                    ptrdiff_t stride = strides[s] * (ptrdiff_t) length;
+
+                    for (size_t o = 0; o < NUM(misalign); o++) {
+                        errors += check_kernels(levels[l].name, length, stride, counts[c],
+                                                misalign[o]);
+                        errors += check_convertor(levels[l].name, length, stride, counts[c],
+                                                  misalign[o]);
+                    }
+                }
+            }
+        }
+    }
+
+    opal_datatype_simd_support = support;
+    opal_datatype_simd_init();
+
+    printf("Found %d errors\n", errors);
+    opal_finalize_util();
+
+    return (0 == errors ? 0 : -1);
+}
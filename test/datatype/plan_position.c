@@ -0,0 +1,191 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ompi/datatype/ompi_datatype.h"
+#include "opal/datatype/opal_convertor.h"
+#include "opal/datatype/opal_datatype_plan.h"
+#include "opal/runtime/opal.h"
+
+/**
+ * Move convertors forward with set_position in the middle of a pack or an
+ * unpack, skipping part of the data, then finish the operation. Convertors
+ * using a pack plan only track their position in bConverted, so this checks
+ * that the plan and the description based convertors agree on the skipped
+ * and copied bytes, and that opal_convertor_raw still starts at the right
+ * place once a plan has moved the convertor.
+ */
+
+#define COUNT 3
+
+static ompi_datatype_t *create_datatype(void)
+{
+    int lengths[4] = {1, 3, 2, 5}, displs[4] = {0, 2, 7, 11};
+    ompi_datatype_t *indexed, *vector;
+
+    ompi_datatype_create_indexed(4, lengths, displs, MPI_INT, &indexed);
+    ompi_datatype_create_hvector(50, 1, 20 * sizeof(int), indexed, &vector);
+    ompi_datatype_commit(&vector);
+    ompi_datatype_destroy(&indexed);
+    return vector;
+}
+
+static size_t pack_range(opal_convertor_t *convertor, unsigned char *packed, size_t length)
+{
+    struct iovec iov = {.iov_base = packed, .iov_len = length};
+    uint32_t iov_count = 1;
+    size_t max_data = length;
+
+    opal_convertor_pack(convertor, &iov, &iov_count, &max_data);
+    return max_data;
+}
+
+static size_t unpack_range(opal_convertor_t *convertor, unsigned char *packed, size_t length)
+{
+    struct iovec iov = {.iov_base = packed, .iov_len = length};
+    uint32_t iov_count = 1;
+    size_t max_data = length;
+
+    opal_convertor_unpack(convertor, &iov, &iov_count, &max_data);
+    return max_data;
+}
+
+static int check(ompi_datatype_t *datatype, const char *name)
+{
+    size_t size, total, first, skip_to, position, length, max_data;
+    unsigned char *packed, *result;
+    int *send_buffer, *recv_buffer, errors = 0;
+    opal_convertor_t *convertor;
+    ptrdiff_t lb, extent;
+    struct iovec iov[8];
+    uint32_t iov_count;
+
+    ompi_datatype_type_size(datatype, &size);
+    ompi_datatype_get_extent(datatype, &lb, &extent);
+    total = size * COUNT;
+    /* stop inside the first instance, then jump forward into the second one */
+    first = (size / 3) & ~(size_t) 3;
+    skip_to = size + size / 2 + 4;
+
+    send_buffer = malloc(extent * COUNT);
+    recv_buffer = malloc(extent * COUNT);
+    for (size_t i = 0; i < extent * COUNT / sizeof(int); i++) {
+        send_buffer[i] = (int) i;
+        recv_buffer[i] = -1;
+    }
+    packed = malloc(total);
+    result = malloc(total);
+
+    convertor = opal_convertor_create(opal_local_arch, 0);
+    opal_convertor_prepare_for_send(convertor, &(datatype->super), COUNT, send_buffer);
+    pack_range(convertor, packed, total);
+    OBJ_RELEASE(convertor);
+
+    /* pack */
+    memset(result, 0, total);
+    convertor = opal_convertor_create(opal_local_arch, 0);
+    opal_convertor_prepare_for_send(convertor, &(datatype->super), COUNT, send_buffer);
+    pack_range(convertor, result, first);
+    position = skip_to;
+    opal_convertor_set_position(convertor, &position);
+    length = pack_range(convertor, result + position, total - position);
+    if (length != total - position || 0 != memcmp(result, packed, first)
+        || 0 != memcmp(result + position, packed + position, length)) {
+        printf("%s: pack error after moving to %" PRIsize_t "\n", name, position);
+        errors++;
+    }
+    OBJ_RELEASE(convertor);
+
+    /* raw: the segments after a partial pack cover the rest of the data */
+    convertor = opal_convertor_create(opal_local_arch, 0);
+    opal_convertor_prepare_for_send(convertor, &(datatype->super), COUNT, send_buffer);
+    position = pack_range(convertor, result, skip_to);
+    do {
+        iov_count = 8;
+        opal_convertor_raw(convertor, iov, &iov_count, &max_data);
+        for (uint32_t i = 0; i < iov_count; i++) {
+            if (position + iov[i].iov_len > total
+                || 0 != memcmp(iov[i].iov_base, packed + position, iov[i].iov_len)) {
+                printf("%s: raw error at %" PRIsize_t "\n", name, position);
+                errors++;
+                break;
+            }
+            position += iov[i].iov_len;
+        }
+    } while (0 != iov_count && position < total);
+    if (position != total) {
+        printf("%s: raw stopped at %" PRIsize_t " instead of %" PRIsize_t "\n", name, position,
+               total);
+        errors++;
+    }
+    OBJ_RELEASE(convertor);
+
+    /* unpack: the skipped bytes must not be written */
+    convertor = opal_convertor_create(opal_local_arch, 0);
+    opal_convertor_prepare_for_recv(convertor, &(datatype->super), COUNT, recv_buffer);
+    unpack_range(convertor, packed, first);
+    position = skip_to;
+    opal_convertor_set_position(convertor, &position);
+    unpack_range(convertor, packed + position, total - position);
+    OBJ_RELEASE(convertor);
+
+    convertor = opal_convertor_create(opal_local_arch, 0);
+    opal_convertor_prepare_for_send(convertor, &(datatype->super), COUNT, recv_buffer);
+    pack_range(convertor, result, total);
+    OBJ_RELEASE(convertor);
+    for (size_t i = 0; i < total; i++) {
+        unsigned char expected = (i < first || i >= skip_to) ? packed[i] : 0xff;
+
+        if (result[i] != expected) {
+            printf("%s: unpack error at byte %" PRIsize_t "\n", name, i);
+            errors++;
+            break;
+        }
+    }
+
+    free(send_buffer);
+    free(recv_buffer);
+    free(packed);
+    free(result);
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    ompi_datatype_t *datatype;
+    unsigned int max_blocks;
+    int errors = 0;
+
+    opal_init(NULL, NULL);
+    ompi_datatype_init();
+
+    datatype = create_datatype();
+    if (NULL == datatype->super.plan) {
+        printf("no pack plan for the datatype\n");
+        errors++;
+    }
+    errors += check(datatype, "plan");
+    ompi_datatype_destroy(&datatype);
+
+    max_blocks = opal_datatype_plan_max_blocks;
+    opal_datatype_plan_max_blocks = 0;
+    datatype = create_datatype();
+    errors += check(datatype, "description");
+    ompi_datatype_destroy(&datatype);
+    opal_datatype_plan_max_blocks = max_blocks;
+
+    printf("Found %d errors\n", errors);
+    opal_finalize_util();
+
+    return (0 == errors ? 0 : -1);
+}
@@ -0,0 +1,245 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_SYS_TIME_H
+#    include <sys/time.h>
+#endif
+
+#include "ompi/datatype/ompi_datatype.h"
+#include "opal/datatype/opal_convertor.h"
+#include "opal/datatype/opal_datatype_checkpoint.h"
+#include "opal/datatype/opal_datatype_plan.h"
+#include "opal/runtime/opal.h"
+#include "opal/util/output.h"
+
+/**
+ * Reposition send and receive convertors at random places inside a large
+ * datatype made of irregular blocks, as a pipelined protocol restarting
+ * fragments would, and check the packed and unpacked data. The cost of the
+ * repositioning should not depend on the distance to the beginning of the
+ * datatype once the position checkpoints are built. Everything runs twice,
+ * with a pack plan and with the plans disabled so that the convertors
+ * interpret the description and restart from the checkpoints.
+ */
+
+#define TIMER_DATA_TYPE struct timeval
+#define GET_TIME(TV)    gettimeofday(&(TV), NULL)
+#define ELAPSED_TIME(TSTART, TEND) \
+    (((TEND).tv_sec - (TSTART).tv_sec) * 1000000 + ((TEND).tv_usec - (TSTART).tv_usec))
+
+#define NBLOCKS     200
+#define NVECTORS    400
+#define COUNT       2
+#define SEGMENT     1500
+#define NPOSITIONS  1000
+
+static ompi_datatype_t *create_irregular_datatype(void)
+{
+    int lengths[NBLOCKS], displs[NBLOCKS], disp = 0;
+    ompi_datatype_t *indexed, *vector;
+    ptrdiff_t lb, extent;
+
+    for (int i = 0; i < NBLOCKS; i++) {
+        lengths[i] = 1 + (i * 7) % 5;
+        displs[i] = disp;
+        disp += lengths[i] + 1 + (i % 3);
+    }
+    ompi_datatype_create_indexed(NBLOCKS, lengths, displs, MPI_INT, &indexed);
+    ompi_datatype_get_extent(indexed, &lb, &extent);
+    ompi_datatype_create_hvector(NVECTORS, 1, extent + 2 * sizeof(int), indexed, &vector);
+    ompi_datatype_commit(&vector);
+    ompi_datatype_destroy(&indexed);
+    return vector;
+}
+
+static size_t random_position(size_t total)
+{
+    return ((size_t) rand() * 1021) % total;
+}
+
+static int check_send(ompi_datatype_t *datatype, const void *buffer, const unsigned char *packed,
+                      size_t total)
+{
+    unsigned char segment[SEGMENT];
+    opal_convertor_t *convertor;
+    int errors = 0;
+
+    convertor = opal_convertor_create(opal_local_arch, 0);
+    opal_convertor_prepare_for_send(convertor, &(datatype->super), COUNT, buffer);
+    for (int i = 0; i < NPOSITIONS; i++) {
+        size_t position = random_position(total), max_data = SEGMENT;
+        struct iovec iov = {.iov_base = segment, .iov_len = SEGMENT};
+        uint32_t iov_count = 1;
+
+        opal_convertor_set_position(convertor, &position);
+        opal_convertor_pack(convertor, &iov, &iov_count, &max_data);
+        if (0 != memcmp(segment, packed + position, max_data)) {
+            if (0 == errors) {
+                printf("pack error for the segment at %" PRIsize_t "\n", position);
+            }
+            errors++;
+        }
+    }
+    OBJ_RELEASE(convertor);
+    return errors;
+}
+
+static void check_recv(ompi_datatype_t *datatype, void *buffer, unsigned char *packed,
+                       size_t total)
+{
+    opal_convertor_t *convertor;
+    size_t nsegments = (total + SEGMENT - 1) / SEGMENT;
+    size_t *order = malloc(nsegments * sizeof(size_t));
+
+    /* unpack the segments in a random order */
+    for (size_t i = 0; i < nsegments; i++) {
+        order[i] = i;
+    }
+    for (size_t i = nsegments - 1; i > 0; i--) {
+        size_t j = (size_t) rand() % (i + 1), tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+
+    convertor = opal_convertor_create(opal_local_arch, 0);
+    opal_convertor_prepare_for_recv(convertor, &(datatype->super), COUNT, buffer);
+    for (size_t i = 0; i < nsegments; i++) {
+        size_t position = order[i] * SEGMENT, max_data = SEGMENT;
+        struct iovec iov = {.iov_base = packed + position, .iov_len = SEGMENT};
+        uint32_t iov_count = 1;
+
+        if (position + SEGMENT > total) {
+            iov.iov_len = max_data = total - position;
+        }
+        opal_convertor_set_position(convertor, &position);
+        opal_convertor_unpack(convertor, &iov, &iov_count, &max_data);
+    }
+    OBJ_RELEASE(convertor);
+    free(order);
+}
+
+static void time_positions(ompi_datatype_t *datatype, const void *buffer, size_t total)
+{
+    TIMER_DATA_TYPE start, end;
+    opal_convertor_t *convertor;
+
+    convertor = opal_convertor_create(opal_local_arch, 0);
+    opal_convertor_prepare_for_send(convertor, &(datatype->super), COUNT, buffer);
+    for (int quarter = 1; quarter <= 4; quarter++) {
+        size_t target = (total / COUNT) * quarter / 4 - 1, position;
+
+        GET_TIME(start);
+        for (int i = 0; i < NPOSITIONS; i++) {
+            position = 0;
+            opal_convertor_set_position(convertor, &position);
+            position = target;
+            opal_convertor_set_position(convertor, &position);
+        }
+        GET_TIME(end);
+        printf("set_position at %3d%% of the datatype: %8.2f usec\n", quarter * 25,
+               (double) ELAPSED_TIME(start, end) / NPOSITIONS);
+    }
+    OBJ_RELEASE(convertor);
+}
+
+static int check_datatype(const char *name)
+{
+    unsigned char *packed, *repacked;
+    int *send_buffer, *recv_buffer, errors;
+    ompi_datatype_t *datatype;
+    size_t size, total, max_data;
+    ptrdiff_t lb, extent;
+    opal_convertor_t *convertor;
+    struct iovec iov;
+    uint32_t iov_count;
+
+    datatype = create_irregular_datatype();
+    ompi_datatype_type_size(datatype, &size);
+    ompi_datatype_get_extent(datatype, &lb, &extent);
+    total = size * COUNT;
+    printf("%s: datatype of %" PRIsize_t " bytes with an extent of %ld\n", name, size,
+           (long) extent);
+
+    send_buffer = malloc(extent * COUNT);
+    recv_buffer = malloc(extent * COUNT);
+    for (size_t i = 0; i < extent * COUNT / sizeof(int); i++) {
+        send_buffer[i] = (int) i;
+        recv_buffer[i] = -1;
+    }
+    packed = malloc(total);
+    repacked = malloc(total);
+
+    /* reference: pack everything at once */
+    convertor = opal_convertor_create(opal_local_arch, 0);
+    opal_convertor_prepare_for_send(convertor, &(datatype->super), COUNT, send_buffer);
+    iov.iov_base = packed;
+    iov.iov_len = max_data = total;
+    iov_count = 1;
+    opal_convertor_pack(convertor, &iov, &iov_count, &max_data);
+    OBJ_RELEASE(convertor);
+
+    errors = check_send(datatype, send_buffer, packed, total);
+
+    check_recv(datatype, recv_buffer, packed, total);
+    convertor = opal_convertor_create(opal_local_arch, 0);
+    opal_convertor_prepare_for_send(convertor, &(datatype->super), COUNT, recv_buffer);
+    iov.iov_base = repacked;
+    iov.iov_len = max_data = total;
+    iov_count = 1;
+    opal_convertor_pack(convertor, &iov, &iov_count, &max_data);
+    OBJ_RELEASE(convertor);
+    if (0 != memcmp(packed, repacked, total)) {
+        printf("%s: unpack error\n", name);
+        errors++;
+    }
+
+    /* the convertors interpreting the description must have gone through the checkpoints */
+    if (NULL == datatype->super.plan && 0 != opal_datatype_checkpoint_step
+        && NULL == datatype->super.checkpoints) {
+        printf("%s: no checkpoints were built\n", name);
+        errors++;
+    }
+
+    time_positions(datatype, send_buffer, total);
+
+    free(send_buffer);
+    free(recv_buffer);
+    free(packed);
+    free(repacked);
+    ompi_datatype_destroy(&datatype);
+
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int max_blocks;
+    int errors;
+
+    opal_init(NULL, NULL);
+    ompi_datatype_init();
+    srand(1);
+
+    /* convertors with a pack plan reposition without any stack walk, without a plan they
+     * restart from the checkpoints */
+    errors = check_datatype("plan");
+    max_blocks = opal_datatype_plan_max_blocks;
+    opal_datatype_plan_max_blocks = 0;
+    errors += check_datatype("description");
+    opal_datatype_plan_max_blocks = max_blocks;
+
+    printf("Found %d errors\n", errors);
+    opal_finalize_util();
+
+    return (0 == errors ? 0 : -1);
+}
@@ -0,0 +1,160 @@
+/*
+ * Overlap of communication and computation for a nonblocking allreduce and
+ * for large point-to-point messages. Each operation is timed alone, then
+ * posted before a compute phase of the same duration and completed after
+ * it. The overlap is the fraction of the communication hidden behind the
+ * computation: 0% when the operation only progresses inside MPI_Wait, 100%
+ * when it completes in the background. The slowdown is the fraction of the
+ * computation lost while the operation is outstanding, compared with the
+ * same compute phase run with nothing to progress: it shows the cost of a
+ * progress thread competing with the application for the core.
+ *
+ *   mpirun -n 4 ./async_overlap
+ *   mpirun -n 4 --mca mpi_async_progress 1 ./async_overlap
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mpi.h"
+
+#define ITERATIONS 10
+
+static volatile double sink = 0.0;
+
+/* spin for the given time without calling MPI, returns the work done */
+static double compute(double seconds)
+{
+    double start = MPI_Wtime();
+    double x = 1.0, work = 0.0;
+
+    while (MPI_Wtime() - start < seconds) {
+        for (int i = 0; i < 1000; i++) {
+            x = x * 1.000001 + 0.000001;
+        }
+        work += 1.0;
+    }
+    sink = x;
+    return work;
+}
+
+static void post_iallreduce(double *in, double *out, int count, MPI_Request *requests)
+{
+    MPI_Iallreduce(in, out, count, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD, &requests[0]);
+}
+
+/* even ranks send to the next odd rank */
+static void post_isend(double *in, double *out, int count, MPI_Request *requests)
+{
+    int rank, size;
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (rank % 2) {
+        MPI_Irecv(out, count, MPI_DOUBLE, rank - 1, 0, MPI_COMM_WORLD, &requests[0]);
+    } else if (rank + 1 < size) {
+        MPI_Isend(in, count, MPI_DOUBLE, rank + 1, 0, MPI_COMM_WORLD, &requests[0]);
+    } else {
+        requests[0] = MPI_REQUEST_NULL;
+    }
+}
+
+static void measure(const char *name, int count, int collective)
+{
+    double *in = malloc(count * sizeof(double)), *out = malloc(count * sizeof(double));
+    double start, comm = 0.0, total = 0.0, overlap, slowdown;
+    double work[2] = {0.0, 0.0};
+    MPI_Request requests[1];
+    int rank;
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    for (int i = 0; i < count; i++) {
+        in[i] = (double) rank;
+    }
+
+    /* communication alone, the first iteration warms up the connections */
+    for (int i = 0; i <= ITERATIONS; i++) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        start = MPI_Wtime();
+        if (collective) {
+            post_iallreduce(in, out, count, requests);
+        } else {
+            post_isend(in, out, count, requests);
+        }
+        MPI_Wait(&requests[0], MPI_STATUS_IGNORE);
+        if (i > 0) {
+            comm += MPI_Wtime() - start;
+        }
+    }
+    comm /= ITERATIONS;
+    /* every rank computes for the same time */
+    MPI_Allreduce(MPI_IN_PLACE, &comm, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+    /* computation alone */
+    for (int i = 0; i < ITERATIONS; i++) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        work[0] += compute(comm);
+    }
+
+    /* communication overlapped with computation */
+    for (int i = 0; i < ITERATIONS; i++) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        start = MPI_Wtime();
+        if (collective) {
+            post_iallreduce(in, out, count, requests);
+        } else {
+            post_isend(in, out, count, requests);
+        }
+        work[1] += compute(comm);
+        MPI_Wait(&requests[0], MPI_STATUS_IGNORE);
+        total += MPI_Wtime() - start;
+    }
+    total /= ITERATIONS;
+    MPI_Allreduce(MPI_IN_PLACE, &total, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, work, 2, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+
+    overlap = 100.0 * (2.0 * comm - total) / comm;
+    if (overlap < 0.0) {
+        overlap = 0.0;
+    } else if (overlap > 100.0) {
+        overlap = 100.0;
+    }
+    slowdown = work[0] > 0.0 ? 100.0 * (1.0 - work[1] / work[0]) : 0.0;
+    if (0 == rank) {
+        printf("%-16s %12d %12.1f %12.1f %9.1f%% %9.1f%%\n", name, count * (int) sizeof(double),
+               comm * 1e6, total * 1e6, overlap, slowdown);
+    }
+
+    free(in);
+    free(out);
+}
+
+int main(int argc, char *argv[])
+{
+    int rank, size;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (size < 2) {
+        if (0 == rank) {
+            fprintf(stderr, "async_overlap needs at least 2 processes\n");
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    if (0 == rank) {
+        printf("%-16s %12s %12s %12s %10s %10s\n", "operation", "bytes", "comm (us)",
+               "total (us)", "overlap", "slowdown");
+    }
+    for (int count = 1024; count <= 4 * 1024 * 1024; count *= 16) {
+        measure("MPI_Iallreduce", count, 1);
+    }
+    for (int count = 16 * 1024; count <= 4 * 1024 * 1024; count *= 16) {
+        measure("MPI_Isend", count, 0);
+    }
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,132 @@
+/*
+ * Multi-threaded message rate. Every process runs the same number of
+ * threads and thread t exchanges windows of small messages with the process
+ * t + 1 ranks away, so that the threads of a process receive from different
+ * peers at the same time on one communicator. The receives name their
+ * source, or use MPI_ANY_SOURCE every WILD_EVERY windows to measure the
+ * cost of wildcard receives. Meant to compare the matching locks of ob1:
+ *
+ *   mpirun -n 8 ./mt_msgrate 4
+ *   mpirun -n 8 --mca pml_ob1_peer_matching 1 ./mt_msgrate 4
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mpi.h"
+
+#define WINDOW     64
+#define ITERATIONS 2000
+#define MAX_SIZE   4096
+
+typedef struct {
+    int id;
+    int length;
+    int wild_every; /* 0: no wildcard receive */
+    pthread_barrier_t *barrier;
+} thread_args_t;
+
+static int rank, size;
+
+static void *exchange(void *arg)
+{
+    thread_args_t *args = (thread_args_t *) arg;
+    int dst = (rank + 1 + args->id) % size, src = (rank + size - 1 - args->id) % size;
+    MPI_Request requests[2 * WINDOW];
+    char *sbuf = calloc(WINDOW, MAX_SIZE), *rbuf = calloc(WINDOW, MAX_SIZE);
+
+    pthread_barrier_wait(args->barrier);
+    for (int i = 0; i < ITERATIONS; i++) {
+        int from = src;
+
+        if (args->wild_every && 0 == i % args->wild_every) {
+            from = MPI_ANY_SOURCE;
+        }
+        /* the tag only matches the messages of this thread's peer */
+        for (int j = 0; j < WINDOW; j++) {
+            MPI_Irecv(rbuf + j * MAX_SIZE, args->length, MPI_BYTE, from, args->id, MPI_COMM_WORLD,
+                      &requests[j]);
+        }
+        for (int j = 0; j < WINDOW; j++) {
+            MPI_Isend(sbuf + j * MAX_SIZE, args->length, MPI_BYTE, dst, args->id, MPI_COMM_WORLD,
+                      &requests[WINDOW + j]);
+        }
+        MPI_Waitall(2 * WINDOW, requests, MPI_STATUSES_IGNORE);
+    }
+
+    free(sbuf);
+    free(rbuf);
+    return NULL;
+}
+
+static void measure(int nthreads, int length, int wild_every)
+{
+    pthread_t *threads = malloc(nthreads * sizeof(pthread_t));
+    thread_args_t *args = malloc(nthreads * sizeof(thread_args_t));
+    pthread_barrier_t barrier;
+    double start, elapsed, rate;
+
+    pthread_barrier_init(&barrier, NULL, nthreads + 1);
+    for (int t = 0; t < nthreads; t++) {
+        args[t] = (thread_args_t){.id = t, .length = length, .wild_every = wild_every,
+                                  .barrier = &barrier};
+        pthread_create(&threads[t], NULL, exchange, &args[t]);
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    start = MPI_Wtime();
+    pthread_barrier_wait(&barrier);
+    for (int t = 0; t < nthreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    elapsed = MPI_Wtime() - start;
+
+    /* messages received per second by a process */
+    rate = (double) nthreads * ITERATIONS * WINDOW / elapsed;
+    MPI_Allreduce(MPI_IN_PLACE, &rate, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    if (0 == rank) {
+        printf("%8d %8d %12s %14.0f\n", nthreads, length,
+               wild_every ? "any_source" : "specific", rate / size);
+    }
+
+    pthread_barrier_destroy(&barrier);
+    free(threads);
+    free(args);
+}
+
+int main(int argc, char *argv[])
+{
+    int provided, max_threads;
+
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (MPI_THREAD_MULTIPLE != provided || size < 2) {
+        if (0 == rank) {
+            fprintf(stderr, "mt_msgrate needs MPI_THREAD_MULTIPLE and at least 2 processes\n");
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    /* each thread talks to a different peer */
+    max_threads = size - 1;
+    if (argc > 1 && atoi(argv[1]) > 0 && atoi(argv[1]) < max_threads) {
+        max_threads = atoi(argv[1]);
+    }
+
+    if (0 == rank) {
+        printf("%8s %8s %12s %14s\n", "threads", "bytes", "receives", "msgs/s/proc");
+    }
+    for (int nthreads = 1; nthreads <= max_threads; nthreads *= 2) {
+        for (int length = 8; length <= MAX_SIZE; length *= 8) {
+            measure(nthreads, length, 0);
+            measure(nthreads, length, 16);
+        }
+    }
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,149 @@
+/*
+ * Large non-contiguous messages between two processes. Each message is
+ * described by a different datatype on each side (strided vector, indexed
+ * blocks of varying length, contiguous), so that it goes through the
+ * single-copy scatter-gather path of ob1 between local processes (messages
+ * of pml_ob1_smsc_iov_min_size bytes or more) as well as through the
+ * regular protocols, and the received data is checked element by element.
+ *
+ *   mpirun -n 2 ./noncontig_large
+ *   mpirun -n 2 --mca pml_ob1_smsc_iov_min_size 0 ./noncontig_large
+ *   mpirun -n 2 --mca pml_ob1_smsc_iov_max 16 ./noncontig_large
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mpi.h"
+
+enum { LAYOUT_CONTIG, LAYOUT_VECTOR, LAYOUT_INDEXED, LAYOUT_COUNT };
+
+static const char *layout_name[LAYOUT_COUNT] = {"contiguous", "vector", "indexed"};
+
+/* position in the buffer of each of the count doubles of a layout: every
+ * double, every other double, or blocks of 1 to 7 doubles separated by gaps
+ * of 3. Returns the number of doubles the layout spans. */
+static int layout_positions(int layout, int count, int *positions)
+{
+    int offset = 0;
+
+    for (int i = 0, block = 0; i < count; block++) {
+        int len = (LAYOUT_INDEXED == layout) ? 1 + block % 7 : 1;
+
+        for (int j = 0; j < len && i < count; j++) {
+            positions[i++] = offset++;
+        }
+        offset += (LAYOUT_INDEXED == layout) ? 3 : (LAYOUT_VECTOR == layout) ? 1 : 0;
+    }
+
+    return offset;
+}
+
+/* datatype describing count doubles at the given positions */
+static MPI_Datatype make_type(int layout, int count, const int *positions)
+{
+    int *lengths, *displs, nblocks = 0;
+    MPI_Datatype type;
+
+    if (LAYOUT_CONTIG == layout) {
+        MPI_Type_contiguous(count, MPI_DOUBLE, &type);
+    } else if (LAYOUT_VECTOR == layout) {
+        MPI_Type_vector(count, 1, 2, MPI_DOUBLE, &type);
+    } else {
+        lengths = malloc(count * sizeof(int));
+        displs = malloc(count * sizeof(int));
+        for (int i = 0; i < count; i++) {
+            if (nblocks && displs[nblocks - 1] + lengths[nblocks - 1] == positions[i]) {
+                ++lengths[nblocks - 1];
+            } else {
+                displs[nblocks] = positions[i];
+                lengths[nblocks++] = 1;
+            }
+        }
+        MPI_Type_indexed(nblocks, lengths, displs, MPI_DOUBLE, &type);
+        free(lengths);
+        free(displs);
+    }
+    MPI_Type_commit(&type);
+
+    return type;
+}
+
+static int check(int send_layout, int recv_layout, int count)
+{
+    int layout = send_layout, rank, span, errors = 0;
+    int *positions = malloc(count * sizeof(int));
+    MPI_Datatype type;
+    double *buffer;
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    if (0 != rank) {
+        layout = recv_layout;
+    }
+    span = layout_positions(layout, count, positions);
+    type = make_type(layout, count, positions);
+    buffer = malloc(span * sizeof(double));
+    for (int i = 0; i < span; i++) {
+        buffer[i] = -1.0;
+    }
+
+    if (0 == rank) {
+        for (int i = 0; i < count; i++) {
+            buffer[positions[i]] = (double) i;
+        }
+        MPI_Send(buffer, 1, type, 1, 0, MPI_COMM_WORLD);
+    } else {
+        MPI_Recv(buffer, 1, type, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        for (int i = 0, j = 0; i < span; i++) {
+            double expected = -1.0; /* the gaps must not be written */
+
+            if (j < count && positions[j] == i) {
+                expected = (double) j++;
+            }
+            if (buffer[i] != expected && ++errors <= 5) {
+                fprintf(stderr, "%s -> %s, %d doubles: position %d is %g, expected %g\n",
+                        layout_name[send_layout], layout_name[recv_layout], count, i, buffer[i],
+                        expected);
+            }
+        }
+    }
+
+    MPI_Type_free(&type);
+    free(positions);
+    free(buffer);
+
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    int rank, size, errors = 0, total;
+    const int counts[] = {1000, 2048, 2049, 65536, 1 << 20, 4 * (1 << 20) + 3};
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (2 != size) {
+        if (0 == rank) {
+            fprintf(stderr, "noncontig_large needs exactly 2 processes\n");
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        for (int send_layout = 0; send_layout < LAYOUT_COUNT; send_layout++) {
+            for (int recv_layout = 0; recv_layout < LAYOUT_COUNT; recv_layout++) {
+                errors += check(send_layout, recv_layout, counts[c]);
+            }
+        }
+    }
+
+    MPI_Allreduce(&errors, &total, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (0 == rank) {
+        printf("noncontig_large: %s (%d errors)\n", total ? "FAILED" : "passed", total);
+    }
+
+    MPI_Finalize();
+    return total ? 1 : 0;
+}
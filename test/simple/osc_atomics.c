@@ -0,0 +1,152 @@
+/*
+ * Concurrent accumulates on a window of rank 0. All the processes update
+ * the same elements at the same time with MPI_Fetch_and_op and
+ * MPI_Accumulate, some with single elements of a predefined datatype
+ * (done with processor atomics by osc/sm), some with a derived datatype or
+ * more elements than osc_sm_acc_atomics_max_count (done under the
+ * accumulate locks). The two kinds of updates hit the same elements and
+ * adjacent ones, and the final values are checked against the expected
+ * totals, so a lost update on either path is detected.
+ *
+ *   mpirun -n 4 --mca osc sm ./osc_atomics
+ *   mpirun -n 4 --mca osc sm --mca osc_sm_acc_atomics_max_count 0 ./osc_atomics
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mpi.h"
+
+#define ITERATIONS 10000
+#define ELEMENTS   48
+#define BLOCK      32
+
+/* layout of the window */
+enum {
+    E_MIXED = 0,      /* fetch_and_op +1 and the strided accumulate */
+    E_SUM = 1,        /* single element accumulate of rank + 1 */
+    E_STRIDED = 2,    /* 2, 4, 6 only get the strided accumulate */
+    E_BEFORE = 7,     /* fetch_and_op +1 right before the block */
+    E_BLOCK = 8,      /* BLOCK elements accumulated at once */
+    E_AFTER = E_BLOCK + BLOCK, /* fetch_and_op +1 right after the block */
+    E_MAX,            /* MPI_MAX, done with a compare-exchange loop */
+    E_BOR,            /* MPI_BOR of one bit per rank */
+};
+
+static int check(const int64_t *values, int size, int64_t *fetched, int nfetched)
+{
+    int64_t expected[ELEMENTS] = {0}, ranks_sum = (int64_t) size * (size + 1) / 2;
+    int errors = 0;
+
+    expected[E_MIXED] = 2 * (int64_t) size * ITERATIONS;
+    expected[E_SUM] = ranks_sum * ITERATIONS;
+    for (int i = E_STRIDED; i < E_BEFORE; i += 2) {
+        expected[i] = (int64_t) size * ITERATIONS;
+    }
+    expected[E_BEFORE] = (int64_t) size * ITERATIONS;
+    for (int i = E_BLOCK; i < E_AFTER; i++) {
+        expected[i] = ranks_sum * ITERATIONS;
+    }
+    expected[E_AFTER] = (int64_t) size * ITERATIONS;
+    expected[E_MAX] = (int64_t) (size - 1) * ITERATIONS + ITERATIONS - 1;
+    for (int r = 0; r < size; r++) {
+        expected[E_BOR] |= (int64_t) 1 << (r % 62);
+    }
+
+    for (int i = 0; i < ELEMENTS; i++) {
+        if (values[i] != expected[i]) {
+            fprintf(stderr, "element %d is %lld, expected %lld\n", i, (long long) values[i],
+                    (long long) expected[i]);
+            ++errors;
+        }
+    }
+
+    /* every increment of E_MIXED is seen by at most one fetch */
+    for (int i = 0; i < nfetched; i++) {
+        int64_t v = fetched[i];
+
+        if (v < 0 || v >= expected[E_MIXED]) {
+            fprintf(stderr, "fetched out of range value %lld\n", (long long) v);
+            ++errors;
+            continue;
+        }
+        if (fetched[nfetched + v / 64] & ((int64_t) 1 << (v % 64))) {
+            if (++errors <= 5) {
+                fprintf(stderr, "value %lld was fetched twice\n", (long long) v);
+            }
+        }
+        fetched[nfetched + v / 64] |= (int64_t) 1 << (v % 64);
+    }
+
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    int64_t *base, *fetched = NULL, one = 1, mine, result, ones[4] = {1, 1, 1, 1}, block[BLOCK];
+    int rank, size, errors = 0, nfetched;
+    MPI_Datatype strided;
+    MPI_Win win;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    MPI_Win_allocate(0 == rank ? ELEMENTS * sizeof(int64_t) : 0, sizeof(int64_t), MPI_INFO_NULL,
+                     MPI_COMM_WORLD, &base, &win);
+    if (0 == rank) {
+        for (int i = 0; i < ELEMENTS; i++) {
+            base[i] = 0;
+        }
+    }
+    MPI_Type_vector(4, 1, 2, MPI_INT64_T, &strided);
+    MPI_Type_commit(&strided);
+
+    mine = rank + 1;
+    for (int i = 0; i < BLOCK; i++) {
+        block[i] = mine;
+    }
+    nfetched = size * ITERATIONS;
+    if (0 == rank) {
+        /* the fetched values, followed by a bitmap of the values seen */
+        fetched = calloc(nfetched + (2 * nfetched + 63) / 64, sizeof(int64_t));
+    } else {
+        fetched = malloc(ITERATIONS * sizeof(int64_t));
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Win_lock_all(0, win);
+    for (int i = 0; i < ITERATIONS; i++) {
+        int64_t max_value = (int64_t) rank * ITERATIONS + i, bit = (int64_t) 1 << (rank % 62);
+
+        MPI_Fetch_and_op(&one, &fetched[i], MPI_INT64_T, 0, E_MIXED, MPI_SUM, win);
+        MPI_Accumulate(ones, 4, MPI_INT64_T, 0, E_MIXED, 1, strided, MPI_SUM, win);
+        MPI_Accumulate(&mine, 1, MPI_INT64_T, 0, E_SUM, 1, MPI_INT64_T, MPI_SUM, win);
+        MPI_Fetch_and_op(&one, &result, MPI_INT64_T, 0, E_BEFORE, MPI_SUM, win);
+        MPI_Accumulate(block, BLOCK, MPI_INT64_T, 0, E_BLOCK, BLOCK, MPI_INT64_T, MPI_SUM, win);
+        MPI_Fetch_and_op(&one, &result, MPI_INT64_T, 0, E_AFTER, MPI_SUM, win);
+        MPI_Accumulate(&max_value, 1, MPI_INT64_T, 0, E_MAX, 1, MPI_INT64_T, MPI_MAX, win);
+        MPI_Accumulate(&bit, 1, MPI_INT64_T, 0, E_BOR, 1, MPI_INT64_T, MPI_BOR, win);
+        MPI_Win_flush(0, win);
+    }
+    MPI_Win_unlock_all(win);
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    MPI_Gather(0 == rank ? MPI_IN_PLACE : fetched, ITERATIONS, MPI_INT64_T, fetched, ITERATIONS,
+               MPI_INT64_T, 0, MPI_COMM_WORLD);
+    if (0 == rank) {
+        MPI_Win_lock(MPI_LOCK_SHARED, 0, 0, win);
+        MPI_Win_sync(win);
+        errors = check(base, size, fetched, nfetched);
+        MPI_Win_unlock(0, win);
+        printf("osc_atomics: %s (%d errors)\n", errors ? "FAILED" : "passed", errors);
+    }
+    MPI_Bcast(&errors, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+    free(fetched);
+    MPI_Type_free(&strided);
+    MPI_Win_free(&win);
+    MPI_Finalize();
+    return errors ? 1 : 0;
+}
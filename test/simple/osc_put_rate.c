@@ -0,0 +1,131 @@
+/*
+ * Rate of small MPI_Put operations in a passive target epoch, with the
+ * target slots written in sequence or in a random order, and a flush every
+ * FLUSH_EVERY puts. Every process writes to the next one and checks the
+ * content of its own window at the end. Sequential puts can be coalesced
+ * by osc/rdma, random ones mostly can not and show the cost of trying:
+ *
+ *   mpirun -n 2 --mca osc rdma --mca btl tcp,self ./osc_put_rate
+ *   mpirun -n 2 --mca osc rdma --mca btl tcp,self \
+ *          --mca osc_rdma_put_coalesce_size 64 ./osc_put_rate
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mpi.h"
+
+#define SLOTS       8192
+#define MAX_SIZE    64
+#define FLUSH_EVERY 1024
+#define REPEAT      10
+
+static unsigned char slot_value(int writer, int slot, int byte)
+{
+    return (unsigned char) (writer * 31 + slot * 7 + byte);
+}
+
+static int run(const char *name, const int *order, int length, MPI_Win win, unsigned char *base)
+{
+    unsigned char source[SLOTS][MAX_SIZE];
+    int rank, size, target, writer, errors = 0;
+    double start, elapsed, rate;
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    target = (rank + 1) % size;
+    writer = (rank + size - 1) % size;
+
+    for (int s = 0; s < SLOTS; s++) {
+        for (int b = 0; b < length; b++) {
+            source[s][b] = slot_value(rank, s, b);
+        }
+    }
+    memset(base, 0, SLOTS * MAX_SIZE);
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    start = MPI_Wtime();
+    MPI_Win_lock_all(0, win);
+    for (int r = 0; r < REPEAT; r++) {
+        for (int i = 0; i < SLOTS; i++) {
+            int slot = order[i];
+
+            MPI_Put(source[slot], length, MPI_BYTE, target, (MPI_Aint) slot * length, length,
+                    MPI_BYTE, win);
+            if (0 == (i + 1) % FLUSH_EVERY) {
+                MPI_Win_flush(target, win);
+            }
+        }
+    }
+    MPI_Win_unlock_all(win);
+    elapsed = MPI_Wtime() - start;
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    /* the slots are packed at the put length */
+    MPI_Win_lock(MPI_LOCK_SHARED, rank, 0, win);
+    MPI_Win_sync(win);
+    for (int s = 0; s < SLOTS; s++) {
+        for (int b = 0; b < length; b++) {
+            if (base[s * length + b] != slot_value(writer, s, b) && ++errors <= 5) {
+                fprintf(stderr, "%d: %s puts of %d bytes: slot %d byte %d is %d, expected %d\n",
+                        rank, name, length, s, b, base[s * length + b],
+                        slot_value(writer, s, b));
+            }
+        }
+    }
+    MPI_Win_unlock(rank, win);
+
+    rate = (double) SLOTS * REPEAT / elapsed;
+    MPI_Allreduce(MPI_IN_PLACE, &rate, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    if (0 == rank) {
+        printf("%-12s %8d %14.0f\n", name, length, rate / size);
+    }
+
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    int rank, size, errors = 0, total, sequential[SLOTS], random_order[SLOTS];
+    unsigned char *base;
+    MPI_Win win;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    /* MPI_Win_create so that local peers go through the network path as well */
+    base = malloc(SLOTS * MAX_SIZE);
+    MPI_Win_create(base, SLOTS * MAX_SIZE, 1, MPI_INFO_NULL, MPI_COMM_WORLD, &win);
+
+    srand(42 + rank);
+    for (int i = 0; i < SLOTS; i++) {
+        sequential[i] = random_order[i] = i;
+    }
+    for (int i = SLOTS - 1; i > 0; i--) {
+        int j = rand() % (i + 1), tmp = random_order[i];
+
+        random_order[i] = random_order[j];
+        random_order[j] = tmp;
+    }
+
+    if (0 == rank) {
+        printf("%-12s %8s %14s\n", "order", "bytes", "puts/s/proc");
+    }
+    for (int length = 8; length <= MAX_SIZE; length *= 2) {
+        errors += run("sequential", sequential, length, win, base);
+        errors += run("random", random_order, length, win, base);
+    }
+
+    MPI_Allreduce(&errors, &total, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (0 == rank) {
+        printf("osc_put_rate: %s (%d errors)\n", total ? "FAILED" : "passed", total);
+    }
+
+    MPI_Win_free(&win);
+    free(base);
+    MPI_Finalize();
+    return total ? 1 : 0;
+}
@@ -0,0 +1,120 @@
+/*
+ * Ping-pong latency of small messages between two processes, with
+ * persistent requests restarted for every message and with regular sends
+ * and receives. Persistent sends of ob1 reuse the BTL and protocol selected
+ * on their first start, so the difference shows the cost of that selection:
+ *
+ *   mpirun -n 2 ./persist_latency
+ *   mpirun -n 2 --mca btl tcp,self ./persist_latency
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mpi.h"
+
+#define MAX_SIZE   1024
+#define WARMUP     1000
+#define ITERATIONS 20000
+
+static double pingpong_persistent(int rank, int length, char *sbuf, char *rbuf)
+{
+    MPI_Request requests[2];
+    int peer = 1 - rank;
+    double start = 0.0;
+
+    MPI_Send_init(sbuf, length, MPI_BYTE, peer, 0, MPI_COMM_WORLD, &requests[0]);
+    MPI_Recv_init(rbuf, length, MPI_BYTE, peer, 0, MPI_COMM_WORLD, &requests[1]);
+    for (int i = 0; i < WARMUP + ITERATIONS; i++) {
+        if (WARMUP == i) {
+            MPI_Barrier(MPI_COMM_WORLD);
+            start = MPI_Wtime();
+        }
+        if (0 == rank) {
+            MPI_Start(&requests[0]);
+            MPI_Wait(&requests[0], MPI_STATUS_IGNORE);
+            MPI_Start(&requests[1]);
+            MPI_Wait(&requests[1], MPI_STATUS_IGNORE);
+        } else {
+            MPI_Start(&requests[1]);
+            MPI_Wait(&requests[1], MPI_STATUS_IGNORE);
+            MPI_Start(&requests[0]);
+            MPI_Wait(&requests[0], MPI_STATUS_IGNORE);
+        }
+    }
+    start = MPI_Wtime() - start;
+    MPI_Request_free(&requests[0]);
+    MPI_Request_free(&requests[1]);
+
+    return start;
+}
+
+static double pingpong_regular(int rank, int length, char *sbuf, char *rbuf)
+{
+    int peer = 1 - rank;
+    double start = 0.0;
+
+    for (int i = 0; i < WARMUP + ITERATIONS; i++) {
+        if (WARMUP == i) {
+            MPI_Barrier(MPI_COMM_WORLD);
+            start = MPI_Wtime();
+        }
+        if (0 == rank) {
+            MPI_Send(sbuf, length, MPI_BYTE, peer, 0, MPI_COMM_WORLD);
+            MPI_Recv(rbuf, length, MPI_BYTE, peer, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        } else {
+            MPI_Recv(rbuf, length, MPI_BYTE, peer, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            MPI_Send(sbuf, length, MPI_BYTE, peer, 0, MPI_COMM_WORLD);
+        }
+    }
+
+    return MPI_Wtime() - start;
+}
+
+int main(int argc, char *argv[])
+{
+    char sbuf[MAX_SIZE], rbuf[MAX_SIZE];
+    int rank, size, errors = 0;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (2 != size) {
+        if (0 == rank) {
+            fprintf(stderr, "persist_latency needs exactly 2 processes\n");
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    memset(sbuf, rank + 1, MAX_SIZE);
+    if (0 == rank) {
+        printf("%8s %14s %14s\n", "bytes", "persistent us", "regular us");
+    }
+    for (int length = 0; length <= MAX_SIZE; length = length ? length * 4 : 1) {
+        double persistent, regular;
+
+        memset(rbuf, 0, MAX_SIZE);
+        persistent = pingpong_persistent(rank, length, sbuf, rbuf);
+        for (int i = 0; i < length; i++) {
+            if (rbuf[i] != (char) (2 - rank) && ++errors <= 5) {
+                fprintf(stderr, "%d: %d bytes: byte %d is %d\n", rank, length, i, rbuf[i]);
+            }
+        }
+        regular = pingpong_regular(rank, length, sbuf, rbuf);
+        /* half a round trip */
+        if (0 == rank) {
+            printf("%8d %14.2f %14.2f\n", length, persistent * 1e6 / (2.0 * ITERATIONS),
+                   regular * 1e6 / (2.0 * ITERATIONS));
+        }
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, &errors, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (0 == rank) {
+        printf("persist_latency: %s (%d errors)\n", errors ? "FAILED" : "passed", errors);
+    }
+
+    MPI_Finalize();
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,171 @@
+/*
+ * Message rate and bandwidth between two processes, with windows of
+ * non-blocking sends as a pipelining application would post them. Meant
+ * to compare the write modes of the TCP BTL over the loopback interface:
+ *
+ *   mpirun -n 2 --mca btl tcp,self --mca btl_tcp_if_include lo ./tcp_msgrate
+ *   mpirun -n 2 --mca btl tcp,self --mca btl_tcp_if_include lo \
+ *          --mca btl_tcp_send_batch 32 ./tcp_msgrate
+ *   mpirun -n 2 --mca btl tcp,self --mca btl_tcp_if_include lo \
+ *          --mca btl_tcp_zerocopy_threshold 32768 ./tcp_msgrate
+ *
+ * With the connections progressed by I/O threads instead of libevent, the
+ * second run limiting the fragments so that the I/O thread runs out of them
+ * while receiving the windows:
+ *
+ *   mpirun -n 2 --mca btl tcp,self --mca btl_tcp_if_include lo \
+ *          --mca btl_tcp_progress_thread 1 --mca btl_tcp_epoll_threads 2 ./tcp_msgrate
+ *   mpirun -n 2 --mca btl tcp,self --mca btl_tcp_if_include lo \
+ *          --mca btl_tcp_progress_thread 1 --mca btl_tcp_epoll_threads 1 \
+ *          --mca btl_tcp_free_list_max 64 ./tcp_msgrate
+ *
+ * It then sends a single message of LARGE_SIZE bytes (or the size in MB
+ * given as argument) a few times and checks its content, to measure the
+ * bandwidth of one message striped over several connections:
+ *
+ *   mpirun -n 2 --mca btl tcp,self --mca btl_tcp_links 4 \
+ *          --mca btl_tcp_stripe_min_size 1048576 ./tcp_msgrate
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mpi.h"
+
+#define WINDOW     64
+#define MAX_SIZE   (4 * 1024 * 1024)
+#define MAX_BYTES  (256 * 1024 * 1024)
+#define ITERATIONS 1000
+#define LARGE_SIZE ((size_t) 1024 * 1024 * 1024)
+#define LARGE_REPEAT 4
+
+static MPI_Datatype kbyte_type;
+
+/* one message of length bytes at a time, the receiver checks the content */
+static int large_bandwidth(int rank, size_t length)
+{
+    int peer = 1 - rank, errors = 0;
+    unsigned char *buffer = malloc(length);
+    double start, elapsed;
+
+    if (NULL == buffer) {
+        fprintf(stderr, "%d: cannot allocate %zu bytes\n", rank, length);
+        return 1;
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    elapsed = 0.0;
+    for (int r = 0; r < LARGE_REPEAT; r++) {
+        for (size_t i = 0; i < length; i += 4096) {
+            buffer[i] = 0 == rank ? (unsigned char) (i / 4096 + r) : 0;
+        }
+        MPI_Barrier(MPI_COMM_WORLD);
+        start = MPI_Wtime();
+        /* the count of a single send is an int, a contiguous type carries the rest */
+        if (0 == rank) {
+            MPI_Send(buffer, (int) (length / 1024), kbyte_type, peer, 0, MPI_COMM_WORLD);
+            MPI_Recv(NULL, 0, MPI_BYTE, peer, 1, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        } else {
+            MPI_Recv(buffer, (int) (length / 1024), kbyte_type, peer, 0, MPI_COMM_WORLD,
+                     MPI_STATUS_IGNORE);
+            MPI_Send(NULL, 0, MPI_BYTE, peer, 1, MPI_COMM_WORLD);
+        }
+        elapsed += MPI_Wtime() - start;
+        if (1 == rank) {
+            for (size_t i = 0; i < length; i += 4096) {
+                if (buffer[i] != (unsigned char) (i / 4096 + r) && ++errors <= 5) {
+                    fprintf(stderr, "byte %zu is %d\n", i, buffer[i]);
+                }
+            }
+        }
+    }
+    if (0 == rank) {
+        printf("%10zu %12.0f %12.2f\n", length, LARGE_REPEAT / elapsed,
+               (double) LARGE_REPEAT * length / elapsed / 1e6);
+    }
+
+    free(buffer);
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    MPI_Request requests[WINDOW];
+    int rank, size, peer, iterations, errors;
+    size_t large;
+    char *buffer;
+    double start, elapsed;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (2 != size) {
+        if (0 == rank) {
+            fprintf(stderr, "tcp_msgrate needs exactly 2 processes\n");
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    peer = 1 - rank;
+
+    /* the window shares a single buffer, only the rate matters */
+    buffer = malloc(MAX_SIZE);
+    memset(buffer, rank, MAX_SIZE);
+
+    if (0 == rank) {
+        printf("%10s %12s %12s\n", "bytes", "msgs/s", "MB/s");
+    }
+    for (int length = 1; length <= MAX_SIZE; length *= 4) {
+        iterations = ITERATIONS;
+        if ((size_t) iterations * WINDOW * length > MAX_BYTES) {
+            iterations = MAX_BYTES / ((size_t) WINDOW * length);
+            if (iterations < 2) {
+                iterations = 2;
+            }
+        }
+
+        MPI_Barrier(MPI_COMM_WORLD);
+        start = MPI_Wtime();
+        for (int i = 0; i < iterations; i++) {
+            for (int j = 0; j < WINDOW; j++) {
+                if (0 == rank) {
+                    MPI_Isend(buffer, length, MPI_BYTE, peer, j, MPI_COMM_WORLD, &requests[j]);
+                } else {
+                    MPI_Irecv(buffer, length, MPI_BYTE, peer, j, MPI_COMM_WORLD, &requests[j]);
+                }
+            }
+            MPI_Waitall(WINDOW, requests, MPI_STATUSES_IGNORE);
+        }
+        /* the window is complete once the receiver has all of it */
+        if (0 == rank) {
+            MPI_Recv(NULL, 0, MPI_BYTE, peer, WINDOW, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        } else {
+            MPI_Send(NULL, 0, MPI_BYTE, peer, WINDOW, MPI_COMM_WORLD);
+        }
+        elapsed = MPI_Wtime() - start;
+
+        if (0 == rank) {
+            double messages = (double) iterations * WINDOW;
+            printf("%10d %12.0f %12.2f\n", length, messages / elapsed,
+                   messages * length / elapsed / 1e6);
+        }
+    }
+
+    free(buffer);
+
+    MPI_Type_contiguous(1024, MPI_BYTE, &kbyte_type);
+    MPI_Type_commit(&kbyte_type);
+    large = LARGE_SIZE;
+    if (argc > 1 && atoi(argv[1]) > 0) {
+        large = (size_t) atoi(argv[1]) * 1024 * 1024;
+    }
+    errors = large_bandwidth(rank, large);
+    MPI_Allreduce(MPI_IN_PLACE, &errors, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (0 == rank) {
+        printf("tcp_msgrate: %s (%d errors)\n", errors ? "FAILED" : "passed", errors);
+    }
+    MPI_Type_free(&kbyte_type);
+
+    MPI_Finalize();
+    return errors ? 1 : 0;
+}
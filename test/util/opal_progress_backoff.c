@@ -0,0 +1,129 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "opal_config.h"
+
+#include <stdio.h>
+
+#include "opal/constants.h"
+#include "opal/runtime/opal.h"
+#include "opal/runtime/opal_progress.h"
+#include "support.h"
+
+/*
+ * Check the back-off of the idle progress callbacks: an idle callback is
+ * skipped for 1, 2, 4, ... calls up to opal_progress_max_backoff, and is
+ * polled on every call again once it reports events or once
+ * opal_progress_poll_now() is called for it.
+ */
+
+#define MAX_BACKOFF 8
+#define CALLS       40
+
+#define NUM(a) ((int) (sizeof(a) / sizeof((a)[0])))
+
+static int dummy_polls = 0;
+static int dummy_events = 0;
+
+static int dummy_progress(void)
+{
+    ++dummy_polls;
+    return dummy_events;
+}
+
+/* run opal_progress ncalls times, and store the calls that polled the dummy callback, numbered
+ * from 1 */
+static int record_polls(int ncalls, int *polled)
+{
+    int npolled = 0;
+
+    for (int i = 1; i <= ncalls; ++i) {
+        int before = dummy_polls;
+
+        opal_progress();
+        if (dummy_polls != before) {
+            polled[npolled++] = i;
+        }
+    }
+    return npolled;
+}
+
+static void check_polls(const char *name, const int *expected, int nexpected, const int *polled,
+                        int npolled)
+{
+    char comment[128];
+
+    snprintf(comment, sizeof(comment), "%s: number of polls", name);
+    test_comment(comment);
+    if (!test_verify_int(nexpected, npolled)) {
+        return;
+    }
+    for (int i = 0; i < nexpected; ++i) {
+        snprintf(comment, sizeof(comment), "%s: poll %d", name, i);
+        test_comment(comment);
+        test_verify_int(expected[i], polled[i]);
+    }
+}
+
+/* run opal_progress until it polls the dummy callback, which takes at most MAX_BACKOFF + 1
+ * calls */
+static void wait_poll(void)
+{
+    int polled[1], ncalls = 1;
+
+    while (0 == record_polls(1, polled) && ncalls <= MAX_BACKOFF) {
+        ++ncalls;
+    }
+    test_comment("calls before the end of the back-off");
+    test_verify_int(1, ncalls <= MAX_BACKOFF + 1);
+}
+
+int main(int argc, char *argv[])
+{
+    /* polled, then skipped for 1, 2, 4, 8, 8, ... calls */
+    const int idle[] = {1, 3, 6, 11, 20, 29, 38};
+    const int busy[] = {1, 2, 3};
+    int polled[CALLS], npolled, ret;
+
+    test_init("opal_progress back-off");
+
+    ret = opal_init(&argc, &argv);
+    if (OPAL_SUCCESS != ret) {
+        test_fail_stop("opal_init failed", ret);
+    }
+
+    opal_progress_max_backoff = MAX_BACKOFF;
+    opal_progress_register(dummy_progress);
+
+    /* exponential back-off of an idle callback */
+    npolled = record_polls(CALLS, polled);
+    check_polls("idle", idle, NUM(idle), polled, npolled);
+
+    /* reporting events resets the back-off, the callback is polled on every call while it reports
+     * some and backs off from 1 call again once it is idle */
+    dummy_events = 1;
+    wait_poll();
+    npolled = record_polls(NUM(busy), polled);
+    check_polls("events", busy, NUM(busy), polled, npolled);
+    dummy_events = 0;
+    npolled = record_polls(CALLS, polled);
+    check_polls("idle after events", idle, NUM(idle), polled, npolled);
+
+    /* opal_progress_poll_now() ends the back-off, the callback is polled on the next call and
+     * backs off from 1 call again */
+    opal_progress_poll_now(dummy_progress);
+    npolled = record_polls(CALLS, polled);
+    check_polls("idle after poll_now", idle, NUM(idle), polled, npolled);
+
+    opal_progress_unregister(dummy_progress);
+    opal_progress_max_backoff = 0;
+
+    opal_finalize();
+
+    return test_finalize();
+}